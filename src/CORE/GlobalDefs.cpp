@@ -16,7 +16,13 @@ const String &styleDir PROGMEM = PSTR("/style"),
 			 &alertsDir PROGMEM = PSTR("/alerts"),
 			 &updateDir PROGMEM = PSTR("/update"),
 			 &firmwareDir PROGMEM = PSTR("/firmware"),
-             &scriptDir PROGMEM = PSTR("/script");
+			 &logDir PROGMEM = PSTR("/log"),
+			 &traceDir PROGMEM = PSTR("/trace"),
+			 &heapDir PROGMEM = PSTR("/heap"),
+             &scriptDir PROGMEM = PSTR("/script"),
+			 &scriptUploadDir PROGMEM = PSTR("/script_upload"),
+			 &scriptCheckDir PROGMEM = PSTR("/script_check"),
+			 &scriptCommitDir PROGMEM = PSTR("/script_commit");
 //
 
 //PLC RELATED TAGS
@@ -29,12 +35,37 @@ const String &bitTagDN PROGMEM = PSTR("DN"), //Done
 			 &bitTagSRCB PROGMEM = PSTR("B"), //Source B variabel input
 			 &bitTagDEST PROGMEM = PSTR("DEST"), //Destination
 			 &bitTagVAL PROGMEM = PSTR("VAL"), //Value bit - generic
+			 &bitTagOV PROGMEM = PSTR("OV"), //Overflow
+			 &bitTagUN PROGMEM = PSTR("UN"), //Underflow
+			 &bitTagRATE PROGMEM = PSTR("RATE"), //Rate of change (per second)
+			 &bitTagRE PROGMEM = PSTR("RE"), //Rising edge
+			 &bitTagFE PROGMEM = PSTR("FE"), //Falling edge
+			 &bitTagPW PROGMEM = PSTR("PW"), //Pulse width
+			 &bitTagEU PROGMEM = PSTR("EU"), //Value in engineering units
+			 &bitTagPV PROGMEM = PSTR("PV"), //Process variable
+			 &bitTagSP PROGMEM = PSTR("SP"), //Setpoint
+			 &bitTagCV PROGMEM = PSTR("CV"), //Control variable (output)
+			 &bitTagKP PROGMEM = PSTR("KP"), //Proportional gain
+			 &bitTagKI PROGMEM = PSTR("KI"), //Integral gain (per second)
+			 &bitTagKD PROGMEM = PSTR("KD"), //Derivative gain (seconds)
+			 &bitTagMAN PROGMEM = PSTR("MAN"), //Manual mode
+			 &bitTagMIN PROGMEM = PSTR("MIN"), //Minimum value
+			 &bitTagMAX PROGMEM = PSTR("MAX"), //Maximum value
+			 &bitTagERR PROGMEM = PSTR("ERR"), //Error value
+			 &bitTagLEN PROGMEM = PSTR("LEN"), //Length (number of elements)
+			 &bitTagEM PROGMEM = PSTR("EM"), //Empty
+			 &bitTagFL PROGMEM = PSTR("FL"), //Full
+			 &bitTagPOS PROGMEM = PSTR("POS"), //Position (number of stored values)
+			 &bitTagUL PROGMEM = PSTR("UL"), //Unload bit
+			 &bitTagSTEP PROGMEM = PSTR("STEP"), //Current step
+			 &bitTagJMP PROGMEM = PSTR("JMP"), //Jump request
 
              &logicTagNO PROGMEM = PSTR("NO"), //Normally open contact
 			 &logicTagNC PROGMEM = PSTR("NC"), //Normally closed contact
 
              &typeTagTOF PROGMEM = PSTR("TOF"), //TYPE: Timer-off
 			 &typeTagTON PROGMEM = PSTR("TON"), //TYPE: Timer-on
+			 &typeTagRTO PROGMEM = PSTR("RTO"), //TYPE: Retentive timer-on
 			 &typeTagCTD PROGMEM = PSTR("CTD"), //TYPE: Counter-down
 			 &typeTagCTU PROGMEM = PSTR("CTU"), //TYPE: Counter-up
 			 &typeTagMGRE PROGMEM = PSTR("GRE"), //TYPE: MATH - Greater than
@@ -56,9 +87,24 @@ const String &bitTagDN PROGMEM = PSTR("DN"), //Done
 			 &typeTagMADD PROGMEM = PSTR("ADD"), //TYPE: MATH - Addition function
 			 &typeTagMSUB PROGMEM = PSTR("SUB"), //TYPE: MATH - Subtraction function
 			 &typeTagMMOV PROGMEM = PSTR("MOV"), //MOV blocks are responsible for transferring (copying) data between two variable objects.
+			 &typeTagMCOP PROGMEM = PSTR("COP"), //TYPE: MATH - Array copy
+			 &typeTagMFILL PROGMEM = PSTR("FILL"), //TYPE: MATH - Array fill
+			 &typeTagMFIND PROGMEM = PSTR("FIND"), //TYPE: MATH - Array search
+			 &typeTagMSUM PROGMEM = PSTR("SUM"), //TYPE: MATH - Array sum
+			 &typeTagMAVG PROGMEM = PSTR("AVG"), //TYPE: MATH - Array average
+			 &typeTagMMIN PROGMEM = PSTR("MIN"), //TYPE: MATH - Array minimum
+			 &typeTagMMAX PROGMEM = PSTR("MAX"), //TYPE: MATH - Array maximum
+			 &typeTagMCPT PROGMEM = PSTR("CPT"), //TYPE: MATH - Compute (expression)
 			 &typeTagAnalog PROGMEM = PSTR("ANALOG"), //input (and possibly output) identifier - for analog signals
 			 &typeTagDigital PROGMEM = PSTR("DIGITAL"), //input (and possibly output) identifier - for digital signals
 			 &typeTagPWM PROGMEM = PSTR("PWM"), //Pulse width modulation 
+			 &typeTagQUAD PROGMEM = PSTR("QUAD"), //Quadrature encoder input (high speed counters)
+			 &typeTagInterrupt PROGMEM = PSTR("INT"), //Digital input with interrupt driven edge capture
+			 &typeTagAVG PROGMEM = PSTR("AVG"), //Analog filter: moving average
+			 &typeTagMED PROGMEM = PSTR("MED"), //Analog filter: median
+			 &typeTagIIR PROGMEM = PSTR("IIR"), //Analog filter: first order low pass
+			 &typeTagMS PROGMEM = PSTR("MS"), //Timer time base: milliseconds
+			 &typeTagUS PROGMEM = PSTR("US"), //Timer time base: microseconds
 
              &timerTag1 PROGMEM = PSTR("TIMER"), //Timer object
 			 &timerTag2 PROGMEM = PSTR("TMR"), //Timer object alias
@@ -66,6 +112,21 @@ const String &bitTagDN PROGMEM = PSTR("DN"), //Done
 			 &inputTag2 PROGMEM = PSTR("IN"), //Input object alias
 			 &counterTag1 PROGMEM = PSTR("COUNTER"), //Counter object
 			 &counterTag2 PROGMEM = PSTR("CNTR"), //Counter object alias
+			 &hsCounterTag PROGMEM = PSTR("HSC"), //High speed (hardware) counter object
+			 &scheduleTag1 PROGMEM = PSTR("SCHEDULE"), //Schedule (time of day/day of week) object
+			 &scheduleTag2 PROGMEM = PSTR("SCH"), //Schedule object alias
+			 &pidTag PROGMEM = PSTR("PID"), //PID controller object
+			 &fifoTag PROGMEM = PSTR("FIFO"), //First in, first out stack object
+			 &lifoTag PROGMEM = PSTR("LIFO"), //Last in, first out stack object
+			 &unloadTag1 PROGMEM = PSTR("UNLOAD"), //Stack unload object
+			 &unloadTag2 PROGMEM = PSTR("UNL"), //Stack unload object alias
+			 &shiftLeftTag PROGMEM = PSTR("BSL"), //Bit shift left register object
+			 &shiftRightTag PROGMEM = PSTR("BSR"), //Bit shift right register object
+			 &sequencerTag PROGMEM = PSTR("SEQ"), //Step sequencer object
+			 &loggerTag PROGMEM = PSTR("LOG"), //Data logger object
+			 &retainTag PROGMEM = PSTR("RET"), //Retentive flag (last argument of a declaration)
+			 &taskTag PROGMEM = PSTR("TASK"), //Task section header: TASK[<NAME>,<PERIOD>]
+			 &taskTagMain PROGMEM = PSTR("MAIN"), //Task that holds the rungs before the first task section
 			 &variableTag1 PROGMEM = PSTR("VARIABLE"), //Virtuals serve as boolean storage for outputs (instead of physical pins).
 			 &variableTag2 PROGMEM = PSTR("VAR"), //Virtual object alias
 			 &outputTag1 PROGMEM = PSTR("OUTPUT"), //Output object
@@ -77,12 +138,17 @@ const String &bitTagDN PROGMEM = PSTR("DN"), //Done
 
 //Storage related constants
 const String &file_Stylesheet PROGMEM = PSTR("/style.css"),
-			 &file_Configuration PROGMEM = PSTR("/config.cfg"),
-			 &file_Script PROGMEM = PSTR("/PLC_SCRIPT.txt");
+			 &file_Configuration PROGMEM = PSTR("/config.cfg"), //Text settings, only read to migrate settings saved by older firmware
+			 &file_Settings PROGMEM = PSTR("/settings.bin"), //Binary settings record
+			 &file_Script PROGMEM = PSTR("/PLC_SCRIPT.txt"),
+			 &file_Retain PROGMEM = PSTR("/retain.dat"), //Retentive value journal
+			 &file_RetainTemp PROGMEM = PSTR("/retain.tmp"); //Retentive value snapshot, while it is being written
 //
 
 //Web UI Constants
 const String &transmission_HTML PROGMEM = PSTR("text/html"),
+			 &transmission_CSV PROGMEM = PSTR("text/csv"),
+			 &transmission_Binary PROGMEM = PSTR("application/octet-stream"),
 			 &html_form_Begin PROGMEM = PSTR("<FORM action=\"."),
 			 &html_form_Middle PROGMEM = PSTR("\" method=\"post\" id=\"form\">"),
 			 &html_form_Middle_Upload PROGMEM = PSTR("\" method=\"post\" enctype=\"multipart/form-data\" id=\"form\">"), 
@@ -112,7 +178,8 @@ const String &err_failed_creation PROGMEM = PSTR("Failed to create object."),
 			 &err_invalid_function PROGMEM = PSTR("Function given is not supported."),
 			 &err_math_too_many_args PROGMEM = PSTR("Function was given too many arguments."),
 			 &err_math_too_few_args PROGMEM = PSTR("Function was given too few arguments."),
-			 &err_math_division_by_zero PROGMEM = PSTR("A division by zero was about to occur.");
+			 &err_math_division_by_zero PROGMEM = PSTR("A division by zero was about to occur."),
+			 &err_invalid_expression PROGMEM = PSTR("Invalid expression.");
 //
 //Variable string definitions
 const String &VAR_INT32 PROGMEM = PSTR("INT32"),
@@ -404,6 +471,14 @@ OBJ_TYPE findMathObjectType( const String &str )
 	else if ( str == typeTagMSUB ) return OBJ_TYPE::TYPE_MATH_SUB;
 	else if ( str == typeTagMSIN ) return OBJ_TYPE::TYPE_MATH_SIN;
 	else if ( str == typeTagMNEQ ) return OBJ_TYPE::TYPE_MATH_NEQ;
+	else if ( str == typeTagMCOP ) return OBJ_TYPE::TYPE_MATH_COP;
+	else if ( str == typeTagMFILL ) return OBJ_TYPE::TYPE_MATH_FILL;
+	else if ( str == typeTagMFIND ) return OBJ_TYPE::TYPE_MATH_FIND;
+	else if ( str == typeTagMSUM ) return OBJ_TYPE::TYPE_MATH_SUM;
+	else if ( str == typeTagMAVG ) return OBJ_TYPE::TYPE_MATH_AVG;
+	else if ( str == typeTagMMIN ) return OBJ_TYPE::TYPE_MATH_MIN;
+	else if ( str == typeTagMMAX ) return OBJ_TYPE::TYPE_MATH_MAX;
+	else if ( str == typeTagMCPT ) return OBJ_TYPE::TYPE_MATH_CPT;
 
 	return OBJ_TYPE::TYPE_INVALID; //could not find the object
 }
@@ -16,6 +16,7 @@
 #include <map>
 
 #define DEBUG //comment out to remove debugging code.
+//#define DEBUG_REMOTE //prints every remote exchange. Builds the messages in the scan, so it allocates on every update (the event trace records the exchanges without that).
 
 using namespace std;
 
@@ -41,7 +42,13 @@ extern const String &styleDir PROGMEM,
 					&alertsDir PROGMEM,
 					&updateDir PROGMEM,
 					&firmwareDir PROGMEM,
-			 		&scriptDir PROGMEM;
+					&logDir PROGMEM,
+					&traceDir PROGMEM,
+					&heapDir PROGMEM,
+			 		&scriptDir PROGMEM,
+					&scriptUploadDir PROGMEM,
+					&scriptCheckDir PROGMEM,
+					&scriptCommitDir PROGMEM;
 //
 
 //PLC_Remote Constants for queries (non printable chars)
@@ -54,6 +61,7 @@ const char CMD_REQUEST_UPDATE = 17, //Data prefix for requesting (by a client) a
 		   CHAR_UPDATE_GROUP = 29, //This character is used to denote the separation of a set of data records (pertaining to individual ladder objects) for serial or web updates.
 		   CHAR_UPDATE_RECORD = 30, //This character is used to denote the separation of a data record as it pertains to receiving updates from serial or a web interface.
 		   CHAR_QUERY_END = 15, //This character is appended to the end of the update string, and denotes the end of all update info. This must be included before updates are applied.
+		   CHAR_ARG_MASK = 28, //Used by the parser in place of object arguments that contain logic operators (EX: CPT expressions), so they aren't split apart.
 		   CHAR_TRANSMIT_END = 14; //This char is appended to the end of a string that has been transmitted between hosts. Used to mark the end of a read cycle.
 //
 
@@ -85,17 +93,25 @@ const char CMD_DISCONNECT = 'd',
 		   CMD_AP = 'a', //"ssid":"password"
 		   CMD_VERBOSE = 'v', //<mode> can be 0 or any non-zero value, as well as 'on' or 'off'
 		   CMD_PROGRAM = 'p', //stores specified values to eeprom so that they will load automatically in the future
-		   CMD_TIME = 't'; //Used to set system time. No args returns time, args set time.
+		   CMD_TIME = 't', //Used to set system time. No args returns time, args set time.
+		   CMD_TASKS = 'k', //Lists the PLC tasks with their timing statistics
+		   CMD_WATCHDOG = 'w', //Shows the scan watchdog state and last overrun. 'reset' releases held outputs and clears a fault
+		   CMD_TRACE = 'r'; //Dumps the event trace as hex lines. 'on'/'off' enables or disables tracing, 'rungs' also records each rung
 
 
 //Storage related constants
 extern const String &file_Stylesheet PROGMEM,
 			        &file_Configuration PROGMEM,
-			        &file_Script PROGMEM;
+					&file_Settings PROGMEM,
+			        &file_Script PROGMEM,
+					&file_Retain PROGMEM,
+					&file_RetainTemp PROGMEM;
 //
 
 //Web UI constants
 extern const String &transmission_HTML PROGMEM,
+					&transmission_CSV PROGMEM,
+					&transmission_Binary PROGMEM,
 			 		&html_form_Begin PROGMEM,
 			 		&html_form_Middle PROGMEM,
 					&html_form_Middle_Upload PROGMEM,
@@ -126,7 +142,8 @@ extern const String &err_failed_creation PROGMEM,
 					&err_invalid_function PROGMEM,
 					&err_math_too_many_args PROGMEM,
 					&err_math_too_few_args PROGMEM,
-					&err_math_division_by_zero PROGMEM;
+					&err_math_division_by_zero PROGMEM,
+					&err_invalid_expression PROGMEM;
 
 //Variable string definitions
 extern const String &VAR_INT32 PROGMEM,
@@ -151,12 +168,22 @@ enum class OBJ_TYPE : uint8_t
 	TYPE_OUTPUT_PWM, 	//physical output - PWM output type
 	TYPE_VIRTUAL,		//internal coil (variable)
 	TYPE_CLOCK,			//clock object type 
+	TYPE_SCHEDULE,		//time of day/day of week schedule
 	TYPE_TIMER_ON,			//timed on
 	TYPE_TIMER_OFF,			//timed off
 	TYPE_TIMER_RET,			//retentive timer
 	TYPE_COUNTER_UP,			//count up timer
 	TYPE_COUNTER_DOWN,			//count down timer
+	TYPE_COUNTER_HS,			//high speed (hardware) pulse counter
 	TYPE_ONS,			//one shot objects. Pulses high briefly, then goes low. Will not pulse until low-> high transition occurs. 
+	TYPE_PID,			//closed loop PID controller
+	TYPE_FIFO,			//first in, first out stack of values
+	TYPE_LIFO,			//last in, first out stack of values
+	TYPE_STACK_UNLOAD,	//unloads a value from a FIFO/LIFO stack
+	TYPE_SHIFT_LEFT,	//bit shift register, shifts toward higher positions
+	TYPE_SHIFT_RIGHT,	//bit shift register, shifts toward position 0
+	TYPE_SEQUENCER,		//step sequencer (state machine)
+	TYPE_LOGGER,		//data logger (compressed samples saved to flash)
 	TYPE_MATH_MUL, //Multiply
 	TYPE_MATH_DIV, //Divide
 	TYPE_MATH_ADD, //Addition
@@ -178,6 +205,13 @@ enum class OBJ_TYPE : uint8_t
 	TYPE_MATH_DEC,		//decrement block - subtracts 1 from the inputted source variable
 	TYPE_MATH_CPT,		//compute block. Performs a math operation and sends the calculated value to the provided storage variable
 	TYPE_MATH_MOV,		//Move block, used for transferring data from a source to another destination (IE: From Source to Source, Dest to Source, etc.)
+	TYPE_MATH_COP,		//Array copy block - copies a range of elements from one array into another
+	TYPE_MATH_FILL,		//Array fill block - writes a single value into a range of array elements
+	TYPE_MATH_FIND,		//Array search block - finds the first element in a range that is equal to a value
+	TYPE_MATH_SUM,		//Array sum block - adds all elements in a range
+	TYPE_MATH_AVG,		//Array average block - averages all elements in a range
+	TYPE_MATH_MIN,		//Array minimum block - finds the smallest element in a range
+	TYPE_MATH_MAX,		//Array maximum block - finds the largest element in a range
 	TYPE_REMOTE,		//Remote object. Ued in cluster and expander operations when multiple ESP devices are interconnected via networks.
 
 	//Variable Exclusive Types
@@ -190,6 +224,7 @@ enum class OBJ_TYPE : uint8_t
 	TYPE_VAR_LONG,		//variable type, used to store information (long int - 64bit)
 	TYPE_VAR_ULONG,		//variable type, used to store information (unsigned long - 64bit)
 	TYPE_VAR_STRING,	//variable type, used to store information (String)
+	TYPE_VAR_ARRAY,		//array variable, a fixed length block of elements of a single variable type
 };
 
 enum OBJ_LOGIC : uint8_t 
@@ -245,7 +280,8 @@ enum class ERR_DATA : uint8_t
 	ERR_INVALID_FUNCTION, //This indicates that a function was given to a math object that is not supported.
 	ERR_MATH_TOO_MANY_ARGS, //This indicates that a function was given too many arguments to use.
 	ERR_MATH_TOO_FEW_ARGS, //This indicates that a function was given too few arguments to use.
-	ERR_MATH_DIV_BY_0 //This indicates that a division by zero was about to occur.
+	ERR_MATH_DIV_BY_0, //This indicates that a division by zero was about to occur.
+	ERR_INVALID_EXPRESSION //This indicates that an expression given to a compute block could not be compiled.
 };
 
 
@@ -258,12 +294,37 @@ extern const String &bitTagDN PROGMEM,
 					&bitTagSRCB PROGMEM,
 					&bitTagDEST PROGMEM,
 					&bitTagVAL PROGMEM,
+					&bitTagOV PROGMEM,
+					&bitTagUN PROGMEM,
+					&bitTagRATE PROGMEM,
+					&bitTagRE PROGMEM,
+					&bitTagFE PROGMEM,
+					&bitTagPW PROGMEM,
+					&bitTagEU PROGMEM,
+					&bitTagPV PROGMEM,
+					&bitTagSP PROGMEM,
+					&bitTagCV PROGMEM,
+					&bitTagKP PROGMEM,
+					&bitTagKI PROGMEM,
+					&bitTagKD PROGMEM,
+					&bitTagMAN PROGMEM,
+					&bitTagMIN PROGMEM,
+					&bitTagMAX PROGMEM,
+					&bitTagERR PROGMEM,
+					&bitTagLEN PROGMEM,
+					&bitTagEM PROGMEM,
+					&bitTagFL PROGMEM,
+					&bitTagPOS PROGMEM,
+					&bitTagUL PROGMEM,
+					&bitTagSTEP PROGMEM,
+					&bitTagJMP PROGMEM,
 
 			 		&logicTagNO PROGMEM,
 			 		&logicTagNC PROGMEM,
 
 			 		&typeTagTOF PROGMEM,
 			 		&typeTagTON PROGMEM,
+			 		&typeTagRTO PROGMEM,
 			 		&typeTagCTD PROGMEM,
 			 		&typeTagCTU PROGMEM,
 			 		&typeTagMGRE PROGMEM,
@@ -285,9 +346,24 @@ extern const String &bitTagDN PROGMEM,
 					&typeTagMADD PROGMEM,
 					&typeTagMSUB PROGMEM,
 					&typeTagMMOV PROGMEM,
+					&typeTagMCOP PROGMEM,
+					&typeTagMFILL PROGMEM,
+					&typeTagMFIND PROGMEM,
+					&typeTagMSUM PROGMEM,
+					&typeTagMAVG PROGMEM,
+					&typeTagMMIN PROGMEM,
+					&typeTagMMAX PROGMEM,
+					&typeTagMCPT PROGMEM,
 					&typeTagAnalog PROGMEM,
 					&typeTagDigital PROGMEM,
 					&typeTagPWM PROGMEM,
+					&typeTagQUAD PROGMEM,
+					&typeTagInterrupt PROGMEM,
+					&typeTagAVG PROGMEM,
+					&typeTagMED PROGMEM,
+					&typeTagIIR PROGMEM,
+					&typeTagMS PROGMEM,
+					&typeTagUS PROGMEM,
 
 			 		&timerTag1 PROGMEM,
 			 		&timerTag2 PROGMEM,
@@ -295,6 +371,21 @@ extern const String &bitTagDN PROGMEM,
 			 		&inputTag2 PROGMEM,
 					&counterTag1 PROGMEM,
 			 		&counterTag2 PROGMEM,
+					&hsCounterTag PROGMEM,
+					&scheduleTag1 PROGMEM,
+					&scheduleTag2 PROGMEM,
+					&pidTag PROGMEM,
+					&fifoTag PROGMEM,
+					&lifoTag PROGMEM,
+					&unloadTag1 PROGMEM,
+					&unloadTag2 PROGMEM,
+					&shiftLeftTag PROGMEM,
+					&shiftRightTag PROGMEM,
+					&sequencerTag PROGMEM,
+					&loggerTag PROGMEM,
+					&retainTag PROGMEM,
+					&taskTag PROGMEM,
+					&taskTagMain PROGMEM,
 			 		&variableTag1 PROGMEM,
 			 		&variableTag2 PROGMEM,
 			 		&outputTag1 PROGMEM,
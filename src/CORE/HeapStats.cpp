@@ -0,0 +1,239 @@
+/*
+ * HeapStats.cpp
+ *
+ * Heap accounting by subsystem, see HeapStats.h.
+ */
+
+#include "HeapStats.h"
+#include "GlobalDefs.h"
+#include <new>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+
+static Heap_Tag_Stats heapTagStats[HEAP_NUM_TAGS]; //zero initialized before any constructor runs, malloc may be called first
+static thread_local uint8_t i_heapTag = HEAP_TAG_OTHER;
+static thread_local uint32_t i_threadAllocs = 0;
+
+Heap_Scope::Heap_Scope( HEAP_TAG tag )
+{
+	i_previous = i_heapTag;
+	i_heapTag = tag;
+}
+
+Heap_Scope::~Heap_Scope()
+{
+	i_heapTag = i_previous;
+}
+
+#if HEAP_ACCOUNTING
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_heap_caps.h>
+#define heapBlockSize(ptr) heap_caps_get_allocated_size(ptr)
+#else
+#include <malloc.h>
+#define heapBlockSize(ptr) malloc_usable_size(ptr)
+#endif
+
+extern "C"
+{
+	void *__real_malloc( size_t );
+	void *__real_calloc( size_t, size_t );
+	void *__real_realloc( void *, size_t );
+	void __real_free( void * );
+	void __wrap_free( void * );
+}
+
+static void countAllocation( size_t size )
+{
+	Heap_Tag_Stats &stats = heapTagStats[i_heapTag];
+	i_threadAllocs++;
+	stats.i_allocs.fetch_add(1, memory_order_relaxed);
+	stats.i_bytes.fetch_add(size, memory_order_relaxed);
+}
+
+static void countFree()
+{
+	heapTagStats[i_heapTag].i_frees.fetch_add(1, memory_order_relaxed);
+}
+
+//The last two bytes of each block (past the bytes that were asked for) hold the subsystem that allocated it and a check of it, so the block's size is
+//taken off the right subsystem wherever it's freed. Blocks that didn't come through the wrappers (heap_caps_malloc, libraries linked without them) fail
+//the check and are left out of the bytes in use.
+static void tagBlock( void *ptr )
+{
+	uint8_t *block = static_cast<uint8_t *>(ptr), tag = i_heapTag;
+	size_t size = heapBlockSize(ptr);
+	block[size - HEAP_TAG_SIZE] = tag;
+	block[size - 1] = tag ^ HEAP_TAG_CHECK;
+
+	Heap_Tag_Stats &stats = heapTagStats[tag];
+	int32_t current = stats.i_current.fetch_add(size, memory_order_relaxed) + size;
+	int32_t peak = stats.i_peak.load(memory_order_relaxed);
+	while ( current > peak && !stats.i_peak.compare_exchange_weak(peak, current, memory_order_relaxed) ){}
+}
+
+static void untagBlock( void *ptr )
+{
+	const uint8_t *block = static_cast<const uint8_t *>(ptr);
+	size_t size = heapBlockSize(ptr);
+	if ( size < HEAP_TAG_SIZE )
+		return;
+
+	uint8_t tag = block[size - HEAP_TAG_SIZE];
+	if ( tag < HEAP_NUM_TAGS && block[size - 1] == ( tag ^ HEAP_TAG_CHECK ) )
+		heapTagStats[tag].i_current.fetch_sub(size, memory_order_relaxed);
+}
+
+//Every reference to malloc, calloc, realloc and free in the program (including the libraries) is redirected here by the linker.
+extern "C" void *__wrap_malloc( size_t size )
+{
+	if ( size > SIZE_MAX - HEAP_TAG_SIZE )
+		return 0;
+
+	void *ptr = __real_malloc(size + HEAP_TAG_SIZE);
+	if ( ptr )
+	{
+		countAllocation(size);
+		tagBlock(ptr);
+	}
+	return ptr;
+}
+
+extern "C" void *__wrap_calloc( size_t num, size_t size )
+{
+	if ( size && num > ( SIZE_MAX - HEAP_TAG_SIZE ) / size )
+		return 0;
+
+	void *ptr = __real_calloc(1, num * size + HEAP_TAG_SIZE);
+	if ( ptr )
+	{
+		countAllocation(num * size);
+		tagBlock(ptr);
+	}
+	return ptr;
+}
+
+//A realloc counts as an allocation even when the block grows in place, the scan must not rely on the allocator having room.
+extern "C" void *__wrap_realloc( void *ptr, size_t size )
+{
+	if ( ptr && !size )
+	{
+		__wrap_free(ptr);
+		return 0;
+	}
+	if ( size > SIZE_MAX - HEAP_TAG_SIZE )
+		return 0;
+
+	if ( ptr )
+		untagBlock(ptr); //counted again below if the realloc fails, as the block is kept
+	void *newPtr = __real_realloc(ptr, size + HEAP_TAG_SIZE);
+	if ( !newPtr )
+	{
+		if ( ptr )
+			tagBlock(ptr);
+		return 0;
+	}
+
+	if ( ptr )
+		countFree();
+	countAllocation(size);
+	tagBlock(newPtr);
+	return newPtr;
+}
+
+extern "C" void __wrap_free( void *ptr )
+{
+	if ( ptr )
+	{
+		countFree();
+		untagBlock(ptr);
+	}
+	__real_free(ptr);
+}
+
+static void *heapAllocateOrThrow( size_t size )
+{
+	void *ptr = malloc( size ? size : 1 );
+	if ( !ptr )
+	{
+		#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+		throw bad_alloc();
+		#else
+		abort();
+		#endif
+	}
+	return ptr;
+}
+
+//Replaced so C++ allocations go through the wrapped malloc, also where the C++ library is linked dynamically (native build).
+void *operator new( size_t size ){ return heapAllocateOrThrow(size); }
+void *operator new[]( size_t size ){ return heapAllocateOrThrow(size); }
+void *operator new( size_t size, const nothrow_t & ) noexcept { return malloc( size ? size : 1 ); }
+void *operator new[]( size_t size, const nothrow_t & ) noexcept { return malloc( size ? size : 1 ); }
+void operator delete( void *ptr ) noexcept { free(ptr); }
+void operator delete[]( void *ptr ) noexcept { free(ptr); }
+void operator delete( void *ptr, const nothrow_t & ) noexcept { free(ptr); }
+void operator delete[]( void *ptr, const nothrow_t & ) noexcept { free(ptr); }
+#if __cpp_sized_deallocation
+void operator delete( void *ptr, size_t ) noexcept { free(ptr); }
+void operator delete[]( void *ptr, size_t ) noexcept { free(ptr); }
+#endif
+#endif
+
+void Heap_Monitor::update( uint32_t now )
+{
+	if ( i_numSamples && now - i_lastSample < HEAP_SAMPLE_INTERVAL )
+		return;
+
+	i_lastSample = now;
+	history[i_nextSample] = takeSample();
+	i_nextSample = ( i_nextSample + 1 ) % HEAP_HISTORY_SAMPLES;
+	if ( i_numSamples < HEAP_HISTORY_SAMPLES )
+		i_numSamples++;
+}
+
+Heap_Sample Heap_Monitor::takeSample()
+{
+	Heap_Sample sample;
+	sample.i_time = millis() / 1000;
+	sample.i_free = ESP.getFreeHeap();
+	sample.i_largest = ESP.getMaxAllocHeap();
+	sample.i_minFree = ESP.getMinFreeHeap();
+	return sample;
+}
+
+uint32_t Heap_Monitor::getThreadAllocs()
+{
+	return i_threadAllocs;
+}
+
+const Heap_Tag_Stats &Heap_Monitor::getTagStats( uint8_t tag )
+{
+	return heapTagStats[ tag < HEAP_NUM_TAGS ? tag : HEAP_TAG_OTHER ];
+}
+
+const char *Heap_Monitor::getTagName( uint8_t tag )
+{
+	switch ( tag )
+	{
+		case HEAP_TAG_PLC:
+			return PSTR("PLC runtime");
+		case HEAP_TAG_PARSER:
+			return PSTR("Parser");
+		case HEAP_TAG_WEB:
+			return PSTR("Web");
+		case HEAP_TAG_REMOTE:
+			return PSTR("Remote");
+		case HEAP_TAG_ALERTS:
+			return PSTR("Alerts");
+		default:
+			return PSTR("Other");
+	}
+}
+
+void Heap_Monitor::resetPeaks()
+{
+	for ( uint8_t x = 0; x < HEAP_NUM_TAGS; x++ )
+		heapTagStats[x].i_peak.store( heapTagStats[x].i_current.load() );
+}
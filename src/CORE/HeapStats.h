@@ -0,0 +1,101 @@
+/*
+ * HeapStats.h
+ *
+ * Heap accounting by subsystem. malloc, calloc, realloc and free are wrapped at link time (-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free,
+ * see platformio.ini), and the global operator new/delete are replaced to go through them, so Arduino Strings, containers, make_shared and the libraries
+ * are all counted. Each allocation and free is counted against the subsystem that made it, along with the bytes requested.
+ * Code marks the subsystem it belongs to with a Heap_Scope, which lasts until the end of the enclosing block. Scopes nest, and are kept per thread.
+ * The wrappers also keep the bytes in use and the peak of each subsystem: every block is asked for HEAP_TAG_SIZE bytes longer, and its last bytes hold the
+ * subsystem that allocated it, so it's taken off that subsystem wherever it's freed. Blocks are counted at the size the allocator set aside for them.
+ * The device totals (free heap, largest free block) are sampled over time by Heap_Monitor.
+ * The accounting works the same in the native build, so the tests and benchmarks under test/ check the counts (see test/README).
+ * Build with -DHEAP_ACCOUNTING=0, and without the --wrap link flags, to keep only the device totals.
+ */
+
+#ifndef HEAPSTATS_H_
+#define HEAPSTATS_H_
+
+#include "Arduino.h"
+#include <atomic>
+
+using namespace std;
+
+#ifndef HEAP_ACCOUNTING
+#define HEAP_ACCOUNTING 1
+#endif
+
+#define HEAP_TAG_SIZE 2 //bytes added to each block: the subsystem, and a check of it
+#define HEAP_TAG_CHECK 0xA5
+
+#define HEAP_HISTORY_SAMPLES 60
+#define HEAP_SAMPLE_INTERVAL 60000 //mS between samples of the device totals (one hour of history)
+
+enum HEAP_TAG : uint8_t
+{
+	HEAP_TAG_OTHER, //allocations outside of any scope (setup, libraries)
+	HEAP_TAG_PLC, //logic scan
+	HEAP_TAG_PARSER, //script parsing, including the program it builds
+	HEAP_TAG_WEB, //web requests and their data fields
+	HEAP_TAG_REMOTE, //remote clients and the remote server
+	HEAP_TAG_ALERTS, //message history
+	HEAP_NUM_TAGS
+};
+
+struct Heap_Tag_Stats
+{
+	atomic<int32_t> i_current; //bytes in use, allocated by this subsystem and not freed yet
+	atomic<int32_t> i_peak;
+	atomic<uint32_t> i_allocs, //malloc, calloc and realloc calls (new goes through malloc)
+					 i_frees;
+	atomic<uint32_t> i_bytes; //bytes requested by those allocations (wraps around)
+};
+
+//Device totals at a point in time.
+struct Heap_Sample
+{
+	uint32_t i_time, //uptime (seconds)
+			 i_free,
+			 i_largest, //largest block that can be allocated
+			 i_minFree; //lowest free heap since boot
+};
+
+//Tags the allocations made while it exists with the given subsystem.
+class Heap_Scope
+{
+	public:
+	Heap_Scope( HEAP_TAG );
+	~Heap_Scope();
+
+	private:
+	uint8_t i_previous;
+};
+
+class Heap_Monitor
+{
+	public:
+	Heap_Monitor(){ i_numSamples = 0; i_nextSample = 0; i_lastSample = 0; }
+
+	//Samples the device totals once every HEAP_SAMPLE_INTERVAL. Arg: current time (mS)
+	void update( uint32_t );
+	//Returns a sample of the device totals, 0 being the oldest.
+	const Heap_Sample &getSample( uint8_t index ){ return history[ ( i_nextSample + HEAP_HISTORY_SAMPLES - i_numSamples + index ) % HEAP_HISTORY_SAMPLES ]; }
+	uint8_t getNumSamples(){ return i_numSamples; }
+
+	//Returns the device totals now.
+	static Heap_Sample takeSample();
+	static const Heap_Tag_Stats &getTagStats( uint8_t tag );
+	//Returns the number of allocations (malloc, calloc, realloc) made by the calling thread since it started. Comparing it before and after a piece of code
+	//tells whether that code allocated, without counting what the other core did in the meantime. Always 0 when built without HEAP_ACCOUNTING.
+	static uint32_t getThreadAllocs();
+	static const char *getTagName( uint8_t tag );
+	//Sets the peak of each subsystem to its current use, so a new peak can be measured (EX: between runs of a benchmark).
+	static void resetPeaks();
+
+	private:
+	Heap_Sample history[HEAP_HISTORY_SAMPLES];
+	uint8_t i_numSamples,
+			i_nextSample;
+	uint32_t i_lastSample;
+};
+
+#endif /* HEAPSTATS_H_ */
@@ -55,6 +55,15 @@ void UICore::parseSerialData()
 					case CMD_TIME:
 						parseTime( parseArgs( pos, length, buffer ) );
 						break;
+					case CMD_TASKS:
+						printTaskStats();
+						break;
+					case CMD_WATCHDOG:
+						parseWatchdog( parseArgs( pos, length, buffer ) );
+						break;
+					case CMD_TRACE:
+						parseTrace( parseArgs( pos, length, buffer ) );
+						break;
 					default:
 						continue; //Nothing here? just skip it.
 				}
@@ -190,11 +199,10 @@ void UICore::parseVerbose( const vector<String> &args ) //deprecated?
 
 void UICore::parseCfg( const vector<String> &args )
 {
-	generateSettingsMap();
-	if ( args.size() <= 0 )
+	if ( args.size() <= 0 ) //list every setting in the text format
 	{
-		for ( settings_itr = settingsMap.begin(); settings_itr != settingsMap.end(); settings_itr++ )
-			sendMessage( settings_itr->first + CHAR_EQUALS + settings_itr->second.get()->getSettingValue(), PRIORITY_HIGH);
+		for ( uint8_t x = 0; x < settings.size(); x++ )
+			sendMessage( settings[x].getName() + String(CHAR_EQUALS) + settings[x].getSettingValue(), PRIORITY_HIGH);
 	}
 	else
 	{
@@ -203,13 +211,11 @@ void UICore::parseCfg( const vector<String> &args )
 			vector<String> splitArgs = splitString(args[x], CHAR_EQUALS);
 			if (splitArgs.size() == 2) //can only have 2 args
 			{
-				for ( settings_itr = settingsMap.begin(); settings_itr != settingsMap.end(); settings_itr++ )
+				Device_Setting *setting = findSetting(splitArgs[0]);
+				if ( setting )
 				{
-					if ( settings_itr->first == splitArgs[0] ) //search for the specific setting string identifier
-					{
-						settings_itr->second.get()->setSettingValue(splitArgs[1]);
-						sendMessage(PSTR("Applying setting to ") + splitArgs[0], PRIORITY_HIGH);
-					}
+					setting->setSettingValue(splitArgs[1]);
+					sendMessage(PSTR("Applying setting to ") + splitArgs[0], PRIORITY_HIGH);
 				}
 			}
 			else if (splitArgs[0] == PSTR("save"))
@@ -218,8 +224,6 @@ void UICore::parseCfg( const vector<String> &args )
 				sendMessage(PSTR("Wrong number of arguments for setting."), PRIORITY_HIGH);
 		}
 	}
-	
-	clearSettingsMap(); //empty the map here
 }
 
 void UICore::parseTime( const vector<String> &args )
@@ -0,0 +1,226 @@
+/*
+ * SlotStorage.cpp
+ *
+ * A/B slot storage with a CRC32 checked header and a pointer record, see SlotStorage.h.
+ */
+
+#include "SlotStorage.h"
+#include "GlobalDefs.h"
+
+SlotStorage::SlotStorage( const String &path )
+{
+	s_path = path;
+	i_writeSlot = 0;
+	memset( &writeHeader, 0, sizeof(writeHeader) );
+}
+
+uint32_t SlotStorage::crc32( uint32_t crc, const uint8_t *data, size_t length )
+{
+	return crc32_le( crc, data, length ); //table driven version in ROM
+}
+
+bool SlotStorage::readHeader( uint8_t slot, Slot_Header &header )
+{
+	String path = getSlotPath(slot);
+	if ( !SPIFFS.exists(path) )
+		return false;
+
+	File slotFile = SPIFFS.open(path, FILE_READ);
+	if ( !slotFile )
+		return false;
+
+	bool valid = slotFile.read( reinterpret_cast<uint8_t *>(&header), sizeof(header) ) == sizeof(header) && header.i_magic == SLOT_MAGIC
+				 && slotFile.size() == sizeof(header) + header.i_length; //a slot that was cut short is the wrong size
+	slotFile.close();
+	return valid;
+}
+
+bool SlotStorage::verify( File &slotFile, const Slot_Header &header )
+{
+	uint8_t chunk[SLOT_CHUNK_SIZE];
+	uint32_t crc = 0, remaining = header.i_length;
+	while ( remaining )
+	{
+		size_t length = remaining < SLOT_CHUNK_SIZE ? remaining : SLOT_CHUNK_SIZE;
+		if ( slotFile.read( chunk, length ) != length )
+			return false;
+
+		crc = crc32( crc, chunk, length );
+		remaining -= length;
+	}
+
+	return crc == header.i_crc;
+}
+
+int8_t SlotStorage::findCurrent( const Slot_Header *headers, const bool *valid )
+{
+	File pointerFile = SPIFFS.open( s_path + PSTR(".ptr"), FILE_READ );
+	if ( pointerFile )
+	{
+		Slot_Pointer pointer;
+		bool read = pointerFile.read( reinterpret_cast<uint8_t *>(&pointer), sizeof(pointer) ) == sizeof(pointer);
+		pointerFile.close();
+
+		if ( read && pointer.i_magic == SLOT_POINTER_MAGIC && pointer.i_slot < 2 && pointer.i_crc == crc32( 0, reinterpret_cast<const uint8_t *>(&pointer), offsetof(Slot_Pointer, i_crc) )
+			 && valid[pointer.i_slot] && headers[pointer.i_slot].i_version == pointer.i_version )
+			return pointer.i_slot;
+	}
+
+	//no usable pointer record (lost during a save, or never written), fall back on the versions
+	if ( valid[0] && valid[1] )
+		return ( headers[1].i_version > headers[0].i_version ) ? 1 : 0;
+	if ( valid[0] || valid[1] )
+		return valid[1] ? 1 : 0;
+
+	return SLOT_NONE;
+}
+
+int8_t SlotStorage::findIntact( const Slot_Header *headers, const bool *valid, File &file )
+{
+	int8_t current = findCurrent( headers, valid );
+	if ( current == SLOT_NONE )
+		return SLOT_NONE;
+
+	for ( uint8_t x = 0; x < 2; x++ ) //the current slot first, then the other one if the current slot's data is damaged
+	{
+		uint8_t slot = x ? !current : current;
+		if ( !valid[slot] )
+			continue;
+
+		file = SPIFFS.open( getSlotPath(slot), FILE_READ );
+		if ( file && file.seek( sizeof(Slot_Header) ) && verify( file, headers[slot] ) && file.seek( sizeof(Slot_Header) ) )
+			return slot;
+
+		file.close();
+	}
+
+	return SLOT_NONE;
+}
+
+int32_t SlotStorage::open( File &file )
+{
+	Slot_Header headers[2];
+	bool valid[2] = { readHeader(0, headers[0]), readHeader(1, headers[1]) };
+	int8_t slot = findIntact( headers, valid, file );
+	return ( slot == SLOT_NONE ) ? SLOT_NONE : headers[slot].i_length;
+}
+
+bool SlotStorage::begin()
+{
+	Slot_Header headers[2];
+	bool valid[2] = { readHeader(0, headers[0]), readHeader(1, headers[1]) };
+	File intactFile;
+	int8_t intact = findIntact( headers, valid, intactFile ); //the copy open() would load, which may not be the current one if its data is damaged
+	intactFile.close();
+	i_writeSlot = ( intact == SLOT_NONE ) ? 0 : !intact; //never the only good copy
+
+	memset( &writeHeader, 0, sizeof(writeHeader) ); //no magic until commit(), so the slot isn't valid while it is being written or checked
+	writeHeader.i_version = 1; //newer than either slot, so the version fallback picks it over a damaged slot with a higher version
+	for ( uint8_t slot = 0; slot < 2; slot++ )
+	{
+		if ( valid[slot] && headers[slot].i_version >= writeHeader.i_version )
+			writeHeader.i_version = headers[slot].i_version + 1;
+	}
+
+	writeFile = SPIFFS.open( getSlotPath(i_writeSlot), FILE_WRITE );
+	if ( !writeFile )
+		return false;
+
+	if ( writeFile.write( reinterpret_cast<const uint8_t *>(&writeHeader), sizeof(writeHeader) ) != sizeof(writeHeader) )
+	{
+		writeFile.close();
+		return false;
+	}
+
+	return true;
+}
+
+bool SlotStorage::write( const uint8_t *data, size_t length )
+{
+	if ( !writeFile )
+		return false;
+
+	for ( size_t pos = 0; pos < length; pos += SLOT_CHUNK_SIZE ) //small writes, so the file system never needs a second copy of the data
+	{
+		size_t chunk = ( length - pos < SLOT_CHUNK_SIZE ) ? length - pos : SLOT_CHUNK_SIZE;
+		if ( writeFile.write( data + pos, chunk ) != chunk )
+		{
+			writeFile.close();
+			return false;
+		}
+	}
+
+	writeHeader.i_crc = crc32( writeHeader.i_crc, data, length );
+	writeHeader.i_length += length;
+	return true;
+}
+
+bool SlotStorage::end()
+{
+	if ( !writeFile )
+		return false;
+
+	bool success = writeFile.seek(0) && writeFile.write( reinterpret_cast<const uint8_t *>(&writeHeader), sizeof(writeHeader) ) == sizeof(writeHeader);
+	writeFile.close();
+	if ( !success )
+		return false;
+
+	File slotFile = SPIFFS.open( getSlotPath(i_writeSlot), FILE_READ ); //read it back before it can replace the current copy
+	success = slotFile && slotFile.seek( sizeof(Slot_Header) ) && verify( slotFile, writeHeader );
+	slotFile.close();
+	return success;
+}
+
+int32_t SlotStorage::openWritten( File &file )
+{
+	file = SPIFFS.open( getSlotPath(i_writeSlot), FILE_READ );
+	if ( file && file.seek( sizeof(Slot_Header) ) )
+		return writeHeader.i_length;
+
+	file.close();
+	return SLOT_NONE;
+}
+
+bool SlotStorage::commit()
+{
+	//the slot gets its magic here, so a copy that was written but rejected (failed to parse) can't be picked up by the version fallback in findCurrent()
+	File slotFile = SPIFFS.open( getSlotPath(i_writeSlot), "r+" );
+	writeHeader.i_magic = SLOT_MAGIC;
+	bool success = slotFile && slotFile.write( reinterpret_cast<const uint8_t *>(&writeHeader), sizeof(writeHeader) ) == sizeof(writeHeader);
+	slotFile.close();
+	if ( !success )
+		return false;
+
+	Slot_Pointer pointer;
+	memset( &pointer, 0, sizeof(pointer) );
+	pointer.i_magic = SLOT_POINTER_MAGIC;
+	pointer.i_version = writeHeader.i_version;
+	pointer.i_slot = i_writeSlot;
+	pointer.i_crc = crc32( 0, reinterpret_cast<const uint8_t *>(&pointer), offsetof(Slot_Pointer, i_crc) );
+
+	File pointerFile = SPIFFS.open( s_path + PSTR(".ptr"), FILE_WRITE );
+	if ( pointerFile ) //If this write is cut short the pointer fails its CRC, and the versions select the new copy anyway
+		pointerFile.write( reinterpret_cast<const uint8_t *>(&pointer), sizeof(pointer) );
+	pointerFile.close();
+	return true;
+}
+
+bool SlotStorage::save( const char *data, uint32_t length )
+{
+	if ( !begin() || !write( reinterpret_cast<const uint8_t *>(data), length ) || !end() )
+		return false;
+
+	return commit();
+}
+
+void SlotStorage::remove()
+{
+	for ( uint8_t slot = 0; slot < 2; slot++ )
+	{
+		if ( SPIFFS.exists(getSlotPath(slot)) )
+			SPIFFS.remove(getSlotPath(slot));
+	}
+
+	if ( SPIFFS.exists(s_path + PSTR(".ptr")) )
+		SPIFFS.remove(s_path + PSTR(".ptr"));
+}
@@ -0,0 +1,92 @@
+/*
+ * SlotStorage.h
+ *
+ * Power loss safe storage for files that are replaced as a whole (logic script, device settings). Each file has two copies (slots) in the flash file system,
+ * each with a header holding its length, version and CRC32. A save always writes the slot that is not in use, reads it back to verify it, and only then
+ * points a small pointer record at it. A save that is cut short leaves the previous copy untouched and still selected.
+ * If the pointer record itself is lost, the valid slot with the highest version is used.
+ */
+
+#ifndef SLOTSTORAGE_H_
+#define SLOTSTORAGE_H_
+
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <rom/crc.h>
+
+#define SLOT_MAGIC 0x31544C53 //"SLT1"
+#define SLOT_POINTER_MAGIC 0x31525450 //"PTR1"
+#define SLOT_CHUNK_SIZE 256 //bytes written or verified at a time
+#define SLOT_NONE -1
+
+//Stored at the start of each slot, followed by the data.
+struct Slot_Header
+{
+	uint32_t i_magic, //SLOT_MAGIC
+			 i_version, //incremented on each save, the newest valid slot wins if the pointer record is lost
+			 i_length, //bytes of data following the header
+			 i_crc; //CRC32 of the data
+};
+
+//Names the slot that holds the current copy.
+struct Slot_Pointer
+{
+	uint32_t i_magic, //SLOT_POINTER_MAGIC
+			 i_version; //version of the slot being pointed to
+	uint8_t i_slot,
+			i_reserved[3];
+	uint32_t i_crc; //CRC32 of the fields above
+};
+
+class SlotStorage
+{
+	public:
+	//Arg: base path, the slots are stored at <path>.a and <path>.b, and the pointer record at <path>.ptr
+	SlotStorage( const String & );
+
+	//Opens the current copy for reading, positioned at the start of its data. The copy's CRC is checked before it is returned.
+	//Returns the length of the data, or SLOT_NONE if there is no valid copy.
+	int32_t open( File & );
+	//Writes the data to the unused slot in chunks, verifies it, then makes it the current copy. Returns false if the previous copy is still the current one.
+	bool save( const char *, uint32_t );
+
+	//The steps of save(), for data that arrives in pieces (uploads). Nothing replaces the current copy until commit() is called.
+	//Opens the unused slot for writing. Returns false if it couldn't be opened. If the current slot's data is damaged, the damaged slot is the one written,
+	//so the copy that open() falls back on is kept.
+	bool begin();
+	//Appends the data to the slot being written. Returns false (and gives up on the slot) if the write failed.
+	bool write( const uint8_t *, size_t );
+	//Completes the slot's length and CRC and reads the slot back to verify it. Returns false if the data didn't read back correctly.
+	//The slot stays invalid (no magic) until commit(), so a copy that is checked and rejected is never used.
+	bool end();
+	//Opens the slot written by end() for reading, positioned at the start of its data. Returns the length of the data, or SLOT_NONE.
+	int32_t openWritten( File & );
+	//Marks the slot written by end() as valid and makes it the current copy. Returns false if the previous copy is still the current one.
+	bool commit();
+	//Removes both slots and the pointer record.
+	void remove();
+	//Returns true if neither slot has been written yet.
+	bool isEmpty(){ return !SPIFFS.exists(getSlotPath(0)) && !SPIFFS.exists(getSlotPath(1)); }
+
+	//Updates a running CRC32 with the given data. Start with a CRC of 0.
+	static uint32_t crc32( uint32_t, const uint8_t *, size_t );
+
+	private:
+	//Reads the header of the given slot. Returns false if the slot doesn't exist or the header isn't valid.
+	bool readHeader( uint8_t, Slot_Header & );
+	//Reads the data of the given slot (positioned after its header) and compares its CRC against the header.
+	bool verify( File &, const Slot_Header & );
+	//Returns the slot holding the current copy, or SLOT_NONE. Args: <Header of each slot>, <Header of each slot is valid>. Only the headers are checked, not the data.
+	int8_t findCurrent( const Slot_Header *, const bool * );
+	//Returns the slot that open() loads: the current slot, or the other slot if the current slot's data fails its CRC. SLOT_NONE if neither is intact.
+	//The slot is left open in the given file, positioned at the start of its data. Args: <Header of each slot>, <Header of each slot is valid>, <File>
+	int8_t findIntact( const Slot_Header *, const bool *, File & );
+	String getSlotPath( uint8_t slot ){ return s_path + ( slot ? PSTR(".b") : PSTR(".a") ); }
+
+	String s_path;
+	File writeFile; //slot being written, between begin() and end()
+	Slot_Header writeHeader; //header of the slot being written, its CRC and length are updated by write()
+	uint8_t i_writeSlot;
+};
+
+#endif /* SLOTSTORAGE_H_ */
@@ -1,5 +1,6 @@
 #include "UICore.h"
 #include "GlobalDefs.h"
+#include "SlotStorage.h"
 #include <PLC/PLC_Main.h>
 
 
@@ -84,77 +85,231 @@ String Device_Setting::getSettingValue()
     return "";
 }
 
-void UICore::generateSettingsMap()
+void Device_Setting::writeRecord( vector<uint8_t> &record, uint8_t id )
 {
+    uint32_t value = 0;
+    uint8_t size = 0;
+    switch(getType())
+    {
+        case OBJ_TYPE::TYPE_VAR_STRING:
+        {
+            size = getSTRING().length() > UINT8_MAX ? UINT8_MAX : getSTRING().length();
+            record.push_back(id);
+            record.push_back(size);
+            record.insert( record.end(), getSTRING().c_str(), getSTRING().c_str() + size );
+        }
+        return;
+        case OBJ_TYPE::TYPE_VAR_BOOL: value = getBOOL(); size = sizeof(bool); break;
+        case OBJ_TYPE::TYPE_VAR_UBYTE: value = getUINT8(); size = sizeof(uint8_t); break;
+        case OBJ_TYPE::TYPE_VAR_USHORT: value = getUINT16(); size = sizeof(uint16_t); break;
+        case OBJ_TYPE::TYPE_VAR_UINT: value = getUINT(); size = sizeof(uint32_t); break;
+        default:
+        return;
+    }
+
+    record.push_back(id);
+    record.push_back(size);
+    for ( uint8_t x = 0; x < size; x++ ) //little endian
+        record.push_back( static_cast<uint8_t>( value >> (x * 8) ) );
+}
+
+void Device_Setting::readRecord( const uint8_t *data, uint8_t length )
+{
+    if ( getType() == OBJ_TYPE::TYPE_VAR_STRING )
+    {
+        char buffer[UINT8_MAX + 1];
+        memcpy( buffer, data, length );
+        buffer[length] = 0;
+        getSTRING() = buffer;
+        return;
+    }
+
+    uint32_t value = 0;
+    for ( uint8_t x = 0; x < length && x < sizeof(uint32_t); x++ )
+        value |= static_cast<uint32_t>(data[x]) << (x * 8);
+
+    switch(getType())
+    {
+        case OBJ_TYPE::TYPE_VAR_BOOL: getBOOL() = value > 0; break;
+        case OBJ_TYPE::TYPE_VAR_UBYTE: getUINT8() = static_cast<uint8_t>(value); break;
+        case OBJ_TYPE::TYPE_VAR_USHORT: getUINT16() = static_cast<uint16_t>(value); break;
+        case OBJ_TYPE::TYPE_VAR_UINT: getUINT() = value; break;
+        default: break;
+    }
+}
+
+void UICore::generateSettingsTable()
+{
+    settings.reserve(SETTING_PLC_SCAN_POLICY); //the last ID is also the number of settings
+    //Must be added in SETTING_ID order, the ID of a setting is its position in the table.
+
     //Device specific settings
-    settingsMap.emplace(PSTR("dev_id"), make_shared<Device_Setting>( &getUniqueID() ) ); //Unique ID of the ESPLC device
-    settingsMap.emplace(PSTR("dev_serial_v"), make_shared<Device_Setting>( &i_verboseMode) ); //Serial verbosity settings, for debugging/status updates on local device
+    settings.emplace_back( PSTR("dev_id"), &getUniqueID() ); //Unique ID of the ESPLC device
+    settings.emplace_back( PSTR("dev_serial_v"), &i_verboseMode ); //Serial verbosity settings, for debugging/status updates on local device
 
     //security related settings
-    settingsMap.emplace(PSTR("bt_en"), make_shared<Device_Setting>( &b_enableBT) ); //Enable bluetooth interface
-    settingsMap.emplace(PSTR("bt_pwd"), make_shared<Device_Setting>( &getBTPWD() ) ); //password for Bluetooth adaptor connectivity
-    settingsMap.emplace(PSTR("ui_uname"), make_shared<Device_Setting>( &getLoginName() ) ); //username for web UI access (security)
-    settingsMap.emplace(PSTR("ui_pwd"), make_shared<Device_Setting>( &getLoginPWD() ) ); //password for web UI access (security)
+    settings.emplace_back( PSTR("bt_en"), &b_enableBT ); //Enable bluetooth interface
+    settings.emplace_back( PSTR("bt_pwd"), &getBTPWD() ); //password for Bluetooth adaptor connectivity
+    settings.emplace_back( PSTR("ui_uname"), &getLoginName() ); //username for web UI access (security)
+    settings.emplace_back( PSTR("ui_pwd"), &getLoginPWD() ); //password for web UI access (security)
 
     //Network settings
-    settingsMap.emplace(PSTR("net_ap_en"), make_shared<Device_Setting>( &b_enableAP) ); //enable access point mode
-    settingsMap.emplace(PSTR("net_sta_retry"), make_shared<Device_Setting>( &b_autoRetryConnection) ); //Retry connection to internet on failure
-    settingsMap.emplace(PSTR("net_sta_retry_count"), make_shared<Device_Setting>( &i_connectionRetries ) ); //number of attempts to retry a connection
-    settingsMap.emplace(PSTR("net_sta_retry_timeout"), make_shared<Device_Setting>( &i_timeoutLimit) ); //seconds before timeout on connection
-    settingsMap.emplace(PSTR("net_ap_ssid"), make_shared<Device_Setting>( &getWiFiAPSSID() ) );
-    settingsMap.emplace(PSTR("net_sta_ssid"), make_shared<Device_Setting>( &getWiFiSSID() ) ); //SSID of Wifi connection - for autoconnection
-    settingsMap.emplace(PSTR("net_ap_pwd"), make_shared<Device_Setting>( &getWiFiAPPWD() ) ); //password for WiFi auto-connection
-    settingsMap.emplace(PSTR("net_sta_pwd"), make_shared<Device_Setting>( &getWiFiPWD() ) ); //password for WiFi auto-connection
-    settingsMap.emplace(PSTR("net_hostname"), make_shared<Device_Setting>( &getWiFiHostname() ) ); 
-    settingsMap.emplace(PSTR("dns_en"), make_shared<Device_Setting>( &b_enableDNS ) ); //enable DNS server
-    settingsMap.emplace(PSTR("dns_hostname"), make_shared<Device_Setting>( &getDNSHostname() ) ); //hostname for DNS server.
+    settings.emplace_back( PSTR("net_ap_en"), &b_enableAP ); //enable access point mode
+    settings.emplace_back( PSTR("net_sta_retry"), &b_autoRetryConnection ); //Retry connection to internet on failure
+    settings.emplace_back( PSTR("net_sta_retry_count"), &i_connectionRetries ); //number of attempts to retry a connection
+    settings.emplace_back( PSTR("net_sta_retry_timeout"), &i_timeoutLimit ); //seconds before timeout on connection
+    settings.emplace_back( PSTR("net_ap_ssid"), &getWiFiAPSSID() );
+    settings.emplace_back( PSTR("net_sta_ssid"), &getWiFiSSID() ); //SSID of Wifi connection - for autoconnection
+    settings.emplace_back( PSTR("net_ap_pwd"), &getWiFiAPPWD() ); //password for WiFi auto-connection
+    settings.emplace_back( PSTR("net_sta_pwd"), &getWiFiPWD() ); //password for WiFi auto-connection
+    settings.emplace_back( PSTR("net_hostname"), &getWiFiHostname() ); 
+    settings.emplace_back( PSTR("dns_en"), &b_enableDNS ); //enable DNS server
+    settings.emplace_back( PSTR("dns_hostname"), &getDNSHostname() ); //hostname for DNS server.
 
     //PLC networking settings
-    settingsMap.emplace(PSTR("plc_netmode"), make_shared<Device_Setting>( &i_plc_netmode )); //Switch for disabled (0), IO expander mode (1), or cluster mode (2)
-    settingsMap.emplace(PSTR("plc_broadcast_port"), make_shared<Device_Setting>( &i_plc_broadcast_port )); //status broadcast port 
+    settings.emplace_back( PSTR("plc_netmode"), &i_plc_netmode ); //Switch for disabled (0), IO expander mode (1), or cluster mode (2)
+    settings.emplace_back( PSTR("plc_broadcast_port"), &i_plc_broadcast_port ); //status broadcast port 
+    settings.emplace_back( PSTR("plc_retain_interval"), &i_plc_retain_interval ); //seconds between writes of retentive values
 
     //Time Settings
-	settingsMap.emplace(PSTR("time_en"), make_shared<Device_Setting>( &b_enableNIST) ); //Enable automatic time fetching when connected to internet
-	settingsMap.emplace(PSTR("time_server"), make_shared<Device_Setting>( &getNISTServer() ) ); //URL for time fetching
-    settingsMap.emplace(PSTR("time_port"), make_shared<Device_Setting>( &i_NISTPort) ); //port for time fetching
-    settingsMap.emplace(PSTR("time_upd_freq"), make_shared<Device_Setting>( &i_NISTupdateFreq) ); //update frequency for time fetching. 
+	settings.emplace_back( PSTR("time_en"), &b_enableNIST ); //Enable automatic time fetching when connected to internet
+	settings.emplace_back( PSTR("time_server"), &getNISTServer() ); //URL for time fetching
+    settings.emplace_back( PSTR("time_port"), &i_NISTPort ); //port for time fetching
+    settings.emplace_back( PSTR("time_upd_freq"), &i_NISTupdateFreq ); //update frequency for time fetching. 
+
+    //Added later, IDs of older settings must not change
+    settings.emplace_back( PSTR("plc_dual_core"), &b_plc_dual_core ); //process independent rungs on both cores
+    settings.emplace_back( PSTR("plc_scan_budget"), &i_plc_scan_budget ); //scan watchdog budget (uS)
+    settings.emplace_back( PSTR("plc_scan_overruns"), &i_plc_scan_overruns ); //overruns in a row before the policy is applied
+    settings.emplace_back( PSTR("plc_scan_policy"), &i_plc_scan_policy ); //log, skip, safe, fault
 }
 
-void UICore::clearSettingsMap()
+Device_Setting *UICore::findSetting( const String &name )
 {
-	settingsMap.clear(); //empty the map. Should delete the objects that were created.
+    for ( uint8_t x = 0; x < settings.size(); x++ )
+    {
+        if ( name == settings[x].getName() )
+            return &settings[x];
+    }
+
+    return 0;
 }
 
+void UICore::encodeSettings( vector<uint8_t> &record )
+{
+    uint32_t magic = SETTINGS_RECORD_MAGIC;
+    record.clear();
+    record.reserve( SETTINGS_HEADER_SIZE + settings.size() * ( 2 + sizeof(uint32_t) ) ); //enough for most devices in one allocation, strings are short
+    record.insert( record.end(), reinterpret_cast<uint8_t *>(&magic), reinterpret_cast<uint8_t *>(&magic) + sizeof(magic) );
+    record.push_back(SETTINGS_RECORD_VERSION);
+    record.push_back(settings.size());
+    for ( uint8_t x = 0; x < settings.size(); x++ )
+        settings[x].writeRecord( record, x + 1 );
+}
+
+bool UICore::decodeSettings( const uint8_t *record, size_t length )
+{
+    uint32_t magic;
+    if ( length < SETTINGS_HEADER_SIZE )
+        return false;
+
+    memcpy( &magic, record, sizeof(magic) );
+    if ( magic != SETTINGS_RECORD_MAGIC || record[4] > SETTINGS_RECORD_VERSION )
+        return false;
+
+    size_t pos = SETTINGS_HEADER_SIZE;
+    for ( uint8_t x = 0; x < record[5]; x++ ) //each field is its ID, length, then the value
+    {
+        if ( pos + 2 > length || pos + 2 + record[pos + 1] > length )
+            return false;
+
+        uint8_t id = record[pos];
+        if ( id && id <= settings.size() ) //fields saved by newer firmware are skipped
+            settings[id - 1].readRecord( record + pos + 2, record[pos + 1] );
+
+        pos += 2 + record[pos + 1];
+    }
+
+    return true;
+}
+
+
+//Opens the current copy of a file that is stored in slots. Falls back on a file saved by older firmware (before slots were used) under the base path.
+static int32_t openSlotFile( const String &path, File &file )
+{
+    SlotStorage storage(path);
+    int32_t length = storage.open(file);
+    if ( length == SLOT_NONE && storage.isEmpty() && SPIFFS.exists(path) )
+    {
+        file = SPIFFS.open(path, FILE_READ);
+        if ( file )
+            length = file.size();
+    }
+
+    return length;
+}
+
+//Saves the data to the unused slot and makes it the current copy, then removes the file saved by older firmware (if any).
+static bool saveSlotFile( const String &path, const String &data )
+{
+    if ( !SlotStorage(path).save( data.c_str(), data.length() ) )
+        return false;
+
+    if ( SPIFFS.exists(path) )
+        SPIFFS.remove(path);
+    return true;
+}
 
 bool UICore::loadSettings()
 {
     if ( !b_FSOpen )
         return false;
 
-    File settingsFile = SPIFFS.open(file_Configuration, FILE_READ);
-    if (!settingsFile)
+    File settingsFile;
+    int32_t length = SlotStorage(file_Settings).open(settingsFile);
+    if ( length == SLOT_NONE ) //no binary record yet
+        return migrateSettings();
+
+    vector<uint8_t> record(length); //the whole record in one read
+    bool success = settingsFile.read( record.data(), length ) == static_cast<size_t>(length) && decodeSettings( record.data(), length );
+    settingsFile.close();
+    if ( !success )
     {
         sendMessage(err_Config, PRIORITY_HIGH);
         return false;
     }
 
-    generateSettingsMap();
+    sendMessage(succ_Config_loaded);
+    return true;
+}
+
+bool UICore::migrateSettings()
+{
+    File settingsFile;
+    if ( openSlotFile(file_Configuration, settingsFile) == SLOT_NONE )
+    {
+        sendMessage(err_Config, PRIORITY_HIGH);
+        return false;
+    }
 
     while(settingsFile.position() != settingsFile.size()) //Go through the entire settings file
     {
         String settingID = settingsFile.readStringUntil(CHAR_EQUALS),
                settingValue = settingsFile.readStringUntil(CHAR_NEWLINE);
 
-        for ( settings_itr = settingsMap.begin(); settings_itr != settingsMap.end(); settings_itr++ )
-        {
-            if ( settings_itr->first == settingID ) //search for the specific setting string identifier
-                settings_itr->second.get()->setSettingValue(settingValue);
-        }
+        Device_Setting *setting = findSetting(settingID);
+        if ( setting )
+            setting->setSettingValue(settingValue);
     }
-
-    clearSettingsMap();
-    sendMessage(succ_Config_loaded);
     settingsFile.close();
+    sendMessage(succ_Config_loaded);
+
+    if ( saveSettings() ) //the text file is only removed once the binary record is in place
+    {
+        SlotStorage(file_Configuration).remove();
+        if ( SPIFFS.exists(file_Configuration) )
+            SPIFFS.remove(file_Configuration);
+    }
     return true;
 }
 
@@ -163,19 +318,49 @@ bool UICore::loadPLCScript( String &script )
     if ( !b_FSOpen )
         return false;
 
-    File scriptFile = SPIFFS.open(file_Script, FILE_READ);
-    if (!scriptFile)
+    File scriptFile;
+    int32_t length = openSlotFile(file_Script, scriptFile);
+    script = String(); //free the old script before the new one is allocated
+    if ( length > SCRIPT_EDITOR_MAX ) //parsed from flash, only the editor goes without it
+    {
+        scriptFile.close();
+        sendMessage(PSTR("PLC script is too large for the editor, upload changes as a file."));
+        return false;
+    }
+    if ( length == SLOT_NONE || !script.reserve(length) ) //one allocation of the final size, rather than growing (and copying) as it is read
     {
+        scriptFile.close();
         sendMessage(err_Script, PRIORITY_HIGH);
         return false;
     }
 
-    script = scriptFile.readString(); //read directly into scrpt variable
+    char chunk[SLOT_CHUNK_SIZE + 1];
+    size_t read;
+    while ( length > 0 && ( read = scriptFile.read( reinterpret_cast<uint8_t *>(chunk), length < SLOT_CHUNK_SIZE ? length : SLOT_CHUNK_SIZE ) ) > 0 )
+    {
+        chunk[read] = 0;
+        script += chunk;
+        length -= read;
+    }
     scriptFile.close();
     sendMessage(succ_Script_loaded);
     return true;
 }
 
+bool UICore::openPLCScript( File &scriptFile )
+{
+    if ( !b_FSOpen )
+        return false;
+
+    if ( openSlotFile(file_Script, scriptFile) == SLOT_NONE )
+    {
+        sendMessage(err_Script, PRIORITY_HIGH);
+        return false;
+    }
+
+    return true;
+}
+
 String UICore::loadWebStylesheet()
 {
     if ( !b_FSOpen )
@@ -200,18 +385,13 @@ bool UICore::savePLCScript( const String &script )
     if ( !b_FSOpen || !script.length() ) //must have some length and FS must be initialized
         return false;
 
-    if ( SPIFFS.exists(file_Script) )
-        SPIFFS.remove(file_Script);
-
-    File scriptFile = SPIFFS.open(file_Script, FILE_WRITE); //create a new file
-    if (!scriptFile)
+    p_checkedScript.reset(); //its slot is about to be written
+    if ( !saveSlotFile(file_Script, script) ) //the previously saved script is kept if this fails
     {
         sendMessage(err_Script, PRIORITY_HIGH );
         return false;
     }
 
-    scriptFile.print(script); //just print the entire script as given.
-    scriptFile.close(); //close the file;
     sendMessage(succ_Script);
     return true;
 }
@@ -221,30 +401,23 @@ bool UICore::saveSettings()
     if ( !b_FSOpen )
         return false;
 
-    if ( SPIFFS.exists(file_Configuration)) 
-        SPIFFS.remove(file_Configuration); //remove if possible
-
-    File settingsFile = SPIFFS.open(file_Configuration, FILE_WRITE);
-    if (!settingsFile)
+    vector<uint8_t> record;
+    encodeSettings(record);
+    #ifdef DEBUG
+    for ( uint8_t x = 0; x < settings.size(); x++ ) //printed in pieces, rather than building each line
     {
-        sendMessage(err_Config, PRIORITY_HIGH );
-        return false;
+        Serial.print(settings[x].getName());
+        Serial.print(CHAR_EQUALS);
+        Serial.println(settings[x].getSettingValue());
     }
+    #endif
 
-    generateSettingsMap(); //create our temporary list of settings 
-
-    for ( settings_itr = settingsMap.begin(); settings_itr != settingsMap.end(); settings_itr++ )
+    if ( !SlotStorage(file_Settings).save( reinterpret_cast<const char *>(record.data()), record.size() ) ) //the previously saved settings are kept if this fails
     {
-        String settingValue = settings_itr->second.get()->getSettingValue();
-        settingsFile.print(settings_itr->first + CHAR_EQUALS + settingValue + CHAR_NEWLINE);
-        #ifdef DEBUG
-        Serial.println(settings_itr->first + CHAR_EQUALS + settingValue);
-        #endif
+        sendMessage(err_Config, PRIORITY_HIGH );
+        return false;
     }
 
-    clearSettingsMap(); //empty the map and delete our settings objects to save memory
-
-    settingsFile.close(); //close the file
     sendMessage(succ_Config);
     return true;
 }
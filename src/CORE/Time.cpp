@@ -8,157 +8,171 @@
  */ 
 
 #include "UICore.h"
-#include <limits.h>
-const String &str_0 PROGMEM = PSTR("0");
-const String &str_colon PROGMEM = PSTR(":");
+#include <esp_timer.h>
 
-bool Time::operator<( const Time &T2 )
+void Time::UpdateTime()
 {
-	return ( i_year < T2.i_year || i_month < T2.i_month || i_day < T2.i_day || i_hour < T2.i_hour || i_minute < T2.i_minute || i_second < T2.i_second );
+	int64_t curTime = esp_timer_get_time();
+	int64_t elapsed = curTime - i_lastUpdateTime;
+	
+	if ( !elapsed )
+		return; 
+		
+	i_lastUpdateTime = curTime; 
+
+	if ( i_slew ) //still correcting the clock, speed it up or slow it down by a small fraction of the elapsed time.
+	{
+		int64_t step = elapsed / TIME_SLEW_RATE;
+		if ( i_slew < 0 )
+			step = -min( step, -i_slew );
+		else
+			step = min( step, i_slew );
+
+		i_slew -= step;
+		elapsed += step; //never negative, as the step is at most 1% of the elapsed time
+	}
+
+	i_epoch += elapsed;
 }
 
-Time& Time::operator=( const Time &T2 )
+void Time::AdjustTime( int32_t offset )
 {
-	this->i_year = T2.i_year;
-	this->i_month = T2.i_month;
-	this->i_day = T2.i_day;
-	this->i_hour = T2.i_hour;
-	this->i_minute = T2.i_minute;
-	this->i_second = T2.i_second;
-	this->i_timeZone = T2.i_timeZone;
-	
-	return *this;
+	if ( offset > TIME_SLEW_LIMIT || offset < -TIME_SLEW_LIMIT ) //too far off, just jump to the correct time
+	{
+		UpdateTime();
+		SetEpochMicros( i_epoch + static_cast<int64_t>(offset) * 1000 );
+	}
+	else
+		i_slew = static_cast<int64_t>(offset) * 1000; //replaces any correction still in progress, as the new offset was measured against the partially corrected clock
 }
 
-bool Time::operator==( const Time &T2 )
+void Time::SetEpochMicros( int64_t time )
 {
-	return ( i_year == T2.i_year && i_month == T2.i_month && i_day == T2.i_day && i_hour == T2.i_hour && i_minute == T2.i_minute && i_second == T2.i_second );
+	i_epoch = time;
+	i_slew = 0;
+	i_lastUpdateTime = esp_timer_get_time();
 }
 
-void Time::UpdateTime()
+void Time::SetNTPTime( unsigned long time )
+{
+	SetEpochMicros( static_cast<int64_t>(time) * USEC_PER_SEC );
+}
+
+int32_t Time::DaysFromCivil( int32_t year, uint8_t month, uint8_t day )
+{
+	year -= month <= 2; //years start in March, so the leap day falls at the end of the year
+	int32_t era = year / 400; //years are always after 1970
+	uint32_t yoe = year - era * 400; //year of era [0, 399]
+	uint32_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1; //day of year [0, 365]
+	uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy; //day of era [0, 146096]
+	return era * 146097 + static_cast<int32_t>(doe) - 719468; //shift the epoch from 0000-03-01 to 1970-01-01
+}
+
+void Time::CivilFromDays( int32_t days, int32_t &year, uint8_t &month, uint8_t &day )
 {
-	uint8_t curSec = (millis()/1000)%2;
+	days += 719468; //days since 0000-03-01
+	int32_t era = days / 146097;
+	uint32_t doe = days - era * 146097; //day of era [0, 146096]
+	uint32_t yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365; //year of era [0, 399]
+	uint32_t doy = doe - (365*yoe + yoe/4 - yoe/100); //day of year, starting in March [0, 365]
+	uint32_t mp = (5*doy + 2)/153; //month, starting in March [0, 11]
 	
-	if ( i_lastUpdateSecond == curSec )
-		return; //Same second, do not update yet.
-		
-	i_lastUpdateSecond = curSec; //Save off our update second, since that's the fastest we update.	
+	day = doy - (153*mp + 2)/5 + 1;
+	month = mp < 10 ? mp + 3 : mp - 9;
+	year = static_cast<int32_t>(yoe) + era * 400 + (month <= 2);
+}
 
-	//System clock increase below.
-	IncrementTime( 1, TIME_SECOND );// increment 1 second at a time.
+int64_t Time::MakeEpoch( uint8_t yr, uint8_t mo, uint8_t day, uint8_t hr, uint8_t min, uint8_t sec )
+{
+	int64_t seconds = static_cast<int64_t>( DaysFromCivil( TIME_BASE_YEAR + yr, mo, day ) ) * SEC_PER_DAY + hr * 3600L + min * 60L + sec;
+	return seconds * USEC_PER_SEC;
 }
 
-String Time::GetTimeStr( bool decade ) 
+void Time::setFields( uint8_t yr, uint8_t mo, uint8_t day, uint8_t hr, uint8_t min, uint8_t sec )
 {
-	return ( ( (i_year < 10 && decade) ? str_0 + i_year : i_year ) + str_colon 
-		+ ( ( i_month < 10 && decade ) ? str_0 + i_month: i_month ) + str_colon 
-		+ ( ( i_day < 10 && decade ) ? str_0 + i_day : i_day ) + str_colon
-		+ ( ( i_hour < 10 && decade ) ? str_0 + i_hour : i_hour ) + str_colon 
-		+ ( ( i_minute < 10 && decade ) ? str_0 + i_minute : i_minute ) + str_colon
-		+ ( ( i_second < 10 && decade ) ? str_0 + i_second : i_second ) );
+	i_epoch = MakeEpoch( yr, mo, day, hr, min, sec ) + i_epoch % USEC_PER_SEC; //keep the fraction of a second
 }
 
-void Time::SetNTPTime( unsigned long time )
+void Time::updateFields()
 {
-	//Jan 1 1970 = base time
-	i_year = 0; //reset
-	i_month = 1;
-	i_day = 1;
-	//
-	
-	i_second = time%60; //Set seconds now
-	i_minute = (time/60)%60; //Set the minutes now
-	i_hour = (time/3600)%NUM_HOURS_DAY; //Just total these for now, we can use the existing container for temp storage
-	i_day = AdvanceMonthYear( time/(3600*NUM_HOURS_DAY) );
-	i_year -= 30; //meh
+	int64_t second = i_epoch / USEC_PER_SEC;
+	if ( second == i_fieldsSecond )
+		return; //still valid
+
+	i_fieldsSecond = second;
+
+	int32_t days = second / SEC_PER_DAY, 
+			year = 0;
+	uint32_t secOfDay = second % SEC_PER_DAY;
+	CivilFromDays( days, year, i_month, i_day );
+
+	i_year = year - TIME_BASE_YEAR;
+	i_dayOfWeek = (days + 4) % 7; //1970-01-01 was a Thursday
+	i_hour = secOfDay / 3600;
+	i_minute = (secOfDay / 60) % 60;
+	i_second = secOfDay % 60;
 }
 
-bool Time::IncrementTime( unsigned int inc, uint8_t unit )
+String Time::GetTimeStr( bool decade ) 
 {
-	unsigned int tempMinutes = 0;
-	unsigned int tempHours = 0;
-	
+	int64_t second = i_epoch / USEC_PER_SEC;
+	if ( second != i_strSecond || decade != b_strDecade ) //only format once per second
+	{
+		updateFields();
+		snprintf( s_timeStr, sizeof(s_timeStr), decade ? "%02d:%02d:%02d:%02d:%02d:%02d" : "%d:%d:%d:%d:%d:%d", 
+				  i_year, i_month, i_day, i_hour, i_minute, i_second );
+		i_strSecond = second;
+		b_strDecade = decade;
+	}
+	return String(s_timeStr);
+}
+
+bool Time::IncrementTime( uint32_t inc, uint8_t unit )
+{
+	static const int64_t maxTime = MakeEpoch( MAX_YEAR, NUM_MONTHS_YEAR, 31, NUM_HOURS_DAY - 1, 59, 59 );
+
 	switch ( unit )
 	{
-		case TIME_SECOND: //Yeah, we've gotta go all the way up the chain. woohoo, on the plus side, we can't possibly roll over multiple days with seconds here.
-			if ( long(inc + i_second) >= UINT_MAX )
-				inc = UINT_MAX - i_second;
-			
-			tempMinutes = (((inc + i_second)/60) + i_minute); //Total minutes + existing minutes
-			i_second = (inc + i_second)%60; //Set seconds now
-		
-			if ( tempMinutes > i_minute ) //Should we proceed beyond this? (saving CPU)
-			{
-				i_minute = tempMinutes%60; //Set the minutes now
-				i_hour = ((tempMinutes/60) + i_hour); //Just total these for now, we can use the existing container for temp storage
-				i_day = AdvanceMonthYear( (i_hour/NUM_HOURS_DAY + i_day) );
-				i_hour = i_hour%NUM_HOURS_DAY; //Finally, Get the remainder from our stored hours, now that we've calculated the days and such
-			}
-			break; //END TIME_SECOND
-			
+		case TIME_SECOND:
+			i_epoch += static_cast<int64_t>(inc) * USEC_PER_SEC;
+			break;
 		case TIME_MINUTE:
-			if ( long(inc + i_minute) >= UINT_MAX )
-				inc = UINT_MAX - i_minute; //prevent overflow
-
-			tempHours = ((inc + i_minute)/60 + i_hour); //Save using old minutes
-			i_minute = (inc + i_minute)%60; //Set new minutes
-			if ( tempHours > i_hour )
-			{
-				i_day = AdvanceMonthYear( i_day + ((tempHours/NUM_HOURS_DAY) )%GetMonthDays( i_month ) );
-				i_hour = tempHours%NUM_HOURS_DAY;
-			}
-			break; //END TIME_MINUTE
-			
+			i_epoch += static_cast<int64_t>(inc) * 60 * USEC_PER_SEC;
+			break;
 		case TIME_HOUR:
-			if ( long(inc + i_hour) >= UINT_MAX )
-				inc = UINT_MAX - i_hour; //prevent overflow
-		
-			i_day = AdvanceMonthYear((inc + i_hour/NUM_HOURS_DAY) + i_day)%GetMonthDays(i_month); //Set the final day count, based on final month.
-			i_hour = (inc + i_hour)%NUM_HOURS_DAY;	
-			break; //END TIME_HOUR
-		
+			i_epoch += static_cast<int64_t>(inc) * 3600 * USEC_PER_SEC;
+			break;
 		case TIME_DAY:
-			if ( ((inc + i_day)/365) + i_year >= MAX_YEAR ) //Should never reach UINT_MAX
-				inc = MAX_YEAR*365; //Max number of days
-			else 
-				inc += i_day; //Add our current days
-			
-			i_day = AdvanceMonthYear(inc)%GetMonthDays( i_month ); //using final modulus
-			break; //END TIME_DAY
-		
+			i_epoch += static_cast<int64_t>(inc) * SEC_PER_DAY * USEC_PER_SEC;
+			break;
 		case TIME_MONTH: 
-			if ( ((inc + i_month)/NUM_MONTHS_YEAR + i_year) > MAX_YEAR )
-				inc = MAX_YEAR*NUM_MONTHS_YEAR; //cap
-			else
-				inc += i_month; //Add existing month
-				
-			i_month = inc%NUM_MONTHS_YEAR; //Just apply this here
-			while ( inc > NUM_MONTHS_YEAR )
-			{
-				inc -= NUM_MONTHS_YEAR;
-				i_year++;
-				if ( i_year >= MAX_YEAR )
-					return false; //end, we've hit the max year
-			}
-			break; //END TIME_MONTH
-			
 		case TIME_YEAR:
-			if ( (inc + i_year) > MAX_YEAR ) //Since we're using unsigned byte
-				i_year = MAX_YEAR; //cap
-			else
-				i_year += inc; //just add this, easy peasy
-			break; //END TIME_YEAR
+		{
+			updateFields();
+			uint32_t totalMonths = static_cast<uint32_t>(i_year) * NUM_MONTHS_YEAR + (i_month - 1) + ( unit == TIME_YEAR ? inc * NUM_MONTHS_YEAR : inc );
+			if ( totalMonths / NUM_MONTHS_YEAR > MAX_YEAR )
+				break; //capped below
 			
+			uint8_t yr = totalMonths / NUM_MONTHS_YEAR, 
+					mo = totalMonths % NUM_MONTHS_YEAR + 1, 
+					day = min( i_day, DaysInMonth( TIME_BASE_YEAR + yr, mo ) ); //clamp to the end of the month (EX: Jan 31 + 1 month = Feb 28/29)
+			setFields( yr, mo, day, i_hour, i_minute, i_second );
+			return true;
+		}
 		default:	
 			return false; //No valid unit, just end.
 	}
+
+	if ( i_epoch > maxTime || unit >= TIME_MONTH ) //cap
+	{
+		i_epoch = maxTime;
+		return false;
+	}
 	return true;
 }
 
-
-uint8_t Time::GetMonthDays( uint8_t month )
+uint8_t Time::DaysInMonth( uint16_t year, uint8_t month )
 {
-	uint16_t totalYear = 1970 + i_year; //leap year stuff
 	switch( month )
 	{
 		case 4:
@@ -167,7 +181,7 @@ uint8_t Time::GetMonthDays( uint8_t month )
 		case 11:
 			return 30;
 		case 2:
-			if ( !(totalYear%4) && totalYear%400 ) //for NTP stuff
+			if ( !(year%4) && ( year%100 || !(year%400) ) ) 
 				return 29;
 				
 			return 28;
@@ -176,21 +190,6 @@ uint8_t Time::GetMonthDays( uint8_t month )
 	}
 }
 
-uint8_t Time::AdvanceMonthYear( unsigned int days )
-{
-	while ( days > GetMonthDays(i_month) )
-	{
-		days -= GetMonthDays(i_month);
-		i_month++; //Just keep adding the months up, we shouldn't be able to roll over here.
-		if ( i_month > NUM_MONTHS_YEAR )
-		{
-			i_month = 1; //Roll over
-			if ( i_year < MAX_YEAR )
-				i_year++; //Happy new year
-		}
-	}
-	return days; //Should always be 31 or less
-}
 bool Time::SetTime( const String &str ) 
 {
 	vector<String> strVector;
@@ -217,27 +216,19 @@ bool Time::SetTime( const String &str )
 }
 bool Time::SetTime( const uint8_t &yr, const uint8_t &mo, const uint8_t &day, const uint8_t &hr, const uint8_t &min, const uint8_t &sec )
 {
-	if ( yr > MAX_YEAR || mo > NUM_MONTHS_YEAR || day > GetMonthDays(mo) || hr >= NUM_HOURS_DAY || min >= 60 || sec >= 60)
+	if ( yr > MAX_YEAR || !mo || mo > NUM_MONTHS_YEAR || !day || hr >= NUM_HOURS_DAY || min >= 60 || sec >= 60)
 		return false; //We went out of bounds somewhere
+
+	if ( day > DaysInMonth( TIME_BASE_YEAR + yr, mo ) )
+		return false;
 		
-	i_year = yr;
-	i_month = mo;
-	i_day = day;
-	i_hour = hr;
-	i_minute = min;
-	i_second = sec;
-	
+	setFields( yr, mo, day, hr, min, sec );
 	return true;
 }
 
 bool Time::SetTime( const Time &T2 )
 {
-	i_year = T2.i_year;
-	i_month = T2.i_month;
-	i_day = T2.i_day;
-	i_hour = T2.i_hour;
-	i_minute = T2.i_minute;
-	i_second = T2.i_second;
+	i_epoch = T2.i_epoch;
 	i_timeZone = T2.i_timeZone;
 	
 	return true;
@@ -245,34 +236,7 @@ bool Time::SetTime( const Time &T2 )
 
 bool Time::SetTime( const Time *T2 )
 {
-	i_year = T2->i_year;
-	i_month = T2->i_month;
-	i_day = T2->i_day;
-	i_hour = T2->i_hour;
-	i_minute = T2->i_minute;
-	i_second = T2->i_second;
-	i_timeZone = T2->i_timeZone;
-	
-	return true;
-}
-
-bool Time::IsAhead( const Time *T2 )
-{
-	if ( i_year > T2->i_year ) //year is ahead of the other's
-		return true; //A year ahead.
-	else if ( i_month > T2->i_month && i_year == T2->i_year )
-		return true; //Month is ahead, and year is equal or greater
-	else if ( i_day > T2->i_day && i_month == T2->i_month )
-		return true;
-	else if ( i_hour > T2->i_hour && i_day == T2->i_day )
-		return true;
-	else if ( i_minute > T2->i_minute && i_hour == T2->i_hour )
-		return true;
-	else if ( i_second > T2->i_second && i_minute == T2->i_minute )
-		return true;
-	
-	
-	return false;
+	return SetTime( *T2 );
 }
 
 bool Time::setYear( const uint8_t yr )
@@ -280,26 +244,20 @@ bool Time::setYear( const uint8_t yr )
 	if ( yr > MAX_YEAR )
 		return false;
 
-	i_year = yr;
-	return true;
+	updateFields();
+	return SetTime( yr, i_month, i_day, i_hour, i_minute, i_second );
 }
 
 bool Time::setMonth( const uint8_t mo )
 {
-	if ( mo > NUM_MONTHS_YEAR )
-		return false;
-	
-	i_month = mo;
-	return true;
+	updateFields();
+	return SetTime( i_year, mo, i_day, i_hour, i_minute, i_second );
 }
 
 bool Time::setDay( const uint8_t day )
 {
-	if ( day > GetMonthDays(i_month) )
-		return false;
-	
-	i_day = day;
-	return true;
+	updateFields();
+	return SetTime( i_year, i_month, day, i_hour, i_minute, i_second );
 }
 
 bool Time::setHour( const uint8_t hr )
@@ -307,7 +265,8 @@ bool Time::setHour( const uint8_t hr )
 	if ( hr >= NUM_HOURS_DAY)
 		return false;
 	
-	i_hour = hr;
+	updateFields();
+	setFields( i_year, i_month, i_day, hr, i_minute, i_second );
 	return true;
 }
 
@@ -316,7 +275,8 @@ bool Time::setMinute( const uint8_t min )
 	if (min >= 60)
 		return false;
 	
-	i_minute= min;
+	updateFields();
+	setFields( i_year, i_month, i_day, i_hour, min, i_second );
 	return true;
 }
 
@@ -325,6 +285,7 @@ bool Time::setSecond( const uint8_t sec )
 	if (sec >= 60)
 		return false;
 	
-	i_second = sec;
+	updateFields();
+	setFields( i_year, i_month, i_day, i_hour, i_minute, sec );
 	return true;
-}
\ No newline at end of file
+}
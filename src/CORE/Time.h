@@ -7,6 +7,7 @@
  */ 
 
 #include "GlobalDefs.h"
+#include <esp_timer.h>
 
 #ifndef TIME_H_
 #define TIME_H_
@@ -14,6 +15,11 @@
 #define MAX_YEAR 99 //Only working within bounds of last two digits (NOT Year 2100 compliant, as if that matters)
 #define NUM_MONTHS_YEAR 12 //Number of months to a year
 #define NUM_HOURS_DAY 24 //Number of hours to a day
+#define TIME_BASE_YEAR 2000 //i_year is stored as an offset from this year
+#define TIME_SLEW_LIMIT 500 //Clock corrections (ms) larger than this are stepped, smaller corrections are slewed in gradually
+#define TIME_SLEW_RATE 100 //While slewing, the clock is corrected by at most 1uS per this many uS of elapsed time (1%)
+#define USEC_PER_SEC 1000000LL
+#define SEC_PER_DAY 86400L
 
 enum TIME_UNITS
 {
@@ -25,29 +31,34 @@ enum TIME_UNITS
 	TIME_YEAR
 };
 
+//Time is stored as a single 64 bit UNIX timestamp (uS). Calendar fields are only calculated when they are requested, and are cached until the second changes.
 class Time
 {
 	public: 
 
 	Time( uint8_t yr = 0, uint8_t mo = 1, uint8_t da = 1, uint8_t hr = 1, uint8_t min = 0, uint8_t sec = 0, uint8_t tz = 0 )
 	{
-		if ( mo > 12 )
-			mo = 12;
-		if ( hr > 24 )
-			hr = 24;
-		if ( min > 60 )
-			min = 60;
-		if ( sec > 60 )
-			sec = 60;
-		i_year = yr; i_second = sec; i_minute = min; i_timeZone = tz; //Init to 0
-		i_hour = hr; i_day = da; i_month = mo; //Default to 1, as we cannot have a day 0, or month 0, etc.
+		if ( mo > NUM_MONTHS_YEAR )
+			mo = NUM_MONTHS_YEAR;
+		if ( hr >= NUM_HOURS_DAY )
+			hr = NUM_HOURS_DAY - 1;
+		if ( min >= 60 )
+			min = 59;
+		if ( sec >= 60 )
+			sec = 59;
+		i_epoch = MakeEpoch( yr, mo ? mo : 1, da ? da : 1, hr, min, sec ); 
+		i_timeZone = tz;
+		i_lastUpdateTime = esp_timer_get_time(); i_slew = 0; //the first update only adds the time since the object was made
+		i_fieldsSecond = -1; i_strSecond = -1; b_strDecade = false;
 	}
 	Time( const Time &T2 )
 	{
+		i_lastUpdateTime = esp_timer_get_time(); i_slew = 0; 
+		i_fieldsSecond = -1; i_strSecond = -1; b_strDecade = false;
 		SetTime( T2 );
 	}
 	
-	void UpdateTime(); //used to update the time in the time object
+	void UpdateTime(); //Advances the time using the hardware timer. Used to keep the system clock running.
 	//This function sets the time using integers for arguments.
 	bool SetTime( const uint8_t &yr, const uint8_t &mo, const uint8_t &day, const uint8_t &hr, const uint8_t &min, const uint8_t &sec );
 	bool SetTime( const Time &T2 ); //For copying values over
@@ -60,41 +71,85 @@ class Time
 	bool setHour( const uint8_t );
 	bool setMinute( const uint8_t );
 	bool setSecond( const uint8_t );
+	uint8_t getYear(){ updateFields(); return i_year; }
+	uint8_t getMonth(){ updateFields(); return i_month; }
+	uint8_t getDay(){ updateFields(); return i_day; }
+	uint8_t getHour(){ updateFields(); return i_hour; }
+	uint8_t getMinute(){ updateFields(); return i_minute; }
+	uint8_t getSecond(){ updateFields(); return i_second; }
+	//Returns the day of the week (0 = Sunday).
+	uint8_t getDayOfWeek(){ updateFields(); return i_dayOfWeek; }
 
 	void SetNTPTime( unsigned long ); //For translating NTP to a valid date/time
+	//Sets the time from a UNIX timestamp in milliseconds, discarding any pending slew.
+	void SetEpochMillis( uint64_t time ){ SetEpochMicros( static_cast<int64_t>(time) * 1000 ); }
+	//Sets the time from a UNIX timestamp in microseconds, discarding any pending slew.
+	void SetEpochMicros( int64_t );
+	//Returns the current time as a UNIX timestamp in seconds.
+	uint32_t GetEpoch(){ return i_epoch / USEC_PER_SEC; }
+	//Returns the current time as a UNIX timestamp in milliseconds.
+	uint64_t GetEpochMillis(){ return i_epoch / 1000; }
+	//Returns the current time as a UNIX timestamp in microseconds.
+	int64_t GetEpochMicros(){ return i_epoch; }
+	//Applies a correction (ms) to the clock. Small corrections are slewed over time so the clock never jumps, large ones are stepped.
+	void AdjustTime( int32_t );
+	//Returns the portion of the last correction (ms) that has not yet been slewed into the clock.
+	int32_t GetPendingSlew(){ return i_slew / 1000; }
 	//Input increment amount, along with time unit, can also be used to set.
 	bool IncrementTime( uint32_t, uint8_t ); 
-	bool IsAhead( const Time * );
+	bool IsAhead( const Time *T2 ){ return i_epoch > T2->i_epoch; }
 	bool IsBehind( const Time *T2 ){ return !IsAhead(T2); }
-	uint8_t GetMonthDays( uint8_t ); //Used to determine the proper number of days in a specific month.
+	uint8_t GetMonthDays( uint8_t month ){ return DaysInMonth( TIME_BASE_YEAR + getYear(), month ); } //Used to determine the proper number of days in a specific month.
 	void SetTimeZone( int8_t zone ){ i_timeZone = zone; }
 	uint8_t GetTimeZone(){ return i_timeZone; }
+	//Returns the time formatted as YY:MM:DD:HR:MI:SE, zero padded unless false is given. The text is only formatted once per second.
 	String GetTimeStr( bool = true ); 
 	
 	//Operator stuff.
-	bool operator< ( const Time &T2 ); //see time.cpp
-	bool operator> ( const Time &T2 ){ return !(*this < T2 ); }
-	bool operator<= ( const Time &T2 ){ return *this < T2; }
-	bool operator>= ( const Time &T2 ){ return !(*this < T2 ); }
-	bool operator== ( const Time &T2 ); //see time.cpp
+	bool operator< ( const Time &T2 ){ return i_epoch < T2.i_epoch; }
+	bool operator> ( const Time &T2 ){ return i_epoch > T2.i_epoch; }
+	bool operator<= ( const Time &T2 ){ return i_epoch <= T2.i_epoch; }
+	bool operator>= ( const Time &T2 ){ return i_epoch >= T2.i_epoch; }
+	bool operator== ( const Time &T2 ){ return i_epoch / USEC_PER_SEC == T2.i_epoch / USEC_PER_SEC; } //equal to the second
 	bool operator!= ( const Time &T2 ){ return !(*this == T2);}
-	Time& operator= ( const Time &T2 );
+	Time& operator= ( const Time &T2 ){ SetTime( T2 ); return *this; }
 	//
 	
+	//Returns the number of days since 1970-01-01 for the given year, month and day.
+	static int32_t DaysFromCivil( int32_t, uint8_t, uint8_t );
+	//Converts a number of days since 1970-01-01 into a year, month and day.
+	static void CivilFromDays( int32_t, int32_t &, uint8_t &, uint8_t & );
+	//Returns the number of days in the inputted month (1-12) of the inputted year (EX: 2024).
+	static uint8_t DaysInMonth( uint16_t, uint8_t );
+	
 	private:
-	uint8_t AdvanceMonthYear( unsigned int ); //Used to advance the month, and possibly the year, using a value of days as an input. Returns the remainder of days.
+	//Recalculates the calendar fields from the stored timestamp, if the second has changed since they were last calculated.
+	void updateFields();
+	//Returns the UNIX timestamp (uS) for the inputted calendar fields.
+	static int64_t MakeEpoch( uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t );
+	//Rebuilds the timestamp from the calendar fields, keeping the sub-second portion.
+	void setFields( uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t );
 	
-	uint8_t i_second,
+	int64_t i_epoch, //UNIX timestamp (uS)
+			i_lastUpdateTime, //hardware timer value at the last update (uS)
+			i_slew, //correction (uS) that is yet to be applied to the clock
+			i_fieldsSecond, //second (since epoch) that the calendar fields were calculated for
+			i_strSecond; //second (since epoch) that the cached time text was formatted for
+
+	uint8_t i_second, //cached calendar fields
 		i_minute,
 		i_hour,
 		i_day,
 		i_month,
 		i_year,
-		i_lastUpdateSecond; //only need one bit for this
+		i_dayOfWeek;
+	
+	bool b_strDecade; //cached time text was formatted with zero padding
+	char s_timeStr[24]; //cached time text
 	
 	int8_t i_timeZone;
 };
 
 
 
-#endif /* TIME_H_ */
\ No newline at end of file
+#endif /* TIME_H_ */
@@ -0,0 +1,186 @@
+/*
+ * TimeSync.cpp
+ *
+ * Function definitions for the Time_Sync class (non-blocking SNTP client).
+ */ 
+
+#include "TimeSync.h"
+#include <esp_timer.h>
+
+//Reads a big endian 32 bit value from the packet buffer.
+static uint32_t readUint32( const uint8_t *buffer )
+{
+	return ( static_cast<uint32_t>(buffer[0]) << 24 ) | ( static_cast<uint32_t>(buffer[1]) << 16 ) | ( static_cast<uint32_t>(buffer[2]) << 8 ) | buffer[3];
+}
+
+//Converts an NTP timestamp (32.32 fixed point seconds since 1900) into a UNIX timestamp in microseconds.
+static int64_t readNTPTimestamp( const uint8_t *buffer )
+{
+	uint32_t seconds = readUint32( buffer ) - NTP_UNIX_OFFSET;
+	uint64_t fraction = readUint32( buffer + 4 );
+	return static_cast<int64_t>(seconds) * 1000000 + static_cast<int64_t>( (fraction * 1000000) >> 32 );
+}
+
+bool Time_Sync::begin( const String &server, uint16_t port )
+{
+	if ( isBusy() || !server.length() )
+		return false;
+
+	i_serverPort = port;
+	i_retries = 0;
+	i_requestMillis = millis();
+
+	if ( serverIP.fromString(server) ) //no lookup required
+	{
+		i_state = SYNC_WAITING;
+		i_requestTime = 0; //send on the next call to process(), once we have the UDP object
+		return true;
+	}
+
+	s_serverName = server; //the network stack needs the name to stay valid until the lookup has completed
+	b_dnsDone = false;
+	i_dnsAddress = 0;
+	i_state = SYNC_RESOLVING;
+
+	ip_addr_t address;
+	err_t err = dns_gethostbyname( s_serverName.c_str(), &address, &Time_Sync::handleDNSFound, this );
+	if ( err == ERR_OK ) //already cached
+	{
+		serverIP = IPAddress( address.u_addr.ip4.addr );
+		i_state = SYNC_WAITING;
+		i_requestTime = 0;
+	}
+	else if ( err != ERR_INPROGRESS ) //lookup could not be started
+	{
+		fail();
+		return false;
+	}
+
+	return true;
+}
+
+void Time_Sync::handleDNSFound( const char *, const ip_addr_t *address, void *arg )
+{
+	Time_Sync *pSync = static_cast<Time_Sync *>(arg);
+	pSync->i_dnsAddress = address ? address->u_addr.ip4.addr : 0;
+	pSync->b_dnsDone = true;
+}
+
+uint8_t Time_Sync::process( WiFiUDP &udp, Time *pTime )
+{
+	switch( i_state )
+	{
+		case SYNC_RESOLVING:
+			if ( b_dnsDone )
+			{
+				if ( !i_dnsAddress )
+					return fail(); //unknown host
+
+				serverIP = IPAddress( i_dnsAddress );
+				i_state = SYNC_WAITING;
+				sendRequest( udp );
+			}
+			else if ( millis() - i_requestMillis > NTP_TIMEOUT )
+				return fail();
+			break;
+
+		case SYNC_WAITING:
+			if ( !i_requestTime ) //address was known without a lookup
+				sendRequest( udp );
+			else if ( checkReply( udp, pTime ) )
+			{
+				i_state = SYNC_IDLE;
+				return SYNC_RESULT_SUCCESS;
+			}
+			else if ( millis() - i_requestMillis > NTP_TIMEOUT )
+			{
+				if ( ++i_retries >= NTP_MAX_RETRIES )
+					return fail();
+
+				sendRequest( udp ); //try again, the previous request or reply may have been dropped
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	return SYNC_RESULT_NONE;
+}
+
+void Time_Sync::sendRequest( WiFiUDP &udp )
+{
+	uint8_t buffer[NTP_PACKET_SIZE];
+	memset( buffer, 0, NTP_PACKET_SIZE );
+	buffer[0] = 0b11100011; // LI (unsynchronized), Version 4, Mode 3 (client)
+
+	i_requestTime = esp_timer_get_time();
+	i_requestMillis = millis();
+
+	//The transmit timestamp is echoed back by the server as the originate timestamp, so the local send time is used to match the reply.
+	for ( uint8_t x = 0; x < 8; x++ )
+		buffer[40 + x] = static_cast<uint64_t>(i_requestTime) >> ( 56 - x * 8 );
+
+	udp.beginPacket( serverIP, i_serverPort );
+	udp.write( buffer, NTP_PACKET_SIZE );
+	udp.endPacket();
+}
+
+bool Time_Sync::checkReply( WiFiUDP &udp, Time *pTime )
+{
+	uint8_t buffer[NTP_PACKET_SIZE];
+
+	for ( uint8_t packets = 0; packets < 4; packets++ ) //discard a few stale or unrelated packets at most, per call
+	{
+		if ( !udp.parsePacket() ) 
+			return false; //nothing waiting
+
+		int64_t replyTime = esp_timer_get_time(); 
+		
+		if ( udp.read( buffer, NTP_PACKET_SIZE ) < NTP_PACKET_SIZE )
+			continue;
+
+		bool matched = true;
+		for ( uint8_t x = 0; x < 8; x++ ) //originate timestamp must be our request
+		{
+			if ( buffer[24 + x] != static_cast<uint8_t>( static_cast<uint64_t>(i_requestTime) >> ( 56 - x * 8 ) ) )
+				matched = false;
+		}
+
+		if ( !matched || (buffer[0] & 0x07) != 4 || !buffer[1] || (buffer[0] >> 6) == 3 ) //must be a server reply, not a kiss-of-death, and the server must be synchronized
+			continue;
+
+		int64_t serverReceive = readNTPTimestamp( buffer + 32 ), 
+				serverTransmit = readNTPTimestamp( buffer + 40 );
+
+		int64_t rtt = (replyTime - i_requestTime) - (serverTransmit - serverReceive); //round trip, less the time the server took to reply
+		if ( rtt < 0 )
+			rtt = 0;
+
+		pTime->UpdateTime(); //bring the clock up to the moment of the reply
+		int64_t offset = (serverTransmit + rtt/2) / 1000 - static_cast<int64_t>( pTime->GetEpochMillis() );
+		if ( offset > INT32_MAX )
+			offset = INT32_MAX;
+		else if ( offset < INT32_MIN )
+			offset = INT32_MIN;
+
+		pTime->AdjustTime( offset );
+
+		stats.i_lastOffset = offset;
+		stats.i_lastRTT = rtt;
+		stats.i_minRTT = min( stats.i_minRTT, stats.i_lastRTT );
+		stats.i_maxRTT = max( stats.i_maxRTT, stats.i_lastRTT );
+		stats.i_numSyncs++;
+		stats.i_lastSyncMillis = millis();
+		return true;
+	}
+
+	return false;
+}
+
+uint8_t Time_Sync::fail()
+{
+	i_state = SYNC_IDLE;
+	stats.i_numFailures++;
+	return SYNC_RESULT_FAILED;
+}
@@ -0,0 +1,95 @@
+/*
+ * TimeSync.h
+ *
+ * Non-blocking SNTP client for the system clock. Each call to process() performs at most one short, non-blocking step (DNS lookup, 
+ * request, or reply check), so a time update never stalls the logic scan. Offsets are applied to the clock through Time::AdjustTime().
+ */ 
+
+#ifndef TIMESYNC_H_
+#define TIMESYNC_H_
+
+#include "Time.h"
+#include <WiFiUdp.h>
+#include <lwip/dns.h>
+
+#define NTP_PACKET_SIZE 48
+#define NTP_PORT 123
+#define NTP_UNIX_OFFSET 2208988800UL //seconds between the NTP epoch (1900) and the UNIX epoch (1970)
+#define NTP_TIMEOUT 1500 //time (ms) to wait for a DNS lookup or server reply before retrying
+#define NTP_MAX_RETRIES 3 //number of requests that are sent before giving up on a sync
+
+enum SYNC_STATE : uint8_t
+{
+	SYNC_IDLE = 0,
+	SYNC_RESOLVING, //waiting on the DNS lookup for the server
+	SYNC_WAITING //request sent, waiting on the reply
+};
+
+enum SYNC_RESULT : uint8_t
+{
+	SYNC_RESULT_NONE = 0, //nothing finished during this call
+	SYNC_RESULT_SUCCESS,
+	SYNC_RESULT_FAILED
+};
+
+//Statistics for the most recent syncs, for diagnostics.
+struct Time_Sync_Stats
+{
+	int32_t i_lastOffset; //correction (ms) applied by the last successful sync
+	uint32_t i_lastRTT, //round trip delay (uS) of the last successful sync, excluding server processing time
+			 i_minRTT,
+			 i_maxRTT,
+			 i_numSyncs, //successful syncs
+			 i_numFailures, //syncs that timed out or received an invalid reply
+			 i_lastSyncMillis; //millis() value at the last successful sync
+};
+
+class Time_Sync
+{
+	public:
+	Time_Sync()
+	{
+		i_state = SYNC_IDLE;
+		i_retries = 0;
+		i_requestMillis = 0;
+		i_requestTime = 0;
+		i_serverPort = NTP_PORT;
+		b_dnsDone = false;
+		i_dnsAddress = 0;
+		memset( &stats, 0, sizeof(stats) );
+		stats.i_minRTT = UINT32_MAX;
+	}
+
+	//Starts a new sync with the inputted server (hostname or IP) and port. Returns false if a sync is already in progress.
+	bool begin( const String &, uint16_t = NTP_PORT );
+	//Performs the next step of the sync (if any) without blocking. Applies the measured offset to the inputted clock on success.
+	uint8_t process( WiFiUDP &, Time * );
+	//Abandons any sync in progress.
+	void cancel(){ i_state = SYNC_IDLE; }
+
+	bool isBusy(){ return i_state != SYNC_IDLE; }
+	const Time_Sync_Stats &getStats(){ return stats; }
+
+	private:
+	//Called by the network stack once the DNS lookup has completed.
+	static void handleDNSFound( const char *, const ip_addr_t *, void * );
+	//Sends a request to the resolved server address.
+	void sendRequest( WiFiUDP & );
+	//Checks for a reply to the outstanding request. Returns true if a valid reply was received and applied to the clock.
+	bool checkReply( WiFiUDP &, Time * );
+	uint8_t fail();
+
+	uint8_t i_state, i_retries;
+	uint16_t i_serverPort;
+	IPAddress serverIP;
+	String s_serverName;
+	uint32_t i_requestMillis; //millis() value when the current step was started, for timeouts
+	int64_t i_requestTime; //esp_timer value when the request was sent (uS), also sent to the server to match the reply with the request.
+
+	volatile bool b_dnsDone; //set by the DNS callback
+	volatile uint32_t i_dnsAddress; //resolved address (0 on failure)
+
+	Time_Sync_Stats stats;
+};
+
+#endif /* TIMESYNC_H_ */
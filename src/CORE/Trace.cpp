@@ -0,0 +1,79 @@
+/*
+ * Trace.cpp
+ *
+ * Lock free event trace ring, see Trace.h.
+ */
+
+#include "Trace.h"
+#include "GlobalDefs.h"
+
+Trace_Buffer::Trace_Buffer()
+{
+	i_next = 0;
+	b_enabled = true;
+	b_rungs = false;
+	for ( uint16_t x = 0; x < TRACE_BUFFER_EVENTS; x++ )
+		events[x].i_seq = 0;
+}
+
+void Trace_Buffer::write( uint8_t type, uint16_t id, uint32_t value, int64_t time )
+{
+	uint32_t seq = i_next.fetch_add(1); //claims the slot, so both cores can record at once
+	Trace_Event &event = events[seq & (TRACE_BUFFER_EVENTS - 1)];
+	event.i_seq.store(0, memory_order_relaxed); //a dump skips the slot until it is complete
+	atomic_thread_fence(memory_order_release);
+	event.i_time = static_cast<uint32_t>(time);
+	event.i_id = id;
+	event.i_type = type;
+	#ifdef ARDUINO_ARCH_ESP32
+	event.i_core = xPortGetCoreID();
+	#else
+	event.i_core = 0;
+	#endif
+	event.i_value = value;
+	event.i_seq.store(seq + 1, memory_order_release);
+}
+
+uint32_t Trace_Buffer::dump( function<void(const uint8_t *, uint16_t)> send )
+{
+	uint32_t end = i_next.load(),
+			 start = ( end > TRACE_BUFFER_EVENTS ) ? end - TRACE_BUFFER_EVENTS : 0;
+
+	uint8_t chunk[TRACE_DUMP_CHUNK * TRACE_RECORD_SIZE];
+	uint32_t header[TRACE_HEADER_SIZE / 4] = { TRACE_MAGIC, TRACE_RECORD_SIZE, end, start };
+	memcpy( chunk, header, TRACE_HEADER_SIZE );
+	send( chunk, TRACE_HEADER_SIZE );
+
+	uint32_t dumped = 0;
+	uint16_t length = 0;
+	for ( uint32_t seq = start; seq < end; seq++ )
+	{
+		const Trace_Event &event = events[seq & (TRACE_BUFFER_EVENTS - 1)];
+		if ( event.i_seq.load(memory_order_acquire) != seq + 1 ) //overwritten since the dump started, or still being written
+			continue;
+
+		uint8_t *record = chunk + length;
+		memcpy( record, &event.i_time, 4 );
+		memcpy( record + 4, &event.i_id, 2 );
+		record[6] = event.i_type;
+		record[7] = event.i_core;
+		memcpy( record + 8, &event.i_value, 4 );
+		atomic_thread_fence(memory_order_acquire);
+		if ( event.i_seq.load(memory_order_relaxed) != seq + 1 ) //overwritten while it was copied
+			continue;
+
+		uint32_t number = seq + 1;
+		memcpy( record + 12, &number, 4 );
+		length += TRACE_RECORD_SIZE;
+		dumped++;
+		if ( length == sizeof(chunk) )
+		{
+			send( chunk, length );
+			length = 0;
+		}
+	}
+	if ( length )
+		send( chunk, length );
+
+	return dumped;
+}
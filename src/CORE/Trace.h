@@ -0,0 +1,107 @@
+/*
+ * Trace.h
+ *
+ * A fixed size ring of timestamped binary events (scan and task start/end, rungs, output changes, remote requests, web requests and script parse phases),
+ * for working out what the device was doing when something went wrong. Recording an event is a single atomic increment and a 16 byte write, with no locks,
+ * so it can be called from either core and from the scan itself. The oldest events are overwritten once the ring is full.
+ * The ring is dumped by the /trace route (binary) or the /r serial command (hex lines prefixed with "T:"). tools/trace_to_chrome.py converts either dump
+ * to the Chrome trace JSON format, which can be opened in chrome://tracing or Perfetto.
+ *
+ * Dump format (little endian): header { uint32_t magic ("TRC1"), uint16_t event size, uint16_t reserved, uint32_t events recorded since boot,
+ * uint32_t number of the first event in the dump } followed by the events, oldest first, as { uint32_t time, uint16_t id, uint8_t type, uint8_t core,
+ * uint32_t value, uint32_t number + 1 }. Events that were overwritten while the dump was being sent are left out, so the numbers may have gaps.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "Arduino.h"
+#include <esp_timer.h>
+#include <atomic>
+#include <functional>
+
+using namespace std;
+
+#define TRACE_BUFFER_EVENTS 512 //must be a power of 2. 16 bytes each.
+#define TRACE_MAGIC 0x31435254 //"TRC1"
+#define TRACE_HEADER_SIZE 16
+#define TRACE_RECORD_SIZE 16 //size of an event in a dump
+#define TRACE_DUMP_CHUNK 64 //events sent at a time by a dump
+#define TRACE_WEB_MIN_US 100 //shorter passes of the web server are idle polls, and aren't recorded
+
+enum TRACE_EVENT : uint8_t
+{
+	TRACE_SCAN_BEGIN = 1,
+	TRACE_SCAN_END, //value: scan time (uS)
+	TRACE_TASK_BEGIN, //id: task index
+	TRACE_TASK_END,
+	TRACE_RUNG_BEGIN, //id: rung number (script order). Only recorded with rung tracing enabled.
+	TRACE_RUNG_END,
+	TRACE_OUTPUT_CHANGE, //id: pin, value: new output value
+	TRACE_REMOTE_REQUEST, //id: last octet of the host address, value: bytes sent
+	TRACE_REMOTE_RESPONSE, //id: last octet of the host address, value: latency (uS), 0 if the host didn't reply
+	TRACE_WEB_REQUEST, //value: handling time (uS), recorded at the end of the request
+	TRACE_PARSE_BEGIN, //id: TRACE_PARSE_PHASE
+	TRACE_PARSE_END, //id: TRACE_PARSE_PHASE, value: rungs (parse), tasks (build) or values restored (retain)
+	TRACE_OVERRUN //value: scan time (uS), recorded by the scan watchdog
+};
+
+enum TRACE_PARSE_PHASE : uint16_t
+{
+	TRACE_PARSE_SCRIPT,
+	TRACE_PARSE_BUILD, //task and object ownership
+	TRACE_PARSE_RETAIN //restoring retentive values
+};
+
+struct Trace_Event
+{
+	uint32_t i_time; //uS since boot (low 32 bits)
+	uint16_t i_id;
+	uint8_t i_type; //TRACE_EVENT
+	uint8_t i_core;
+	uint32_t i_value;
+	atomic<uint32_t> i_seq; //number of the event + 1, written last. 0 while the slot is being written.
+};
+
+class Trace_Buffer
+{
+	public:
+	Trace_Buffer();
+
+	//Adds an event to the ring. Args: <TRACE_EVENT>, <ID>, <Value>
+	void record( uint8_t type, uint16_t id = 0, uint32_t value = 0 )
+	{
+		if ( b_enabled )
+			write( type, id, value, esp_timer_get_time() );
+	}
+	//Adds an event that started at an earlier time, such as a request whose duration is only known at the end. Args: <TRACE_EVENT>, <ID>, <Value>, <Time (uS)>
+	void recordAt( uint8_t type, uint16_t id, uint32_t value, int64_t time )
+	{
+		if ( b_enabled )
+			write( type, id, value, time );
+	}
+
+	void setEnabled( bool enable ){ b_enabled = enable; }
+	bool isEnabled(){ return b_enabled; }
+	//Rung events fill the ring within a few scans, so they are only recorded when asked for.
+	void setRungTracing( bool enable ){ b_rungs = enable; }
+	bool isRungTracing(){ return b_enabled && b_rungs; }
+	//Returns the number of events recorded since boot, including those that have been overwritten.
+	uint32_t getNumRecorded(){ return i_next.load(); }
+
+	//Passes the dump to the given function a piece at a time: the header, then up to TRACE_DUMP_CHUNK events per call. Events keep being recorded during the dump,
+	//any that are overwritten before they are read are left out. Returns the number of events dumped.
+	uint32_t dump( function<void(const uint8_t *, uint16_t)> );
+
+	private:
+	void write( uint8_t, uint16_t, uint32_t, int64_t );
+
+	Trace_Event events[TRACE_BUFFER_EVENTS];
+	atomic<uint32_t> i_next; //number of the next event
+	volatile bool b_enabled,
+				  b_rungs;
+};
+
+extern Trace_Buffer EventTrace;
+
+#endif /* TRACE_H_ */
@@ -11,6 +11,7 @@
 #include <memory>
 #include <ESPmDNS.h>
 #include "../PLC/PLC_Main.h" //for directly accessing the PLC object stuff.
+#include "Trace.h"
 
 void UICore::setup()
 {
@@ -39,10 +40,17 @@ void UICore::Process()
 	parseSerialData(); //parse all incoming serial data.
 	if ( WiFi.status() == WL_CONNECTED || WiFi.softAPgetStationNum() ) //Only do this stuff if we're connected to a network, or a client has connected to the AP
 	{
+		Heap_Scope heapScope(HEAP_TAG_WEB);
+		int64_t requestStart = esp_timer_get_time();
 		getWebServer().handleClient(); //Process stuff for clients that have connected.
+		continueLogDownload();
+		int64_t requestTime = esp_timer_get_time() - requestStart;
+		if ( requestTime >= TRACE_WEB_MIN_US ) //a request was handled
+			EventTrace.recordAt( TRACE_WEB_REQUEST, 0, requestTime, requestStart );
 	}
 	
 	updateClock(); //Update our stored system clock values;
+	heapMonitor.update( millis() );
 }
 
 
@@ -237,6 +245,7 @@ void UICore::sendMessage( const String &str, uint8_t priority )
 {
 	if ( priority <= i_verboseMode ) 
 	{
+		Heap_Scope heapScope(HEAP_TAG_ALERTS);
 		uint16_t vectorSize = str.length(); //start with the size of the incoming string, since it will be added to the vector.
 		for ( uint8_t x = 0; x < alerts.size(); x++ )
 				vectorSize += alerts[x].length();
@@ -293,21 +302,162 @@ void UICore::printDiag()
 	sendMessage( PSTR("Time Server Address: ") + getNISTServer(), PRIORITY_HIGH );
 	sendMessage( PSTR("Time Update Interval (mins): ") + String(i_NISTupdateFreq) );
 	sendMessage( PSTR("NIST Time Mode: ") + String(b_enableNIST) );
+	const Time_Sync_Stats &syncStats = timeSync.getStats();
+	sendMessage( PSTR("Time Syncs (OK/Failed): ") + String(syncStats.i_numSyncs) + "/" + String(syncStats.i_numFailures) );
+	if ( syncStats.i_numSyncs )
+	{
+		sendMessage( PSTR("Last Sync Offset (ms): ") + String(syncStats.i_lastOffset) + PSTR(", ") + String( (millis() - syncStats.i_lastSyncMillis)/1000 ) + PSTR(" seconds ago") );
+		sendMessage( PSTR("Sync Round Trip (us) Last/Min/Max: ") + String(syncStats.i_lastRTT) + "/" + String(syncStats.i_minRTT) + "/" + String(syncStats.i_maxRTT) );
+	}
 	
 	sendMessage( PSTR("Available system memory: ") + String(esp_get_free_heap_size()) + PSTR(" bytes."), PRIORITY_HIGH );
+	Heap_Sample heapNow = Heap_Monitor::takeSample();
+	uint32_t lowestLargest = heapNow.i_largest;
+	for ( uint8_t x = 0; x < heapMonitor.getNumSamples(); x++ )
+		lowestLargest = min( lowestLargest, heapMonitor.getSample(x).i_largest );
+	sendMessage( PSTR("Largest free block: ") + String(heapNow.i_largest) + PSTR(" bytes (lowest sampled: ") + String(lowestLargest) + PSTR("), lowest free: ") + String(heapNow.i_minFree) + PSTR(" bytes."), PRIORITY_HIGH );
+	#if HEAP_ACCOUNTING
+	for ( uint8_t x = 0; x < HEAP_NUM_TAGS; x++ )
+	{
+		const Heap_Tag_Stats &stats = Heap_Monitor::getTagStats(x);
+		sendMessage( PSTR("  ") + String(Heap_Monitor::getTagName(x)) + PSTR(" heap allocs/frees: ") + String(stats.i_allocs.load()) + "/" + String(stats.i_frees.load())
+					+ PSTR(", bytes allocated: ") + String(stats.i_bytes.load())
+					+ PSTR(", bytes now/peak: ") + String(stats.i_current.load()) + "/" + String(stats.i_peak.load()), PRIORITY_HIGH );
+	}
+	#endif
 	if ( b_FSOpen )
 	{
 		sendMessage( PSTR("Total flash storage used: ") + String(SPIFFS.usedBytes()) + PSTR(" bytes."), PRIORITY_HIGH );
 		sendMessage( PSTR("Total storage available: ") + String(SPIFFS.totalBytes()) + PSTR(" bytes."), PRIORITY_HIGH );
+
+		const Retain_Stats &retainStats = PLCObj.getRetentiveStorage().getStats();
+		sendMessage( PSTR("Retentive values: ") + String(PLCObj.getRetentiveStorage().getNumEntries()) + PSTR(", writes: ") + String(retainStats.i_numFlushes) 
+					+ PSTR(", records: ") + String(retainStats.i_numRecords) + PSTR(", compactions: ") + String(retainStats.i_numCompactions)
+					+ PSTR(", bytes written: ") + String(static_cast<uint32_t>(retainStats.i_bytesWritten)), PRIORITY_HIGH );
 	}
 }
 
-void UICore::updateClock()
+void UICore::printTaskStats()
+{
+	sendMessage( PSTR("-- PLC Tasks --"), PRIORITY_HIGH );
+	vector<shared_ptr<PLC_Task>> &tasks = PLCObj.getTasks();
+	for ( uint8_t x = 0; x < tasks.size(); x++ )
+	{
+		const Task_Stats &stats = tasks[x]->getStats();
+		String period = tasks[x]->getPeriod() ? String(tasks[x]->getPeriod()) + PSTR("us") : String(PSTR("continuous"));
+		sendMessage( tasks[x]->getName() + PSTR(" (") + period + PSTR("), rungs: ") + String(tasks[x]->getRungs().size()) + PSTR(", runs: ") + String(stats.i_runs), PRIORITY_HIGH );
+		sendMessage( PSTR("  Time (us) Last/Avg/Max: ") + String(static_cast<int32_t>(stats.i_lastTime)) + "/" + String(stats.i_runs ? static_cast<int32_t>(stats.i_totalTime / stats.i_runs) : 0)
+					+ "/" + String(static_cast<int32_t>(stats.i_maxTime)) + PSTR(", max late: ") + String(static_cast<int32_t>(stats.i_maxLatency))
+					+ PSTR(", overruns: ") + String(stats.i_overruns) + PSTR(", preempted: ") + String(stats.i_preemptions) + PSTR(", skipped: ") + String(stats.i_skips), PRIORITY_HIGH );
+	}
+}
+
+void UICore::parseWatchdog( const vector<String> &args )
 {
-	if ( UpdateNIST() ) //if we've updated the time, advance it next round.
+	PLC_Scan_Watchdog &watchdog = PLCObj.getScanWatchdog();
+	if ( args.size() && args[0] == "reset" )
+	{
+		watchdog.clear();
+		sendMessage( PSTR("Scan watchdog cleared."), PRIORITY_HIGH );
 		return;
-		
+	}
+
+	const Watchdog_Stats &stats = watchdog.getStats();
+	const char *policies[] = { PSTR("log"), PSTR("skip"), PSTR("safe"), PSTR("fault") };
+	String state = watchdog.isFaulted() ? PSTR("FAULTED") : ( watchdog.isHolding() ? PSTR("OUTPUTS HELD") : PSTR("OK") );
+	sendMessage( PSTR("-- Scan Watchdog --"), PRIORITY_HIGH );
+	sendMessage( PSTR("Budget: ") + ( watchdog.isEnabled() ? String(watchdog.getBudget()) + PSTR("us, policy: ") + policies[watchdog.getPolicy()] : String(PSTR("disabled")) ) + PSTR(", state: ") + state, PRIORITY_HIGH );
+	sendMessage( PSTR("Scans: ") + String(stats.i_scans) + PSTR(", last/max (us): ") + String(static_cast<int32_t>(stats.i_lastScan)) + "/" + String(static_cast<int32_t>(stats.i_maxScan))
+				+ PSTR(", overruns: ") + String(stats.i_overruns) + PSTR(", trips: ") + String(stats.i_trips), PRIORITY_HIGH );
+	sendMessage( PSTR("Allocating scans: ") + String(stats.i_allocScans) + ( stats.i_allocScans ? PSTR(", last: ") + String(stats.i_lastAllocs) + PSTR(" allocations, ") + PLC_Scan_Watchdog::describeAllocs(stats) : String() ), PRIORITY_HIGH );
+
+	const Watchdog_Overrun &overrun = watchdog.getLastOverrun();
+	if ( !overrun.i_time )
+		return;
+
+	sendMessage( PSTR("Last overrun: ") + String(static_cast<int32_t>(overrun.i_scanTime)) + PSTR("us at uptime ") + String(static_cast<uint32_t>(overrun.i_time / 1000)) + PSTR("ms, epoch ") + String(overrun.i_epoch), PRIORITY_HIGH );
+	sendMessage( PSTR("  Accessors/Remote server/Background/Retentive (us): ") + String(static_cast<int32_t>(overrun.phaseTimes[WATCHDOG_PHASE_ACCESSORS])) + "/" + String(static_cast<int32_t>(overrun.phaseTimes[WATCHDOG_PHASE_REMOTE_SERVER]))
+				+ "/" + String(static_cast<int32_t>(overrun.phaseTimes[WATCHDOG_PHASE_BACKGROUND])) + "/" + String(static_cast<int32_t>(overrun.phaseTimes[WATCHDOG_PHASE_RETAIN])), PRIORITY_HIGH );
+
+	vector<shared_ptr<PLC_Task>> &tasks = PLCObj.getTasks();
+	for ( uint8_t x = 0; x < overrun.taskTimes.size() && x < tasks.size(); x++ )
+		sendMessage( PSTR("  Task ") + tasks[x]->getName() + PSTR(": ") + String(static_cast<int32_t>(overrun.taskTimes[x])) + PSTR("us"), PRIORITY_HIGH );
+
+	//The slowest rungs, slowest first.
+	vector<bool> shown(overrun.rungTimes.size(), false);
+	for ( uint8_t x = 0; x < WATCHDOG_REPORT_RUNGS; x++ )
+	{
+		int32_t slowest = -1;
+		for ( uint16_t y = 0; y < overrun.rungTimes.size(); y++ )
+		{
+			if ( !shown[y] && overrun.rungTimes[y] && ( slowest < 0 || overrun.rungTimes[y] > overrun.rungTimes[slowest] ) )
+				slowest = y;
+		}
+		if ( slowest < 0 )
+			break;
+
+		shown[slowest] = true;
+		sendMessage( PSTR("  Rung ") + String(slowest + 1) + PSTR(": ") + String(overrun.rungTimes[slowest]) + PSTR("us"), PRIORITY_HIGH );
+	}
+}
+
+void UICore::parseTrace( const vector<String> &args )
+{
+	if ( args.size() )
+	{
+		EventTrace.setEnabled( args[0] != "off" );
+		EventTrace.setRungTracing( args[0] == "rungs" );
+		sendMessage( PSTR("Event trace ") + String( args[0] == "off" ? PSTR("disabled.") : PSTR("enabled.") ), PRIORITY_HIGH );
+		return;
+	}
+
+	//Written straight to the serial port, so the dump doesn't end up in the alert history. Each line is one piece of the binary dump.
+	static const char hexChars[] = "0123456789ABCDEF";
+	uint32_t dumped = EventTrace.dump( []( const uint8_t *data, uint16_t length )
+	{
+		for ( uint16_t x = 0; x < length; x += TRACE_RECORD_SIZE )
+		{
+			char line[3 + TRACE_RECORD_SIZE * 2] = { 'T', ':' };
+			for ( uint8_t y = 0; y < TRACE_RECORD_SIZE && x + y < length; y++ )
+			{
+				line[2 + y * 2] = hexChars[data[x + y] >> 4];
+				line[3 + y * 2] = hexChars[data[x + y] & 0x0F];
+			}
+			Serial.println(line);
+		}
+	});
+	sendMessage( PSTR("Trace events dumped: ") + String(dumped), PRIORITY_HIGH );
+}
+
+void UICore::updateClock()
+{
 	p_currentTime->UpdateTime();
+
+	if ( CheckUpdateNIST() )
+		UpdateNIST();
+
+	switch ( timeSync.process( getTimeUDP(), p_currentTime.get() ) ) //never blocks, so the logic scan is not held up by the time server
+	{
+		case SYNC_RESULT_SUCCESS:
+			sendMessage( PSTR("Time updated. Offset (ms): ") + String(timeSync.getStats().i_lastOffset) + PSTR(" Round trip (us): ") + String(timeSync.getStats().i_lastRTT) );
+			break;
+		case SYNC_RESULT_FAILED:
+			sendMessage( PSTR("No response from NIST server: ") + getNISTServer(), PRIORITY_HIGH );
+			break;
+		default:
+			break;
+	}
+}
+
+bool UICore::CheckUpdateNIST()
+{
+	if ( !WiFi.isConnected() || !b_enableNIST || !getNISTServer().length() ) //Must be on a network before attempting to connect to NIST server
+		return false;
+	
+	if ( !i_NISTupdateFreq || timeSync.isBusy() ) //must be a non-zero value
+		return false;
+		
+	return !p_currentTime->IsBehind( p_nextNISTUpdateTime.get() ); //too soon for an update?
 }
 
 bool UICore::UpdateNIST( bool force ) 
@@ -316,16 +466,19 @@ bool UICore::UpdateNIST( bool force )
 	
 	if ( WiFi.isConnected() && b_enableNIST && getNISTServer().length() ) //Must be on a network before attempting to connect to NIST server
 	{
-		if ( !i_NISTupdateFreq && !force ) //must be a non-zero value
-			return false;
-		
-		if ( p_currentTime->IsBehind( p_nextNISTUpdateTime.get() ) && !force ) //too soon for an update?
-			return false;
-		
-		sendMessage( PSTR("Updating time." ) );
+		//Schedule the next update now, so a server that does not respond is not retried every loop.
+		p_nextNISTUpdateTime->SetTime( p_currentTime.get() ); //Replace with current time
+		p_nextNISTUpdateTime->IncrementTime( i_NISTupdateFreq, i_NISTUpdateUnit );//Then increment -- need to rework this a bit
 		
-		if ( !i_nistMode )
+		if ( !i_nistMode ) //DAYTIME protocol blocks while connecting, so it is only used when an update is requested manually.
 		{
+			if ( !force )
+			{
+				sendMessage( PSTR("Scheduled time update skipped: the DAYTIME protocol is only used for manual updates, select NTP for scheduled updates."), PRIORITY_HIGH );
+				return false;
+			}
+
+			sendMessage( PSTR("Updating time." ) );
 			WiFiClient NISTclient;
 			while( !NISTclient.connect(getNISTServer().c_str(), i_NISTPort) )
 			{
@@ -351,41 +504,16 @@ bool UICore::UpdateNIST( bool force )
 				 line.substring(16, 18).toInt(), line.substring(19, 21).toInt(), line.substring(22, 24).toInt() ) )
 					return false;
 			}
+			return true;
 		}
 		else if ( i_nistMode == 1 ) //NTP mode
 		{
-			uint8_t NTP_PACKET_SIZE = 48;
-			byte NTPBuffer[NTP_PACKET_SIZE]; // buffer to hold incoming and outgoing packets
-			memset(NTPBuffer, 0, NTP_PACKET_SIZE);  // set all bytes in the buffer to 0
-			// Initialize values needed to form NTP request
-			NTPBuffer[0] = 0b11100011;   // LI, Version, Mode
-			// send a packet requesting a timestamp:
-			p_UDP->beginPacket(getNISTServer().c_str(), 123); // NTP requests are to port 123
-			p_UDP->write(NTPBuffer, NTP_PACKET_SIZE); 
-			p_UDP->endPacket();
-			
-			delay(100);
-			while ( !p_UDP->parsePacket()  ) //Have we received anything?
-			{
-				if ( retries >= 5 )
-				{
-					sendMessage(PSTR("No response from NIST server: ") + getNISTServer(), PRIORITY_HIGH );
-					return false;
-				}
-				delay(500); // wait a bit
-				retries++;
-			}
-			
-			p_UDP->read(NTPBuffer, NTP_PACKET_SIZE); // read the packet into the buffer
-			uint32_t NTPTime = (NTPBuffer[40] << 24) | (NTPBuffer[41] << 16) | (NTPBuffer[42] << 8) | NTPBuffer[43]; // Combine the 4 timestamp bytes into one 32-bit number
-			// Convert NTP time to a UNIX timestamp:
-			p_currentTime->SetNTPTime( NTPTime - 2208988800UL );
+			if ( force )
+				timeSync.cancel(); //start over with the current server settings
+
+			sendMessage( PSTR("Updating time." ) );
+			return timeSync.begin( getNISTServer(), NTP_PORT ); //the reply is handled by updateClock()
 		}
-		
-		p_nextNISTUpdateTime->SetTime( p_currentTime.get() ); //Replace with current time
-		p_nextNISTUpdateTime->IncrementTime( i_NISTupdateFreq, i_NISTUpdateUnit );//Then increment -- need to rework this a bit
-		
-		return true; //End here, we'll let the system clock carry on on the next second.
 	}
 	return false; //default path
 }
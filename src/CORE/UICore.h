@@ -15,33 +15,83 @@
 #include <memory>
 
 #include "GlobalDefs.h"
-#include "../web/data_fields.h" //depends on settings.h --must come afterwards
+#include "../WEB/data_fields.h" //depends on settings.h --must come afterwards
 #include "Time.h"
+#include "TimeSync.h"
+#include "HeapStats.h"
 
 using namespace std;
 
 #ifndef UICore_H_
 #define UICore_H_
 
+class SlotStorage;
+struct Log_Download;
+
 #define MAX_MESSAGE_HISTORY_SIZE 3072 //total number of characters allowed to be stored in WEB UI alerts history (before a client has read them). 3KB seems like enough?
 
+#define SCRIPT_EDITOR_MAX 16384 //largest logic script (bytes) that is also loaded into RAM for the script page editor. Larger scripts are uploaded as a file.
+
+#define SETTINGS_RECORD_MAGIC 0x32474643 //"CFG2"
+#define SETTINGS_RECORD_VERSION 1
+#define SETTINGS_HEADER_SIZE 6 //magic (4) + version (1) + number of fields (1)
+
+//Identifies each setting in the binary settings record. These are stored in flash, so existing values must never be renumbered (only appended to).
+//The settings table is built in this order, so an ID is also the setting's index in the table (ID - 1).
+enum SETTING_ID : uint8_t
+{
+	SETTING_DEV_ID = 1,
+	SETTING_DEV_SERIAL_V,
+	SETTING_BT_EN,
+	SETTING_BT_PWD,
+	SETTING_UI_UNAME,
+	SETTING_UI_PWD,
+	SETTING_NET_AP_EN,
+	SETTING_NET_STA_RETRY,
+	SETTING_NET_STA_RETRY_COUNT,
+	SETTING_NET_STA_RETRY_TIMEOUT,
+	SETTING_NET_AP_SSID,
+	SETTING_NET_STA_SSID,
+	SETTING_NET_AP_PWD,
+	SETTING_NET_STA_PWD,
+	SETTING_NET_HOSTNAME,
+	SETTING_DNS_EN,
+	SETTING_DNS_HOSTNAME,
+	SETTING_PLC_NETMODE,
+	SETTING_PLC_BROADCAST_PORT,
+	SETTING_PLC_RETAIN_INTERVAL,
+	SETTING_TIME_EN,
+	SETTING_TIME_SERVER,
+	SETTING_TIME_PORT,
+	SETTING_TIME_UPD_FREQ,
+	SETTING_PLC_DUAL_CORE,
+	SETTING_PLC_SCAN_BUDGET,
+	SETTING_PLC_SCAN_OVERRUNS,
+	SETTING_PLC_SCAN_POLICY
+};
+
 class Device_Setting
 {
 	public:
-	Device_Setting( bool *ptr  ){ i_Type = OBJ_TYPE::TYPE_VAR_BOOL; data.b_Ptr = ptr; }
-	Device_Setting( uint8_t *ptr  ){ i_Type = OBJ_TYPE::TYPE_VAR_UBYTE; data.ui8_Ptr = ptr; }
-	Device_Setting( uint16_t *ptr  ){ i_Type = OBJ_TYPE::TYPE_VAR_USHORT; data.ui16_Ptr = ptr; }
-	Device_Setting( uint_fast32_t *ptr  ){ i_Type = OBJ_TYPE::TYPE_VAR_UINT; data.ui_Ptr = ptr; }
-	Device_Setting( String *ptr  ){ i_Type = OBJ_TYPE::TYPE_VAR_STRING; data.s_Ptr = ptr; }
-	Device_Setting( shared_ptr<String> ptr ){ i_Type = OBJ_TYPE::TYPE_VAR_STRING; data.s_Ptr = ptr.get(); }
-	virtual ~Device_Setting(){} //destructor
+	Device_Setting( const char *name, bool *ptr  ){ s_name = name; i_Type = OBJ_TYPE::TYPE_VAR_BOOL; data.b_Ptr = ptr; }
+	Device_Setting( const char *name, uint8_t *ptr  ){ s_name = name; i_Type = OBJ_TYPE::TYPE_VAR_UBYTE; data.ui8_Ptr = ptr; }
+	Device_Setting( const char *name, uint16_t *ptr  ){ s_name = name; i_Type = OBJ_TYPE::TYPE_VAR_USHORT; data.ui16_Ptr = ptr; }
+	Device_Setting( const char *name, uint_fast32_t *ptr  ){ s_name = name; i_Type = OBJ_TYPE::TYPE_VAR_UINT; data.ui_Ptr = ptr; }
+	Device_Setting( const char *name, String *ptr  ){ s_name = name; i_Type = OBJ_TYPE::TYPE_VAR_STRING; data.s_Ptr = ptr; }
+	Device_Setting( const char *name, shared_ptr<String> ptr ){ s_name = name; i_Type = OBJ_TYPE::TYPE_VAR_STRING; data.s_Ptr = ptr.get(); }
 
 	OBJ_TYPE getType(){ return i_Type; }
+	//Returns the name used for the setting in the text format (serial commands, older settings files).
+	const char *getName(){ return s_name; }
 
 	//This function converts a string to the proper value and stores it into the appropriate variable
 	void setSettingValue( const String & );
 	//Returns the current value of the setting stored in the object.
 	String getSettingValue();
+	//Appends the value to a binary settings record, as its length followed by the raw bytes. Arg: <Setting ID>
+	void writeRecord( vector<uint8_t> &, uint8_t );
+	//Stores a value read from a binary settings record. Integers are converted if the stored size differs from the current one. Args: <Data>, <Length>
+	void readRecord( const uint8_t *, uint8_t );
 
 	uint8_t &getUINT8(){ return *data.ui8_Ptr; }
 	uint_fast32_t &getUINT(){ return *data.ui_Ptr; }
@@ -59,6 +109,7 @@ class Device_Setting
 		uint_fast32_t *ui_Ptr;
 	} data;
 
+	const char *s_name;
 	OBJ_TYPE i_Type; //stored the field type, because we can't cast
 };
 
@@ -101,7 +152,13 @@ public:
 
 		i_plc_netmode = 0;
 		i_plc_broadcast_port = 5000;
+		i_plc_retain_interval = 10; //seconds
+		b_plc_dual_core = false;
+		i_plc_scan_budget = 0; //disabled
+		i_plc_scan_overruns = 3;
+		i_plc_scan_policy = 0; //log only
 		//
+		generateSettingsTable(); //all settings pointers are valid from here on
 	}
 	~UICore()
 	{
@@ -131,10 +188,16 @@ public:
 	void parseCfg( const vector<String> & );
 	//Creates a vector of IP addresses based on delimiter(s) from a given String
 	vector<IPAddress> parseIPAddress( const String &, const vector<char> &  ); 
-	//Fills the settings map used for interpreting settings storage/reading to/from SPIFFS (flash file system).
-	void generateSettingsMap(); 
-	//Allows the memory used by the map to be freed after parsing/storing, etc (optimization).
-	void clearSettingsMap(); 
+	//Fills the settings table used for settings storage/reading to/from SPIFFS (flash file system). Built once, in SETTING_ID order.
+	void generateSettingsTable(); 
+	//Returns the setting with the given (text) name, or null if there is none.
+	Device_Setting *findSetting( const String & );
+	//Serializes all settings into a binary settings record.
+	void encodeSettings( vector<uint8_t> & );
+	//Applies the values in a binary settings record. Fields with an unknown ID are skipped. Returns false if the record is not valid.
+	bool decodeSettings( const uint8_t *, size_t );
+	//Loads a text settings file written by older firmware, saves it as a binary record and removes the text file.
+	bool migrateSettings(); 
 	
 	//This basically functions as our main loop function for the Core UI.
 	void Process(); 
@@ -153,6 +216,12 @@ public:
 	void sendMessage( const String &, uint8_t = PRIORITY_LOW ); 
 	//Used to display current network connection information over serial (USB), as well as other device statistics and statuses.
 	void printDiag(); 
+	//Used to display the PLC tasks over serial (USB), with the timing statistics of each one.
+	void printTaskStats();
+	//Prints the scan watchdog state and the timing of the last overrun. Arg 'reset' releases held outputs and clears a fault.
+	void parseWatchdog( const vector<String> & );
+	//Dumps the event trace, or with an argument, enables ('on', 'rungs') or disables ('off') it.
+	void parseTrace( const vector<String> & );
 	
 	//This generates the index page HTML, which functions as a "main menu" for the web UI.
 	void handleIndex(); 
@@ -174,6 +243,14 @@ public:
 	void sendStyleSheet(); 
 	//Sends ystem alerts and other info over the web interface.
 	void handleAlerts();
+	//Starts streaming the samples saved by a logger object, as CSV or as the raw blocks. Args: id=<Logger ID>, fmt=csv|bin
+	void handleLogDownload();
+	//Sends the next few blocks of the log download in progress, if any. Called on each pass of the main loop.
+	void continueLogDownload();
+	//Sends the event trace ring as a binary dump, see Trace.h.
+	void handleTraceDownload();
+	//Sends the heap use of each subsystem and the history of the device totals as CSV.
+	void handleHeapStats();
 
 	void resestFieldContainers();
 
@@ -215,10 +292,18 @@ public:
 	static void applyDeviceSettings(); 
 	//This function handles the application of OTA (over the air) firmware updates via the Web UI
 	static void applyRemoteFirmwareUpdate();
+	//Streams an uploaded logic script into the unused script slot as it arrives, then parses it from there. The script only replaces the saved one if it parses.
+	static void applyScriptUpload();
+	//Streams an uploaded logic script into the unused script slot, then checks it without touching the running program. A script without errors waits there to be committed.
+	static void applyScriptCheck();
+	//Responds once a script upload (or check) is complete.
+	void handleScriptUpload();
+	//Applies the script that passed the last check.
+	void handleScriptCommit();
 
 	//Determines if a NIST server check should be performed.
 	bool CheckUpdateNIST(); 
-	//Performs the NIST update operation.
+	//Starts the NIST update operation. The update itself is performed in the background by updateClock().
 	bool UpdateNIST( bool = false ); 
 
 	//Saves the device settings (wifi, time, etc.)
@@ -233,8 +318,10 @@ public:
 	//arg(s) <bool> : load from storage
 	void applySettings( bool = false ); 
 	
-	//Loads the default logic script for the PLC system from the flash file system.
+	//Loads the default logic script for the PLC system from the flash file system, for the script page editor. Scripts over SCRIPT_EDITOR_MAX bytes are left in flash.
 	bool loadPLCScript( String & ); 
+	//Opens the saved logic script for reading, so it can be parsed straight from the flash file system.
+	bool openPLCScript( File & );
 	//Loads a custom stylesheet (CSS) for web the based UI from the flash file system.
 	String loadWebStylesheet(); 
 
@@ -251,13 +338,28 @@ public:
 	String &getLoginName(){ return *s_authenName.get(); }
 	String &getLoginPWD(){ return *s_authenPWD.get(); }
 	String &getBTPWD(){ return *s_BTPWD.get(); }
+	uint16_t getRetainInterval(){ return i_plc_retain_interval; }
+	bool getDualCoreScan(){ return b_plc_dual_core; }
+	uint16_t getScanBudget(){ return i_plc_scan_budget; }
+	uint8_t getScanOverrunLimit(){ return i_plc_scan_overruns; }
+	uint8_t getScanOverrunPolicy(){ return i_plc_scan_policy; }
 	//
 
+	//Returns true if the flash file system was opened successfully.
+	bool isFSOpen(){ return b_FSOpen; }
+
 	shared_ptr<Time> getSystemTimeObj(){ return p_currentTime; }
 	WebServer &getWebServer(){ return *p_server.get(); }
 	WiFiUDP &getTimeUDP(){ return *p_UDP.get(); }
 
 private:
+	//Writes each piece of an uploaded script into the unused script slot. Returns the slots once the whole script has been written and verified, otherwise null.
+	shared_ptr<SlotStorage> receiveScriptUpload();
+	//Parses an uploaded script from its slot, and makes it the saved script if it parses. Otherwise the saved script is parsed again.
+	bool applyUploadedScript( shared_ptr<SlotStorage> );
+	//Generates a form that uploads a script file. Args: <Route>, <Table title>, <Button label>, <Index of the first field>
+	String generateScriptUploadForm( const String &, const String &, const String &, uint8_t );
+
 	//Acts as storage for the data tables for the WEB UI for all pages.
 	vector <shared_ptr<DataTable>> p_UIDataTables; 
 	vector <shared_ptr<DataTable>> p_StaticDataTables; 
@@ -276,13 +378,15 @@ private:
 	//System Clock objects
 	shared_ptr<Time> p_currentTime;
 	shared_ptr<Time> p_nextNISTUpdateTime; //Used to store the time for next NIST update.
+	Time_Sync timeSync; //Non-blocking NTP client, stepped once per loop.
+	Heap_Monitor heapMonitor; //History of the free heap and the largest free block.
 	uint8_t i_nistMode; //Daylight vs NTP protocol
 	shared_ptr<String> s_NISTServer;
-	unsigned int i_NISTPort;
+	uint_fast32_t i_NISTPort;
 	//
 	
 	//NIST time variables
-	unsigned int i_NISTupdateFreq; //frequency of NIST time update
+	uint_fast32_t i_NISTupdateFreq; //frequency of NIST time update
 	uint8_t i_NISTUpdateUnit; //Unit of time for frequency between updates.
 	bool b_enableNIST; //Enable time server update mode?
 	//
@@ -304,6 +408,11 @@ private:
 	//External PLC devices settings
 	uint8_t i_plc_netmode;
 	uint16_t i_plc_broadcast_port;
+	uint16_t i_plc_retain_interval; //minimum time between writes of retentive values to flash (seconds)
+	bool b_plc_dual_core; //process independent rungs on both cores, applied when the next script is loaded
+	uint16_t i_plc_scan_budget; //scan watchdog time budget (uS), 0 disables the watchdog
+	uint8_t i_plc_scan_overruns, //scans in a row over the budget before the overrun policy is applied
+			i_plc_scan_policy; //WATCHDOG_POLICY
 	//
 
 	//File system related variables
@@ -311,6 +420,9 @@ private:
 	bool b_SaveScript; //used for saving the current PLC script to the file system
 	bool b_SaveConfig; //Used for saving the chosen device configuration
 	bool b_SaveStyleSheet; //Used for saving the CSS file for the web based UI
+	shared_ptr<SlotStorage> p_scriptUpload; //slots of the script being uploaded, between the start and end of the upload
+	shared_ptr<Log_Download> p_logDownload; //log download in progress, sent in pieces by continueLogDownload()
+	shared_ptr<SlotStorage> p_checkedScript; //slots holding a script that passed a check, until it is committed
 	//
 
 	//Web Style Sheet variables
@@ -327,8 +439,7 @@ private:
 	vector<String> alerts; //vestor that stores alerts that have yet to be forwarded to a web client.
 
 	//Settings storage/reading variables
-	std::map<String, shared_ptr<Device_Setting>> settingsMap;
-	std::map<String, shared_ptr<Device_Setting>>::iterator settings_itr;
+	vector<Device_Setting> settings; //indexed by SETTING_ID - 1
 	//
 };
 
@@ -33,6 +33,7 @@
 #include <PLC/PLC_Parser.h>
 #include <PLC/PLC_Rung.h>
 #include <CORE/UICore.h>
+#include <CORE/Trace.h>
 #include <esp_timer.h>
 #include <HardwareSerial.h>
 #include "Arduino.h"
@@ -46,6 +47,7 @@
 #include "./PLC/OBJECTS/obj_counter.h"
 //
 
+Trace_Buffer EventTrace; //Ring of timestamped events, recorded by the scan, IO, network and parser. Declared first, as the other objects may record events.
 PLC_Main PLCObj; //PLC ladder logic processing object. 
 UICore Core; //UI object init -- for web and serial interfaces, as well as settings storage, etc.
 
@@ -55,8 +57,13 @@ void setup()
 	millis(); //HACK HACK - calling this here seems to prevent millis() from crashing the device when a timer is used (weird bug). - DO NOT REMOVE
 	Serial.begin(9600); //open the serial port 
 	Core.setup(); //Initialize all core UI stuff. Should always be before the PLC_Main object is initialized (script is parsed), because certain settings in the FS should be loaded first.
-	Core.loadPLCScript(PLCObj.getScript()); //load the script from the flash file system, 
-	PLCObj.parseScript(PLCObj.getScript()); //Parses the PLC logic script given above (testing).
+	File scriptFile;
+	if ( Core.openPLCScript(scriptFile) ) //Parses the PLC logic script straight from the flash file system, so its size isn't limited by the free heap
+	{
+		PLCObj.parseScript(scriptFile);
+		scriptFile.close();
+	}
+	Core.loadPLCScript(PLCObj.getScript()); //RAM copy for the script page editor, small scripts only
 }
 
 
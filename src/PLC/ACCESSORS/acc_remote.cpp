@@ -1,4 +1,5 @@
 #include "acc_remote.h"
+#include "../../CORE/Trace.h"
 
 const String PROGMEM &connection = PSTR("Connection to: ");
 
@@ -15,7 +16,8 @@ PLC_Remote_Client::PLC_Remote_Client( const String &id, const IPAddress &addr, u
     setState(true); //default to enabled -- maybe make a new ENUM for states tat can be used across all object types... TODO
 
     i_nextUpdate = millis();
-
+    i_replyLimit = REMOTE_REPLY_RESERVE;
+    s_reply.reserve(i_replyLimit);
 
     if( nodeClient.connect(getHostAddress(), getHostPort(), i_timeout) )
         b_enabled = true;
@@ -29,27 +31,10 @@ PLC_Remote_Client::PLC_Remote_Client( const String &id, const IPAddress &addr, u
     //getObjectVARs().emplace_back(make_shared<Ladder_VAR>(&i_updateFreq, "UPFREQ")); //currently unused 
 }
 
-String PLC_Remote_Client::requestFromHost(const vector<String> &cmdVector)
-{
-    String cmd;
-    for ( uint16_t x = 0; x < cmdVector.size(); x++ )
-    {
-        if (!x)
-            cmd += cmdVector[x];
-        else
-        {
-            cmd += CHAR_UPDATE_RECORD + cmdVector[x];
-        }
-        
-    }
-
-    return requestFromHost(cmd);
-}
-
-String PLC_Remote_Client::requestFromHost(const String &cmd)
+bool PLC_Remote_Client::exchange( const String &request )
 {
-    String recvdData;
     uint8_t retries = 0;
+    s_reply = ""; //keeps the buffer
 
     if( !nodeClient.connected() && b_enabled )
     {
@@ -70,53 +55,86 @@ String PLC_Remote_Client::requestFromHost(const String &cmd)
     if( nodeClient.connected() )
     {
         uint32_t storedTime = millis();
+        int64_t requestTime = esp_timer_get_time();
+        bool overlong = false;
+        EventTrace.recordAt( TRACE_REMOTE_REQUEST, getHostAddress()[3], request.length(), requestTime );
         nodeClient.setNoDelay(true); //Send immediately (don't wait for significant packet size unless epcifically told to do so)
-        nodeClient.setTimeout(i_timeout); 
-        nodeClient.print(cmd + CHAR_TRANSMIT_END); //send some message
+        nodeClient.write( reinterpret_cast<const uint8_t *>(request.c_str()), request.length() ); //send some message
         nodeClient.flush();
-        //Wait to receive a reply...
-
-        while( !nodeClient.available() && ((millis() - storedTime) < i_timeout) ){} //loop until the conditions are met
-
-        if ( nodeClient.available() ) //Did we receive anything for realz?
+        
+        //Read the reply a byte at a time into the kept buffer, until the end char or the timeout.
+        while ( (millis() - storedTime) < i_timeout )
         {
-            recvdData += nodeClient.readStringUntil(CHAR_TRANSMIT_END); //just remove these now
-            Core.sendMessage(recvdData);
-            Core.sendMessage( PSTR("TX Bytes: ") + String(cmd.length() + 1) + PSTR(" RX Bytes: ") + String(recvdData.length()) + PSTR(" Latency: ") + String(millis() - storedTime) + " RSSI: " + WiFi.RSSI() + "dBm" ); //some stat
-            //Should also tell number of bytes sent/received.
+            int c = nodeClient.read();
+            if ( c < 0 )
+            {
+                if ( !nodeClient.connected() && !nodeClient.available() ) //host closed the connection
+                    break;
+                continue;
+            }
+            if ( c == CHAR_TRANSMIT_END )
+                break;
+            if ( s_reply.length() >= i_replyLimit ) //longer than any valid reply, don't grow the buffer in the scan
+            {
+                s_reply = "";
+                overlong = true;
+                break;
+            }
+            s_reply += static_cast<char>(c);
         }
 
-        if (!recvdData.length())
+        EventTrace.record( TRACE_REMOTE_RESPONSE, getHostAddress()[3], s_reply.length() ? esp_timer_get_time() - requestTime : 0 );
+        if ( s_reply.length() )
+        {
+            #ifdef DEBUG_REMOTE
+            Core.sendMessage(s_reply);
+            Core.sendMessage( PSTR("TX Bytes: ") + String(request.length()) + PSTR(" RX Bytes: ") + String(s_reply.length()) + PSTR(" Latency: ") + String(millis() - storedTime) + " RSSI: " + WiFi.RSSI() + "dBm" ); //some stat
+            #endif
+        }
+        else if ( overlong )
+            Core.sendMessage( PSTR("Reply from host at: ") + getHostAddress().toString() + PSTR(" is too long, dropped.") );
+        else
             Core.sendMessage( PSTR("No valid response from host at: ") + getHostAddress().toString() );
 
     }
     nodeClient.stop();
     
-    
-    return recvdData;
+    return s_reply.length();
+}
+
+void PLC_Remote_Client::buildUpdateRequest()
+{
+    s_updateRequest = CMD_REQUEST_UPDATE;
+    for ( uint16_t x = 0; x < getObjectVARs().size(); x++ )
+    {
+        if ( x )
+            s_updateRequest += CHAR_UPDATE_RECORD; //split the requested object ID's up by the record char
+        s_updateRequest += getObjectVARs()[x]->getID();
+    }
+    s_updateRequest += CHAR_QUERY_END;
+    s_updateRequest += CHAR_TRANSMIT_END;
+
+    //Reply: <CMD_SEND_UPDATE>, then <ID><CHAR_UPDATE_RECORD><VALUE><CHAR_UPDATE_GROUP> per object, then <CHAR_QUERY_END>
+    uint32_t limit = 2;
+    for ( uint16_t x = 0; x < getObjectVARs().size(); x++ )
+        limit += getObjectVARs()[x]->getID().length() + REMOTE_REPLY_VALUE_MAX + 2;
+
+    i_replyLimit = min( max( limit, static_cast<uint32_t>(REMOTE_REPLY_RESERVE) ), static_cast<uint32_t>(UINT16_MAX) );
+    s_reply.reserve(i_replyLimit);
 }
 
 void PLC_Remote_Client::updateObject()
 {
+    Heap_Scope heapScope(HEAP_TAG_REMOTE);
     if (!checkNetworkConnection() || !b_enabled )
         return; //end here if failed.
 
     if ( millis() > i_nextUpdate ) //time to update?
     {
-        uint16_t numObjects = getObjectVARs().size();
-        if ( numObjects ) //must have some objects initialized in order to reqest updates.
+        if ( getObjectVARs().size() ) //must have some objects initialized in order to reqest updates.
         {
-            String newRequest(CMD_REQUEST_UPDATE); //init with update request
-            for ( uint16_t x = 0; x < numObjects; x++ )
-            {
-                if ( x == numObjects )
-                    newRequest += getObjectVARs()[x]->getID();
-                else
-                    newRequest += getObjectVARs()[x]->getID() + CHAR_UPDATE_RECORD; //split the requested object ID's up by the record char
-            }
-            newRequest += CHAR_QUERY_END;
-
-            handleUpdates(requestFromHost(newRequest));
+            if ( exchange(s_updateRequest) )
+                handleUpdates(s_reply);
         }
         
         //Perform update logic here -- where all the magic happens
@@ -149,7 +167,13 @@ shared_ptr<Ladder_OBJ_Logical> PLC_Remote_Client::findAccessorVarByID( const Str
     if ( !accObj ) //guess not, so we'll poll the remote host for it and initialize it as necessary.
     {
         //Request to initialize from the host
-        accObj = handleInit(requestFromHost(CMD_REQUEST_INIT + id + CHAR_QUERY_END));
+        String request = CMD_REQUEST_INIT + id;
+        request += CHAR_QUERY_END;
+        request += CHAR_TRANSMIT_END;
+        if ( exchange(request) )
+            accObj = handleInit(s_reply);
+        if ( accObj )
+            buildUpdateRequest();
     }
 
     return accObj;
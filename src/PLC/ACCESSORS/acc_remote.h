@@ -4,6 +4,9 @@
 #include "../PLC_IO.h"
 #include "../PLC_Main.h"
 
+#define REMOTE_REPLY_RESERVE 128 //initial size of the reply buffer, enough for the replies to init requests
+#define REMOTE_REPLY_VALUE_MAX 24 //longest value expected in an update reply (a 64 bit integer, or a float with its decimals)
+
 //the PLC_Remote_Client class represents another ESP32 device that processes its own ladder logic operations, and shares data between the current device and itself, thereby enabling tethering/cluster operations
 class PLC_Remote_Client : public Ladder_OBJ_Accessor
 {
@@ -24,23 +27,30 @@ class PLC_Remote_Client : public Ladder_OBJ_Accessor
 	virtual shared_ptr<Ladder_OBJ_Logical> findAccessorVarByID( const String & );
 	//Returns the stored IP address pertaining to the remote host.
 	const IPAddress &getHostAddress(){ return ip_hostAddress; }
-	//Send a specific update request command to the host device, and returns the data String that is received.
-    String requestFromHost(const vector<String> &);
-	String requestFromHost( const String &);
+	//Rebuilds the update request sent on every update, from the remote objects initialized so far, and reserves the reply buffer for the longest
+	//valid reply to it. Called when an object is added (while the script is parsed).
+	void buildUpdateRequest();
 	//Returns the port that the remote update server is accepting requests on.
 	const uint16_t getHostPort(){ return i_hostPort; }
 	//Performs a simple check to make sure that we are still capable of talking to a remote host.
 	bool checkNetworkConnection();
 
 	private: 
+	//Sends a request (already ending with CHAR_TRANSMIT_END) and reads the reply into s_reply. Returns true if a reply was received.
+	//A reply longer than the reserved buffer is dropped rather than growing it.
+	bool exchange( const String & );
+
 	uint32_t i_timeout;
     uint32_t i_nextUpdate,
              i_updateFreq;
-	uint16_t i_hostPort;
+	uint16_t i_hostPort,
+			 i_replyLimit; //longest reply accepted (bytes), the size reserved for s_reply
 	uint8_t i_numRetries;
 
 	WiFiClient nodeClient;
 	IPAddress ip_hostAddress; //This is the address for the remote server.
+	String s_updateRequest, //built once the objects are known, so the periodic update doesn't allocate
+		   s_reply; //keeps its buffer between updates, only grows when a reply is longer than any before it
 
 	bool b_enabled;
 };
@@ -0,0 +1,295 @@
+/* The purpose of this file is to hold the function definitions related to the ArrayBlockOBJ Ladder Object.
+*/
+#include "obj_math_array.h"
+#include <string.h>
+#include <numeric>
+#include <type_traits>
+
+//Copies (and converts) a run of elements between two differently typed arrays.
+template <typename S, typename D>
+static void convertRange( const S *src, D *dest, uint32_t length )
+{
+    for ( uint32_t x = 0; x < length; x++ )
+        dest[x] = static_cast<D>(src[x]);
+}
+
+ArrayBlockOBJ::ArrayBlockOBJ(const String &id, OBJ_TYPE type, shared_ptr<Ladder_Array> src, uint32_t srcStart, shared_ptr<Ladder_Array> dest, uint32_t destStart,
+                             uint32_t length, shared_ptr<Ladder_VAR> value, shared_ptr<Ladder_VAR> result ) : Ladder_OBJ_Logical(id, type)
+{
+    source = src;
+    destination = dest;
+    i_srcStart = srcStart;
+    i_destStart = destStart;
+    i_length = length;
+    valueVar = value;
+    resultVar = result;
+
+    if ( valueVar )
+        getObjectVARs().emplace_back(valueVar);
+
+    if ( type == OBJ_TYPE::TYPE_MATH_COP || type == OBJ_TYPE::TYPE_MATH_FILL ) //these write into the destination array, so need no DEST
+        return;
+
+    if ( !resultVar ) //no destination variable given, so create one for later reference by other objects.
+    {
+        OBJ_TYPE elementType = source->getElementType();
+        if ( type == OBJ_TYPE::TYPE_MATH_AVG || elementType == OBJ_TYPE::TYPE_VAR_FLOAT )
+            resultVar = make_shared<Ladder_VAR>( static_cast<double>(0), bitTagDEST );
+        else if ( type != OBJ_TYPE::TYPE_MATH_FIND && ( elementType == OBJ_TYPE::TYPE_VAR_UINT || elementType == OBJ_TYPE::TYPE_VAR_ULONG ) )
+            resultVar = make_shared<Ladder_VAR>( static_cast<uint64_t>(0), bitTagDEST );
+        else //FIND index, or signed integers
+            resultVar = make_shared<Ladder_VAR>( static_cast<int64_t>(0), bitTagDEST );
+    }
+    getObjectVARs().emplace_back(resultVar);
+}
+
+void ArrayBlockOBJ::getDependencies( vector<Ladder_Dependency> &deps )
+{
+    Ladder_OBJ_Logical::getDependencies(deps);
+    if ( source )
+        source->getDependencies(deps);
+    if ( destination )
+        destination->getDependencies(deps);
+}
+
+void ArrayBlockOBJ::setLineState(bool &state, bool bNot)
+{
+    if (state) //must have a HIGH state before computing.
+    {
+        switch ( getType() )
+        {
+            case OBJ_TYPE::TYPE_MATH_COP:
+            {
+                computeCOP();
+            }
+            break;
+            case OBJ_TYPE::TYPE_MATH_FILL:
+            {
+                computeFILL();
+            }
+            break;
+            case OBJ_TYPE::TYPE_MATH_FIND:
+            {
+                state = computeFIND();
+            }
+            break;
+            default:
+            {
+                computeReduce();
+            }
+            break;
+        }
+    }
+    Ladder_OBJ_Logical::setLineState(state, bNot);
+}
+
+void ArrayBlockOBJ::computeCOP()
+{
+    OBJ_TYPE srcType = source->getElementType();
+    if ( srcType == destination->getElementType() ) //same storage layout, so this is a straight block move (the ranges may overlap within one array)
+    {
+        uint8_t size = Ladder_Array::getElementSize(srcType);
+        memmove( destination->getData<uint8_t>() + i_destStart * size, source->getData<uint8_t>() + i_srcStart * size, i_length * size );
+        return;
+    }
+
+    switch ( srcType )
+    {
+        case OBJ_TYPE::TYPE_VAR_INT:
+            copyFrom( source->getData<int_fast32_t>() + i_srcStart );
+            break;
+        case OBJ_TYPE::TYPE_VAR_UINT:
+            copyFrom( source->getData<uint_fast32_t>() + i_srcStart );
+            break;
+        case OBJ_TYPE::TYPE_VAR_LONG:
+            copyFrom( source->getData<int64_t>() + i_srcStart );
+            break;
+        case OBJ_TYPE::TYPE_VAR_ULONG:
+            copyFrom( source->getData<uint64_t>() + i_srcStart );
+            break;
+        case OBJ_TYPE::TYPE_VAR_FLOAT:
+            copyFrom( source->getData<double>() + i_srcStart );
+            break;
+        case OBJ_TYPE::TYPE_VAR_BOOL:
+            copyFrom( source->getData<bool>() + i_srcStart );
+            break;
+        default:
+            break;
+    }
+}
+
+template <typename S>
+void ArrayBlockOBJ::copyFrom( const S *src )
+{
+    switch ( destination->getElementType() )
+    {
+        case OBJ_TYPE::TYPE_VAR_INT:
+            convertRange( src, destination->getData<int_fast32_t>() + i_destStart, i_length );
+            break;
+        case OBJ_TYPE::TYPE_VAR_UINT:
+            convertRange( src, destination->getData<uint_fast32_t>() + i_destStart, i_length );
+            break;
+        case OBJ_TYPE::TYPE_VAR_LONG:
+            convertRange( src, destination->getData<int64_t>() + i_destStart, i_length );
+            break;
+        case OBJ_TYPE::TYPE_VAR_ULONG:
+            convertRange( src, destination->getData<uint64_t>() + i_destStart, i_length );
+            break;
+        case OBJ_TYPE::TYPE_VAR_FLOAT:
+            convertRange( src, destination->getData<double>() + i_destStart, i_length );
+            break;
+        case OBJ_TYPE::TYPE_VAR_BOOL:
+            convertRange( src, destination->getData<bool>() + i_destStart, i_length );
+            break;
+        default:
+            break;
+    }
+}
+
+void ArrayBlockOBJ::computeFILL()
+{
+    switch ( destination->getElementType() ) //the value is converted once, outside of the loop
+    {
+        case OBJ_TYPE::TYPE_VAR_INT:
+        {
+            int_fast32_t *data = destination->getData<int_fast32_t>() + i_destStart;
+            fill( data, data + i_length, valueVar->getValue<int_fast32_t>() );
+        }
+        break;
+        case OBJ_TYPE::TYPE_VAR_UINT:
+        {
+            uint_fast32_t *data = destination->getData<uint_fast32_t>() + i_destStart;
+            fill( data, data + i_length, valueVar->getValue<uint_fast32_t>() );
+        }
+        break;
+        case OBJ_TYPE::TYPE_VAR_LONG:
+        {
+            int64_t *data = destination->getData<int64_t>() + i_destStart;
+            fill( data, data + i_length, valueVar->getValue<int64_t>() );
+        }
+        break;
+        case OBJ_TYPE::TYPE_VAR_ULONG:
+        {
+            uint64_t *data = destination->getData<uint64_t>() + i_destStart;
+            fill( data, data + i_length, valueVar->getValue<uint64_t>() );
+        }
+        break;
+        case OBJ_TYPE::TYPE_VAR_FLOAT:
+        {
+            double *data = destination->getData<double>() + i_destStart;
+            fill( data, data + i_length, valueVar->getValue<double>() );
+        }
+        break;
+        case OBJ_TYPE::TYPE_VAR_BOOL:
+        {
+            bool *data = destination->getData<bool>() + i_destStart;
+            fill( data, data + i_length, valueVar->getValue<bool>() );
+        }
+        break;
+        default:
+        break;
+    }
+}
+
+bool ArrayBlockOBJ::computeFIND()
+{
+    switch ( source->getElementType() )
+    {
+        case OBJ_TYPE::TYPE_VAR_INT:
+            return findIn( source->getData<int_fast32_t>() );
+        case OBJ_TYPE::TYPE_VAR_UINT:
+            return findIn( source->getData<uint_fast32_t>() );
+        case OBJ_TYPE::TYPE_VAR_LONG:
+            return findIn( source->getData<int64_t>() );
+        case OBJ_TYPE::TYPE_VAR_ULONG:
+            return findIn( source->getData<uint64_t>() );
+        case OBJ_TYPE::TYPE_VAR_FLOAT:
+            return findIn( source->getData<double>() );
+        case OBJ_TYPE::TYPE_VAR_BOOL:
+            return findIn( source->getData<bool>() );
+        default:
+            break;
+    }
+
+    return false;
+}
+
+template <typename T>
+bool ArrayBlockOBJ::findIn( T *data )
+{
+    T *start = data + i_srcStart, *end = start + i_length;
+    T *found = find( start, end, valueVar->getValue<T>() );
+
+    if ( found == end )
+    {
+        resultVar->setValue( static_cast<int64_t>(-1) );
+        return false;
+    }
+
+    resultVar->setValue( static_cast<int64_t>(found - data) ); //index within the whole array, so it can be used directly as an element ID
+    return true;
+}
+
+void ArrayBlockOBJ::computeReduce()
+{
+    switch ( source->getElementType() )
+    {
+        case OBJ_TYPE::TYPE_VAR_INT:
+            reduce( source->getData<int_fast32_t>() + i_srcStart );
+            break;
+        case OBJ_TYPE::TYPE_VAR_UINT:
+            reduce( source->getData<uint_fast32_t>() + i_srcStart );
+            break;
+        case OBJ_TYPE::TYPE_VAR_LONG:
+            reduce( source->getData<int64_t>() + i_srcStart );
+            break;
+        case OBJ_TYPE::TYPE_VAR_ULONG:
+            reduce( source->getData<uint64_t>() + i_srcStart );
+            break;
+        case OBJ_TYPE::TYPE_VAR_FLOAT:
+            reduce( source->getData<double>() + i_srcStart );
+            break;
+        case OBJ_TYPE::TYPE_VAR_BOOL:
+            reduce( source->getData<bool>() + i_srcStart );
+            break;
+        default:
+            break;
+    }
+}
+
+template <typename T>
+void ArrayBlockOBJ::reduce( const T *data )
+{
+    const T *end = data + i_length; //length is always at least 1, checked at creation
+
+    switch ( getType() )
+    {
+        case OBJ_TYPE::TYPE_MATH_SUM:
+        {
+            if ( is_floating_point<T>::value )
+                resultVar->setValue( accumulate( data, end, static_cast<double>(0) ) );
+            else if ( is_unsigned<T>::value )
+                resultVar->setValue( accumulate( data, end, static_cast<uint64_t>(0) ) );
+            else
+                resultVar->setValue( accumulate( data, end, static_cast<int64_t>(0) ) );
+        }
+        break;
+        case OBJ_TYPE::TYPE_MATH_AVG:
+        {
+            resultVar->setValue( accumulate( data, end, static_cast<double>(0) ) / i_length );
+        }
+        break;
+        case OBJ_TYPE::TYPE_MATH_MIN:
+        {
+            resultVar->setValue( *min_element( data, end ) );
+        }
+        break;
+        case OBJ_TYPE::TYPE_MATH_MAX:
+        {
+            resultVar->setValue( *max_element( data, end ) );
+        }
+        break;
+        default:
+        break;
+    }
+}
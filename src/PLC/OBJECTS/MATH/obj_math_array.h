@@ -0,0 +1,50 @@
+#ifndef PLC_IO_OBJ_MATH_ARRAY
+#define PLC_IO_OBJ_MATH_ARRAY
+
+#include <vector>
+#include <memory>
+#include "PLC/PLC_IO.h"
+#include "CORE/GlobalDefs.h"
+#include "PLC/OBJECTS/obj_var.h"
+#include "PLC/OBJECTS/obj_array.h"
+
+//Bulk array operations block. Operations are COP (copy a range into another array), FILL (write one value to a range), FIND (search a range for a value),
+//and SUM, AVG, MIN, MAX (reduce a range to a single value). Ranges are checked against the array lengths when the block is created, so the scan never
+//checks bounds. The element types are resolved once per execution, then each operation runs as a tight loop over the raw storage.
+//FIND passes the line state only when the value was found. DEST holds the index of the found element (-1 if not found), or the result of a reduction.
+class ArrayBlockOBJ : public Ladder_OBJ_Logical
+{
+	public:
+	ArrayBlockOBJ(const String &id, OBJ_TYPE type, shared_ptr<Ladder_Array> src, uint32_t srcStart, shared_ptr<Ladder_Array> dest, uint32_t destStart,
+				  uint32_t length, shared_ptr<Ladder_VAR> value = 0, shared_ptr<Ladder_VAR> result = 0 );
+	~ArrayBlockOBJ(){}
+
+	virtual void setLineState(bool &, bool);
+	virtual void updateObject(){}
+	//Adds the source and destination arrays, which are read and written while the rung is processed.
+	virtual void getDependencies( vector<Ladder_Dependency> & );
+
+	//Copies the source range into the destination range, converting element types if they differ.
+	void computeCOP();
+	//Writes the value into every element of the destination range.
+	void computeFILL();
+	//Returns true if the value exists in the source range. DEST is set to the index of the first match, or -1.
+	bool computeFIND();
+	//Reduces the source range into DEST based on the block type (SUM, AVG, MIN, MAX).
+	void computeReduce();
+
+	private:
+	//Second half of the COP type dispatch, once the source type is known.
+	template <typename S>
+	void copyFrom( const S * );
+	template <typename T>
+	bool findIn( T * );
+	template <typename T>
+	void reduce( const T * );
+
+	shared_ptr<Ladder_Array> source, destination;
+	shared_ptr<Ladder_VAR> valueVar, resultVar;
+	uint32_t i_srcStart, i_destStart, i_length;
+};
+
+#endif /* PLC_IO_OBJ_MATH_ARRAY */
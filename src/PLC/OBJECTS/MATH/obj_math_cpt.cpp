@@ -0,0 +1,445 @@
+/* The purpose of this file is to hold the function definitions related to the ComputeBlockOBJ Ladder Object, including the expression compiler.
+*/
+#include "obj_math_cpt.h"
+
+//Supported function names, with the opcode and number of arguments for each.
+struct CPT_Function
+{
+	const char *name;
+	uint8_t i_op, i_numArgs;
+};
+
+static const CPT_Function cptFunctions[] =
+{
+	{ "ABS", ComputeBlockOBJ::OP_ABS, 1 },
+	{ "SQRT", ComputeBlockOBJ::OP_SQRT, 1 },
+	{ "SIN", ComputeBlockOBJ::OP_SIN, 1 },
+	{ "COS", ComputeBlockOBJ::OP_COS, 1 },
+	{ "TAN", ComputeBlockOBJ::OP_TAN, 1 },
+	{ "ASIN", ComputeBlockOBJ::OP_ASIN, 1 },
+	{ "ACOS", ComputeBlockOBJ::OP_ACOS, 1 },
+	{ "ATAN", ComputeBlockOBJ::OP_ATAN, 1 },
+	{ "LN", ComputeBlockOBJ::OP_LN, 1 },
+	{ "LOG", ComputeBlockOBJ::OP_LOG, 1 },
+	{ "EXP", ComputeBlockOBJ::OP_EXP, 1 },
+	{ "FLOOR", ComputeBlockOBJ::OP_FLOOR, 1 },
+	{ "CEIL", ComputeBlockOBJ::OP_CEIL, 1 },
+	{ "ROUND", ComputeBlockOBJ::OP_ROUND, 1 },
+	{ "MIN", ComputeBlockOBJ::OP_MIN, 2 },
+	{ "MAX", ComputeBlockOBJ::OP_MAX, 2 }
+};
+
+//Recursive descent compiler, turns the infix expression into a postfix (stack) program. Only exists while compile() runs.
+//expr := sum (('<'|'>'|'<='|'>='|'='|'=='|'!='|'<>') sum)? | sum := term (('+'|'-') term)* | term := unary (('*'|'/'|'%') unary)* | unary := '-' unary | power | power := primary ('^' unary)?
+//primary := number | name | function '(' expr (',' expr)* ')' | '(' expr ')'
+struct CPT_Compiler
+{
+	CPT_Compiler( ComputeBlockOBJ &obj, const String &str, function<shared_ptr<Ladder_VAR>(const String &)> &func ) : block(obj), expr(str), resolver(func)
+	{
+		i_pos = 0;
+		i_depth = 0;
+	}
+
+	bool fail( const String &msg )
+	{
+		if ( !block.s_compileError.length() ) //keep the first (innermost) error
+			block.s_compileError = msg + PSTR(" at position ") + String(i_pos + 1);
+		return false;
+	}
+
+	char peek(){ return i_pos < expr.length() ? expr[i_pos] : 0; }
+
+	bool emit( uint8_t op, uint8_t arg = 0 )
+	{
+		if ( op <= ComputeBlockOBJ::OP_LOAD_BOOL ) //loads push a value
+		{
+			if ( ++i_depth > CPT_MAX_STACK )
+				return fail(PSTR("Expression too complex"));
+			if ( i_depth > block.i_stackSize )
+				block.i_stackSize = i_depth;
+		}
+		else if ( op <= ComputeBlockOBJ::OP_MAX ) //binary operations pop two values, push one
+			i_depth--;
+
+		ComputeBlockOBJ::CPT_Instruction ins = { op, arg };
+		block.program.push_back(ins);
+		return true;
+	}
+
+	bool parseExpr()
+	{
+		if ( !parseSum() )
+			return false;
+
+		uint8_t op, length = 2; //only the second characters listed in the grammar belong to the operator, anything else is left for parseSum() to reject
+		char c = peek(), next = i_pos + 1U < expr.length() ? expr[i_pos + 1] : 0;
+		if ( c == '<' && next == '>' ) op = ComputeBlockOBJ::OP_NE;
+		else if ( c == '<' && next == '=' ) op = ComputeBlockOBJ::OP_LE;
+		else if ( c == '>' && next == '=' ) op = ComputeBlockOBJ::OP_GE;
+		else if ( c == '=' && next == '=' ) op = ComputeBlockOBJ::OP_EQ;
+		else if ( c == '!' && next == '=' ) op = ComputeBlockOBJ::OP_NE;
+		else
+		{
+			length = 1;
+			if ( c == '<' ) op = ComputeBlockOBJ::OP_LT;
+			else if ( c == '>' ) op = ComputeBlockOBJ::OP_GT;
+			else if ( c == '=' ) op = ComputeBlockOBJ::OP_EQ;
+			else
+				return true; //no comparison
+		}
+
+		i_pos += length;
+		return parseSum() && emit(op);
+	}
+
+	bool parseSum()
+	{
+		if ( !parseTerm() )
+			return false;
+
+		while ( peek() == '+' || peek() == '-' )
+		{
+			uint8_t op = ( expr[i_pos++] == '+' ) ? ComputeBlockOBJ::OP_ADD : ComputeBlockOBJ::OP_SUB;
+			if ( !parseTerm() || !emit(op) )
+				return false;
+		}
+		return true;
+	}
+
+	bool parseTerm()
+	{
+		if ( !parseUnary() )
+			return false;
+
+		while ( peek() == '*' || peek() == '/' || peek() == '%' )
+		{
+			char c = expr[i_pos++];
+			uint8_t op = ( c == '*' ) ? ComputeBlockOBJ::OP_MUL : ( c == '/' ) ? ComputeBlockOBJ::OP_DIV : ComputeBlockOBJ::OP_MOD;
+			if ( !parseUnary() || !emit(op) )
+				return false;
+		}
+		return true;
+	}
+
+	bool parseUnary()
+	{
+		if ( peek() == '-' )
+		{
+			i_pos++;
+			return parseUnary() && emit(ComputeBlockOBJ::OP_NEG);
+		}
+		if ( peek() == '+' )
+		{
+			i_pos++;
+			return parseUnary();
+		}
+		return parsePower();
+	}
+
+	bool parsePower()
+	{
+		if ( !parsePrimary() )
+			return false;
+
+		if ( peek() == '^' ) //right associative, 2^3^2 = 2^9
+		{
+			i_pos++;
+			return parseUnary() && emit(ComputeBlockOBJ::OP_POW);
+		}
+		return true;
+	}
+
+	bool parsePrimary()
+	{
+		char c = peek();
+		if ( c == CHAR_P_START )
+		{
+			i_pos++;
+			if ( !parseExpr() )
+				return false;
+			if ( peek() != CHAR_P_END )
+				return fail(PSTR("Missing )"));
+			i_pos++;
+			return true;
+		}
+		if ( isdigit(c) || c == '.' )
+			return parseNumber();
+		if ( isalpha(c) || c == '_' )
+			return parseName();
+		if ( !c )
+			return fail(PSTR("Unexpected end of expression"));
+
+		return fail(PSTR("Unexpected character '") + String(c) + "'");
+	}
+
+	bool parseNumber()
+	{
+		uint16_t start = i_pos;
+		bool isFloat = false;
+		while ( isdigit(peek()) || peek() == '.' )
+		{
+			if ( peek() == '.' )
+				isFloat = true;
+			i_pos++;
+		}
+		if ( peek() == 'E' ) //exponent, EX: 1.5E3
+		{
+			isFloat = true;
+			i_pos++;
+			if ( peek() == '-' || peek() == '+' )
+				i_pos++;
+			while ( isdigit(peek()) )
+				i_pos++;
+		}
+
+		String str = expr.substring(start, i_pos);
+		double value = atof(str.c_str());
+		for ( uint16_t x = 0; x < block.constants.size(); x++ ) //reuse a matching constant
+		{
+			if ( block.constants[x] == value )
+				return emit(ComputeBlockOBJ::OP_CONST, x);
+		}
+		if ( block.constants.size() >= CPT_MAX_OPERANDS )
+			return fail(PSTR("Too many constants"));
+
+		if ( isFloat )
+			block.b_integer = false; //a fractional constant forces floating point math
+		block.constants.push_back(value);
+		return emit(ComputeBlockOBJ::OP_CONST, block.constants.size() - 1);
+	}
+
+	bool parseName()
+	{
+		uint16_t start = i_pos;
+		while ( isalnum(peek()) || peek() == '_' || peek() == CHAR_VAR_OPERATOR || peek() == CHAR_ACCESSOR_OPERATOR )
+			i_pos++;
+
+		String name = expr.substring(start, i_pos);
+		if ( peek() == CHAR_P_START ) //function call
+			return parseFunction(name);
+
+		shared_ptr<Ladder_VAR> var = resolver(name);
+		if ( !var || !var->getValuePtr() )
+			return fail(PSTR("Unknown variable ") + name);
+
+		uint8_t op;
+		switch ( var->getType() )
+		{
+			case OBJ_TYPE::TYPE_VAR_INT: op = ComputeBlockOBJ::OP_LOAD_INT; break;
+			case OBJ_TYPE::TYPE_VAR_UINT: op = ComputeBlockOBJ::OP_LOAD_UINT; break;
+			case OBJ_TYPE::TYPE_VAR_USHORT: op = ComputeBlockOBJ::OP_LOAD_USHORT; break;
+			case OBJ_TYPE::TYPE_VAR_LONG: op = ComputeBlockOBJ::OP_LOAD_LONG; break;
+			case OBJ_TYPE::TYPE_VAR_ULONG: op = ComputeBlockOBJ::OP_LOAD_ULONG; break;
+			case OBJ_TYPE::TYPE_VAR_BOOL: op = ComputeBlockOBJ::OP_LOAD_BOOL; break;
+			default: op = ComputeBlockOBJ::OP_LOAD_FLOAT; block.b_integer = false; break;
+		}
+
+		const void *ptr = var->getValuePtr();
+		for ( uint16_t x = 0; x < block.operands.size(); x++ ) //same variable referenced more than once
+		{
+			if ( block.operands[x] == ptr )
+				return emit(op, x);
+		}
+		if ( block.operands.size() >= CPT_MAX_OPERANDS )
+			return fail(PSTR("Too many variables"));
+
+		block.operands.push_back(ptr);
+		block.sources.push_back(var);
+		return emit(op, block.operands.size() - 1);
+	}
+
+	bool parseFunction( const String &name )
+	{
+		const CPT_Function *func = 0;
+		for ( uint8_t x = 0; x < sizeof(cptFunctions) / sizeof(CPT_Function); x++ )
+		{
+			if ( name == cptFunctions[x].name )
+				func = &cptFunctions[x];
+		}
+		if ( !func )
+			return fail(PSTR("Unknown function ") + name);
+
+		i_pos++; //skip (
+		for ( uint8_t x = 0; x < func->i_numArgs; x++ )
+		{
+			if ( x && peek() != CHAR_COMMA )
+				return fail(PSTR("Too few arguments for ") + name);
+			if ( x )
+				i_pos++;
+			if ( !parseExpr() )
+				return false;
+		}
+		if ( peek() != CHAR_P_END )
+			return fail(PSTR("Missing ) for ") + name);
+		i_pos++;
+
+		if ( func->i_op != ComputeBlockOBJ::OP_ABS && func->i_op != ComputeBlockOBJ::OP_MIN && func->i_op != ComputeBlockOBJ::OP_MAX )
+			block.b_integer = false; //everything else works on fractions
+		return emit(func->i_op);
+	}
+
+	ComputeBlockOBJ &block;
+	const String &expr;
+	function<shared_ptr<Ladder_VAR>(const String &)> &resolver;
+	uint16_t i_pos;
+	uint8_t i_depth;
+};
+
+bool ComputeBlockOBJ::compile( const String &expr, function<shared_ptr<Ladder_VAR>(const String &)> resolver )
+{
+	program.clear();
+	operands.clear();
+	sources.clear();
+	constants.clear();
+	intConstants.clear();
+	s_compileError.clear();
+	i_stackSize = 0;
+	b_integer = true; //until something requires floating point
+
+	CPT_Compiler compiler(*this, expr, resolver);
+	if ( !compiler.parseExpr() )
+		return false;
+	if ( compiler.i_pos < expr.length() )
+		return compiler.fail(PSTR("Unexpected character '") + String(expr[compiler.i_pos]) + "'");
+
+	for ( uint16_t x = 0; x < program.size() && b_integer; x++ )
+	{
+		if ( program[x].i_op == OP_DIV || program[x].i_op == OP_POW )
+			b_integer = false;
+	}
+	if ( b_integer )
+	{
+		for ( uint16_t x = 0; x < constants.size(); x++ )
+			intConstants.push_back( static_cast<int64_t>(constants[x]) );
+	}
+
+	program.shrink_to_fit();
+	operands.shrink_to_fit();
+	constants.shrink_to_fit();
+
+	if ( !destination ) //no destination object given so create one for later reference by other objects.
+	{
+		if ( b_integer )
+			destination = make_shared<Ladder_VAR>( static_cast<int64_t>(0), bitTagDEST );
+		else
+			destination = make_shared<Ladder_VAR>( static_cast<double>(0), bitTagDEST );
+	}
+	getObjectVARs().emplace_back(destination);
+
+	#ifdef DEBUG
+	Serial.println(PSTR("CPT compiled. Instructions: ") + String(program.size()) + PSTR(" Stack: ") + String(i_stackSize) + ( b_integer ? PSTR(" (integer)") : PSTR(" (float)") ));
+	#endif
+	return true;
+}
+
+static inline double cptMod( double a, double b ){ return fmod(a, b); }
+static inline int64_t cptMod( int64_t a, int64_t b ){ return a % b; }
+
+template <typename T>
+bool ComputeBlockOBJ::execute( T &result )
+{
+	T stack[CPT_MAX_STACK];
+	uint8_t sp = 0;
+	const CPT_Instruction *ins = program.data(), *end = ins + program.size();
+
+	for ( ; ins < end; ins++ )
+	{
+		switch ( ins->i_op )
+		{
+			case OP_CONST: stack[sp++] = getConstant(ins->i_arg, T()); break;
+			case OP_LOAD_INT: stack[sp++] = static_cast<T>(*static_cast<const int_fast32_t *>(operands[ins->i_arg])); break;
+			case OP_LOAD_UINT: stack[sp++] = static_cast<T>(*static_cast<const uint_fast32_t *>(operands[ins->i_arg])); break;
+			case OP_LOAD_USHORT: stack[sp++] = static_cast<T>(*static_cast<const uint16_t *>(operands[ins->i_arg])); break;
+			case OP_LOAD_LONG: stack[sp++] = static_cast<T>(*static_cast<const int64_t *>(operands[ins->i_arg])); break;
+			case OP_LOAD_ULONG: stack[sp++] = static_cast<T>(*static_cast<const uint64_t *>(operands[ins->i_arg])); break;
+			case OP_LOAD_FLOAT: stack[sp++] = static_cast<T>(*static_cast<const double *>(operands[ins->i_arg])); break;
+			case OP_LOAD_BOOL: stack[sp++] = static_cast<T>(*static_cast<const bool *>(operands[ins->i_arg])); break;
+			case OP_ADD: sp--; stack[sp - 1] += stack[sp]; break;
+			case OP_SUB: sp--; stack[sp - 1] -= stack[sp]; break;
+			case OP_MUL: sp--; stack[sp - 1] *= stack[sp]; break;
+			case OP_DIV:
+				sp--;
+				if ( stack[sp] == 0 ) //cannot divide by zero
+					return false;
+				stack[sp - 1] /= stack[sp];
+				break;
+			case OP_MOD:
+				sp--;
+				if ( stack[sp] == 0 )
+					return false;
+				stack[sp - 1] = cptMod(stack[sp - 1], stack[sp]);
+				break;
+			case OP_POW: sp--; stack[sp - 1] = pow(stack[sp - 1], stack[sp]); break;
+			case OP_LT: sp--; stack[sp - 1] = stack[sp - 1] < stack[sp]; break;
+			case OP_GT: sp--; stack[sp - 1] = stack[sp - 1] > stack[sp]; break;
+			case OP_LE: sp--; stack[sp - 1] = stack[sp - 1] <= stack[sp]; break;
+			case OP_GE: sp--; stack[sp - 1] = stack[sp - 1] >= stack[sp]; break;
+			case OP_EQ: sp--; stack[sp - 1] = stack[sp - 1] == stack[sp]; break;
+			case OP_NE: sp--; stack[sp - 1] = stack[sp - 1] != stack[sp]; break;
+			case OP_MIN: sp--; if ( stack[sp] < stack[sp - 1] ) stack[sp - 1] = stack[sp]; break;
+			case OP_MAX: sp--; if ( stack[sp] > stack[sp - 1] ) stack[sp - 1] = stack[sp]; break;
+			case OP_NEG: stack[sp - 1] = -stack[sp - 1]; break;
+			case OP_ABS: if ( stack[sp - 1] < 0 ) stack[sp - 1] = -stack[sp - 1]; break;
+			case OP_SQRT: stack[sp - 1] = sqrt(stack[sp - 1]); break;
+			case OP_SIN: stack[sp - 1] = sin(stack[sp - 1]); break;
+			case OP_COS: stack[sp - 1] = cos(stack[sp - 1]); break;
+			case OP_TAN: stack[sp - 1] = tan(stack[sp - 1]); break;
+			case OP_ASIN: stack[sp - 1] = asin(stack[sp - 1]); break;
+			case OP_ACOS: stack[sp - 1] = acos(stack[sp - 1]); break;
+			case OP_ATAN: stack[sp - 1] = atan(stack[sp - 1]); break;
+			case OP_LN: stack[sp - 1] = log(stack[sp - 1]); break;
+			case OP_LOG: stack[sp - 1] = log10(stack[sp - 1]); break;
+			case OP_EXP: stack[sp - 1] = exp(stack[sp - 1]); break;
+			case OP_FLOOR: stack[sp - 1] = floor(stack[sp - 1]); break;
+			case OP_CEIL: stack[sp - 1] = ceil(stack[sp - 1]); break;
+			case OP_ROUND: stack[sp - 1] = round(stack[sp - 1]); break;
+			default: break;
+		}
+	}
+
+	result = stack[0];
+	return true;
+}
+
+void ComputeBlockOBJ::compute()
+{
+	if ( b_integer )
+	{
+		int64_t result;
+		if ( execute(result) )
+			destination->setValue(result);
+	}
+	else
+	{
+		double result;
+		if ( execute(result) )
+			destination->setValue(result);
+	}
+}
+
+bool ComputeBlockOBJ::evaluate()
+{
+	if ( b_integer )
+	{
+		int64_t result;
+		return execute(result) && result != 0;
+	}
+
+	double result;
+	return execute(result) && result != 0;
+}
+
+void ComputeBlockOBJ::getDependencies( vector<Ladder_Dependency> &deps )
+{
+	Ladder_OBJ_Logical::getDependencies(deps);
+	for ( uint8_t x = 0; x < sources.size(); x++ )
+		sources[x]->getDependencies(deps);
+}
+
+void ComputeBlockOBJ::setLineState(bool &state, bool bNot)
+{
+	if ( state && program.size() ) //must have a HIGH state before computing.
+		compute();
+
+	Ladder_OBJ_Logical::setLineState(state, bNot);
+}
@@ -0,0 +1,83 @@
+#ifndef PLC_IO_OBJ_MATH_CPT
+#define PLC_IO_OBJ_MATH_CPT
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include "PLC/PLC_IO.h"
+#include "CORE/GlobalDefs.h"
+#include "PLC/OBJECTS/obj_var.h"
+#include <math.h>
+
+#define CPT_MAX_STACK 16 //maximum evaluation depth of a compiled expression
+#define CPT_MAX_OPERANDS 255 //maximum number of distinct variables or constants in a single expression
+
+//Compute block. Evaluates an infix expression over variables, object bits and constants, then stores the result in DEST.
+//EX: C1[CPT,TANK.DEST,(LVL.EU-OFFSET)*2.5/AREA+SQRT(FLOW)]
+//Operators are + - * / % ^ (power) and unary -. A comparison (< > <= >= = != <>) may join two sums and results in 1 or 0. Functions are ABS, SQRT, SIN, COS, TAN, ASIN, ACOS, ATAN, LN, LOG, EXP, FLOOR, CEIL, ROUND, MIN(A,B), MAX(A,B).
+//The expression is compiled once when the script is loaded into a small stack program. Each variable load is resolved to its storage type at that time,
+//so the scan reads values directly without any lookups. If every operand is an integer and no operator needs fractions (/ ^ or most functions), the program
+//runs in 64-bit integer math, otherwise in double precision. A division by zero leaves DEST unchanged, the same as a DIV block.
+class ComputeBlockOBJ : public Ladder_OBJ_Logical
+{
+	friend struct CPT_Compiler;
+
+	public:
+	ComputeBlockOBJ(const String &id, shared_ptr<Ladder_VAR> dest = 0, OBJ_TYPE type = OBJ_TYPE::TYPE_MATH_CPT ) : Ladder_OBJ_Logical(id, type)
+	{
+		destination = dest;
+		i_stackSize = 0;
+		b_integer = false;
+	}
+	~ComputeBlockOBJ(){}
+
+	virtual void setLineState(bool &, bool);
+	virtual void updateObject(){}
+	//Adds the variables referenced by the expression, along with DEST.
+	virtual void getDependencies( vector<Ladder_Dependency> & );
+
+	//Compiles the inputted expression. Variable names are looked up with the inputted function. Returns false if the expression is invalid (see getCompileError()).
+	bool compile( const String &, function<shared_ptr<Ladder_VAR>(const String &)> );
+	//Returns a description of the problem found by the last call to compile().
+	const String &getCompileError(){ return s_compileError; }
+	//Evaluates the compiled expression and stores the result in DEST.
+	void compute();
+	//Evaluates the compiled expression without storing it, returns true if the result is nonzero. Used for conditions, where * and + act as AND and OR on bits.
+	bool evaluate();
+	//Returns true if the expression is evaluated in integer math.
+	bool usesInteger(){ return b_integer; }
+
+	//Program opcodes. Loads are listed first, then binary operations, then unary operations (the compiler relies on this order).
+	enum CPT_OP : uint8_t
+	{
+		OP_CONST,
+		OP_LOAD_INT, OP_LOAD_UINT, OP_LOAD_USHORT, OP_LOAD_LONG, OP_LOAD_ULONG, OP_LOAD_FLOAT, OP_LOAD_BOOL,
+		OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD, OP_POW, OP_LT, OP_GT, OP_LE, OP_GE, OP_EQ, OP_NE, OP_MIN, OP_MAX, //binary
+		OP_NEG, OP_ABS, OP_SQRT, OP_SIN, OP_COS, OP_TAN, OP_ASIN, OP_ACOS, OP_ATAN, OP_LN, OP_LOG, OP_EXP, OP_FLOOR, OP_CEIL, OP_ROUND //unary
+	};
+
+	private:
+	struct CPT_Instruction
+	{
+		uint8_t i_op, //CPT_OP
+				i_arg; //operand or constant index for loads
+	};
+
+	//Runs the program, returns false if a division by zero occurred.
+	template <typename T>
+	bool execute( T & );
+	double getConstant( uint8_t index, double ){ return constants[index]; }
+	int64_t getConstant( uint8_t index, int64_t ){ return intConstants[index]; }
+
+	vector<CPT_Instruction> program;
+	vector<const void *> operands; //value addresses of the referenced variables
+	vector<shared_ptr<Ladder_VAR>> sources; //keeps the referenced variables alive
+	vector<double> constants;
+	vector<int64_t> intConstants; //integer copies of the constants, only used in integer mode
+	shared_ptr<Ladder_VAR> destination;
+	String s_compileError;
+	uint8_t i_stackSize;
+	bool b_integer;
+};
+
+#endif /* PLC_IO_OBJ_MATH_CPT */
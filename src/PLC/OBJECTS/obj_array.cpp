@@ -0,0 +1,148 @@
+#include "obj_array.h"
+
+//////////////////////////////////////////////////////////////////////////
+// ARRAY OBJECT BEGIN
+//////////////////////////////////////////////////////////////////////////
+Ladder_Array::Ladder_Array( const String &id, OBJ_TYPE elementType, uint32_t length, OBJ_TYPE type ) : Ladder_OBJ_Logical(id, type)
+{
+	i_elementType = elementType;
+	i_length = length;
+	storage.resize( ( static_cast<uint64_t>(length) * getElementSize(elementType) + sizeof(uint64_t) - 1 ) / sizeof(uint64_t), 0 ); //zero filled
+
+	getObjectVARs().emplace_back( make_shared<Ladder_VAR>( static_cast<uint_fast32_t>(length), bitTagLEN ) ); //a copy, writing to LEN can't change the bounds
+}
+
+uint8_t Ladder_Array::getElementSize( OBJ_TYPE type )
+{
+	switch( type )
+	{
+		case OBJ_TYPE::TYPE_VAR_INT:
+			return sizeof(int_fast32_t);
+		case OBJ_TYPE::TYPE_VAR_UINT:
+			return sizeof(uint_fast32_t);
+		case OBJ_TYPE::TYPE_VAR_LONG:
+			return sizeof(int64_t);
+		case OBJ_TYPE::TYPE_VAR_ULONG:
+			return sizeof(uint64_t);
+		case OBJ_TYPE::TYPE_VAR_FLOAT:
+			return sizeof(double);
+		case OBJ_TYPE::TYPE_VAR_BOOL:
+			return sizeof(bool);
+		default:
+			break;
+	}
+
+	return 0; //not a type that can be stored in an array
+}
+
+OBJ_TYPE Ladder_Array::getStorageType( OBJ_TYPE type )
+{
+	if ( type == OBJ_TYPE::TYPE_VAR_UBYTE || type == OBJ_TYPE::TYPE_VAR_USHORT )
+		return OBJ_TYPE::TYPE_VAR_UINT;
+
+	return getElementSize(type) ? type : OBJ_TYPE::TYPE_INVALID;
+}
+
+void Ladder_Array::setElement( uint32_t index, Ladder_VAR &var )
+{
+	switch( getElementType() )
+	{
+		case OBJ_TYPE::TYPE_VAR_INT:
+			getData<int_fast32_t>()[index] = var.getValue<int_fast32_t>();
+			break;
+		case OBJ_TYPE::TYPE_VAR_UINT:
+			getData<uint_fast32_t>()[index] = var.getValue<uint_fast32_t>();
+			break;
+		case OBJ_TYPE::TYPE_VAR_LONG:
+			getData<int64_t>()[index] = var.getValue<int64_t>();
+			break;
+		case OBJ_TYPE::TYPE_VAR_ULONG:
+			getData<uint64_t>()[index] = var.getValue<uint64_t>();
+			break;
+		case OBJ_TYPE::TYPE_VAR_FLOAT:
+			getData<double>()[index] = var.getValue<double>();
+			break;
+		case OBJ_TYPE::TYPE_VAR_BOOL:
+			getData<bool>()[index] = var.getValue<bool>();
+			break;
+		default:
+			break;
+	}
+}
+
+void Ladder_Array::getElement( uint32_t index, Ladder_VAR &var )
+{
+	switch( getElementType() )
+	{
+		case OBJ_TYPE::TYPE_VAR_INT:
+			var.setValue( getData<int_fast32_t>()[index] );
+			break;
+		case OBJ_TYPE::TYPE_VAR_UINT:
+			var.setValue( getData<uint_fast32_t>()[index] );
+			break;
+		case OBJ_TYPE::TYPE_VAR_LONG:
+			var.setValue( getData<int64_t>()[index] );
+			break;
+		case OBJ_TYPE::TYPE_VAR_ULONG:
+			var.setValue( getData<uint64_t>()[index] );
+			break;
+		case OBJ_TYPE::TYPE_VAR_FLOAT:
+			var.setValue( getData<double>()[index] );
+			break;
+		case OBJ_TYPE::TYPE_VAR_BOOL:
+			var.setValue( getData<bool>()[index] );
+			break;
+		default:
+			break;
+	}
+}
+
+void Ladder_Array::getDependencies( vector<Ladder_Dependency> &deps )
+{
+	Ladder_OBJ_Logical::getDependencies(deps);
+	const uint8_t *data = reinterpret_cast<const uint8_t *>(storage.data());
+	deps.push_back( { data, data + storage.size() * sizeof(uint64_t) } );
+}
+
+shared_ptr<Ladder_VAR> Ladder_Array::getObjectVAR( const String &id )
+{
+	shared_ptr<Ladder_VAR> var = Ladder_OBJ_Logical::getObjectVAR(id); //LEN, or an element that has been referenced before
+	if ( var || strDataType(id) != 1 ) //element IDs must be plain integers
+		return var;
+
+	int64_t index = parseInt(id);
+	if ( index < 0 || index >= i_length ) //out of bounds, the caller reports the invalid object
+		return 0;
+
+	String elementID = String(static_cast<uint32_t>(index)); //normalize the ID, so "03" and "3" share a variable
+	var = Ladder_OBJ_Logical::getObjectVAR(elementID);
+	if ( var )
+		return var;
+
+	switch( getElementType() ) //element variables point directly into the storage block
+	{
+		case OBJ_TYPE::TYPE_VAR_INT:
+			var = make_shared<Ladder_VAR>( getData<int_fast32_t>() + index, elementID );
+			break;
+		case OBJ_TYPE::TYPE_VAR_UINT:
+			var = make_shared<Ladder_VAR>( getData<uint_fast32_t>() + index, elementID );
+			break;
+		case OBJ_TYPE::TYPE_VAR_LONG:
+			var = make_shared<Ladder_VAR>( getData<int64_t>() + index, elementID );
+			break;
+		case OBJ_TYPE::TYPE_VAR_ULONG:
+			var = make_shared<Ladder_VAR>( getData<uint64_t>() + index, elementID );
+			break;
+		case OBJ_TYPE::TYPE_VAR_FLOAT:
+			var = make_shared<Ladder_VAR>( getData<double>() + index, elementID );
+			break;
+		case OBJ_TYPE::TYPE_VAR_BOOL:
+			var = make_shared<Ladder_VAR>( getData<bool>() + index, elementID );
+			break;
+		default:
+			return 0;
+	}
+
+	getObjectVARs().emplace_back(var);
+	return var;
+}
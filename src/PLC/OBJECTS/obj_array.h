@@ -0,0 +1,78 @@
+#ifndef PLC_IO_OBJ_ARRAY
+#define PLC_IO_OBJ_ARRAY
+
+#include "../PLC_IO.h"
+#include "obj_var.h"
+#include <algorithm>
+
+#define ARRAY_MAX_LENGTH 4096 //maximum number of elements in a single array, keeps a typo in the script from eating the heap
+
+//Array objects store a fixed number of elements of a single variable type in one contiguous block of memory, so recipes, trend windows and lookup tables
+//don't require a separate variable for every value. The storage is allocated once when the array is created and is never resized.
+//Individual elements are accessed with the var operator (ARR.0, ARR.1, etc.) anywhere a variable may be used. Element variables point into the array storage.
+//Bits that are accessible from an array: LEN (number of elements), 0..LEN-1 (elements)
+class Ladder_Array : public Ladder_OBJ_Logical
+{
+	public:
+	//elementType must be one of TYPE_VAR_INT, TYPE_VAR_UINT, TYPE_VAR_LONG, TYPE_VAR_ULONG, TYPE_VAR_FLOAT, or TYPE_VAR_BOOL
+	Ladder_Array( const String &id, OBJ_TYPE elementType, uint32_t length, OBJ_TYPE type = OBJ_TYPE::TYPE_VAR_ARRAY );
+	~Ladder_Array(){}
+
+	virtual shared_ptr<Ladder_VAR> getObjectVAR( const String & );
+	//Adds the array and its whole storage, which every element variable points into.
+	virtual void getDependencies( vector<Ladder_Dependency> & );
+
+	//Returns the number of elements stored in the array.
+	uint32_t getLength(){ return i_length; }
+	//Returns the variable type of the elements stored in the array.
+	OBJ_TYPE getElementType(){ return i_elementType; }
+	//Returns the size (in bytes) of a single element for the given variable type, or 0 if the type can't be stored in an array.
+	static uint8_t getElementSize( OBJ_TYPE );
+	//Returns the element type that can hold values of the given variable type (EX: TYPE_VAR_USHORT is stored as TYPE_VAR_UINT), or TYPE_INVALID.
+	static OBJ_TYPE getStorageType( OBJ_TYPE );
+
+	//Returns a pointer to the first element of the array. T must match the element type.
+	template <typename T>
+	T *getData(){ return reinterpret_cast<T *>(storage.data()); }
+
+	//Stores the value of the inputted variable into the element at the given index, converted to the element type. No bounds checking is done.
+	void setElement( uint32_t, Ladder_VAR & );
+	//Stores the value of the element at the given index into the inputted variable. No bounds checking is done.
+	void getElement( uint32_t, Ladder_VAR & );
+
+	//Sets every element in the array to the given value, converted to the element type.
+	template <typename T>
+	void setAll( const T val )
+	{
+		switch( getElementType() )
+		{
+			case OBJ_TYPE::TYPE_VAR_INT:
+				fill( getData<int_fast32_t>(), getData<int_fast32_t>() + i_length, static_cast<int_fast32_t>(val) );
+				break;
+			case OBJ_TYPE::TYPE_VAR_UINT:
+				fill( getData<uint_fast32_t>(), getData<uint_fast32_t>() + i_length, static_cast<uint_fast32_t>(val) );
+				break;
+			case OBJ_TYPE::TYPE_VAR_LONG:
+				fill( getData<int64_t>(), getData<int64_t>() + i_length, static_cast<int64_t>(val) );
+				break;
+			case OBJ_TYPE::TYPE_VAR_ULONG:
+				fill( getData<uint64_t>(), getData<uint64_t>() + i_length, static_cast<uint64_t>(val) );
+				break;
+			case OBJ_TYPE::TYPE_VAR_FLOAT:
+				fill( getData<double>(), getData<double>() + i_length, static_cast<double>(val) );
+				break;
+			case OBJ_TYPE::TYPE_VAR_BOOL:
+				fill( getData<bool>(), getData<bool>() + i_length, static_cast<bool>(val) );
+				break;
+			default:
+				break;
+		}
+	}
+
+	private:
+	OBJ_TYPE i_elementType;
+	uint32_t i_length;
+	vector<uint64_t> storage; //raw element storage, 64-bit words keep every element type aligned
+};
+
+#endif
@@ -0,0 +1,196 @@
+#include "obj_hscounter.h"
+#include <esp_timer.h>
+#include <soc/pcnt_struct.h>
+
+//////////////////////////////////////////////////////////////////////////
+// HIGH SPEED COUNTER OBJECT BEGIN
+//////////////////////////////////////////////////////////////////////////
+HSCounterOBJ::HSCounterOBJ(const String &id, pcnt_unit_t unit, uint8_t pin, int8_t ctrl_pin, int_fast32_t preset, int_fast32_t accum, OBJ_TYPE type, uint8_t mode, uint16_t filter, bool attach) : Ladder_OBJ_Logical(id, type)
+{
+	b_attached = attach;
+	iUnit = unit;
+	iPin = pin;
+	iCtrlPin = ctrl_pin;
+	iPreset = preset;
+	iAccum = accum;
+	iOverflowCount = 0;
+	iLastCount = 0;
+	iLastTotal = 0;
+	iRateCount = 0;
+	iRateTime = esp_timer_get_time();
+	dRate = 0;
+	doneBit = false;
+	enableBit = false;
+	overflowBit = false;
+	underflowBit = false;
+	countMux = portMUX_INITIALIZER_UNLOCKED;
+
+	pcnt_config_t pcnt_conf;
+	pcnt_conf.pulse_gpio_num = pin;
+	pcnt_conf.ctrl_gpio_num = ctrl_pin;
+	pcnt_conf.channel = PCNT_CHANNEL_0;
+	pcnt_conf.unit = unit;
+	pcnt_conf.counter_h_lim = HSC_LIMIT;
+	pcnt_conf.counter_l_lim = -HSC_LIMIT;
+	pcnt_conf.hctrl_mode = PCNT_MODE_KEEP;
+	pcnt_conf.lctrl_mode = PCNT_MODE_KEEP;
+	pcnt_conf.neg_mode = PCNT_COUNT_DIS;
+
+	if ( mode == HSC_MODE_QUAD ) //A = pulse pin, B = control pin. Count both edges of A, direction follows the level of B.
+	{
+		pcnt_conf.pos_mode = PCNT_COUNT_DEC;
+		pcnt_conf.neg_mode = PCNT_COUNT_INC;
+		pcnt_conf.lctrl_mode = PCNT_MODE_REVERSE;
+	}
+	else if ( mode == HSC_MODE_DOWN )
+		pcnt_conf.pos_mode = PCNT_COUNT_DEC;
+	else
+		pcnt_conf.pos_mode = PCNT_COUNT_INC;
+
+	if ( !attach ) //the unit may be in use by the running program
+	{
+		b_hwReady = true;
+		return;
+	}
+
+	b_hwReady = ( pcnt_unit_config(&pcnt_conf) == ESP_OK );
+
+	if ( b_hwReady )
+	{
+		if ( filter )
+		{
+			pcnt_set_filter_value(iUnit, filter > 1023 ? 1023 : filter);
+			pcnt_filter_enable(iUnit);
+		}
+		else
+			pcnt_filter_disable(iUnit);
+
+		pcnt_event_enable(iUnit, PCNT_EVT_H_LIM);
+		pcnt_event_enable(iUnit, PCNT_EVT_L_LIM);
+		pcnt_counter_pause(iUnit);
+		pcnt_counter_clear(iUnit);
+
+		pcnt_isr_service_install(0); //may already be installed by another counter, which is fine
+		b_hwReady = ( pcnt_isr_handler_add(iUnit, handleLimitISR, this) == ESP_OK );
+		pcnt_counter_resume(iUnit);
+	}
+}
+
+HSCounterOBJ::~HSCounterOBJ()
+{
+	#ifdef DEBUG
+	Serial.println(PSTR("High Speed Counter Destructor"));
+	#endif
+	if ( !b_attached )
+		return;
+
+	pcnt_counter_pause(iUnit);
+	pcnt_event_disable(iUnit, PCNT_EVT_H_LIM);
+	pcnt_event_disable(iUnit, PCNT_EVT_L_LIM);
+	pcnt_isr_handler_remove(iUnit);
+}
+
+void IRAM_ATTR HSCounterOBJ::handleLimitISR( void *arg )
+{
+	HSCounterOBJ *pObj = static_cast<HSCounterOBJ *>(arg);
+	portENTER_CRITICAL_ISR(&pObj->countMux);
+	if ( PCNT.status_unit[pObj->iUnit].h_lim_lat ) //the hardware counter resets to 0 once a limit is reached
+		pObj->iOverflowCount += HSC_LIMIT;
+	else if ( PCNT.status_unit[pObj->iUnit].l_lim_lat )
+		pObj->iOverflowCount -= HSC_LIMIT;
+	portEXIT_CRITICAL_ISR(&pObj->countMux);
+}
+
+int64_t HSCounterOBJ::getHardwareCount()
+{
+	int16_t count = 0;
+	portENTER_CRITICAL(&countMux); //read both halves together, so a limit event can't land in between
+	pcnt_get_counter_value(iUnit, &count);
+	int64_t total = iOverflowCount + count;
+	portEXIT_CRITICAL(&countMux);
+
+	//A jump of more than half the limit means the counter was reset at a limit and the ISR hasn't folded it yet.
+	if ( total - iLastTotal < -HSC_LIMIT / 2 )
+		total += HSC_LIMIT;
+	else if ( total - iLastTotal > HSC_LIMIT / 2 )
+		total -= HSC_LIMIT;
+
+	iLastTotal = total;
+	return total;
+}
+
+void HSCounterOBJ::updateObject()
+{
+	bool lineState = getLineState();
+	int64_t count = getHardwareCount();
+	int64_t delta = count - iLastCount;
+	iLastCount = count;
+
+	if ( lineState ) //only accumulate while the rung is enabled
+	{
+		int64_t accum = static_cast<int64_t>(iAccum) + delta;
+		if ( accum > INT32_MAX ) //wrap around like a 32 bit counter would, but remember that it happened
+		{
+			overflowBit = true;
+			accum -= 4294967296LL;
+		}
+		else if ( accum < INT32_MIN )
+		{
+			underflowBit = true;
+			accum += 4294967296LL;
+		}
+		iAccum = accum;
+	}
+
+	int64_t currentTime = esp_timer_get_time();
+	if ( currentTime - iRateTime >= HSC_RATE_PERIOD ) //pulses per second over the last period
+	{
+		dRate = static_cast<double>(count - iRateCount) * 1000000.0 / static_cast<double>(currentTime - iRateTime);
+		iRateCount = count;
+		iRateTime = currentTime;
+	}
+
+	doneBit = ( iAccum >= iPreset );
+	enableBit = lineState;
+	setState(lineState);
+	Ladder_OBJ_Logical::updateObject(); //parent class
+}
+
+shared_ptr<Ladder_VAR> HSCounterOBJ::getObjectVAR( const String &id )
+{
+	shared_ptr<Ladder_VAR> var = Ladder_OBJ_Logical::getObjectVAR(id);
+	if ( !var ) //already exists?
+	{
+		if ( id == bitTagEN )
+			var = make_shared<Ladder_VAR>(&enableBit, id);
+		else if ( id == bitTagDN )
+			var = make_shared<Ladder_VAR>(&doneBit, id);
+		else if ( id == bitTagOV )
+			var = make_shared<Ladder_VAR>(&overflowBit, id);
+		else if ( id == bitTagUN )
+			var = make_shared<Ladder_VAR>(&underflowBit, id);
+		else if ( id == bitTagPRE )
+			var = make_shared<Ladder_VAR>(&iPreset, id);
+		else if ( id == bitTagACC )
+			var = make_shared<Ladder_VAR>(&iAccum, id);
+		else if ( id == bitTagRATE )
+			var = make_shared<Ladder_VAR>(&dRate, id);
+
+		if ( var )
+		{
+			#ifdef DEBUG 
+			Serial.println(PSTR("Created new High Speed Counter Object Tag: ") + id ); 
+			#endif
+			getObjectVARs().emplace_back(var);
+		}
+	}
+
+	if ( !var )
+	{
+		#ifdef DEBUG 
+		Serial.println(PSTR("Failed: Object Tag: ") + id ); 
+		#endif
+	}
+
+	return var;
+}
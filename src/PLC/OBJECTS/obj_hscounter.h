@@ -0,0 +1,64 @@
+#ifndef PLC_IO_OBJ_HSCOUNTER
+#define PLC_IO_OBJ_HSCOUNTER
+
+#include "../PLC_IO.h"
+#include "obj_var.h"
+#include <driver/pcnt.h> //pulse counter peripheral
+
+#define HSC_LIMIT 30000 //hardware counter is 16 bit, so the overflow interrupt folds the count into software at this value
+#define HSC_RATE_PERIOD 100000 //minimum time (uS) between updates of the RATE value
+#define HSC_FILTER_DEFAULT 100 //glitch filter length in APB clock cycles (80MHz), max 1023
+
+//High speed counter objects count pulses on a physical pin using the ESP32 PCNT peripheral, so pulses shorter than a logic scan are not lost.
+//The accumulator follows the hardware count while the rung is enabled. QUAD mode uses the control pin as the B channel of a quadrature encoder.
+//Bits that are accessible from a high speed counter: EN (Enabled), DN (Done), OV (Overflow), UN (Underflow), ACC (Accumulator), PRE (Preset), RATE (pulses per second)
+class HSCounterOBJ : public Ladder_OBJ_Logical
+{
+	public:
+	enum HSC_MODE : uint8_t
+	{
+		HSC_MODE_UP, //count rising edges up
+		HSC_MODE_DOWN, //count rising edges down
+		HSC_MODE_QUAD //quadrature decoding, direction determined by the control pin
+	};
+
+	HSCounterOBJ(const String &id, pcnt_unit_t unit, uint8_t pin, int8_t ctrl_pin = PCNT_PIN_NOT_USED, int_fast32_t preset = 0, int_fast32_t accum = 0,
+				 OBJ_TYPE type = OBJ_TYPE::TYPE_COUNTER_HS, uint8_t mode = HSC_MODE_UP, uint16_t filter = HSC_FILTER_DEFAULT, bool attach = true );
+	~HSCounterOBJ();
+
+	virtual void setLineState(bool &state, bool bNot){ Ladder_OBJ_Logical::setLineState(state, bNot); }
+	virtual void updateObject();
+	virtual shared_ptr<Ladder_VAR> getObjectVAR( const String & );
+
+	//Returns true if the PCNT unit was successfully configured.
+	bool getHardwareReady(){ return b_hwReady; }
+	//Returns the total number of pulses seen by the hardware since the object was created (including folded overflows).
+	//The hardware counter resets to 0 at a limit before the limit ISR folds the count, and the ISR may still be pending (or running on the other core) when
+	//the counter is read. A read that lands in that window is corrected against the previous one, so at most HSC_LIMIT / 2 pulses may pass between reads.
+	int64_t getHardwareCount();
+	void reset(){ iAccum = 0; overflowBit = false; underflowBit = false; }
+
+	private:
+	//Called from the PCNT ISR whenever the hardware counter reaches one of its limits.
+	static void IRAM_ATTR handleLimitISR( void * );
+
+	pcnt_unit_t iUnit;
+	uint8_t iPin;
+	int8_t iCtrlPin;
+	bool b_hwReady,
+		 b_attached; //false for counters created by a script check, which never configure the PCNT unit
+
+	volatile int64_t iOverflowCount; //pulses folded out of the hardware counter by the ISR
+	portMUX_TYPE countMux; //guards iOverflowCount between the ISR and the logic scan
+
+	int64_t iLastCount, //hardware count at the previous scan
+			iLastTotal, //value returned by the previous getHardwareCount()
+			iRateCount; //hardware count at the start of the current RATE period
+	int64_t iRateTime; //start time (uS) of the current RATE period
+
+	int_fast32_t iPreset, iAccum;
+	double dRate;
+	bool doneBit, enableBit, overflowBit, underflowBit;
+};
+
+#endif
@@ -1,9 +1,79 @@
 #include "obj_input_basic.h"
+#include <esp_timer.h>
 
 
 //////////////////////////////////////////////////////////////////////////
 // INPUT OBJECT BEGIN
 //////////////////////////////////////////////////////////////////////////
+void IRAM_ATTR InputOBJ::handleEdgeISR( void *arg )
+{
+	InputOBJ *pObj = static_cast<InputOBJ *>(arg);
+	Input_Capture &cap = pObj->edgeCapture;
+	uint32_t now = static_cast<uint32_t>(esp_timer_get_time());
+
+	uint32_t level = gpio_get_level(static_cast<gpio_num_t>(pObj->iPin)) ? 1 : 0;
+
+	cap.i_seq++; //odd: update in progress
+	if ( level == cap.i_level ) //both edges of a pulse shorter than the interrupt latency, which only raise the interrupt once
+	{
+		cap.i_rises++;
+		cap.i_falls++;
+		cap.i_pulseWidth = level ? now - cap.i_riseTime : 0; //a short low pulse ends the high pulse before it, a short high pulse is too short to measure
+		cap.i_riseTime = now;
+	}
+	else if ( level )
+	{
+		cap.i_riseTime = now;
+		cap.i_rises++;
+	}
+	else
+	{
+		cap.i_pulseWidth = now - cap.i_riseTime;
+		cap.i_falls++;
+	}
+	cap.i_level = level;
+	cap.i_seq++; //even: record is consistent again
+}
+
+void InputOBJ::latchInput()
+{
+	iValue = getInput();
+	if ( getType() == OBJ_TYPE::TYPE_INPUT_ANALOG )
+	{
+		dScaled = dScaleMin + (dScaleMax - dScaleMin) * (analogChannel ? analogChannel->getValue() : iValue) / ADC_MAX_COUNT;
+		if ( dScaled >= dThresholdOn )
+			analogState = true;
+		else if ( dScaled < dThresholdOff || dThresholdOff == dThresholdOn ) //no hysteresis band configured
+			analogState = false;
+		return;
+	}
+	if ( !b_capture )
+		return;
+
+	uint32_t seq, rises, falls, pulseWidth;
+	do //take a consistent snapshot of the capture record
+	{
+		seq = edgeCapture.i_seq;
+		rises = edgeCapture.i_rises;
+		falls = edgeCapture.i_falls;
+		pulseWidth = edgeCapture.i_pulseWidth;
+	} while ( (seq & 1) || seq != edgeCapture.i_seq );
+
+	risingBit = ( rises != iLastRises );
+	fallingBit = ( falls != iLastFalls );
+	iLastRises = rises;
+	iLastFalls = falls;
+
+	if ( fallingBit ) //a high pulse completed since the last scan
+		iPulseWidth = pulseWidth;
+
+	//A pulse that started and ended between two scans is still presented to the logic for one scan.
+	if ( getLogic() == LOGIC_NO && risingBit )
+		iValue = 1;
+	else if ( getLogic() == LOGIC_NC && fallingBit )
+		iValue = 0;
+}
+
 void InputOBJ::updateObject()
 {
 	Ladder_OBJ_Logical::updateObject(); //parent class - must be called last
@@ -11,8 +81,6 @@ void InputOBJ::updateObject()
 
 void InputOBJ::setLineState( bool &state, bool bNot)
 {
-	iValue = getInput();
-
 	if (state) //must have a HIGH state coming into the object before performing actions (indicates that the previous object had a successful pass)
 	{
 		if ( getType() == OBJ_TYPE::TYPE_INPUT ) //digital input only (0/1)
@@ -25,10 +93,10 @@ void InputOBJ::setLineState( bool &state, bool bNot)
 				state = false;
 		}
 		else if ( getType() == OBJ_TYPE::TYPE_INPUT_ANALOG ) //we can still treat analog signals as a logic high or low, but we must have a threshhold that must be crossed.
-		{ //2700 is ~ 2/3 of 4096 (12 bit analog reading), so we'll roll with that for now
-			if( ( iValue < 2700 ) && getLogic() == LOGIC_NO) //input is low (button not pressed) and logic is normally open (default position of button is off)
+		{ //the thresholded state is determined once per scan in latchInput()
+			if( !analogState && getLogic() == LOGIC_NO) //input is low (button not pressed) and logic is normally open (default position of button is off)
 				state = (bNot ? true : false); //input not activated
-			else if ( ( iValue >= 2700 ) && getLogic() == LOGIC_NC) //input is high (button is pressed), but logic is normally closed (0)
+			else if ( analogState && getLogic() == LOGIC_NC) //input is high (button is pressed), but logic is normally closed (0)
 				state = (bNot ? true : false); //input not activated, only active if input is 0 in this case
 			else if ( bNot )
 				state = false;
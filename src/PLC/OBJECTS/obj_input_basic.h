@@ -3,28 +3,80 @@
 
 #include "../PLC_IO.h"
 #include "obj_var.h"
+#include "../PLC_Analog.h"
+
+#define ADC_MAX_COUNT 4095 //12 bit readings
+#define ADC_DEFAULT_THRESHOLD 2700 //~2/3 of full scale, used when no thresholds are given
 #include <driver/adc.h> //analog support
+#include <driver/gpio.h>
+
+//Edge capture record for interrupt driven inputs. Written by the GPIO ISR and read by the scan without locking.
+//The ISR increments i_seq before and after each update, so a reader that sees an odd or changed sequence number simply retries.
+struct Input_Capture
+{
+	volatile uint32_t i_seq; //sequence counter (odd while the ISR is writing)
+	volatile uint32_t i_rises, i_falls; //total number of edges seen since the object was created
+	volatile uint32_t i_riseTime; //timestamp (uS, lower 32 bits of esp_timer_get_time) of the latest rising edge
+	volatile uint32_t i_pulseWidth; //width (uS) of the latest complete high pulse, taken as a 32 bit difference so it survives the timestamp wrap
+	volatile uint32_t i_level; //pin level after the latest edge
+};
 
 //Inputs objects check the state of a physical pin and perform logic opertions based on the state of that pin. This may entail setting the rung state to high or low depending on the logic script.
+//The pin is sampled once at the start of each scan (the input process image), so all references to the input within a scan see the same value.
+//Inputs declared with the INT type also capture edges by interrupt, so pulses shorter than a scan are still seen by the logic for one scan.
+//Analog inputs read the filtered value published by the background sampler, scale it to engineering units (EU), and apply ON/OFF thresholds with hysteresis.
+//Inputs created for a script check are not attached: the pin is left as it is, so the running program keeps using it.
+//Bits that are accessible from an interrupt input: VAL (Value), RE (Rising Edge), FE (Falling Edge), PW (last high pulse width in uS, 0 if shorter than the interrupt latency)
 class InputOBJ : public Ladder_OBJ_Logical
 {
 	public:
-	InputOBJ( const String &id, uint8_t pin, OBJ_TYPE type = OBJ_TYPE::TYPE_INPUT, uint8_t logic = LOGIC_NO ) : Ladder_OBJ_Logical(id, type)
+	InputOBJ( const String &id, uint8_t pin, OBJ_TYPE type = OBJ_TYPE::TYPE_INPUT, uint8_t logic = LOGIC_NO, bool capture = false, bool attach = true ) : Ladder_OBJ_Logical(id, type)
 	{ 
 		iPin = pin; 
+		b_attached = attach;
 		iValue = 0; //default
+		b_capture = capture && type == OBJ_TYPE::TYPE_INPUT; //edge capture only makes sense for digital inputs
+		memset(&edgeCapture, 0, sizeof(edgeCapture));
+		iLastRises = 0;
+		iLastFalls = 0;
+		iPulseWidth = 0;
+		risingBit = false;
+		fallingBit = false;
+		analogState = false;
+		dScaled = 0;
+		dScaleMin = 0; //default scaling is 1:1 with raw ADC counts
+		dScaleMax = ADC_MAX_COUNT;
+		dThresholdOn = ADC_DEFAULT_THRESHOLD; 
+		dThresholdOff = ADC_DEFAULT_THRESHOLD;
 
 		getObjectVARs().emplace_back(make_shared<Ladder_VAR>(&iValue, bitTagVAL)); 
 
 		uint64_t gpioBitMask = 1ULL<<pin;
 		gpio_mode_t gpioMode = GPIO_MODE_INPUT;
 		gpio_config_t io_conf;
-		io_conf.intr_type = GPIO_INTR_DISABLE; //disable interrupts
+		io_conf.intr_type = b_capture ? GPIO_INTR_ANYEDGE : GPIO_INTR_DISABLE; //interrupts are only needed for edge capture
 		io_conf.mode = gpioMode;
 		io_conf.pin_bit_mask = gpioBitMask;
 		io_conf.pull_down_en = GPIO_PULLDOWN_ENABLE; //always pull low
 		io_conf.pull_up_en = GPIO_PULLUP_DISABLE;
-		gpio_config(&io_conf);
+		if ( attach )
+			gpio_config(&io_conf);
+
+		if ( b_capture )
+		{
+			getObjectVARs().emplace_back(make_shared<Ladder_VAR>(&risingBit, bitTagRE)); 
+			getObjectVARs().emplace_back(make_shared<Ladder_VAR>(&fallingBit, bitTagFE)); 
+			getObjectVARs().emplace_back(make_shared<Ladder_VAR>(&iPulseWidth, bitTagPW)); 
+			if ( attach )
+			{
+				edgeCapture.i_level = gpio_get_level(static_cast<gpio_num_t>(pin)); //the ISR classifies each edge against the level before it
+				gpio_install_isr_service(0); //may already be installed by another input, which is fine
+				gpio_isr_handler_add(static_cast<gpio_num_t>(pin), handleEdgeISR, this);
+			}
+		}
+
+		if ( type == OBJ_TYPE::TYPE_INPUT_ANALOG )
+			getObjectVARs().emplace_back(make_shared<Ladder_VAR>(&dScaled, bitTagEU)); 
 
 		setLogic(logic); 
 	}
@@ -33,22 +85,47 @@ class InputOBJ : public Ladder_OBJ_Logical
 		#ifdef DEBUG
 		Serial.println(PSTR("Input Destructor")); 
 		#endif
+		if ( b_capture && b_attached )
+			gpio_isr_handler_remove(static_cast<gpio_num_t>(iPin));
 	}
 
 	uint16_t getInput()
 	{ 
 		if ( getType() == OBJ_TYPE::TYPE_INPUT_ANALOG )
-			return analogRead(iPin);
+			return analogChannel ? static_cast<uint16_t>(analogChannel->getValue() + 0.5f) : analogRead(iPin);
 		
 		return digitalRead(iPin);
 	} //Return the value of the input from the assigned pin.
+	//Associates the input with a channel of the background analog sampler.
+	void setAnalogChannel( shared_ptr<Analog_Channel> channel ){ analogChannel = channel; }
+	//Sets the engineering unit values that correspond to raw readings of 0 and ADC_MAX_COUNT.
+	void setScaling( double min, double max ){ dScaleMin = min; dScaleMax = max; }
+	//Sets the EU values at which the input turns on, and back off again. Args: <ON>, <OFF>
+	void setThresholds( double on, double off ){ dThresholdOn = on; dThresholdOff = off > on ? on : off; }
 	uint8_t getInputPin(){ return iPin; }
+	//Samples the pin (and consumes any captured edges) into the input process image. Called once at the start of each scan.
+	void latchInput();
 	virtual void updateObject();
 	virtual void setLineState(bool &, bool);
 	
 	private:
+	static void IRAM_ATTR handleEdgeISR( void * );
+
 	uint8_t iPin;
 	uint16_t iValue; //input value that was read and stored off
+	bool b_capture; //edge capture by interrupt enabled?
+	bool b_attached; //false for inputs created by a script check
+
+	Input_Capture edgeCapture; //written by the ISR
+	uint32_t iLastRises, iLastFalls; //edge counts already consumed by the scan
+	uint_fast32_t iPulseWidth; //width of the last complete high pulse (uS)
+	bool risingBit, fallingBit; //edge seen since the previous scan
+
+	shared_ptr<Analog_Channel> analogChannel; //background sampler channel (analog inputs only)
+	double dScaled, //latest value in engineering units
+		   dScaleMin, dScaleMax,
+		   dThresholdOn, dThresholdOff; 
+	bool analogState; //thresholded state, held between the ON and OFF thresholds
 };
 
 #endif
\ No newline at end of file
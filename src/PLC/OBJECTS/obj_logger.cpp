@@ -0,0 +1,523 @@
+#include "obj_logger.h"
+#include "../../CORE/UICore.h"
+#include <string.h>
+
+extern UICore Core;
+
+//Reads the current value of a variable as raw bits. Integer types are widened to 64 bits (sign extended where signed), so their deltas are small.
+static uint64_t readRaw( OBJ_TYPE type, const void *ptr )
+{
+	switch( type )
+	{
+		case OBJ_TYPE::TYPE_VAR_BOOL: return *static_cast<const bool *>(ptr);
+		case OBJ_TYPE::TYPE_VAR_USHORT: return *static_cast<const uint16_t *>(ptr);
+		case OBJ_TYPE::TYPE_VAR_INT: return static_cast<int64_t>(*static_cast<const int_fast32_t *>(ptr));
+		case OBJ_TYPE::TYPE_VAR_UINT: return *static_cast<const uint_fast32_t *>(ptr);
+		default: break;
+	}
+
+	uint64_t raw; //LONG, ULONG, FLOAT
+	memcpy( &raw, ptr, sizeof(uint64_t) );
+	return raw;
+}
+
+static uint8_t *writeVarint( uint8_t *out, uint64_t value )
+{
+	while ( value >= 0x80 )
+	{
+		*out++ = static_cast<uint8_t>(value) | 0x80;
+		value >>= 7;
+	}
+	*out++ = static_cast<uint8_t>(value);
+	return out;
+}
+
+static const uint8_t *readVarint( const uint8_t *in, const uint8_t *end, uint64_t &value )
+{
+	value = 0;
+	for ( uint8_t shift = 0; in < end && shift < 64; shift += 7 )
+	{
+		uint8_t byte = *in++;
+		value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if ( !(byte & 0x80) )
+			return in;
+	}
+	return 0; //ran off the end of the block
+}
+
+static uint64_t zigZag( int64_t value ){ return ( static_cast<uint64_t>(value) << 1 ) ^ static_cast<uint64_t>( value >> 63 ); }
+static int64_t unZigZag( uint64_t value ){ return static_cast<int64_t>( value >> 1 ) ^ -static_cast<int64_t>( value & 1 ); }
+
+//Encodes a floating point value as its XOR with the previous value: 0xFF if equal, otherwise the leading/trailing zero byte counts then the bytes in between.
+static uint8_t *writeXOR( uint8_t *out, uint64_t value )
+{
+	if ( !value )
+	{
+		*out++ = 0xFF;
+		return out;
+	}
+
+	uint8_t lead = 0, trail = 0;
+	while ( !( value >> (56 - lead * 8) & 0xFF ) )
+		lead++;
+	while ( !( value >> (trail * 8) & 0xFF ) )
+		trail++;
+
+	*out++ = (lead << 4) | trail;
+	for ( int8_t x = 7 - lead; x >= trail; x-- )
+		*out++ = static_cast<uint8_t>( value >> (x * 8) );
+	return out;
+}
+
+static const uint8_t *readXOR( const uint8_t *in, const uint8_t *end, uint64_t &value )
+{
+	value = 0;
+	if ( in >= end )
+		return 0;
+
+	uint8_t control = *in++;
+	if ( control == 0xFF )
+		return in;
+
+	uint8_t lead = control >> 4, trail = control & 0x0F;
+	if ( lead + trail > 7 || end - in < 8 - lead - trail )
+		return 0;
+
+	for ( int8_t x = 7 - lead; x >= trail; x-- )
+		value |= static_cast<uint64_t>(*in++) << (x * 8);
+	return in;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// LOGGER OBJECT BEGIN
+//////////////////////////////////////////////////////////////////////////
+LoggerOBJ::LoggerOBJ(const String &id, PLC_Timer_Wheel *wheel, const vector<shared_ptr<Ladder_VAR>> &varList, const vector<String> &nameList, uint32_t period, OBJ_TYPE type, bool attach ) : Ladder_OBJ_Logical(id, type)
+{
+	vars = varList;
+	names = nameList;
+	pWheel = wheel;
+	i_period = period;
+	for ( uint8_t x = 0; x < vars.size(); x++ )
+		varPtrs.push_back( vars[x]->getValuePtr() );
+	prevValues.resize( vars.size() );
+
+	for ( uint8_t x = 0; x < LOG_NUM_BLOCKS; x++ )
+		blocks[x].state.store(LOG_BLOCK_FREE);
+	i_fillBlock = 0;
+	i_writeBlock = 0;
+	i_length = 0;
+	i_numSamples = 0;
+	i_sequence = 0;
+	i_rotations = 0;
+	iBaseTime = 0;
+	iPrevTime = 0;
+	iPrevDelta = 0;
+	iNextSample = 0;
+	i_numLogged = 0;
+	i_numDropped = 0;
+	enableBit = false;
+	b_filling = false;
+	s_fileName = PSTR("/") + id + PSTR(".log");
+	s_oldFileName = PSTR("/") + id + PSTR(".old");
+
+	fileMutex = xSemaphoreCreateMutex();
+	stoppedSignal = xSemaphoreCreateBinary();
+	taskHandle = 0;
+	b_running = attach;
+	if ( attach && xTaskCreatePinnedToCore(writerTask, "PLC_LOG", LOG_WRITER_STACK, this, 1, &taskHandle, LOG_WRITER_CORE) != pdPASS )
+	{
+		taskHandle = 0; //nothing would ever save the blocks, see hasWriter()
+		b_running = false;
+	}
+}
+
+LoggerOBJ::~LoggerOBJ()
+{
+	if ( b_filling && i_numSamples ) //hand over the samples taken so far, the task saves them before it stops
+		closeBlock();
+
+	b_running = false;
+	if ( taskHandle )
+	{
+		xTaskNotifyGive(taskHandle);
+		xSemaphoreTake(stoppedSignal, portMAX_DELAY);
+	}
+
+	vSemaphoreDelete(stoppedSignal);
+	vSemaphoreDelete(fileMutex);
+}
+
+void LoggerOBJ::updateHeader()
+{
+	Log_Block_Header header;
+	memset( &header, 0, sizeof(header) );
+	header.i_magic = LOG_MAGIC;
+	header.i_sequence = i_sequence;
+	header.i_baseTime = iBaseTime;
+	header.i_numSamples = i_numSamples;
+	header.i_length = i_length;
+	header.i_numVars = vars.size();
+	memcpy( blocks[i_fillBlock].data, &header, sizeof(header) );
+}
+
+bool LoggerOBJ::beginBlock( int64_t now )
+{
+	Log_Block &block = blocks[i_fillBlock];
+	if ( block.state.load(memory_order_acquire) != LOG_BLOCK_FREE ) //the writer task hasn't caught up yet
+		return false;
+
+	i_length = sizeof(Log_Block_Header);
+	for ( uint8_t x = 0; x < vars.size(); x++ )
+		block.data[i_length++] = static_cast<uint8_t>(vars[x]->getType());
+
+	i_numSamples = 0;
+	iBaseTime = now;
+	iPrevTime = now;
+	iPrevDelta = 0;
+	for ( uint8_t x = 0; x < prevValues.size(); x++ )
+		prevValues[x] = 0;
+
+	b_filling = true;
+	return true;
+}
+
+void LoggerOBJ::closeBlock()
+{
+	updateHeader();
+	blocks[i_fillBlock].state.store(LOG_BLOCK_READY, memory_order_release);
+	i_fillBlock = (i_fillBlock + 1) % LOG_NUM_BLOCKS;
+	i_sequence++;
+	b_filling = false;
+	if ( taskHandle )
+		xTaskNotifyGive(taskHandle);
+}
+
+void LoggerOBJ::sample( int64_t now )
+{
+	if ( !b_filling && !beginBlock(now) )
+	{
+		i_numDropped++;
+		return;
+	}
+
+	uint8_t *start = blocks[i_fillBlock].data, *out = start + i_length;
+	int64_t delta = now - iPrevTime;
+	out = writeVarint( out, zigZag(delta - iPrevDelta) );
+	iPrevDelta = delta;
+	iPrevTime = now;
+
+	for ( uint8_t x = 0; x < vars.size(); x++ )
+	{
+		uint64_t raw = readRaw( vars[x]->getType(), varPtrs[x] );
+		if ( vars[x]->getType() == OBJ_TYPE::TYPE_VAR_FLOAT )
+			out = writeXOR( out, raw ^ prevValues[x] );
+		else
+			out = writeVarint( out, zigZag( static_cast<int64_t>(raw - prevValues[x]) ) );
+		prevValues[x] = raw;
+	}
+
+	i_length = out - start;
+	i_numSamples++;
+	i_numLogged++;
+
+	if ( i_length + LOG_MAX_SAMPLE_SIZE(vars.size()) > LOG_BLOCK_SIZE ) //the next sample might not fit
+		closeBlock();
+}
+
+void LoggerOBJ::updateObject()
+{
+	bool lineState = getLineState();
+	int64_t now = pWheel->getNow();
+
+	if ( lineState )
+	{
+		if ( !i_period )
+		{
+			if ( !enableBit ) //sample on the rising edge only
+				sample(now);
+		}
+		else if ( !enableBit || now >= iNextSample )
+		{
+			sample(now);
+			iNextSample += static_cast<int64_t>(i_period) * 1000;
+			if ( iNextSample <= now ) //starting, or the scan fell behind, so don't try to catch up
+				iNextSample = now + static_cast<int64_t>(i_period) * 1000;
+		}
+	}
+
+	if ( b_filling && i_numSamples && now - iBaseTime >= LOG_FLUSH_INTERVAL )
+		closeBlock();
+
+	enableBit = lineState;
+	Ladder_OBJ_Logical::updateObject();
+}
+
+void LoggerOBJ::writeBlocks()
+{
+	if ( blocks[i_writeBlock].state.load(memory_order_acquire) != LOG_BLOCK_READY )
+		return;
+
+	xSemaphoreTake(fileMutex, portMAX_DELAY);
+	File logFile;
+	if ( Core.isFSOpen() ) //without a file system the blocks are dropped, so the scan can keep sampling
+		logFile = SPIFFS.open(s_fileName, FILE_APPEND);
+	while ( blocks[i_writeBlock].state.load(memory_order_acquire) == LOG_BLOCK_READY )
+	{
+		Log_Block &block = blocks[i_writeBlock];
+		Log_Block_Header header;
+		memcpy( &header, block.data, sizeof(header) );
+
+		if ( logFile && logFile.size() + header.i_length > LOG_FILE_MAX ) //rotate, only the previous file is kept
+		{
+			logFile.close();
+			SPIFFS.remove(s_oldFileName);
+			SPIFFS.rename(s_fileName, s_oldFileName);
+			logFile = SPIFFS.open(s_fileName, FILE_APPEND);
+			i_rotations++;
+		}
+
+		if ( logFile )
+			logFile.write( block.data, header.i_length );
+
+		block.state.store(LOG_BLOCK_FREE, memory_order_release);
+		i_writeBlock = (i_writeBlock + 1) % LOG_NUM_BLOCKS;
+	}
+	logFile.close();
+	xSemaphoreGive(fileMutex);
+}
+
+void LoggerOBJ::writerTask( void *arg )
+{
+	LoggerOBJ *pLogger = static_cast<LoggerOBJ *>(arg);
+
+	while ( pLogger->b_running )
+	{
+		ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOG_WRITER_WAKE));
+		pLogger->writeBlocks();
+	}
+
+	xSemaphoreGive(pLogger->stoppedSignal);
+	vTaskDelete(0); //delete self
+}
+
+void LoggerOBJ::beginRead( Log_Read_Cursor &cursor )
+{
+	xSemaphoreTake(fileMutex, portMAX_DELAY);
+	cursor.i_rotations = i_rotations;
+	xSemaphoreGive(fileMutex);
+	cursor.i_offset = 0;
+	cursor.i_file = 0;
+	cursor.b_done = false;
+}
+
+uint16_t LoggerOBJ::copyNextBlock( Log_Read_Cursor &cursor, uint8_t *buffer, vector<uint8_t> &tail )
+{
+	xSemaphoreTake(fileMutex, portMAX_DELAY);
+	if ( cursor.i_rotations != i_rotations ) //the files were renamed since the last call
+	{
+		if ( cursor.i_file && i_rotations - cursor.i_rotations == 1 ) //the file being read is now the rotated one, at the same offset
+			cursor.i_file = 0;
+		else //the blocks being read were removed, go on with the oldest ones left (none of which have been passed on yet)
+		{
+			cursor.i_file = 0;
+			cursor.i_offset = 0;
+		}
+		cursor.i_rotations = i_rotations;
+	}
+
+	const String *files[] = { &s_oldFileName, &s_fileName };
+	for ( ; cursor.i_file < 2; cursor.i_file++, cursor.i_offset = 0 )
+	{
+		if ( !Core.isFSOpen() || !SPIFFS.exists(*files[cursor.i_file]) )
+			continue;
+
+		File logFile = SPIFFS.open(*files[cursor.i_file], FILE_READ);
+		Log_Block_Header header;
+		uint16_t length = 0;
+		if ( logFile && logFile.seek(cursor.i_offset) && logFile.read( reinterpret_cast<uint8_t *>(&header), sizeof(header) ) == sizeof(header)
+			 && header.i_magic == LOG_MAGIC && header.i_length >= sizeof(header) && header.i_length <= LOG_BLOCK_SIZE ) //anything else was cut short by a power loss
+		{
+			memcpy( buffer, &header, sizeof(header) );
+			uint16_t rest = header.i_length - sizeof(header);
+			if ( logFile.read( buffer + sizeof(header), rest ) == rest )
+				length = header.i_length;
+		}
+		logFile.close();
+
+		if ( length ) //carry on from the same file next time, blocks may still be appended to it
+		{
+			cursor.i_offset += length;
+			xSemaphoreGive(fileMutex);
+			return length;
+		}
+	}
+
+	//Blocks still in RAM. Both files were read to the end under this lock, so none of these has been passed on yet, and the writer task can't save them until it is released.
+	//The scan runs on the same task as the web server, so none of these change while they are copied.
+	tail.clear();
+	for ( uint8_t x = 0, index = i_writeBlock; x < LOG_NUM_BLOCKS && blocks[index].state.load(memory_order_acquire) == LOG_BLOCK_READY; x++, index = (index + 1) % LOG_NUM_BLOCKS )
+	{
+		Log_Block_Header header;
+		memcpy( &header, blocks[index].data, sizeof(header) );
+		tail.insert( tail.end(), blocks[index].data, blocks[index].data + header.i_length );
+	}
+	if ( b_filling && i_numSamples )
+	{
+		updateHeader();
+		tail.insert( tail.end(), blocks[i_fillBlock].data, blocks[i_fillBlock].data + i_length );
+	}
+	xSemaphoreGive(fileMutex);
+
+	cursor.b_done = true;
+	return 0;
+}
+
+bool LoggerOBJ::readBlocks( Log_Read_Cursor &cursor, uint8_t maxBlocks, function<void(const uint8_t *, uint16_t)> callback )
+{
+	uint8_t buffer[LOG_BLOCK_SIZE];
+	vector<uint8_t> tail;
+	for ( uint8_t numRead = 0; numRead < maxBlocks && !cursor.b_done; numRead++ )
+	{
+		uint16_t length = copyNextBlock(cursor, buffer, tail); //the lock is released before the block is passed on, the callback may wait on the network
+		if ( length )
+			callback( buffer, length );
+	}
+
+	for ( uint32_t offset = 0; offset < tail.size(); ) //the blocks that were still in RAM
+	{
+		Log_Block_Header header;
+		memcpy( &header, &tail[offset], sizeof(header) );
+		callback( &tail[offset], header.i_length );
+		offset += header.i_length;
+	}
+
+	return !cursor.b_done;
+}
+
+bool LoggerOBJ::isSaved()
+{
+	for ( uint8_t x = 0; x < LOG_NUM_BLOCKS; x++ )
+	{
+		if ( blocks[x].state.load(memory_order_acquire) == LOG_BLOCK_READY )
+			return false;
+	}
+
+	xSemaphoreTake(fileMutex, portMAX_DELAY); //the writer task may still be closing the file
+	xSemaphoreGive(fileMutex);
+	return true;
+}
+
+bool LoggerOBJ::decodeSamples( const uint8_t *block, uint16_t length, function<void(int64_t, const uint64_t *)> callback )
+{
+	Log_Block_Header header;
+	if ( length < sizeof(header) )
+		return false;
+
+	memcpy( &header, block, sizeof(header) );
+	if ( header.i_magic != LOG_MAGIC || header.i_length != length || header.i_numVars > LOG_MAX_VARS || length < sizeof(header) + header.i_numVars )
+		return false;
+
+	const uint8_t *types = block + sizeof(header), *in = types + header.i_numVars, *end = block + length;
+	uint64_t prev[LOG_MAX_VARS] = {0}, value;
+	int64_t time = header.i_baseTime, delta = 0;
+
+	for ( uint16_t s = 0; s < header.i_numSamples; s++ )
+	{
+		if ( !( in = readVarint(in, end, value) ) )
+			return false;
+
+		delta += unZigZag(value);
+		time += delta;
+
+		for ( uint8_t x = 0; x < header.i_numVars; x++ )
+		{
+			if ( static_cast<OBJ_TYPE>(types[x]) == OBJ_TYPE::TYPE_VAR_FLOAT )
+			{
+				if ( !( in = readXOR(in, end, value) ) )
+					return false;
+				prev[x] ^= value;
+			}
+			else
+			{
+				if ( !( in = readVarint(in, end, value) ) )
+					return false;
+				prev[x] += static_cast<uint64_t>( unZigZag(value) );
+			}
+		}
+		callback( time, prev );
+	}
+
+	return true;
+}
+
+bool LoggerOBJ::decodeBlock( const uint8_t *block, uint16_t length, String &out )
+{
+	Log_Block_Header header;
+	if ( length < sizeof(header) )
+		return false;
+
+	memcpy( &header, block, sizeof(header) );
+	const uint8_t *types = block + sizeof(header);
+	return decodeSamples( block, length, [&out, &header, types]( int64_t time, const uint64_t *values )
+	{
+		out += intToStr(time);
+		for ( uint8_t x = 0; x < header.i_numVars; x++ )
+		{
+			out += CHAR_COMMA;
+			switch( static_cast<OBJ_TYPE>(types[x]) )
+			{
+				case OBJ_TYPE::TYPE_VAR_FLOAT:
+				{
+					double d;
+					memcpy( &d, &values[x], sizeof(double) );
+					out += String(d, 6);
+				}
+				break;
+				case OBJ_TYPE::TYPE_VAR_ULONG:
+				case OBJ_TYPE::TYPE_VAR_UINT:
+				case OBJ_TYPE::TYPE_VAR_USHORT:
+				case OBJ_TYPE::TYPE_VAR_BOOL:
+					out += intToStr(values[x]);
+					break;
+				default: //signed types
+					out += intToStr( static_cast<int64_t>(values[x]) );
+					break;
+			}
+		}
+		out += CHAR_NEWLINE;
+	});
+}
+
+String LoggerOBJ::getCSVHeader()
+{
+	String header = PSTR("TIME_US");
+	for ( uint8_t x = 0; x < names.size(); x++ )
+		header += CHAR_COMMA + names[x];
+	return header + CHAR_NEWLINE;
+}
+
+shared_ptr<Ladder_VAR> LoggerOBJ::getObjectVAR( const String &id )
+{
+	shared_ptr<Ladder_VAR> var = Ladder_OBJ_Logical::getObjectVAR(id);
+	if ( !var ) //proceed if it doesn't already exist
+	{
+		if ( id == bitTagEN )
+			var = make_shared<Ladder_VAR>(&enableBit, id);
+		else if ( id == bitTagACC )
+			var = make_shared<Ladder_VAR>(&i_numLogged, id);
+		else if ( id == bitTagERR )
+			var = make_shared<Ladder_VAR>(&i_numDropped, id);
+		else if ( id == bitTagPRE )
+			var = make_shared<Ladder_VAR>(&i_period, id);
+
+		if ( var )
+		{
+			#ifdef DEBUG
+			Serial.println(PSTR("Created new Logger Object Tag: ") + id );
+			#endif
+			getObjectVARs().emplace_back(var);
+		}
+	}
+
+	return var;
+}
@@ -0,0 +1,142 @@
+#ifndef PLC_IO_OBJ_LOGGER
+#define PLC_IO_OBJ_LOGGER
+
+#include "../PLC_IO.h"
+#include "../PLC_Timer.h"
+#include "obj_var.h"
+#include <SPIFFS.h>
+#include <functional>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#define LOG_MAX_VARS 32 //maximum number of variables sampled by a single logger
+#define LOG_BLOCK_SIZE 1024 //size of a RAM block (bytes), including its header
+#define LOG_NUM_BLOCKS 4 //number of RAM blocks in the ring, filled blocks wait here until the writer task has saved them
+#define LOG_MAX_SAMPLE_SIZE(vars) (10 + (vars) * 10) //worst case encoded size of a sample (varints are at most 10 bytes)
+#define LOG_FLUSH_INTERVAL 60000000 //time (uS) after which a partly filled block is saved anyway, so slow loggers still reach the flash
+#define LOG_FILE_MAX 65536 //size (bytes) at which the current log file is rotated
+#define LOG_MAX_NAME 24 //longest logger ID that still makes a valid SPIFFS file name
+#define LOG_MAGIC 0x31474F4C //"LOG1"
+#define LOG_WRITER_CORE 0 //the Arduino loop (and logic scan) runs on core 1
+#define LOG_WRITER_STACK 3072
+#define LOG_WRITER_WAKE 1000 //longest time (mS) the writer task sleeps without being notified
+
+enum LOG_BLOCK_STATE : uint8_t
+{
+	LOG_BLOCK_FREE, //available to the scan
+	LOG_BLOCK_READY //filled, waiting for the writer task
+};
+
+//Stored at the start of every block, followed by one type byte per variable and then the encoded samples. Blocks are saved to the file as they are (without the unused space).
+//The previous values used for the deltas restart with every block, so each block can be decoded on its own.
+struct Log_Block_Header
+{
+	uint32_t i_magic, //LOG_MAGIC
+			 i_sequence; //block number since the logger was created
+	int64_t i_baseTime; //time of the first sample (uS since boot)
+	uint16_t i_numSamples,
+			 i_length; //total size of the block (bytes), including the header
+	uint8_t i_numVars,
+			i_reserved[3];
+};
+
+//A block in the RAM ring.
+struct Log_Block
+{
+	uint8_t data[LOG_BLOCK_SIZE];
+	atomic<uint8_t> state; //LOG_BLOCK_STATE, set with release by the side handing the block over, read with acquire before the data is touched
+};
+
+//Position of a reader within the saved blocks, kept between calls to LoggerOBJ::readBlocks() so a download can be sent a few blocks at a time.
+struct Log_Read_Cursor
+{
+	uint32_t i_rotations, //rotations of the log file seen by the reader
+			 i_offset; //offset (bytes) of the next block in the file being read
+	uint8_t i_file; //0 = rotated file, 1 = current file
+	bool b_done; //every block has been passed on
+};
+
+//Logger objects sample a list of variables into compressed blocks in RAM, which are saved to a rotating file in the flash file system by a low priority task,
+//so the scan never waits on a flash write.
+//EX: L1[LOG,100,TANK.EU,PUMP.CV,VALVE] samples every 100 mS while the rung is true. A period of 0 takes one sample on each rising edge of the rung.
+//Each sample is stored as the zig-zag varint of its time delta-of-delta (uS), then per variable: the zig-zag varint of the change in value for integer/bool variables,
+//or the XOR with the previous value for floating point variables (a byte holding the number of leading and trailing zero bytes, then the bytes in between).
+//Slow moving values take 1-2 bytes per variable per sample. The log is saved to /<ID>.log, which is renamed to /<ID>.old once it reaches LOG_FILE_MAX.
+//The log can be downloaded from /log?id=<ID>&fmt=csv (or fmt=bin for the raw blocks). Loggers created for a script check have no writer task, and never touch the log files.
+//Bits that are accessible from a logger: EN (Enabled), ACC (Number of samples taken), ERR (Number of samples dropped because the writer task fell behind), PRE (Period in mS)
+class LoggerOBJ : public Ladder_OBJ_Logical
+{
+	public:
+	LoggerOBJ(const String &id, PLC_Timer_Wheel *wheel, const vector<shared_ptr<Ladder_VAR>> &varList, const vector<String> &nameList, uint32_t period, OBJ_TYPE type = OBJ_TYPE::TYPE_LOGGER, bool attach = true );
+	~LoggerOBJ();
+
+	virtual void setLineState(bool &state, bool bNot){ Ladder_OBJ_Logical::setLineState(state, bNot); }
+	virtual void updateObject();
+	virtual shared_ptr<Ladder_VAR> getObjectVAR( const String & );
+
+	//Places the cursor at the oldest saved block.
+	void beginRead( Log_Read_Cursor & );
+	//Calls the given function for up to the given number of saved blocks from the cursor on, oldest first: the rotated file, the current file, then the blocks
+	//still in RAM (which are all passed on in one call, so the count may be exceeded by up to LOG_NUM_BLOCKS + 1). Each block is copied out under the file lock,
+	//which is released before the function is called, so a slow reader never holds up the writer task.
+	//A rotation between blocks is followed, blocks that were removed by it are skipped. Returns false once every block has been passed on.
+	bool readBlocks( Log_Read_Cursor &, uint8_t, function<void(const uint8_t *, uint16_t)> );
+	//Calls the given function for each sample in the block, with its time (uS) and the raw bits of each value as the scan read them (integers widened to
+	//64 bits, sign extended where signed). Returns false if the block is not valid.
+	static bool decodeSamples( const uint8_t *, uint16_t, function<void(int64_t, const uint64_t *)> );
+	//Appends the samples in the given block to the string as CSV lines (time, then one column per variable). Returns false if the block is not valid.
+	static bool decodeBlock( const uint8_t *, uint16_t, String & );
+	//Returns the CSV header line for the logged variables.
+	String getCSVHeader();
+	//Returns false if the writer task couldn't be started, or the logger was created for a script check.
+	bool hasWriter(){ return taskHandle; }
+	//Returns true once the writer task has saved every filled block.
+	bool isSaved();
+	const String &getFileName(){ return s_fileName; }
+	const String &getOldFileName(){ return s_oldFileName; }
+
+	private:
+	static void writerTask( void * );
+	//Saves every filled block to the log file. Called from the writer task.
+	void writeBlocks();
+	//Encodes the current value of every variable into the current block.
+	void sample( int64_t );
+	//Starts a new block in the next ring slot, if it is free.
+	bool beginBlock( int64_t );
+	//Completes the header of the current block and hands it to the writer task.
+	void closeBlock();
+	//Writes the header fields of the current block into its data.
+	void updateHeader();
+	//Copies the next saved block from the cursor on into the buffer (LOG_BLOCK_SIZE) and returns its length. Once both files have been read to the end,
+	//the blocks still in RAM are copied into the tail instead, the cursor is done and 0 is returned. The file lock is only held for the copy.
+	uint16_t copyNextBlock( Log_Read_Cursor &, uint8_t *, vector<uint8_t> & );
+
+	vector<shared_ptr<Ladder_VAR>> vars;
+	vector<const void *> varPtrs; //resolved once, read directly each sample
+	vector<String> names;
+	vector<uint64_t> prevValues; //raw bits of the previous sample's values, in the current block
+	PLC_Timer_Wheel *pWheel;
+	Log_Block blocks[LOG_NUM_BLOCKS];
+	uint8_t i_fillBlock, //block being filled by the scan
+			i_writeBlock; //next block to be saved by the writer task
+	uint16_t i_length, //bytes used in the current block
+			 i_numSamples; //samples in the current block
+	uint32_t i_sequence,
+			 i_rotations; //times the log file has been rotated, lets a reader follow the rename
+	int64_t iBaseTime, iPrevTime, iPrevDelta, //sample times in the current block (uS)
+			iNextSample; //time of the next periodic sample (uS)
+	uint_fast32_t i_period, //mS, 0 samples on the rising edge of the rung
+				  i_numLogged, //ACC
+				  i_numDropped; //ERR
+	String s_fileName, s_oldFileName;
+	SemaphoreHandle_t fileMutex; //guards the log files between the writer task and readBlocks
+	SemaphoreHandle_t stoppedSignal; //given by the task once it has left its loop
+	TaskHandle_t taskHandle;
+	volatile bool b_running;
+	bool enableBit,
+		 b_filling; //the current block has been started
+};
+
+#endif
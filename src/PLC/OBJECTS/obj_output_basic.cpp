@@ -1,4 +1,5 @@
 #include "obj_output_basic.h"
+#include "../../CORE/Trace.h"
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -6,23 +7,46 @@
 //////////////////////////////////////////////////////////////////////////
 void OutputOBJ::updateObject() //Logic used to update the coil
 {
-	bool lineState = (getLineState()!=getLogic()) ? LOW : HIGH;
-
-	if ( getType() == OBJ_TYPE::TYPE_OUTPUT )
+	if ( b_holding ) //the scan watchdog has taken over the pin
 	{
-		if ( iOutputValue != lineState )
-			iOutputValue = lineState; //only update if changed.
-
-		digitalWrite(iPin, lineState);
+		Ladder_OBJ_Logical::updateObject();
+		return;
 	}
-	else if ( getType() == OBJ_TYPE::TYPE_OUTPUT_PWM )
-	{
-		if ( !lineState )
-			iOutputValue = lineState;
-		else
-			iOutputValue = iDutyCycle; //set as the stored duty cycle
 
+	uint16_t lastValue = iOutputValue;
+	iOutputValue = getOutputValue( getLineState() );
+	if ( iOutputValue != lastValue )
+		EventTrace.record( TRACE_OUTPUT_CHANGE, iPin, iOutputValue );
+
+	if ( getType() == OBJ_TYPE::TYPE_OUTPUT )
+		digitalWrite(iPin, iOutputValue);
+	else if ( getType() == OBJ_TYPE::TYPE_OUTPUT_PWM )
 		ledcWrite(iPWMChannel, iOutputValue);
-	}
+
 	Ladder_OBJ_Logical::updateObject();
+}
+
+uint16_t OutputOBJ::getOutputValue( bool state )
+{
+	bool level = (state != getLogic()) ? LOW : HIGH;
+	if ( getType() == OBJ_TYPE::TYPE_OUTPUT_PWM )
+		return level ? iDutyCycle : 0; //set as the stored duty cycle
+
+	return level;
+}
+
+void OutputOBJ::holdSafeState()
+{
+	b_holding = true;
+	uint16_t safeValue = getOutputValue( b_safeState );
+	if ( iOutputValue != safeValue )
+		EventTrace.record( TRACE_OUTPUT_CHANGE, iPin, safeValue );
+	iOutputValue = safeValue;
+	if ( !b_attached )
+		return;
+
+	if ( getType() == OBJ_TYPE::TYPE_OUTPUT )
+		digitalWrite(iPin, iOutputValue);
+	else if ( getType() == OBJ_TYPE::TYPE_OUTPUT_PWM )
+		ledcWrite(iPWMChannel, iOutputValue);
 }
\ No newline at end of file
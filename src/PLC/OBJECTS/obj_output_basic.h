@@ -5,21 +5,25 @@
 #include "obj_var.h"
 
 //An output object typically represents a physical pin or boolean, and represents the final logic state on a rung after all other logic operations have been performed. 
+//Outputs created for a script check are not attached, and never drive (or release) their pin.
 class OutputOBJ: public Ladder_OBJ_Logical
 {
 	public:
 	//PWM resolution formula 8*10^6/(2^resolution) = max frequency 
-	OutputOBJ( const String &id, uint8_t pin, OBJ_TYPE type = OBJ_TYPE::TYPE_OUTPUT, uint8_t logic = LOGIC_NO, uint8_t pwm_channel = 0, uint16_t duty_cycle = 0, double pwm_frequency = -1, uint8_t pwm_resolution = 12 ) : Ladder_OBJ_Logical(id, type)
+	OutputOBJ( const String &id, uint8_t pin, OBJ_TYPE type = OBJ_TYPE::TYPE_OUTPUT, uint8_t logic = LOGIC_NO, uint8_t pwm_channel = 0, uint16_t duty_cycle = 0, double pwm_frequency = -1, uint8_t pwm_resolution = 12, bool attach = true ) : Ladder_OBJ_Logical(id, type)
 	{ 
 		iPin = pin; 
+		b_attached = attach;
 		iPWMChannel = pwm_channel;
 		iDutyCycle = duty_cycle;
 		iOutputValue = 0; //by default
-		
+		b_safeState = false; //de-energized
+		b_holding = false;
 
 		if ( type == OBJ_TYPE::TYPE_OUTPUT )
 		{
-			pinMode(pin, OUTPUT); 
+			if ( attach )
+				pinMode(pin, OUTPUT); 
 			getObjectVARs().emplace_back(make_shared<Ladder_VAR>(&iOutputValue, bitTagVAL)); //VAL variable - corresponds to the duty cycle of a PWM output, or a HIGH/LOW signal
 		}
 		else if ( type == OBJ_TYPE::TYPE_OUTPUT_PWM )
@@ -29,8 +33,11 @@ class OutputOBJ: public Ladder_OBJ_Logical
 			if ( pwm_frequency < 0 || pwm_frequency > freq_max )
 				pwm_frequency = freq_max;
 
-			ledcSetup(pwm_channel, pwm_frequency, pwm_resolution); //configure the PWM parameters
-			ledcAttachPin(pin, pwm_channel); //set the IO pin as a PWM output
+			if ( attach )
+			{
+				ledcSetup(pwm_channel, pwm_frequency, pwm_resolution); //configure the PWM parameters
+				ledcAttachPin(pin, pwm_channel); //set the IO pin as a PWM output
+			}
 			getObjectVARs().emplace_back(make_shared<Ladder_VAR>(&iDutyCycle, bitTagVAL)); //VAL variable - corresponds to the duty cycle of a PWM output, or a HIGH/LOW signal
 		}
 
@@ -42,6 +49,9 @@ class OutputOBJ: public Ladder_OBJ_Logical
 		 #ifdef DEBUG 
 		 Serial.println(PSTR("Output Destructor")); 
 		 #endif 
+		 if ( !b_attached ) //the pin belongs to the running program
+			 return;
+
 		 digitalWrite(iPin, LOW);
 
 		 if (getType() == OBJ_TYPE::TYPE_OUTPUT_PWM)
@@ -50,11 +60,22 @@ class OutputOBJ: public Ladder_OBJ_Logical
 
 	virtual void updateObject();
 	uint8_t getOutputPin(){ return iPin; }
+	//Sets the rung state the output falls back to if the scan watchdog trips. The pin follows it through the NO/NC logic, so a de-energized NO output is LOW (duty of 0 for PWM).
+	void setSafeState( bool energized ){ b_safeState = energized; }
+	//Drives the pin to the configured safe state, and keeps it there until released. The rung logic no longer changes the pin.
+	void holdSafeState();
+	void releaseSafeState(){ b_holding = false; }
 	virtual void setLineState(bool &state, bool bNot){ Ladder_OBJ_Logical::setLineState(state, bNot); }
 	
 	private:
+	//Returns the value written to the pin for the given rung state.
+	uint16_t getOutputValue( bool );
+
 	uint8_t iPin,
 			iPWMChannel;
+	bool b_attached; //false for outputs created by a script check
+	bool b_holding, //held at the safe state by the scan watchdog
+		 b_safeState; //rung state applied while held, false (de-energized) unless configured
 
 	uint16_t iOutputValue, //used for both analog and digital outputs.	
 			 iDutyCycle;
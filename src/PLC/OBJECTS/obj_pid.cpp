@@ -0,0 +1,119 @@
+#include "obj_pid.h"
+
+//////////////////////////////////////////////////////////////////////////
+// PID OBJECT BEGIN
+//////////////////////////////////////////////////////////////////////////
+void PIDOBJ::handleSample( void *arg )
+{
+	PIDOBJ *pPID = static_cast<PIDOBJ *>(arg);
+	pPID->compute();
+
+	pPID->i_nextSample += pPID->i_period;
+	if ( pPID->i_nextSample <= pPID->pWheel->getNow() ) //a scan took longer than the sample period, skip ahead rather than running several samples back to back
+	{
+		pPID->i_overruns++;
+		pPID->i_nextSample = pPID->pWheel->getNow() + pPID->i_period;
+	}
+	pPID->pWheel->schedule(&pPID->sampleNode, pPID->i_nextSample);
+}
+
+void PIDOBJ::compute()
+{
+	double pv = pvVar->getValue<double>(),
+		   kp = kpVar->getValue<double>(),
+		   ki = kiVar->getValue<double>(),
+		   kd = kdVar->getValue<double>(),
+		   dt = i_period / 1000000.0;
+
+	dError = spVar->getValue<double>() - pv;
+	double proportional = kp * dError;
+
+	if ( manualBit || !b_initialized ) //track the CV, so switching to auto (or enabling the loop) does not bump the output
+	{
+		dIntegral = cvVar->getValue<double>() - proportional;
+		dLastPV = pv;
+		b_initialized = true;
+		if ( manualBit )
+			return;
+	}
+
+	double derivative = -kd * (pv - dLastPV) / dt;
+	dLastPV = pv;
+
+	//Anti-windup: stop integrating while the output is saturated in the direction the integral would push it.
+	double step = ki * dError * dt,
+		   unclamped = proportional + dIntegral + step + derivative;
+	if ( !( unclamped > dOutMax && step > 0 ) && !( unclamped < dOutMin && step < 0 ) )
+		dIntegral += step;
+
+	double output = proportional + dIntegral + derivative;
+	if ( output > dOutMax )
+		output = dOutMax;
+	else if ( output < dOutMin )
+		output = dOutMin;
+
+	cvVar->setValue(output);
+}
+
+void PIDOBJ::updateObject()
+{
+	bool lineState = getLineState();
+
+	if ( lineState && !sampleNode.isScheduled() ) //start sampling
+	{
+		b_initialized = false;
+		i_nextSample = pWheel->getNow() + i_period;
+		pWheel->schedule(&sampleNode, i_nextSample);
+	}
+	else if ( !lineState && sampleNode.isScheduled() ) //stop sampling, CV holds its last value
+	{
+		pWheel->cancel(&sampleNode);
+	}
+
+	enableBit = lineState;
+	setState(lineState);
+	Ladder_OBJ_Logical::updateObject(); //parent class
+}
+
+shared_ptr<Ladder_VAR> PIDOBJ::getObjectVAR( const String &id )
+{ 
+	if ( id == bitTagPV )
+		return pvVar;
+	else if ( id == bitTagSP )
+		return spVar;
+	else if ( id == bitTagCV )
+		return cvVar;
+	else if ( id == bitTagKP )
+		return kpVar;
+	else if ( id == bitTagKI )
+		return kiVar;
+	else if ( id == bitTagKD )
+		return kdVar;
+
+	shared_ptr<Ladder_VAR> var = Ladder_OBJ_Logical::getObjectVAR(id);
+	if ( !var ) //proceed if it doesn't already exist
+	{
+		if ( id == bitTagEN )
+			var = make_shared<Ladder_VAR>(&enableBit, id);
+		else if ( id == bitTagMAN )
+			var = make_shared<Ladder_VAR>(&manualBit, id);
+		else if ( id == bitTagMIN )
+			var = make_shared<Ladder_VAR>(&dOutMin, id);
+		else if ( id == bitTagMAX )
+			var = make_shared<Ladder_VAR>(&dOutMax, id);
+		else if ( id == bitTagERR )
+			var = make_shared<Ladder_VAR>(&dError, id);
+		else if ( id == bitTagOV )
+			var = make_shared<Ladder_VAR>(&i_overruns, id);
+
+		if ( var )
+		{
+			getObjectVARs().emplace_back(var); //store it off.
+			#ifdef DEBUG 
+			Serial.println(PSTR("Created new PID Object Tag: ") + id ); 
+			#endif
+		}
+	}
+
+	return var;
+}
@@ -0,0 +1,72 @@
+#ifndef PLC_IO_OBJ_PID
+#define PLC_IO_OBJ_PID
+
+#include "../PLC_IO.h"
+#include "../PLC_Timer.h"
+#include "obj_var.h"
+
+#define PID_DEFAULT_PERIOD 100 //sample period (ms)
+#define PID_DEFAULT_MIN 0 //output clamp
+#define PID_DEFAULT_MAX 100 //output clamp
+
+//PID objects perform closed loop control of a process variable (PV) by adjusting a control variable (CV) in order to reach a setpoint (SP).
+//The calculation is performed by the shared timer wheel at a fixed sample period while the rung is enabled, so the loop does not depend on the scan time.
+//PV, SP, CV and the gains may be bound to any variable or object bit, in the same way as math blocks.
+//Output = KP*e + KI*integral(e dt) + KD*d(-PV)/dt. Derivative is taken on the PV so setpoint changes don't kick the output, and integration stops while the output is saturated (anti-windup).
+//Bits that are accessible from a PID: EN (Enabled), MAN (Manual mode - CV is set by the script, loop tracks it for bumpless transfer), PV, SP, CV, KP, KI, KD, MIN, MAX, ERR (last error), OV (Sample overrun count)
+class PIDOBJ : public Ladder_OBJ_Logical
+{
+	public:
+	PIDOBJ(const String &id, PLC_Timer_Wheel *wheel, shared_ptr<Ladder_VAR> pv, shared_ptr<Ladder_VAR> sp, shared_ptr<Ladder_VAR> cv, 
+		   shared_ptr<Ladder_VAR> kp, shared_ptr<Ladder_VAR> ki, shared_ptr<Ladder_VAR> kd, uint32_t period = PID_DEFAULT_PERIOD, 
+		   double outMin = PID_DEFAULT_MIN, double outMax = PID_DEFAULT_MAX, OBJ_TYPE type = OBJ_TYPE::TYPE_PID ) : Ladder_OBJ_Logical(id, type),
+		   sampleNode( handleSample, this )
+	{
+		pWheel = wheel;
+		pvVar = pv; spVar = sp; cvVar = cv;
+		kpVar = kp; kiVar = ki; kdVar = kd;
+		i_period = period * 1000; //uS
+		dOutMin = outMin;
+		dOutMax = outMax;
+		dIntegral = 0;
+		dLastPV = 0;
+		dError = 0;
+		i_nextSample = 0;
+		i_overruns = 0;
+		enableBit = false;
+		manualBit = false;
+		b_initialized = false;
+	}
+	~PIDOBJ()
+	{
+		pWheel->cancel(&sampleNode);
+	}
+
+	virtual void setLineState(bool &state, bool bNot){ Ladder_OBJ_Logical::setLineState(state, bNot); }
+	virtual void updateObject();
+	virtual shared_ptr<Ladder_VAR> getObjectVAR( const String &id );
+
+	private:
+	//Called by the timer wheel once per sample period.
+	static void handleSample( void * );
+	//Performs a single PID calculation using a fixed time step of one sample period.
+	void compute();
+
+	PLC_Timer_Wheel *pWheel;
+	Timer_Wheel_Node sampleNode;
+	int64_t i_nextSample; //time (uS) of the next sample, advanced by a whole period each time so the rate does not drift
+	uint32_t i_period; //sample period (uS)
+	uint_fast32_t i_overruns; //number of samples that were skipped due to long scans
+
+	shared_ptr<Ladder_VAR> pvVar, spVar, cvVar, 
+						   kpVar, kiVar, kdVar;
+	double dOutMin, dOutMax, 
+		   dIntegral, //integral term, in output units
+		   dLastPV, //PV at the last sample, for the derivative term
+		   dError; //error at the last sample
+	bool enableBit, 
+		 manualBit,
+		 b_initialized; //integral and derivative terms have been initialized from the current CV/PV
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "obj_schedule.h"
+
+//////////////////////////////////////////////////////////////////////////
+// SCHEDULE OBJECT BEGIN
+//////////////////////////////////////////////////////////////////////////
+//Converts a HHMM string into minutes of the day. Returns false if the format is invalid. 2400 is allowed for windows that close at midnight.
+static bool parseHHMM( const String &str, uint16_t &minutes )
+{
+	if ( str.length() != 4 )
+		return false;
+
+	for ( uint8_t x = 0; x < 4; x++ )
+	{
+		if ( !isdigit(str[x]) )
+			return false;
+	}
+
+	uint16_t value = str.toInt();
+	if ( value % 100 >= 60 || value > 2400 )
+		return false;
+
+	minutes = (value / 100) * 60 + value % 100;
+	return true;
+}
+
+bool ScheduleOBJ::parseWindow( const String &str, Schedule_Window &window )
+{
+	static const char dayChars[] = { 'U', 'M', 'T', 'W', 'R', 'F', 'S' }; //indexed by day of the week (0 = Sunday)
+	vector<String> parts = splitString( str, SCHEDULE_WINDOW_SPLIT );
+	uint8_t numParts = parts.size();
+
+	if ( numParts < 2 || numParts > 3 )
+		return false;
+
+	window.i_days = SCHEDULE_DAYS_ALL; //default to daily
+	if ( numParts == 3 ) //days of the week were given
+	{
+		window.i_days = 0;
+		for ( uint8_t x = 0; x < parts[0].length(); x++ )
+		{
+			uint8_t day = 0;
+			while ( day < sizeof(dayChars) && dayChars[day] != parts[0][x] )
+				day++;
+
+			if ( day >= sizeof(dayChars) )
+				return false; //unknown day
+
+			window.i_days |= 1 << day;
+		}
+	}
+
+	if ( !parseHHMM( parts[numParts - 2], window.i_start ) || !parseHHMM( parts[numParts - 1], window.i_end ) || window.i_start >= 24*60 )
+		return false;
+
+	return window.i_start != window.i_end && window.i_days; //must open for some amount of time
+}
+
+void ScheduleOBJ::evaluate( uint32_t now )
+{
+	uint32_t today = now / SEC_PER_DAY;
+	bool active = false;
+	uint32_t next = UINT32_MAX;
+
+	for ( uint8_t x = 0; x < windows.size(); x++ )
+	{
+		const Schedule_Window &window = windows[x];
+		uint32_t length = ( window.i_end > window.i_start ? window.i_end - window.i_start : window.i_end + 24*60 - window.i_start ) * 60;
+
+		for ( int8_t d = -1; d <= 7; d++ ) //yesterday (windows that run past midnight) through the same day next week
+		{
+			uint32_t day = today + d;
+			if ( !( window.i_days & ( 1 << ((day + 4) % 7) ) ) ) //1970-01-01 was a Thursday
+				continue;
+
+			uint32_t open = day * SEC_PER_DAY + window.i_start * 60,
+					 close = open + length;
+
+			if ( open <= now && now < close )
+				active = true;
+
+			if ( open > now && open < next )
+				next = open;
+			if ( close > now && close < next )
+				next = close;
+		}
+	}
+
+	enableBit = active;
+	i_nextTransition = next;
+	i_lastEvaluation = now;
+}
+
+void ScheduleOBJ::setLineState( bool &state, bool bNot )
+{
+	if ( state && enableBit == bNot ) //schedule acts as a contact
+		state = false;
+
+	Ladder_OBJ_Logical::setLineState(state, bNot);
+}
+
+void ScheduleOBJ::updateObject()
+{
+	uint32_t now = pClock->GetEpoch();
+	if ( now >= i_nextTransition || now < i_lastEvaluation ) //reached the next transition, or the clock was set backwards
+		evaluate( now );
+
+	setState( enableBit );
+	Ladder_OBJ_Logical::updateObject(); //parent class
+}
+
+shared_ptr<Ladder_VAR> ScheduleOBJ::getObjectVAR( const String &id )
+{ 
+	shared_ptr<Ladder_VAR> var = Ladder_OBJ_Logical::getObjectVAR(id);
+	if ( !var ) //proceed if it doesn't already exist
+	{
+		if ( id == bitTagEN )
+			var = make_shared<Ladder_VAR>(&enableBit, id);
+
+		if ( var )
+		{
+			getObjectVARs().emplace_back(var); //store it off.
+			#ifdef DEBUG 
+			Serial.println(PSTR("Created new Schedule Object Tag: ") + id ); 
+			#endif
+		}
+	}
+
+	return var;
+}
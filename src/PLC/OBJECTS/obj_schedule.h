@@ -0,0 +1,55 @@
+#ifndef PLC_IO_OBJ_SCHEDULE
+#define PLC_IO_OBJ_SCHEDULE
+
+#include "../PLC_IO.h"
+#include "../../CORE/Time.h"
+#include "obj_var.h"
+
+#define SCHEDULE_DAYS_ALL 0x7F //all days of the week (bit 0 = Sunday)
+#define SCHEDULE_WINDOW_SPLIT '-' //EX: MTWRF-0600-1800
+
+//A single time window within a schedule. Windows that end before they start run past midnight into the next day.
+struct Schedule_Window
+{
+	uint16_t i_start, //minute of the day that the window opens
+			 i_end; //minute of the day that the window closes
+	uint8_t i_days; //days of the week that the window opens on (bit 0 = Sunday)
+};
+
+//Schedule objects are active (EN) while the clock is within any of their time windows. EX: MTWRF-0600-1800 runs weekdays from 06:00 to 18:00.
+//The next transition time is calculated once, so the schedule is only evaluated again when the clock reaches it (or is set backwards).
+//Bits that are accessible from a schedule: EN (Enabled - within a window)
+class ScheduleOBJ : public Ladder_OBJ_Logical
+{
+	public:
+	ScheduleOBJ(const String &id, Time *clock, const vector<Schedule_Window> &windowList, OBJ_TYPE type = OBJ_TYPE::TYPE_SCHEDULE) : Ladder_OBJ_Logical(id, type)
+	{
+		pClock = clock;
+		windows = windowList;
+		enableBit = false;
+		i_nextTransition = 0; //evaluate on the first scan
+		i_lastEvaluation = 0;
+	}
+	~ScheduleOBJ(){ windows.clear(); }
+
+	virtual void setLineState(bool &, bool);
+	virtual void updateObject();
+	virtual shared_ptr<Ladder_VAR> getObjectVAR( const String &id );
+
+	//Parses a window from the script. Format: [DAYS-]HHMM-HHMM, where days are any of M T W R F S U (Monday - Sunday). Returns false if the format is invalid.
+	static bool parseWindow( const String &, Schedule_Window & );
+	//Returns the time (seconds since epoch) of the next window opening or closing after the inputted time.
+	uint32_t getNextTransition(){ return i_nextTransition; }
+
+	private:
+	//Determines whether or not the inputted time is within a window, and calculates the next transition time.
+	void evaluate( uint32_t );
+
+	Time *pClock;
+	vector<Schedule_Window> windows;
+	uint32_t i_nextTransition, //time (seconds since epoch) that the schedule must be evaluated again
+			 i_lastEvaluation; //time of the last evaluation, to detect the clock being set backwards
+	bool enableBit;
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include "obj_sequencer.h"
+
+//////////////////////////////////////////////////////////////////////////
+// SEQUENCER OBJECT BEGIN
+//////////////////////////////////////////////////////////////////////////
+SequencerOBJ::SequencerOBJ(const String &id, PLC_Timer_Wheel *wheel, const vector<Sequencer_Step> &stepList, shared_ptr<Ladder_VAR> dest, OBJ_TYPE type ) : Ladder_OBJ_Logical(id, type)
+{
+	steps = stepList;
+	steps.shrink_to_fit(); //the step table is never resized, so the step bits can point into it
+	pWheel = wheel;
+	destVar = dest;
+	iTimeStart = 0;
+	iBaseAccum = 0;
+	i_step = 0;
+	i_accum = 0;
+	i_jumpRequest = -1;
+	enableBit = false;
+	doneBit = false;
+	b_running = false;
+	b_accUsed = false;
+
+	if ( !destVar ) //no destination given, so create one to hold the current mask
+		destVar = make_shared<Ladder_VAR>( static_cast<uint_fast32_t>(0), bitTagDEST );
+	getObjectVARs().emplace_back(destVar);
+
+	enterStep(0, 0);
+}
+
+void SequencerOBJ::enterStep( uint16_t step, int64_t now )
+{
+	steps[i_step].b_active = false;
+	i_step = step;
+	i_publishedStep = step;
+
+	Sequencer_Step &current = steps[step];
+	current.b_active = true;
+	i_preset = current.i_preset;
+	iBaseAccum = 0;
+	iTimeStart = now;
+
+	for ( uint8_t x = 0; x < SEQ_MASK_BITS; x++ )
+		maskBits[x] = current.i_mask & (1UL << x);
+	destVar->setValue( static_cast<uint_fast32_t>(current.i_mask) );
+}
+
+void SequencerOBJ::jump( uint_fast32_t step, int64_t now )
+{
+	i_step = i_publishedStep; //undoes a write to STEP, so the step being left is the one marked inactive
+	if ( step >= steps.size() ) //an invalid step is ignored
+		return;
+
+	doneBit = false;
+	enterStep(step, now);
+}
+
+void SequencerOBJ::updateObject()
+{
+	bool lineState = getLineState();
+	int64_t now = pWheel->getNow(); //sampled once at the start of the scan
+
+	if ( i_jumpRequest >= 0 ) //JMP was written by the script, any write restarts the step. A jump request takes priority over a write to STEP in the same scan.
+	{
+		jump(i_jumpRequest, now);
+		i_jumpRequest = -1;
+	}
+	else if ( i_step != i_publishedStep ) //STEP was written by the script
+		jump(i_step, now);
+
+	if ( lineState )
+	{
+		if ( !b_running ) //starting or resuming, the time already spent in the step is kept in iBaseAccum
+		{
+			iTimeStart = now;
+			b_running = true;
+		}
+
+		Sequencer_Step &current = steps[i_step];
+		int64_t elapsed = getElapsed(now);
+		if ( !doneBit && elapsed >= static_cast<int64_t>(current.i_preset) * 1000 && ( !current.condition || current.condition->evaluate() ) )
+		{
+			current.i_time = elapsed / 1000;
+			if ( current.i_next == SEQ_DONE )
+			{
+				iBaseAccum = elapsed; //hold the time on the last step
+				doneBit = true;
+			}
+			else
+				enterStep(current.i_next, now);
+		}
+	}
+	else if ( b_running ) //paused, keep the current step and its time
+	{
+		iBaseAccum = getElapsed(now);
+		b_running = false;
+	}
+
+	if ( b_accUsed ) //only calculate the accumulator if something can read it
+		i_accum = getElapsed(now) / 1000;
+
+	enableBit = lineState;
+	Ladder_OBJ_Logical::updateObject();
+}
+
+shared_ptr<Ladder_VAR> SequencerOBJ::getObjectVAR( const String &id )
+{
+	shared_ptr<Ladder_VAR> var = Ladder_OBJ_Logical::getObjectVAR(id);
+	if ( !var ) //proceed if it doesn't already exist
+	{
+		if ( id == bitTagEN )
+			var = make_shared<Ladder_VAR>(&enableBit, id);
+		else if ( id == bitTagDN )
+			var = make_shared<Ladder_VAR>(&doneBit, id);
+		else if ( id == bitTagSTEP )
+			var = make_shared<Ladder_VAR>(&i_step, id);
+		else if ( id == bitTagJMP )
+			var = make_shared<Ladder_VAR>(&i_jumpRequest, id);
+		else if ( id == bitTagPRE )
+			var = make_shared<Ladder_VAR>(&i_preset, id);
+		else if ( id == bitTagACC )
+		{
+			b_accUsed = true;
+			var = make_shared<Ladder_VAR>(&i_accum, id);
+		}
+		else if ( strDataType(id) == 1 ) //step active bit
+		{
+			int64_t step = parseInt(id);
+			if ( step < 0 || static_cast<uint64_t>(step) >= steps.size() || id != String(static_cast<uint32_t>(step)) ) //only the plain step number, so "03" doesn't make a second tag
+				return 0;
+
+			var = make_shared<Ladder_VAR>(&steps[step].b_active, id);
+		}
+		else if ( id.length() > 1 && ( id[0] == 'B' || id[0] == 'T' ) && strDataType(id.substring(1)) == 1 ) //mask bit or step time
+		{
+			int64_t index = parseInt(id.substring(1));
+			if ( id[0] == 'B' && index >= 0 && index < SEQ_MASK_BITS )
+				var = make_shared<Ladder_VAR>(&maskBits[index], id);
+			else if ( id[0] == 'T' && index >= 0 && static_cast<uint64_t>(index) < steps.size() )
+				var = make_shared<Ladder_VAR>(&steps[index].i_time, id);
+		}
+
+		if ( var )
+		{
+			#ifdef DEBUG
+			Serial.println(PSTR("Created new Sequencer Object Tag: ") + id );
+			#endif
+			getObjectVARs().emplace_back(var);
+		}
+	}
+
+	return var;
+}
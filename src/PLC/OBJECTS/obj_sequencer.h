@@ -0,0 +1,68 @@
+#ifndef PLC_IO_OBJ_SEQUENCER
+#define PLC_IO_OBJ_SEQUENCER
+
+#include "../PLC_IO.h"
+#include "../PLC_Timer.h"
+#include "obj_var.h"
+#include "MATH/obj_math_cpt.h"
+
+#define SEQ_MAX_STEPS 1024 //maximum number of steps in a single sequencer
+#define SEQ_MASK_BITS 32 //number of output bits per step
+#define SEQ_DONE 0xFFFF //next step value that completes the sequence
+
+//A single sequencer step, built by the script parser.
+struct Sequencer_Step
+{
+	uint32_t i_mask; //output bits written to DEST while the step is active
+	uint_fast32_t i_preset, //time (mS) that must be spent in the step before its transition can fire
+				  i_time; //duration (mS) of the last completed pass through the step (Tn)
+	uint16_t i_next; //step that is entered when the transition fires
+	bool b_active; //the step is the current step
+	shared_ptr<ComputeBlockOBJ> condition; //transition condition (compiled expression), null if the step only waits for its preset
+};
+
+//Sequencer objects step a process through numbered steps, replacing rungs that compare a step number against every step each scan.
+//EX: SQ1[SEQ,VALVES,1:0:START,6:5000,12:0:TANK.EU>=80,0:2000:0]
+//Each step is MASK:TIME[:NEXT][:CONDITION]. The transition fires once TIME (mS) has passed in the step and the condition (if any) is nonzero, then NEXT is entered.
+//NEXT defaults to the following step, the last step completes the sequence (DN) unless given a NEXT. Conditions are compute expressions, where * is AND and + is OR on bits.
+//Only the current step is looked at each scan (the step number indexes straight into the step table), so the scan cost doesn't grow with the number of steps.
+//The sequence runs while the rung is true, and holds the current step and its time while false. Writing a step number to JMP (EX: MOV 0 to SQ1.JMP) enters that step
+//on the next update, restarting its time and clearing DN, even if it is already the current step. Writing a different step number to STEP does the same, but
+//writing the current step number to STEP can't be told apart from no write and does nothing. JMP reads as -1 while no jump is pending.
+//Bits that are accessible from a sequencer: EN (Enabled), DN (Done), STEP (Current step), JMP (Jump request), ACC (mS in current step), PRE (Current step TIME), DEST (Current step MASK),
+//n (Step n is active), Bn (Bit n of the current MASK), Tn (mS spent in step n on its last pass)
+class SequencerOBJ : public Ladder_OBJ_Logical
+{
+	public:
+	SequencerOBJ(const String &id, PLC_Timer_Wheel *wheel, const vector<Sequencer_Step> &stepList, shared_ptr<Ladder_VAR> dest = 0, OBJ_TYPE type = OBJ_TYPE::TYPE_SEQUENCER );
+	~SequencerOBJ(){}
+
+	virtual void setLineState(bool &state, bool bNot){ Ladder_OBJ_Logical::setLineState(state, bNot); }
+	virtual void updateObject();
+	virtual shared_ptr<Ladder_VAR> getObjectVAR( const String & );
+
+	private:
+	//Makes the given step the current step, restarting its time and clearing DN. Handles writes to JMP and STEP, an invalid step leaves the current step as it was.
+	//Args: <Step>, <Time at the start of the scan (uS)>
+	void jump( uint_fast32_t, int64_t );
+	//Sets the given step as the current step and publishes its outputs.
+	void enterStep( uint16_t, int64_t );
+	//Returns the time (uS) spent in the current step.
+	int64_t getElapsed( int64_t now ){ return ( b_running && !doneBit ) ? iBaseAccum + (now - iTimeStart) : iBaseAccum; }
+
+	vector<Sequencer_Step> steps; //indexed by step number
+	shared_ptr<Ladder_VAR> destVar;
+	PLC_Timer_Wheel *pWheel;
+	int64_t iTimeStart, //start of the current timing run (uS)
+			iBaseAccum; //time spent in the step before the current timing run (uS)
+	uint_fast32_t i_step,
+				  i_publishedStep, //last value written to i_step, used to detect writes to STEP from the script
+				  i_accum, i_preset;
+	int_fast32_t i_jumpRequest; //step written to JMP, -1 if no jump is pending
+	bool maskBits[SEQ_MASK_BITS];
+	bool enableBit, doneBit,
+		 b_running, //the step time is accumulating
+		 b_accUsed; //ACC has been referenced, so it needs to be kept up to date
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "obj_shift.h"
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////
+// SHIFT REGISTER OBJECT BEGIN
+//////////////////////////////////////////////////////////////////////////
+ShiftRegisterOBJ::ShiftRegisterOBJ(const String &id, shared_ptr<Ladder_VAR> bit, uint32_t length, OBJ_TYPE type ) : Ladder_OBJ_Logical(id, type)
+{
+	bitVar = bit;
+	i_length = length;
+	i_head = 0;
+	enableBit = false;
+	unloadBit = false;
+	bits.resize( ( length + 31 ) / 32, 0 );
+}
+
+void ShiftRegisterOBJ::shift()
+{
+	uint32_t inPos;
+	if ( getType() == OBJ_TYPE::TYPE_SHIFT_RIGHT )
+	{
+		unloadBit = getBit(0);
+		inPos = i_length - 1;
+		if ( ++i_head >= i_length )
+			i_head = 0;
+	}
+	else
+	{
+		unloadBit = getBit(i_length - 1);
+		inPos = 0;
+		i_head = i_head ? i_head - 1 : i_length - 1;
+	}
+
+	uint32_t index = i_head + inPos; //the slot that was just shifted out is reused for the new bit
+	if ( index >= i_length )
+		index -= i_length;
+	setBitAt( index, bitVar->getValue<bool>() );
+
+	for ( uint16_t x = 0; x < taps.size(); x++ )
+		taps[x].var->setValue( getBit(taps[x].i_pos) );
+}
+
+void ShiftRegisterOBJ::reset()
+{
+	fill( bits.begin(), bits.end(), 0 );
+	i_head = 0;
+	unloadBit = false;
+
+	for ( uint16_t x = 0; x < taps.size(); x++ )
+		taps[x].var->setValue(false);
+}
+
+void ShiftRegisterOBJ::updateObject()
+{
+	bool lineState = getLineState();
+	if ( lineState && !enableBit ) //shift on the rising edge only
+		shift();
+
+	enableBit = lineState;
+	Ladder_OBJ_Logical::updateObject();
+}
+
+shared_ptr<Ladder_VAR> ShiftRegisterOBJ::getObjectVAR( const String &id )
+{
+	shared_ptr<Ladder_VAR> var = Ladder_OBJ_Logical::getObjectVAR(id);
+	if ( !var ) //proceed if it doesn't already exist
+	{
+		if ( id == bitTagEN )
+			var = make_shared<Ladder_VAR>(&enableBit, id);
+		else if ( id == bitTagUL )
+			var = make_shared<Ladder_VAR>(&unloadBit, id);
+		else if ( id == bitTagLEN )
+			var = make_shared<Ladder_VAR>( static_cast<uint_fast32_t>(i_length), id );
+		else if ( strDataType(id) == 1 ) //register position
+		{
+			int64_t pos = parseInt(id);
+			if ( pos < 0 || pos >= i_length )
+				return 0;
+
+			String posID = String(static_cast<uint32_t>(pos)); //normalize the ID, so "03" and "3" share a variable
+			var = Ladder_OBJ_Logical::getObjectVAR(posID);
+			if ( var )
+				return var;
+
+			var = make_shared<Ladder_VAR>( getBit(pos), posID ); //a copy of the bit, so the storage can rotate underneath it
+			Shift_Tap tap = { static_cast<uint32_t>(pos), var };
+			taps.push_back(tap);
+		}
+
+		if ( var )
+		{
+			#ifdef DEBUG
+			Serial.println(PSTR("Created new Shift Register Object Tag: ") + id );
+			#endif
+			getObjectVARs().emplace_back(var);
+		}
+	}
+
+	return var;
+}
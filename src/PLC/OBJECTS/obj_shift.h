@@ -0,0 +1,55 @@
+#ifndef PLC_IO_OBJ_SHIFT
+#define PLC_IO_OBJ_SHIFT
+
+#include "../PLC_IO.h"
+#include "obj_var.h"
+
+#define SHIFT_MAX_LENGTH 65536 //maximum number of bits in a single shift register
+
+//Bit shift register objects shift a line of bits by one position on each rising edge of the rung, for tracking parts along a conveyor.
+//BSL shifts toward higher positions (the BIT input enters at position 0), BSR shifts toward position 0 (the BIT input enters at LEN-1). The bit shifted out is stored in UL.
+//The bits are packed in a ring buffer and a shift only moves the start position, so a shift costs the same regardless of the length.
+//Positions are read with the var operator (SR.12), only the positions referenced by the script are updated after each shift. Positions are read only.
+//Bits that are accessible from a shift register: EN (Enabled), UL (Unload bit), LEN (Length), 0..LEN-1 (Register positions)
+class ShiftRegisterOBJ : public Ladder_OBJ_Logical
+{
+	public:
+	ShiftRegisterOBJ(const String &id, shared_ptr<Ladder_VAR> bit, uint32_t length, OBJ_TYPE type = OBJ_TYPE::TYPE_SHIFT_LEFT );
+	~ShiftRegisterOBJ(){}
+
+	virtual void setLineState(bool &state, bool bNot){ Ladder_OBJ_Logical::setLineState(state, bNot); }
+	virtual void updateObject();
+	virtual shared_ptr<Ladder_VAR> getObjectVAR( const String & );
+
+	//Shifts the register by one position, inserting the current BIT value.
+	void shift();
+	//Returns the bit stored at the given register position.
+	bool getBit( uint32_t pos )
+	{
+		uint32_t index = i_head + pos;
+		if ( index >= i_length )
+			index -= i_length;
+		return bits[index >> 5] & (1UL << (index & 31));
+	}
+	//Clears every bit in the register.
+	void reset();
+
+	private:
+	void setBitAt( uint32_t index, bool val ){ if ( val ) bits[index >> 5] |= (1UL << (index & 31)); else bits[index >> 5] &= ~(1UL << (index & 31)); }
+
+	//Position variables that have been referenced by the script, refreshed after each shift.
+	struct Shift_Tap
+	{
+		uint32_t i_pos;
+		shared_ptr<Ladder_VAR> var;
+	};
+
+	vector<uint32_t> bits; //packed register storage
+	vector<Shift_Tap> taps;
+	shared_ptr<Ladder_VAR> bitVar;
+	uint32_t i_length,
+			 i_head; //storage index of position 0
+	bool enableBit, unloadBit;
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include "obj_stack.h"
+
+//////////////////////////////////////////////////////////////////////////
+// STACK OBJECT BEGIN
+//////////////////////////////////////////////////////////////////////////
+StackOBJ::StackOBJ(const String &id, shared_ptr<Ladder_VAR> src, uint32_t depth, shared_ptr<Ladder_VAR> dest, OBJ_TYPE type ) : Ladder_OBJ_Logical(id, type),
+	storage( id, Ladder_Array::getStorageType(src->getType()), depth )
+{
+	sourceVar = src;
+	destVar = dest;
+	i_head = 0;
+	i_count = 0;
+	enableBit = false;
+	updateStatus();
+
+	if ( !destVar ) //no destination given, so create one that matches the stored values
+	{
+		if ( storage.getElementType() == OBJ_TYPE::TYPE_VAR_FLOAT )
+			destVar = make_shared<Ladder_VAR>( static_cast<double>(0), bitTagDEST );
+		else
+			destVar = make_shared<Ladder_VAR>( static_cast<int64_t>(0), bitTagDEST );
+	}
+	getObjectVARs().emplace_back(destVar);
+}
+
+bool StackOBJ::load()
+{
+	uint_fast32_t depth = storage.getLength();
+	if ( i_count >= depth )
+		return false;
+
+	uint_fast32_t tail = i_head + i_count;
+	if ( tail >= depth )
+		tail -= depth;
+
+	storage.setElement( tail, *sourceVar );
+	i_count++;
+	updateStatus();
+	return true;
+}
+
+bool StackOBJ::unload()
+{
+	if ( !i_count )
+		return false;
+
+	i_count--;
+	if ( getType() == OBJ_TYPE::TYPE_LIFO ) //newest value sits at the tail
+	{
+		uint_fast32_t tail = i_head + i_count;
+		if ( tail >= storage.getLength() )
+			tail -= storage.getLength();
+
+		storage.getElement( tail, *destVar );
+	}
+	else
+	{
+		storage.getElement( i_head, *destVar );
+		if ( ++i_head >= storage.getLength() )
+			i_head = 0;
+	}
+
+	updateStatus();
+	return true;
+}
+
+void StackOBJ::updateObject()
+{
+	bool lineState = getLineState();
+	if ( i_count > storage.getLength() ) //POS may be written by the script (EX: MOV 0 to clear the stack), keep it within the depth
+		i_count = storage.getLength();
+
+	if ( lineState && !enableBit ) //load on the rising edge only
+		load();
+
+	updateStatus();
+	enableBit = lineState;
+	Ladder_OBJ_Logical::updateObject();
+}
+
+shared_ptr<Ladder_VAR> StackOBJ::getObjectVAR( const String &id )
+{
+	shared_ptr<Ladder_VAR> var = Ladder_OBJ_Logical::getObjectVAR(id);
+	if ( !var ) //proceed if it doesn't already exist
+	{
+		if ( id == bitTagEN )
+			var = make_shared<Ladder_VAR>(&enableBit, id);
+		else if ( id == bitTagEM )
+			var = make_shared<Ladder_VAR>(&emptyBit, id);
+		else if ( id == bitTagFL )
+			var = make_shared<Ladder_VAR>(&fullBit, id);
+		else if ( id == bitTagPOS )
+			var = make_shared<Ladder_VAR>(&i_count, id);
+		else if ( id == bitTagLEN )
+			var = make_shared<Ladder_VAR>( static_cast<uint_fast32_t>(storage.getLength()), id );
+
+		if ( var )
+		{
+			#ifdef DEBUG
+			Serial.println(PSTR("Created new Stack Object Tag: ") + id );
+			#endif
+			getObjectVARs().emplace_back(var);
+		}
+	}
+
+	return var;
+}
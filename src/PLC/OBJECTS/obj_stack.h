@@ -0,0 +1,67 @@
+#ifndef PLC_IO_OBJ_STACK
+#define PLC_IO_OBJ_STACK
+
+#include "../PLC_IO.h"
+#include "obj_var.h"
+#include "obj_array.h"
+
+//Stack objects hold a fixed number of values in a preallocated ring buffer, for tracking parts or recipes as they move through a process.
+//A rising edge on the rung loads the SRC value. Values are removed by an unload object that references the stack. FIFO unloads the oldest value, LIFO the newest.
+//Loading and unloading only move the head/tail positions, so the cost per scan doesn't depend on the depth. Loads are ignored while full, unloads while empty.
+//Bits that are accessible from a stack: EN (Enabled), EM (Empty), FL (Full), POS (Number of stored values), LEN (Depth), DEST (Last unloaded value)
+class StackOBJ : public Ladder_OBJ_Logical
+{
+	public:
+	StackOBJ(const String &id, shared_ptr<Ladder_VAR> src, uint32_t depth, shared_ptr<Ladder_VAR> dest = 0, OBJ_TYPE type = OBJ_TYPE::TYPE_FIFO );
+	~StackOBJ(){}
+
+	virtual void setLineState(bool &state, bool bNot){ Ladder_OBJ_Logical::setLineState(state, bNot); }
+	virtual void updateObject();
+	virtual shared_ptr<Ladder_VAR> getObjectVAR( const String & );
+
+	//Stores the current SRC value. Returns false if the stack is full.
+	bool load();
+	//Moves the next value (oldest for FIFO, newest for LIFO) into DEST. Returns false if the stack is empty.
+	bool unload();
+	//Discards all stored values.
+	void reset(){ i_head = 0; i_count = 0; updateStatus(); }
+
+	private:
+	void updateStatus(){ emptyBit = !i_count; fullBit = ( i_count == storage.getLength() ); }
+
+	Ladder_Array storage; //ring buffer, elements are the same type as SRC
+	shared_ptr<Ladder_VAR> sourceVar, destVar;
+	uint_fast32_t i_head, //storage index of the oldest value
+				  i_count; //number of stored values (POS)
+	bool enableBit, emptyBit, fullBit;
+};
+
+//Unload objects remove one value from the referenced stack on each rising edge of the rung. All of the stack's bits are accessible through the unload object.
+class StackUnloadOBJ : public Ladder_OBJ_Logical
+{
+	public:
+	StackUnloadOBJ(const String &id, shared_ptr<StackOBJ> stack, OBJ_TYPE type = OBJ_TYPE::TYPE_STACK_UNLOAD ) : Ladder_OBJ_Logical(id, type)
+	{
+		pStack = stack;
+		b_lastState = false;
+	}
+	~StackUnloadOBJ(){}
+
+	virtual void setLineState(bool &state, bool bNot){ Ladder_OBJ_Logical::setLineState(state, bNot); }
+	virtual void updateObject()
+	{
+		bool lineState = getLineState();
+		if ( lineState && !b_lastState )
+			pStack->unload();
+
+		b_lastState = lineState;
+		Ladder_OBJ_Logical::updateObject();
+	}
+	virtual shared_ptr<Ladder_VAR> getObjectVAR( const String &id ){ return pStack->getObjectVAR(id); }
+
+	private:
+	shared_ptr<StackOBJ> pStack;
+	bool b_lastState;
+};
+
+#endif
@@ -3,32 +3,66 @@
 //////////////////////////////////////////////////////////////////////////
 // TIMER OBJECT BEGIN
 //////////////////////////////////////////////////////////////////////////
+void TimerOBJ::handleExpired( void *arg )
+{
+	TimerOBJ *pTimer = static_cast<TimerOBJ *>(arg);
+	pTimer->doneBit = true;
+	pTimer->ttBit = false;
+	pTimer->iBaseAccum = static_cast<int64_t>(pTimer->lDelay) * pTimer->iTimeBase; //accumulator holds at the preset once done
+}
+
+void TimerOBJ::startTiming( int64_t now )
+{
+	ttBit = true;
+	iTimeStart = now;
+	lScheduledDelay = lDelay;
+	pWheel->schedule(&wheelNode, now + static_cast<int64_t>(lDelay) * iTimeBase - iBaseAccum);
+}
+
 void TimerOBJ::updateObject()
 {	
 	bool lineState = getLineState();
-	if ( (lineState && getType() == OBJ_TYPE::TYPE_TIMER_ON) || (!lineState && getType() == OBJ_TYPE::TYPE_TIMER_OFF) )  //Is the pathway to this timer active?
+	int64_t now = pWheel->getNow(); //sampled once at the start of the scan
+
+	if ( b_accUsed && lAccum != lPublishedAccum ) //ACC was written by the script (EX: MOV 0 to reset a retentive timer)
 	{
-		uint32_t currentTime = millis();
-		if ( enableBit != lineState && !ttBit ) //not already counting
-		{
-			ttBit = true;
-			timeStart = currentTime;
-		}
-		if (lAccum >= lDelay )
+		iBaseAccum = static_cast<int64_t>(lAccum) * iTimeBase;
+		if ( lAccum < lDelay )
+			doneBit = false;
+		if ( ttBit )
+			startTiming(now);
+	}
+
+	if ( (lineState && getType() != OBJ_TYPE::TYPE_TIMER_OFF) || (!lineState && getType() == OBJ_TYPE::TYPE_TIMER_OFF) )  //Is the pathway to this timer active?
+	{
+		if ( !ttBit && !doneBit ) //not already counting
+			startTiming(now);
+		else if ( ttBit && lDelay != lScheduledDelay ) //preset was changed while timing
 		{
-			doneBit = true;
-			ttBit = false;
-			lAccum = 0; //empty the accumulator
+			iBaseAccum = getElapsed(now);
+			startTiming(now);
 		}
-		else
-			lAccum = currentTime - timeStart; //update the accumulator
 	}
 	else //reset the timer 
 	{
-		ttBit = false; //timer no longer counting
-		timeStart = 0;
+		if ( ttBit )
+		{
+			pWheel->cancel(&wheelNode);
+			if ( getType() == OBJ_TYPE::TYPE_TIMER_RET ) //retain the time accumulated so far
+				iBaseAccum = getElapsed(now);
+			ttBit = false; //timer no longer counting
+		}
 		if ( getType() != OBJ_TYPE::TYPE_TIMER_RET) //Don't reset done bit for retentive timer. Must be done manually with reset coil 
+		{
 			doneBit = false;
+			iBaseAccum = 0;
+		}
+	}
+
+	if ( b_accUsed ) //only calculate the accumulator if something can read it
+	{
+		lAccum = getElapsed(now) / iTimeBase;
+		lPublishedAccum = lAccum;
 	}
 	
 	enableBit = lineState; //enable bit always matches line state. Set last.
@@ -51,7 +85,10 @@ shared_ptr<Ladder_VAR> TimerOBJ::getObjectVAR( const String &id )
         else if ( id == bitTagTT )
             var = make_shared<Ladder_VAR>(&ttBit, id);
         else if ( id == bitTagACC)
+        {
             var = make_shared<Ladder_VAR>(&lAccum, id);
+            b_accUsed = true; //ACC must now be calculated each scan
+        }
 
         if ( var )
         {
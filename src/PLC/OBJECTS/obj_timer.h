@@ -2,39 +2,67 @@
 #define PLC_IO_OBJ_TIMER
 
 #include "../PLC_IO.h"
+#include "../PLC_Timer.h"
 #include "obj_var.h"
 
-//Timer objects use the system clock to perform a logic operation based on a given action delay.
+#define TIMER_BASE_MS 1000 //PRE/ACC are in milliseconds (default)
+#define TIMER_BASE_US 1 //PRE/ACC are in microseconds
+
+//Timer objects use the shared timer wheel to perform a logic operation based on a given action delay.
+//The timer is only touched by the wheel when it expires, and the accumulator is only calculated if the ACC tag is referenced by the script.
 //Bits that are accessible from a timer: TT (Timer Timing), EN (Enabled), DN (Done), ACC (Accumulator), PRE (Preset)
 class TimerOBJ : public Ladder_OBJ_Logical
 {
 	public:
-	TimerOBJ(const String &id, uint_fast32_t delay, uint_fast32_t accum = 0, OBJ_TYPE type = OBJ_TYPE::TYPE_TIMER_ON) : Ladder_OBJ_Logical(id, type)
+	TimerOBJ(const String &id, PLC_Timer_Wheel *wheel, uint_fast32_t delay, uint_fast32_t accum = 0, OBJ_TYPE type = OBJ_TYPE::TYPE_TIMER_ON, uint16_t timeBase = TIMER_BASE_MS) : Ladder_OBJ_Logical(id, type),
+		wheelNode( handleExpired, this )
 	{ 
 		//Defaults
 		ttBit = false;
 		enableBit = false;
 		doneBit = false;
+		b_accUsed = false;
+		pWheel = wheel;
+		iTimeBase = timeBase;
 		lDelay = delay;  
 		lAccum = accum; 
+		lPublishedAccum = accum;
+		lScheduledDelay = delay;
+		iBaseAccum = static_cast<int64_t>(accum) * timeBase;
+		iTimeStart = 0;
 	}
 	~TimerOBJ()
 	{ 
 		#ifdef DEBUG
 		Serial.println(PSTR("Timer Destructor")); 
 		#endif
+		pWheel->cancel(&wheelNode);
 	}
 	virtual void updateObject();
 	virtual void setLineState(bool &state, bool bNot){ Ladder_OBJ_Logical::setLineState(state, bNot); }
 	virtual shared_ptr<Ladder_VAR> getObjectVAR( const String &id );
 	
 	private:
+	//Called by the timer wheel once the preset has elapsed.
+	static void handleExpired( void * );
+	//Starts (or restarts) the timing run from the stored accumulated time.
+	void startTiming( int64_t );
+	//Returns the elapsed time (uS) for the current timing run, including any retained time.
+	int64_t getElapsed( int64_t now ){ return ttBit ? iBaseAccum + (now - iTimeStart) : iBaseAccum; }
+
 	bool doneBit,
 		enableBit, 
-		ttBit;	
-		
-	uint_fast32_t timeStart, timeEnd, //Local variables only (used for calculations)
-				  lDelay, lAccum;
+		ttBit,
+		b_accUsed; //ACC has been referenced, so it needs to be kept up to date
+
+	PLC_Timer_Wheel *pWheel;
+	Timer_Wheel_Node wheelNode;
+	uint16_t iTimeBase; //uS per PRE/ACC unit
+	int64_t iTimeStart, //start of the current timing run (uS)
+			iBaseAccum; //time accumulated before the current timing run (uS), retained by RTO timers
+	uint_fast32_t lDelay, lAccum,
+				  lScheduledDelay, //preset that the wheel node was scheduled with
+				  lPublishedAccum; //last value written to lAccum, used to detect writes to ACC from the script
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -11,12 +11,52 @@ void Ladder_VAR::setLineState(bool &state, bool bNot)
     Ladder_OBJ_Logical::setLineState(state, bNot); 
 }
 
+void Ladder_VAR::getDependencies( vector<Ladder_Dependency> &deps )
+{
+    const uint8_t *self = reinterpret_cast<const uint8_t *>(this);
+    deps.push_back( { self, self + 1 } );
+
+    const uint8_t *value = static_cast<const uint8_t *>(getValuePtr());
+    if ( value ) //array elements point into the array's storage, so they overlap the array's range
+        deps.push_back( { value, value + 1 } );
+}
+
 void Ladder_VAR::setValue( const String &str )
+{
+    setValue( str.c_str() );
+}
+
+void Ladder_VAR::setValue( const char *str )
 {
     if ( getType() == OBJ_TYPE::TYPE_VAR_FLOAT )
-        setValue( str.toDouble() );
+        setValue( strtod(str, NULL) );
     else
-        setValue( static_cast<int64_t>(strtoll(str.c_str(), NULL, 10)) );
+        setValue( static_cast<int64_t>(strtoll(str, NULL, 10)) );
+}
+
+const void *Ladder_VAR::getValuePtr()
+{
+    switch(getType())
+    {
+        case OBJ_TYPE::TYPE_VAR_BOOL:
+            return b_usesPtr ? static_cast<const void *>(values.b.val_ptr) : &values.b.val;
+        case OBJ_TYPE::TYPE_VAR_FLOAT:
+            return b_usesPtr ? static_cast<const void *>(values.d.val_ptr) : &values.d.val;
+        case OBJ_TYPE::TYPE_VAR_USHORT:
+            return b_usesPtr ? static_cast<const void *>(values.us.val_ptr) : &values.us.val;
+        case OBJ_TYPE::TYPE_VAR_INT:
+            return b_usesPtr ? static_cast<const void *>(values.i.val_ptr) : &values.i.val;
+        case OBJ_TYPE::TYPE_VAR_UINT:
+            return b_usesPtr ? static_cast<const void *>(values.ui.val_ptr) : &values.ui.val;
+        case OBJ_TYPE::TYPE_VAR_LONG:
+            return b_usesPtr ? static_cast<const void *>(values.l.val_ptr) : &values.l.val;
+        case OBJ_TYPE::TYPE_VAR_ULONG:
+            return b_usesPtr ? static_cast<const void *>(values.ul.val_ptr) : &values.ul.val;
+        default:
+        break;
+    }
+
+    return 0;
 }
 
 String Ladder_VAR::getValueStr()
@@ -10,8 +10,10 @@ class Ladder_VAR : public Ladder_OBJ_Logical
 	public:
 	//These constructors are for pointers to existing variables
 	Ladder_VAR( shared_ptr<Ladder_VAR> var, const String &id ) : Ladder_OBJ_Logical( id, var->getType() ){ values = var->values; b_usesPtr = var->b_usesPtr; }  
+	#if UINT_FAST32_MAX != UINT64_MAX //on 64 bit hosts (native tests) the fast types are the 64 bit types, which have their own constructors
 	Ladder_VAR( int_fast32_t *value, const String &id ) : Ladder_OBJ_Logical( id, OBJ_TYPE::TYPE_VAR_INT ){ values.i.val_ptr = value; b_usesPtr = true; }
 	Ladder_VAR( uint_fast32_t *value, const String &id ) : Ladder_OBJ_Logical( id, OBJ_TYPE::TYPE_VAR_UINT ){ values.ui.val_ptr = value; b_usesPtr = true; }
+	#endif
 	Ladder_VAR( bool *value, const String &id ) : Ladder_OBJ_Logical( id, OBJ_TYPE::TYPE_VAR_BOOL ){ values.b.val_ptr = value; b_usesPtr = true; }
 	Ladder_VAR( uint16_t *value, const String &id ) : Ladder_OBJ_Logical( id, OBJ_TYPE::TYPE_VAR_USHORT ){ values.us.val_ptr = value; b_usesPtr = true; }
 	Ladder_VAR( double *value, const String &id ) : Ladder_OBJ_Logical( id, OBJ_TYPE::TYPE_VAR_FLOAT ){ values.d.val_ptr = value; b_usesPtr = true; }
@@ -19,8 +21,13 @@ class Ladder_VAR : public Ladder_OBJ_Logical
 	Ladder_VAR( int64_t *value, const String &id ) : Ladder_OBJ_Logical( id, OBJ_TYPE::TYPE_VAR_LONG ){ values.l.val_ptr = value; b_usesPtr = true; }
 	//
 	//These constructors are for locally stored values
+	#if UINT_FAST32_MAX != UINT64_MAX
 	Ladder_VAR( int_fast32_t value, const String &id ) : Ladder_OBJ_Logical( id, OBJ_TYPE::TYPE_VAR_INT ){ values.i.val = value; b_usesPtr = false; }
 	Ladder_VAR( uint_fast32_t value, const String &id ) : Ladder_OBJ_Logical( id, OBJ_TYPE::TYPE_VAR_UINT ){ values.ui.val = value; b_usesPtr = false; }
+	#else
+	Ladder_VAR( int32_t value, const String &id ) : Ladder_OBJ_Logical( id, OBJ_TYPE::TYPE_VAR_INT ){ values.i.val = value; b_usesPtr = false; }
+	Ladder_VAR( uint32_t value, const String &id ) : Ladder_OBJ_Logical( id, OBJ_TYPE::TYPE_VAR_UINT ){ values.ui.val = value; b_usesPtr = false; }
+	#endif
 	Ladder_VAR( bool value, const String &id ) : Ladder_OBJ_Logical( id, OBJ_TYPE::TYPE_VAR_BOOL ){ values.b.val = value; b_usesPtr = false; }
 	Ladder_VAR( uint16_t value, const String &id ) : Ladder_OBJ_Logical( id, OBJ_TYPE::TYPE_VAR_USHORT ){ values.us.val = value; b_usesPtr = false; }
 	Ladder_VAR( double value, const String &id ) : Ladder_OBJ_Logical( id, OBJ_TYPE::TYPE_VAR_FLOAT ){ values.d.val = value; b_usesPtr = false; }
@@ -177,6 +184,12 @@ class Ladder_VAR : public Ladder_OBJ_Logical
 			}
 	}
 	void setValue( const String & );
+	//Sets the value from the number at the start of the text, which may be followed by anything else (EX: a separator, when reading a record in place).
+	void setValue( const char * );
+	//Returns the address of the stored value (local or pointed to). Used by objects that resolve the variable type once, then read the value directly each scan.
+	const void *getValuePtr();
+	//Adds the variable and the value it refers to. Copies that point to the same value depend on each other.
+	virtual void getDependencies( vector<Ladder_Dependency> & );
 
 	virtual void setLineState(bool &, bool);
 
@@ -0,0 +1,138 @@
+/*
+ * PLC_Analog.cpp
+ *
+ * Background analog sampling and filtering for analog InputOBJs.
+ */ 
+
+#include "PLC_Analog.h"
+#include <HardwareSerial.h>
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////
+// ANALOG CHANNEL BEGIN
+//////////////////////////////////////////////////////////////////////////
+Analog_Channel::Analog_Channel( uint8_t pin, uint8_t filter, double param )
+{
+	i_pin = pin;
+	i_filter = filter;
+	i_window = 1;
+	i_head = 0;
+	i_count = 0;
+	i_sum = 0;
+	f_alpha = 1;
+	f_value = 0;
+	memset(samples, 0, sizeof(samples));
+
+	if ( filter == FILTER_AVG || filter == FILTER_MEDIAN )
+	{
+		if ( param < 1 )
+			param = 1;
+		i_window = param > ADC_BUFFER_SIZE ? ADC_BUFFER_SIZE : static_cast<uint8_t>(param);
+	}
+	else if ( filter == FILTER_IIR && param > 0 && param <= 1 )
+		f_alpha = param;
+}
+
+void Analog_Channel::addSample( uint16_t raw )
+{
+	if ( i_count == i_window ) //window is full, drop the oldest sample from the running sum
+		i_sum -= samples[(i_head + ADC_BUFFER_SIZE - i_window) % ADC_BUFFER_SIZE];
+	else
+		i_count++;
+
+	samples[i_head] = raw;
+	i_sum += raw;
+	i_head = (i_head + 1) % ADC_BUFFER_SIZE;
+
+	switch(i_filter)
+	{
+		case FILTER_AVG:
+			f_value = static_cast<float>(i_sum) / i_count;
+			break;
+		case FILTER_MEDIAN:
+		{
+			uint16_t sorted[ADC_BUFFER_SIZE];
+			for ( uint8_t x = 0; x < i_count; x++ )
+				sorted[x] = samples[(i_head + ADC_BUFFER_SIZE - 1 - x) % ADC_BUFFER_SIZE];
+
+			std::nth_element(sorted, sorted + i_count / 2, sorted + i_count);
+			f_value = sorted[i_count / 2];
+		}
+		break;
+		case FILTER_IIR:
+			if ( i_count == 1 ) //seed with the first reading
+				f_value = raw;
+			else
+				f_value = f_value + f_alpha * (static_cast<float>(raw) - f_value);
+			break;
+		default:
+			f_value = raw;
+			break;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// ANALOG SAMPLER BEGIN
+//////////////////////////////////////////////////////////////////////////
+PLC_Analog_Sampler::PLC_Analog_Sampler()
+{
+	channelMutex = xSemaphoreCreateMutex();
+	stoppedSignal = xSemaphoreCreateBinary();
+	taskHandle = 0;
+	b_running = true;
+	xTaskCreatePinnedToCore(samplerTask, "PLC_ADC", ADC_SAMPLER_STACK, this, 1, &taskHandle, ADC_SAMPLER_CORE);
+	#ifdef DEBUG
+	Serial.println(PSTR("Starting Analog Sampler"));
+	#endif
+}
+
+PLC_Analog_Sampler::~PLC_Analog_Sampler()
+{
+	b_running = false;
+	if ( taskHandle )
+		xSemaphoreTake(stoppedSignal, portMAX_DELAY); //wait for the task to finish its current pass
+
+	vSemaphoreDelete(stoppedSignal);
+	vSemaphoreDelete(channelMutex);
+	channels.clear();
+	#ifdef DEBUG
+	Serial.println(PSTR("Stopping Analog Sampler"));
+	#endif
+}
+
+shared_ptr<Analog_Channel> PLC_Analog_Sampler::addChannel( uint8_t pin, uint8_t filter, double param )
+{
+	shared_ptr<Analog_Channel> channel = make_shared<Analog_Channel>(pin, filter, param);
+	channel->addSample(analogRead(pin)); //make sure the first scan sees a real value
+
+	xSemaphoreTake(channelMutex, portMAX_DELAY);
+	channels.emplace_back(channel);
+	xSemaphoreGive(channelMutex);
+
+	return channel;
+}
+
+void PLC_Analog_Sampler::sampleAll()
+{
+	xSemaphoreTake(channelMutex, portMAX_DELAY);
+	for ( uint8_t x = 0; x < channels.size(); x++ )
+	{
+		channels[x]->addSample(analogRead(channels[x]->getPin()));
+	}
+	xSemaphoreGive(channelMutex);
+}
+
+void PLC_Analog_Sampler::samplerTask( void *arg )
+{
+	PLC_Analog_Sampler *pSampler = static_cast<PLC_Analog_Sampler *>(arg);
+	TickType_t lastWake = xTaskGetTickCount();
+
+	while ( pSampler->b_running )
+	{
+		pSampler->sampleAll();
+		vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(ADC_SAMPLE_PERIOD));
+	}
+
+	xSemaphoreGive(pSampler->stoppedSignal);
+	vTaskDelete(0); //delete self
+}
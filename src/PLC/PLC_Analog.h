@@ -0,0 +1,75 @@
+/*
+ * PLC_Analog.h
+ *
+ * Background sampling of analog inputs. A low priority task on the protocol core (0) reads every configured analog pin at a fixed rate,
+ * stores the raw readings in a small ring buffer per channel, and publishes a filtered value that the logic scan can read without waiting on the ADC.
+ */ 
+
+#ifndef PLC_ANALOG_H_
+#define PLC_ANALOG_H_
+
+#include "PLC_IO.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#define ADC_BUFFER_SIZE 16 //number of raw samples kept per channel (also the max averaging/median window)
+#define ADC_SAMPLE_PERIOD 1 //time between sampling passes (ms)
+#define ADC_SAMPLER_CORE 0 //the Arduino loop (and logic scan) runs on core 1
+#define ADC_SAMPLER_STACK 2048
+
+enum ADC_FILTER : uint8_t
+{
+	FILTER_NONE, //latest raw sample
+	FILTER_AVG, //moving average over the window
+	FILTER_MEDIAN, //median over the window (rejects spikes)
+	FILTER_IIR //first order low pass: value += alpha * (sample - value)
+};
+
+//Per pin sampling state. Only the sampler task writes to the ring buffer, the logic scan only reads the published value.
+struct Analog_Channel
+{
+	Analog_Channel( uint8_t pin, uint8_t filter = FILTER_NONE, double param = 0 );
+
+	//Stores a new raw sample and republishes the filtered value. Called from the sampler task.
+	void addSample( uint16_t );
+	//Returns the latest filtered value (raw ADC counts). Safe to call from the scan.
+	float getValue(){ return f_value; }
+	uint8_t getPin(){ return i_pin; }
+
+	private:
+	uint8_t i_pin,
+			i_filter,
+			i_window, //number of samples used by the AVG/MEDIAN filters
+			i_head, //next ring buffer slot to write
+			i_count; //number of valid samples in the ring buffer
+	float f_alpha; //IIR coefficient (0-1]
+	uint32_t i_sum; //running sum of the samples in the window (AVG)
+	uint16_t samples[ADC_BUFFER_SIZE];
+	volatile float f_value; //published filtered value
+};
+
+//Owns the sampler task and the list of channels being sampled.
+class PLC_Analog_Sampler
+{
+	public:
+	PLC_Analog_Sampler();
+	~PLC_Analog_Sampler();
+
+	//Creates a new channel for the given pin and adds it to the sampling list. Args: <Pin>, <Filter>, <Window size or IIR alpha>
+	shared_ptr<Analog_Channel> addChannel( uint8_t, uint8_t, double );
+	uint8_t getNumChannels(){ return channels.size(); }
+
+	private:
+	static void samplerTask( void * );
+	//Reads every channel once.
+	void sampleAll();
+
+	vector<shared_ptr<Analog_Channel>> channels;
+	SemaphoreHandle_t channelMutex; //guards the channel list between the parser and the sampler task
+	SemaphoreHandle_t stoppedSignal; //given by the task once it has left its loop
+	TaskHandle_t taskHandle;
+	volatile bool b_running;
+};
+
+#endif /* PLC_ANALOG_H_ */
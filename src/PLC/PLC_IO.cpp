@@ -33,29 +33,46 @@ shared_ptr<Ladder_VAR> Ladder_OBJ::getObjectVAR( const String &id )
 	return 0;
 }
 
+void Ladder_OBJ_Logical::getDependencies( vector<Ladder_Dependency> &deps )
+{
+	const uint8_t *self = reinterpret_cast<const uint8_t *>(this);
+	deps.push_back( { self, self + 1 } ); //the line state, and anything else kept in the object
+
+	for ( uint16_t x = 0; x < getObjectVARs().size(); x++ )
+		getObjectVARs()[x]->getDependencies(deps);
+}
+
 void Ladder_OBJ_Accessor::handleUpdates( const String &str)
 {
 	//Update Record Order: <ID>,<VALUE> -- only updating Ladder_VAR objects that are locally stored, for now
-	if (strContains(str, CMD_SEND_UPDATE) && strContains(str, CHAR_QUERY_END) ) //Updates only contain data that might change between updates (omitted: logic, type)
+	//The records are read in place (no split strings), as updates arrive on every update period while the logic is running.
+	int start = str.indexOf(CMD_SEND_UPDATE), end = str.indexOf(CHAR_QUERY_END);
+	if ( start < 0 || end < start ) //Updates only contain data that might change between updates (omitted: logic, type)
+		return;
+
+	const char *data = str.c_str();
+	for ( int group = start + 1; group < end; )
 	{
-		vector<String> groupData = splitString(removeFromStr(str, {CMD_SEND_UPDATE, CHAR_QUERY_END} ), CHAR_UPDATE_GROUP); //remove the update prefix, then break the string up
+		int groupEnd = group;
+		while ( groupEnd < end && data[groupEnd] != CHAR_UPDATE_GROUP )
+			groupEnd++;
 
-		for ( uint16_t x = 0; x < groupData.size(); x++ )
+		const char *record = static_cast<const char *>( memchr(data + group, CHAR_UPDATE_RECORD, groupEnd - group) );
+		if ( record )
 		{
-			vector<String> recordData = splitString(groupData[x], CHAR_UPDATE_RECORD); //break the group string up by records
-
-			if ( recordData.size() > 1 )
+			uint16_t idLength = record - ( data + group );
+			for ( uint16_t x = 0; x < getObjectVARs().size(); x++ ) //attempt to find the (hopefully) existing var.
 			{
-				shared_ptr<Ladder_VAR> pVar = getObjectVAR( recordData[0] ); //attempt to find the (hopefully) existing var.
-
-				if ( pVar ) //&& recordData[1].length()
-					pVar->setValue( recordData[1] );
-				else
+				const String &id = getObjectVARs()[x]->getID();
+				if ( id.length() == idLength && !memcmp(id.c_str(), data + group, idLength) )
 				{
-					//some error.. couldn't update the object because it doesn't exist here? Init problem? 
+					getObjectVARs()[x]->setValue( record + 1 ); //the number ends at the next separator
+					break;
 				}
 			}
 		}
+
+		group = groupEnd + 1;
 	}
 }
 
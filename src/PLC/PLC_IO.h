@@ -24,6 +24,13 @@ using namespace std;
 class Ladder_VAR;
 //
 
+//A range of memory that an object reads or writes while its rung is being processed. Rungs whose ranges never overlap share no state, and can be processed in any order.
+struct Ladder_Dependency
+{
+	const uint8_t *start,
+				  *end; //one past the last byte
+};
+
 
 //This is the base class for all PLC ladder logic objects. Individual object types derive from this class.
 class Ladder_OBJ
@@ -69,6 +76,9 @@ class Ladder_OBJ_Logical : public Ladder_OBJ
 	void setLogic(uint8_t logic) { i_objLogic = logic; }
 	//Set the line state back to false for the next scan This should only be called by the rung manager (which applies the logic after processing)
 	virtual void updateObject(){ b_lineState = false; } 
+	//Adds the memory that the object reads or writes in setLineState() to the list. By default this is the object itself and its local variables.
+	//Objects that reach other variables or arrays while the rung is processed must add those as well. Work done in updateObject() doesn't count, as it is never run in parallel.
+	virtual void getDependencies( vector<Ladder_Dependency> & );
 
 	private:
 	uint8_t i_objLogic;
@@ -119,13 +129,13 @@ class Ladder_OBJ_Accessor : public Ladder_OBJ
 
 //This object serves as a means of storing logic script specific flags that pertain to a single ladder object. 
 //This allows us to perform multiple varying logic operations without the need to create multiple copies of the same object.
+//Wrappers only exist while a line is being parsed. Once the rung is complete, the graph is flattened into the compact node tables stored by the Ladder_Rung.
 struct Ladder_OBJ_Wrapper 
 {
-	Ladder_OBJ_Wrapper(shared_ptr<Ladder_OBJ_Logical> obj, uint16_t rung, bool not_flag = false)
+	Ladder_OBJ_Wrapper(shared_ptr<Ladder_OBJ_Logical> obj, bool not_flag = false)
 	{
 		bNot = not_flag; //Exclusively for NOT logic
 		ladderOBJ = obj; 
-		i_rungNum = rung; //store this here for now
 	}
 	~Ladder_OBJ_Wrapper(){ }
 
@@ -142,23 +152,16 @@ struct Ladder_OBJ_Wrapper
 
 		return true; 
 	}
-
-	void setLineState(bool state)
-	{
-		getObject()->setLineState(state, getNot()); //line state needs to be set per wrapper, not per ladder object
-		
-		for(uint8_t x = 0; x < nextObjects.size(); x++ )
-			nextObjects[x]->setLineState(state);
-	}
 	
 	//Returns the pointer to the ladder object stored by this object.
-	const shared_ptr<Ladder_OBJ_Logical> getObject(){ return ladderOBJ; }
+	const shared_ptr<Ladder_OBJ_Logical> &getObject(){ return ladderOBJ; }
+	//Returns the objects that are logically connected after this one.
+	const vector<shared_ptr<Ladder_OBJ_Wrapper>> &getNextObjects(){ return nextObjects; }
 	//Tells us if the object is being interpreted using NOT logic
 	bool getNot(){ return bNot; }
 		
 	private:
 	bool bNot; //if the object is using not logic (per instance in rungs)
-	uint16_t i_rungNum;
 	shared_ptr<Ladder_OBJ_Logical> ladderOBJ; //Container for the actual Ladder_Obj object
 	vector<shared_ptr<Ladder_OBJ_Wrapper>> nextObjects;
 };
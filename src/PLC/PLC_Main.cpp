@@ -7,26 +7,46 @@
 #include "PLC_Main.h"
 #include "PLC_Parser.h"
 #include <HardwareSerial.h>
+#include <esp_timer.h>
 
 //other object includes
 #include "OBJECTS/MATH/obj_math_basic.h"
+#include "OBJECTS/MATH/obj_math_array.h"
+#include "OBJECTS/MATH/obj_math_cpt.h"
 #include "OBJECTS/obj_var.h"
+#include "OBJECTS/obj_array.h"
 #include "OBJECTS/obj_input_basic.h"
 #include "OBJECTS/obj_output_basic.h"
 #include "OBJECTS/obj_timer.h"
 #include "OBJECTS/obj_counter.h"
+#include "OBJECTS/obj_hscounter.h"
+#include "OBJECTS/obj_schedule.h"
+#include "OBJECTS/obj_pid.h"
+#include "OBJECTS/obj_stack.h"
+#include "OBJECTS/obj_shift.h"
+#include "OBJECTS/obj_sequencer.h"
+#include "OBJECTS/obj_logger.h"
 #include "OBJECTS/obj_oneshot.h"
 #include "ACCESSORS/acc_remote.h"
 //
 
 void PLC_Main::resetAll()
 {
+	retentiveStorage.reset(); //save any pending values before the objects are destroyed
+	tasks.clear(); //stops any dual core workers before the rungs go away
+	i_currentTask = 0;
+	scanWatchdog.reset(); //releases any held outputs
+	backgroundObjects.clear();
+	backgroundInputs.clear();
 	ladderRungs.clear(); //Empty created ladder rungs vector
+	inputObjects.clear(); //Empty the input process image
+	analogSampler.reset(); //stop background analog sampling
 	ladderObjects.clear(); //Empty the created ladder logic objects vector
 	accessorObjects.clear(); // Empty the accessor objects vector
 	ladderVars.clear(); //Empty the created ladder vars vector
 	generatePinMap(); //reset and fill the pinmap
 	generatePWMMap(); //generate the list of available PWM channels for outputs
+	generatePCNTMap(); //generate the list of available pulse counter units
 }
 
 char toUpper( char x )
@@ -103,6 +123,28 @@ int8_t PLC_Main::reservePWMChannel()
 	return -1; //default path indicates an error (cannot reserve)
 }
 
+void PLC_Main::generatePCNTMap()
+{
+	pcntMap.clear(); //just in case
+	for ( uint8_t x = 0; x < PCNT_UNIT_MAX; x++ )
+	{
+		pcntMap.emplace(x, PWM_STATUS::PWM_AVAILABLE);
+	}
+}
+int8_t PLC_Main::reservePCNTUnit()
+{
+	for ( uint8_t x = 0; x < PCNT_UNIT_MAX; x++ )
+	{
+		if ( pcntMap[x] == PWM_STATUS::PWM_AVAILABLE )
+		{
+			pcntMap[x] = PWM_STATUS::PWM_TAKEN; //reserve the unit
+			return x;
+		}
+	}
+
+	return -1; //default path indicates an error (cannot reserve)
+}
+
 String PLC_Main::getObjName( const String &parsedString )
 {
 	String objName;
@@ -120,26 +162,159 @@ String PLC_Main::getObjName( const String &parsedString )
 
 void PLC_Main::processLogic()
 {
+	Heap_Scope heapScope(HEAP_TAG_PLC);
+	int64_t scanStart = esp_timer_get_time();
+	EventTrace.recordAt( TRACE_SCAN_BEGIN, 0, 0, scanStart );
+	scanWatchdog.configure( Core.getScanBudget(), Core.getScanOverrunLimit(), Core.getScanOverrunPolicy() );
+	scanWatchdog.beginScan(scanStart);
+	bool timing = scanWatchdog.isEnabled();
+
+	if ( scanWatchdog.isFaulted() ) //the logic stays stopped until the watchdog is cleared, only remote requests are handled
+	{
+		if ( getRemoteServer() )
+			getRemoteServer()->processRequests();
+		EventTrace.record( TRACE_SCAN_END, 0, esp_timer_get_time() - scanStart );
+		return;
+	}
+
+	//Inputs that no rung references are sampled here, the others at the start of each run of the task that uses them.
+	for ( uint16_t x = 0; x < backgroundInputs.size(); x++ )
+	{
+		backgroundInputs[x]->latchInput();
+	}
+
+	timerWheel.advance(esp_timer_get_time()); //fire any timers that expired since the last scan
+
 	//Update accessor objects first in the scan, as the state in some of the Ladder_OBJ_Logical objects they contain may be of use.
+	int64_t phaseStart = timing ? esp_timer_get_time() : 0;
+	uint32_t phaseAllocs = Heap_Monitor::getThreadAllocs();
 	for ( uint8_t x = 0; x < getNumAccessors(); x++ )
 	{
 		getAccessorObjects()[x]->updateObject();
 	}
+	scanWatchdog.addPhaseAllocs( WATCHDOG_PHASE_ACCESSORS, Heap_Monitor::getThreadAllocs() - phaseAllocs );
+	if ( timing )
+		scanWatchdog.setPhaseTime( WATCHDOG_PHASE_ACCESSORS, esp_timer_get_time() - phaseStart );
 	//
 
-	for (uint16_t x = 0; x < getNumRungs(); x++) //iterate through all available rungs
+	for ( uint8_t x = 0; x < tasks.size(); x++ ) //highest priority first
 	{
-		getLadderRungs()[x]->processRung(x); //perform logic 'scan' on the selected rung
+		int64_t now = esp_timer_get_time();
+		if ( !tasks[x]->isDue(now) )
+			continue;
+
+		if ( scanWatchdog.isSkipped(x) )
+		{
+			tasks[x]->skipRun(now);
+			scanWatchdog.clearSkip();
+		}
+		else
+			runTask(x, now);
 	}
 
+	if ( timing )
+		phaseStart = esp_timer_get_time();
+	phaseAllocs = Heap_Monitor::getThreadAllocs();
 	if ( getRemoteServer() ) //handle the web server (if applicable)
 	{
 		getRemoteServer()->processRequests(); //handle any remote requests/etc.
 	}
+	scanWatchdog.addPhaseAllocs( WATCHDOG_PHASE_REMOTE_SERVER, Heap_Monitor::getThreadAllocs() - phaseAllocs );
+	if ( timing )
+		scanWatchdog.setPhaseTime( WATCHDOG_PHASE_REMOTE_SERVER, esp_timer_get_time() - phaseStart );
 		
+	//Objects that aren't used by any rung (loggers, schedules, etc.) are updated on every pass.
+	if ( timing )
+		phaseStart = esp_timer_get_time();
+	phaseAllocs = Heap_Monitor::getThreadAllocs();
+	for ( uint16_t y = 0; y < backgroundObjects.size(); y++ )
+		backgroundObjects[y]->updateObject(); 
+	scanWatchdog.addPhaseAllocs( WATCHDOG_PHASE_BACKGROUND, Heap_Monitor::getThreadAllocs() - phaseAllocs );
+	if ( timing )
+		scanWatchdog.setPhaseTime( WATCHDOG_PHASE_BACKGROUND, esp_timer_get_time() - phaseStart );
+
+	if ( timing )
+		phaseStart = esp_timer_get_time();
+	phaseAllocs = Heap_Monitor::getThreadAllocs();
+	retentiveStorage.update( timerWheel.getNow() ); //only writes once the interval has passed, and only if something changed
+	scanWatchdog.addPhaseAllocs( WATCHDOG_PHASE_RETAIN, Heap_Monitor::getThreadAllocs() - phaseAllocs );
+	if ( timing )
+		scanWatchdog.setPhaseTime( WATCHDOG_PHASE_RETAIN, esp_timer_get_time() - phaseStart );
+
+	int64_t scanEnd = esp_timer_get_time(); //retentive writes are part of the scan, so they count against the budget
+	scanWatchdog.endScan(scanEnd);
+	EventTrace.recordAt( TRACE_SCAN_END, 0, scanEnd - scanStart, scanEnd );
+}
+
+int64_t PLC_Main::runTask( uint8_t index, int64_t now )
+{
+	PLC_Task &task = *tasks[index];
+	task.beginRun(now);
+	EventTrace.recordAt( TRACE_TASK_BEGIN, index, 0, now );
+
+	//Sample the task's inputs (and consume any captured edges) once, so every reference within this run sees the same value.
+	vector<shared_ptr<InputOBJ>> &inputs = task.getInputs();
+	for ( uint16_t x = 0; x < inputs.size(); x++ )
+		inputs[x]->latchInput();
+
+	timerWheel.advance(now); //a single timestamp for the whole run
+
+	int64_t preempted = 0; //time spent in higher priority tasks
+	if ( task.getPartition() ) //independent groups of rungs are processed on both cores, and both are finished before any object is updated
+		scanWatchdog.addAllocs( task.getPartition()->processRungs() );
+	else
+	{
+		bool timing = scanWatchdog.isEnabled(),
+			 tracing = EventTrace.isRungTracing();
+		vector<shared_ptr<Ladder_Rung>> &rungs = task.getRungs();
+		for ( uint16_t x = 0; x < rungs.size(); x++ ) //iterate through all of the task's rungs
+		{
+			int64_t rungStart = ( timing || tracing ) ? esp_timer_get_time() : 0;
+			rungs[x]->processRung(x); //perform logic 'scan' on the selected rung
+			if ( timing || tracing )
+			{
+				int64_t rungEnd = esp_timer_get_time();
+				if ( timing )
+					scanWatchdog.setRungTime( task.getRungNumber(x), rungEnd - rungStart );
+				if ( tracing )
+				{
+					EventTrace.recordAt( TRACE_RUNG_BEGIN, task.getRungNumber(x), 0, rungStart );
+					EventTrace.recordAt( TRACE_RUNG_END, task.getRungNumber(x), rungEnd - rungStart, rungEnd );
+				}
+			}
+			if ( index && x + 1U < rungs.size() ) //a higher priority task may be due
+				preempted += runPreemptingTasks(index);
+		}
+	}
+
 	//After the logic scans, the object's state is known. Perform the update on the objects (for some objects, this is the "action" function.)
-	for ( uint16_t y = 0; y < ladderObjects.size(); y++ )
-		ladderObjects[y]->updateObject(); 
+	vector<shared_ptr<Ladder_OBJ_Logical>> &objects = task.getObjects();
+	for ( uint16_t y = 0; y < objects.size(); y++ )
+		objects[y]->updateObject();
+
+	int64_t elapsed = esp_timer_get_time() - now;
+	task.endRun( elapsed - preempted );
+	scanWatchdog.addTaskTime( index, elapsed - preempted );
+	EventTrace.recordAt( TRACE_TASK_END, index, elapsed - preempted, now + elapsed );
+	return elapsed;
+}
+
+int64_t PLC_Main::runPreemptingTasks( uint8_t index )
+{
+	int64_t spent = 0;
+	for ( uint8_t x = 0; x < index; x++ )
+	{
+		if ( !tasks[x]->getPeriod() ) //continuous tasks never preempt
+			break;
+
+		int64_t now = esp_timer_get_time();
+		if ( tasks[x]->isDue(now) && !scanWatchdog.isSkipped(x) )
+		{
+			tasks[index]->addPreemption();
+			spent += runTask(x, now);
+		}
+	}
+	return spent;
 }
 
 bool PLC_Main::addLadderRung(shared_ptr<Ladder_Rung> rung)
@@ -149,11 +324,126 @@ bool PLC_Main::addLadderRung(shared_ptr<Ladder_Rung> rung)
 		return false; //error here? invalid number of necessary rung objects
 	}
 		
+	if ( tasks.empty() ) //rungs before the first task section
+		tasks.emplace_back( make_shared<PLC_Task>(taskTagMain, 0) );
+
 	//looks like we're good here	
 	ladderRungs.emplace_back(rung);
+	tasks[i_currentTask]->addRung(rung, ladderRungs.size() - 1);
 	return true;
 }
 
+bool PLC_Main::beginTask( const vector<String> &args )
+{
+	if ( args.size() != 2 || !args[0].length() )
+	{
+		sendError(ERR_DATA::ERR_INSUFFICIENT_ARGS, taskTag);
+		return false;
+	}
+	if ( args[0].length() > MAX_PLC_OBJ_NAME )
+	{
+		sendError(ERR_DATA::ERR_NAME_TOO_LONG, args[0]);
+		return false;
+	}
+
+	String periodStr = args[1];
+	uint32_t scale = 1000; //MS by default
+	if ( periodStr.endsWith(typeTagUS) )
+		scale = 1;
+	if ( periodStr.endsWith(typeTagUS) || periodStr.endsWith(typeTagMS) )
+		periodStr.remove( periodStr.length() - 2 );
+
+	int64_t period = parseInt(periodStr) * scale;
+	if ( strDataType(periodStr) != 1 || period < 0 || period > UINT32_MAX )
+	{
+		sendError(ERR_DATA::ERR_OUT_OF_RANGE, taskTag + CHAR_SPACE + args[1]);
+		return false;
+	}
+
+	for ( uint8_t x = 0; x < tasks.size(); x++ ) //a section may be continued further down the script
+	{
+		if ( tasks[x]->getName() == args[0] )
+		{
+			if ( tasks[x]->getPeriod() != period )
+			{
+				sendError(ERR_DATA::ERR_UNKNOWN_ARGS, taskTag + CHAR_SPACE + args[0] + CHAR_SPACE + args[1]);
+				return false;
+			}
+			i_currentTask = x;
+			return true;
+		}
+	}
+
+	if ( tasks.size() >= TASK_MAX_TASKS )
+	{
+		sendError(ERR_DATA::ERR_OUT_OF_RANGE, taskTag + CHAR_SPACE + args[0]);
+		return false;
+	}
+
+	i_currentTask = tasks.size();
+	tasks.emplace_back( make_shared<PLC_Task>(args[0], period) );
+	return true;
+}
+
+void PLC_Main::buildTasks()
+{
+	//Empty sections are dropped, then the shortest period runs first. Continuous tasks go last.
+	for ( uint8_t x = tasks.size(); x-- > 0; )
+	{
+		if ( tasks[x]->getRungs().empty() )
+			tasks.erase( tasks.begin() + x );
+	}
+	stable_sort( tasks.begin(), tasks.end(), []( const shared_ptr<PLC_Task> &a, const shared_ptr<PLC_Task> &b )
+	{
+		return a->getPeriod() && ( !b->getPeriod() || a->getPeriod() < b->getPeriod() );
+	});
+
+	//Each object belongs to the highest priority task that references it.
+	map<Ladder_OBJ_Logical *, uint8_t> owners;
+	for ( uint8_t x = 0; x < tasks.size(); x++ )
+	{
+		vector<shared_ptr<Ladder_Rung>> &rungs = tasks[x]->getRungs();
+		for ( uint16_t y = 0; y < rungs.size(); y++ )
+		{
+			const vector<shared_ptr<Ladder_OBJ_Logical>> &objects = rungs[y]->getRungObjects();
+			for ( uint16_t z = 0; z < objects.size(); z++ )
+				owners.insert( make_pair(objects[z].get(), x) ); //keeps the first (highest priority) owner
+		}
+	}
+
+	for ( uint16_t x = 0; x < ladderObjects.size(); x++ ) //in declaration order, same as the single task scan
+	{
+		map<Ladder_OBJ_Logical *, uint8_t>::iterator owner = owners.find( ladderObjects[x].get() );
+		if ( owner != owners.end() )
+			tasks[owner->second]->addObject(ladderObjects[x]);
+		else
+			backgroundObjects.push_back(ladderObjects[x]);
+	}
+
+	for ( uint16_t x = 0; x < inputObjects.size(); x++ )
+	{
+		map<Ladder_OBJ_Logical *, uint8_t>::iterator owner = owners.find( inputObjects[x].get() );
+		if ( owner != owners.end() )
+			tasks[owner->second]->addInput(inputObjects[x]);
+		else
+			backgroundInputs.push_back(inputObjects[x]);
+	}
+
+	if ( b_checkOnly || !Core.getDualCoreScan() )
+		return;
+
+	for ( uint8_t x = 0; x < tasks.size(); x++ )
+	{
+		if ( x && tasks[0]->getPeriod() ) //a higher priority periodic task can only preempt between rungs of the serial path, so this task stays on it
+			break;
+
+		unique_ptr<PLC_Rung_Partition> &partition = tasks[x]->getPartition();
+		partition.reset( new PLC_Rung_Partition(tasks[x]->getRungs()) );
+		if ( !partition->isParallel() ) //too little independent work to be worth the hand off
+			partition.reset();
+	}
+}
+
 shared_ptr<Ladder_OBJ_Logical> PLC_Main::findLadderObjByID( const String &id ) //Search through all created objects thus far. This assumes that the object was created successfully.
 {
 	for ( uint16_t x = 0; x < ladderObjects.size(); x++ )
@@ -217,38 +507,187 @@ shared_ptr<Ladder_VAR> PLC_Main::findLadderVarByID( const String &id )
 	return 0; //default
 }
 
+shared_ptr<Ladder_Array> PLC_Main::findLadderArrayByID( const String &id, uint32_t &start )
+{
+	vector<String> argVec = splitString(id, CHAR_VAR_OPERATOR);
+	start = 0;
+
+	if ( argVec.size() > 2 || ( argVec.size() == 2 && strDataType(argVec[1]) != 1 ) ) //only a plain element index may follow the array name
+		return 0;
+
+	shared_ptr<Ladder_OBJ_Logical> obj = findLadderObjByID(argVec[0]);
+	if ( !obj || obj->getType() != OBJ_TYPE::TYPE_VAR_ARRAY )
+		return 0;
+
+	if ( argVec.size() == 2 )
+	{
+		int64_t index = parseInt(argVec[1]);
+		if ( index < 0 || index >= static_cast<Ladder_Array *>(obj.get())->getLength() )
+			return 0;
+		start = index;
+	}
+
+	return static_pointer_cast<Ladder_Array>(obj);
+}
+
 bool PLC_Main::parseScript(const char *script)
 {
-	resetAll(); //Purge all previous ladder logic objects before applying new script, also generate a new pinmap.
+	Heap_Scope heapScope(HEAP_TAG_PARSER);
+	beginScript(); //Purge all previous ladder logic objects before applying new script, also generate a new pinmap.
 
 	String scriptLine; //container for parsed characters
-	uint16_t iLine = 0;
-	for (uint16_t x = 0; x <= strlen(script); x++) //go one char at a time.
+	if ( !parseScriptChars(script, strlen(script), scriptLine) || !parseScriptChars("\n", 1, scriptLine) ) //the newline completes the last line
+		return false;
+
+	finishScript();
+	return !b_checkOnly || !i_numErrors; //success
+}
+
+bool PLC_Main::parseScript(File &scriptFile)
+{
+	Heap_Scope heapScope(HEAP_TAG_PARSER);
+	beginScript();
+
+	String scriptLine;
+	char chunk[SCRIPT_CHUNK_SIZE];
+	size_t read;
+	while ( ( read = scriptFile.read( reinterpret_cast<uint8_t *>(chunk), SCRIPT_CHUNK_SIZE ) ) > 0 ) //only one chunk and the current line are held in RAM
+	{
+		if ( !parseScriptChars(chunk, read, scriptLine) )
+			return false;
+	}
+
+	if ( !parseScriptChars("\n", 1, scriptLine) )
+		return false;
+
+	finishScript();
+	return !b_checkOnly || !i_numErrors;
+}
+
+bool PLC_Main::parseScriptChars(const char *script, size_t length, String &scriptLine)
+{
+	for (size_t x = 0; x < length; x++) //go one char at a time.
 	{
+		i_parseColumn++;
+		bool crlf = b_lastCarriage && script[x] == CHAR_NEWLINE;
+		b_lastCarriage = script[x] == CHAR_CARRIAGE;
 		if ( script[x] == CHAR_SPACE ) //omit spaces
 			continue;
 			
-		if ( script[x] != CHAR_NEWLINE && script[x] != CHAR_CARRIAGE && x < strlen(script) ) //Do this one line at a time.
+		if ( script[x] != CHAR_NEWLINE && script[x] != CHAR_CARRIAGE ) //Do this one line at a time.
 		{
 			scriptLine += toUpper(script[x]); //convert all chars to upper case. This might be done elsewhere later (web interface code) but for now we'll do it here
+			if ( b_checkOnly )
+				checkColumns.push_back(i_parseColumn);
+			continue;
 		}
-		else if (scriptLine.length() > 1) //we've hit a newline or carriage return char and we've got a valid length
+
+		i_parseColumn = 0;
+		if ( crlf ) //the second half of a CRLF, the line was ended by the carriage return
+			continue;
+
+		i_parseLine++; //every line counts, including blank ones, so the line numbers match the editor's
+		if (scriptLine.length() > 1) //we've hit a newline or carriage return char and we've got a valid length
 		{
-			iLine++; //Looks like we have a valid line
-			shared_ptr<PLC_Parser> parser = make_shared<PLC_Parser>(scriptLine, getNumRungs() );
+			uint16_t numErrors = i_numErrors;
+			if ( b_checkOnly )
+				s_checkLine = scriptLine;
+
+			shared_ptr<PLC_Parser> parser = make_shared<PLC_Parser>(scriptLine, getNumRungs(), this );
 			if ( !parser->parseLine() )
 			{
-				sendError( ERR_DATA::ERR_PARSER_FAILED, PSTR("At Line: ") + String(iLine));
-				return false; //error ocurred somewhere?
+				if ( !b_checkOnly )
+				{
+					sendError( ERR_DATA::ERR_PARSER_FAILED, PSTR("At Line: ") + String(i_parseLine));
+					return false; //error ocurred somewhere?
+				}
+				if ( i_numErrors == numErrors ) //the line failed without saying why
+					addDiagnostic( err_parser_failed, "" );
 			}
-
-			scriptLine.clear(); //empty the container for the next line
 		}
+		scriptLine.clear(); //empty the container for the next line, a one char line is dropped rather than joined to the next one
+		checkColumns.clear();
 	}
 
+	return true;
+}
+
+void PLC_Main::beginScript()
+{
+	resetAll();
+	diagnostics.clear();
+	i_numErrors = 0;
+	i_parseLine = 0;
+	i_parseColumn = 0;
+	b_lastCarriage = false;
+	EventTrace.record( TRACE_PARSE_BEGIN, TRACE_PARSE_SCRIPT );
+}
+
+void PLC_Main::addDiagnostic( const String &message, const String &info )
+{
+	if ( i_numErrors++ >= SCRIPT_CHECK_MAX_DIAGNOSTICS )
+		return;
+
+	Script_Diagnostic diagnostic;
+	diagnostic.i_line = i_parseLine;
+	diagnostic.i_column = 0;
+	diagnostic.s_message = message;
+	int pos = info.length() ? s_checkLine.indexOf(info) : -1;
+	if ( pos >= 0 && static_cast<size_t>(pos) < checkColumns.size() )
+		diagnostic.i_column = checkColumns[pos];
+
+	diagnostics.push_back(diagnostic);
+}
+
+Script_Check_Report PLC_Main::checkScript( File &scriptFile, vector<Script_Diagnostic> &errors )
+{
+	Script_Check_Report report;
+	memset( &report, 0, sizeof(report) );
+
+	uint32_t freeHeap = ESP.getFreeHeap();
+	unique_ptr<PLC_Main> staging( new PLC_Main() ); //its own objects, pin map, PWM map and PCNT map
+	staging->b_checkOnly = true;
+	staging->parseScript(scriptFile);
+
+	uint32_t heapNow = ESP.getFreeHeap();
+	report.i_heapUsed = freeHeap > heapNow ? freeHeap - heapNow : 0;
+	report.i_numObjects = staging->ladderObjects.size() + staging->accessorObjects.size();
+	report.i_numVars = staging->ladderVars.size();
+	report.i_numRungs = staging->getNumRungs();
+	for ( uint16_t x = 0; x < staging->getNumRungs(); x++ )
+		report.i_numNodes += staging->ladderRungs[x]->getNumRungObjects();
+	report.i_scanEstimate = ( static_cast<uint32_t>(report.i_numNodes) * SCAN_COST_NODE_NS + static_cast<uint32_t>(report.i_numObjects) * SCAN_COST_OBJECT_NS ) / 1000;
+	report.i_numErrors = staging->i_numErrors;
+	errors.swap( staging->diagnostics );
+	return report;
+}
+
+void PLC_Main::finishScript()
+{
 	pinMap.clear(); //free some memory
 	pwmMap.clear();
-	return true; //success
+	s_checkLine = String();
+	checkColumns.clear();
+	EventTrace.record( TRACE_PARSE_END, TRACE_PARSE_SCRIPT, getNumRungs() );
+
+	EventTrace.record( TRACE_PARSE_BEGIN, TRACE_PARSE_BUILD );
+	buildTasks();
+	EventTrace.record( TRACE_PARSE_END, TRACE_PARSE_BUILD, tasks.size() );
+	if ( b_checkOnly ) //the saved values belong to the running program
+		return;
+
+	retentiveStorage.setInterval( Core.getRetainInterval() );
+	EventTrace.record( TRACE_PARSE_BEGIN, TRACE_PARSE_RETAIN );
+	retentiveStorage.restore(); //saved values replace the initial values from the script, before the first scan
+	EventTrace.record( TRACE_PARSE_END, TRACE_PARSE_RETAIN, retentiveStorage.getNumEntries() );
+
+	scanWatchdog.setProgram( ladderRungs.size(), tasks.size() );
+	for ( uint16_t x = 0; x < ladderObjects.size(); x++ )
+	{
+		OBJ_TYPE type = ladderObjects[x]->getType();
+		if ( type == OBJ_TYPE::TYPE_OUTPUT || type == OBJ_TYPE::TYPE_OUTPUT_PWM )
+			scanWatchdog.addOutput( static_pointer_cast<OutputOBJ>(ladderObjects[x]) );
+	}
 }
 
 shared_ptr<Ladder_OBJ> PLC_Main::createNewLadderObject(const String &name, const vector<String> &ObjArgs )
@@ -259,6 +698,13 @@ shared_ptr<Ladder_OBJ> PLC_Main::createNewLadderObject(const String &name, const
 	}
 	else
 	{
+		if ( ObjArgs.size() > 1 && ObjArgs.back() == retainTag ) //retentive flag, create the object without it
+		{
+			shared_ptr<Ladder_OBJ> newObj = createNewLadderObject( name, vector<String>(ObjArgs.begin(), ObjArgs.end() - 1) );
+			if ( newObj && !addRetentiveOBJ(name, newObj) )
+				sendError(ERR_DATA::ERR_UNKNOWN_ARGS, name + CHAR_SPACE + retainTag);
+			return newObj;
+		}
 		if (ObjArgs.size() >= 1) //must have at least one arg (first indictes the object type)
 		{
 			String type = ObjArgs[0];
@@ -284,6 +730,46 @@ shared_ptr<Ladder_OBJ> PLC_Main::createNewLadderObject(const String &name, const
 			{
 				return createCounterOBJ(name, ObjArgs);
 			}
+			else if ( type == hsCounterTag ) 
+			{
+				return createHSCounterOBJ(name, ObjArgs);
+			}
+			else if ( type == scheduleTag1 || type == scheduleTag2 ) 
+			{
+				return createScheduleOBJ(name, ObjArgs);
+			}
+			else if ( type == pidTag ) 
+			{
+				return createPIDOBJ(name, ObjArgs);
+			}
+			else if ( type == fifoTag || type == lifoTag ) 
+			{
+				return createStackOBJ(name, ObjArgs);
+			}
+			else if ( type == unloadTag1 || type == unloadTag2 ) 
+			{
+				return createStackUnloadOBJ(name, ObjArgs);
+			}
+			else if ( type == shiftLeftTag || type == shiftRightTag ) 
+			{
+				return createShiftRegisterOBJ(name, ObjArgs);
+			}
+			else if ( type == sequencerTag ) 
+			{
+				return createSequencerOBJ(name, ObjArgs);
+			}
+			else if ( type == loggerTag ) 
+			{
+				return createLoggerOBJ(name, ObjArgs);
+			}
+			else if ( objType == OBJ_TYPE::TYPE_MATH_CPT )
+			{
+				return createComputeOBJ(name, ObjArgs);
+			}
+			else if ( objType >= OBJ_TYPE::TYPE_MATH_COP && objType <= OBJ_TYPE::TYPE_MATH_MAX ) //array operations
+			{
+				return createArrayMathOBJ(name, objType, ObjArgs);
+			}
 			else if ( objType != OBJ_TYPE::TYPE_INVALID ) //type == mathTag 
 			{
 				return createMathOBJ(name, objType ,ObjArgs);
@@ -306,12 +792,61 @@ shared_ptr<Ladder_OBJ> PLC_Main::createNewLadderObject(const String &name, const
 	return 0;
 }
 
+bool PLC_Main::addRetentiveOBJ( const String &id, shared_ptr<Ladder_OBJ> obj )
+{
+	shared_ptr<Ladder_VAR> var = findLadderVarByID(id);
+	if ( var == obj ) //a declared variable
+		return retentiveStorage.add(id, var);
+
+	shared_ptr<Ladder_OBJ_Logical> logicalObj = findLadderObjByID(id);
+	if ( !logicalObj || logicalObj != obj )
+		return false;
+
+	return retentiveStorage.add( id + CHAR_VAR_OPERATOR + bitTagACC, logicalObj->getObjectVAR(bitTagACC) ); //timers and counters keep their accumulator
+}
+
 shared_ptr<Ladder_OBJ_Logical> PLC_Main::createInputOBJ( const String &id, const vector<String> &args )
 {
 	uint8_t pin = 0, logic = LOGIC_NO, numArgs = args.size();
+	uint8_t filter = FILTER_NONE;
+	double filterParam = 0, 
+		   scaleMin = 0, scaleMax = ADC_MAX_COUNT, 
+		   thresholdOn = ADC_DEFAULT_THRESHOLD, thresholdOff = ADC_DEFAULT_THRESHOLD;
+	bool capture = false;
 
 	OBJ_TYPE type = OBJ_TYPE::TYPE_INPUT;
 
+	if ( numArgs > 9 ) //analog OFF threshold (EU)
+		thresholdOff = args[9].toDouble();
+
+	if ( numArgs > 8 ) //analog ON threshold (EU)
+	{
+		thresholdOn = args[8].toDouble();
+		if ( numArgs < 10 )
+			thresholdOff = thresholdOn;
+	}
+
+	if ( numArgs > 7 ) //engineering unit scaling
+	{
+		scaleMin = args[6].toDouble();
+		scaleMax = args[7].toDouble();
+	}
+
+	if ( numArgs > 5 ) //averaging/median window or IIR coefficient
+		filterParam = args[5].toDouble();
+
+	if ( numArgs > 4 )
+	{
+		if ( args[4] == typeTagAVG )
+			filter = FILTER_AVG;
+		else if ( args[4] == typeTagMED )
+			filter = FILTER_MEDIAN;
+		else if ( args[4] == typeTagIIR )
+			filter = FILTER_IIR;
+		else if ( args[4].length() )
+			sendError( ERR_DATA::ERR_UNKNOWN_ARGS, args[4] ); 
+	}
+
 	if ( numArgs > 3 )
 		logic = parseLogic(args[3]); //normally open or normally closed.
 
@@ -321,6 +856,8 @@ shared_ptr<Ladder_OBJ_Logical> PLC_Main::createInputOBJ( const String &id, const
 			type = OBJ_TYPE::TYPE_INPUT_ANALOG;
 		else if (args[2] == "D" || args[2] == typeTagDigital )
 			type = OBJ_TYPE::TYPE_INPUT;
+		else if (args[2] == "I" || args[2] == typeTagInterrupt ) //digital input with edge capture
+			capture = true;
 		else
 			sendError( ERR_DATA::ERR_UNKNOWN_ARGS, args[2] ); 
 		
@@ -331,8 +868,21 @@ shared_ptr<Ladder_OBJ_Logical> PLC_Main::createInputOBJ( const String &id, const
 		pin = args[1].toInt(); 
 		if ( isValidPin(pin, type) )
 		{
-			shared_ptr<InputOBJ> newObj(new InputOBJ(id, pin, type, logic));
+			shared_ptr<InputOBJ> newObj(new InputOBJ(id, pin, type, logic, capture, !b_checkOnly));
+			if ( type == OBJ_TYPE::TYPE_INPUT_ANALOG ) //analog inputs are read in the background, not during the scan
+			{
+				if ( !b_checkOnly ) //a check doesn't start the sampler
+				{
+					if ( !analogSampler )
+						analogSampler.reset(new PLC_Analog_Sampler());
+
+					newObj->setAnalogChannel(analogSampler->addChannel(pin, filter, filterParam));
+				}
+				newObj->setScaling(scaleMin, scaleMax);
+				newObj->setThresholds(thresholdOn, thresholdOff);
+			}
 			ladderObjects.emplace_back(newObj); //add to the list of global shared pointers for later reference.
+			inputObjects.emplace_back(newObj); //sampled at the start of each scan
 			setClaimedPin(pin); //set the pin as claimed for this object.
 			#ifdef DEBUG
 			Serial.println(PSTR("NEW INPUT"));
@@ -353,6 +903,15 @@ shared_ptr<Ladder_OBJ_Logical> PLC_Main::createOutputOBJ( const String &id, cons
 	int8_t pwm_channel = 0; //signed because possible -1 (error) value
 
 	double frequency = 5000;
+	bool safeState = false; //de-energized unless configured
+
+	if ( numArgs > 7 ) //state the scan watchdog falls back to
+	{
+		if ( args[7] == "ON" || args[7] == "1" )
+			safeState = true;
+		else if ( args[7] != "OFF" && args[7] != "0" )
+			sendError(ERR_DATA::ERR_UNKNOWN_ARGS, args[7] );
+	}
 
 	if ( numArgs > 6 ) //PWM resolution (bits)
 	{
@@ -409,7 +968,8 @@ shared_ptr<Ladder_OBJ_Logical> PLC_Main::createOutputOBJ( const String &id, cons
 				}
 			}
 
-			shared_ptr<OutputOBJ> newObj(new OutputOBJ(id, pin, type, logic, pwm_channel, duty_cycle, frequency, resolution));
+			shared_ptr<OutputOBJ> newObj(new OutputOBJ(id, pin, type, logic, pwm_channel, duty_cycle, frequency, resolution, !b_checkOnly));
+			newObj->setSafeState(safeState);
 			ladderObjects.emplace_back(newObj);
 			setClaimedPin( pin ); //claim the pin for this object.
 			#ifdef DEBUG
@@ -426,14 +986,26 @@ shared_ptr<Ladder_OBJ_Logical> PLC_Main::createTimerOBJ( const String &id, const
 {
 	uint8_t numArgs = args.size();
 	uint32_t delay = 0, accum = 0;
+	uint16_t timeBase = TIMER_BASE_MS;
 	OBJ_TYPE subType = OBJ_TYPE::TYPE_TIMER_ON;
 
+	if ( numArgs > 4 )
+	{
+		if ( args[4] == typeTagUS )
+			timeBase = TIMER_BASE_US;
+		else if ( args[4] == typeTagMS )
+			timeBase = TIMER_BASE_MS;
+		else
+			sendError(ERR_DATA::ERR_UNKNOWN_ARGS, args[0] + args[4]); 
+	}
 	if ( numArgs > 3 )
 	{	  
 		if ( args[3] == typeTagTOF )
 			subType = OBJ_TYPE::TYPE_TIMER_OFF;
 		else if ( args[3] == typeTagTON )
 			subType = OBJ_TYPE::TYPE_TIMER_ON;
+		else if ( args[3] == typeTagRTO )
+			subType = OBJ_TYPE::TYPE_TIMER_RET;
 		else
 			sendError(ERR_DATA::ERR_UNKNOWN_ARGS, args[0] + args[3]); 
 	}
@@ -445,7 +1017,7 @@ shared_ptr<Ladder_OBJ_Logical> PLC_Main::createTimerOBJ( const String &id, const
 		delay = args[1].toInt(); //verification tests? 
 		if (delay > 1) //Must have a valid delay time. 
 		{
-			shared_ptr<TimerOBJ> newObj(new TimerOBJ(id, delay, accum, subType ));
+			shared_ptr<TimerOBJ> newObj(new TimerOBJ(id, &timerWheel, delay, accum, subType, timeBase ));
 			ladderObjects.emplace_back(newObj);
 			#ifdef DEBUG
 			Serial.println(PSTR("NEW TIMER"));
@@ -488,11 +1060,443 @@ shared_ptr<Ladder_OBJ_Logical> PLC_Main::createCounterOBJ( const String &id, con
 	return 0;
 }
 
+shared_ptr<Ladder_OBJ_Logical> PLC_Main::createHSCounterOBJ( const String &id, const vector<String> &args )
+{
+	int_fast32_t preset = 0, accum = 0;
+	int8_t ctrlPin = PCNT_PIN_NOT_USED;
+	uint16_t filter = HSC_FILTER_DEFAULT;
+	uint8_t numArgs = args.size(),
+			mode = HSCounterOBJ::HSC_MODE_UP;
+
+	if ( numArgs > 6 )
+		filter = args[6].toInt();
+
+	if ( numArgs > 5 ) //control pin, used as the B channel in quadrature mode
+	{
+		uint8_t pin = args[5].toInt();
+		if ( !isValidPin(pin, OBJ_TYPE::TYPE_INPUT) )
+			return 0;
+
+		ctrlPin = pin;
+	}
+
+	if ( numArgs > 4 )
+	{
+		if ( args[4] == typeTagCTU )
+			mode = HSCounterOBJ::HSC_MODE_UP;
+		else if ( args[4] == typeTagCTD )
+			mode = HSCounterOBJ::HSC_MODE_DOWN;
+		else if ( args[4] == typeTagQUAD )
+			mode = HSCounterOBJ::HSC_MODE_QUAD;
+		else
+			sendError(ERR_DATA::ERR_UNKNOWN_ARGS, args[0] + args[4]);
+	}
+
+	if ( mode == HSCounterOBJ::HSC_MODE_QUAD && ctrlPin == PCNT_PIN_NOT_USED ) //quadrature decoding needs both channels
+	{
+		sendError(ERR_DATA::ERR_INSUFFICIENT_ARGS, id );
+		return 0;
+	}
+
+	if ( numArgs > 3 )
+		accum = args[3].toInt();
+
+	if ( numArgs > 2 )
+		preset = args[2].toInt();
+
+	if ( numArgs > 1 )
+	{
+		uint8_t pin = args[1].toInt();
+		if ( pin == ctrlPin )
+		{
+			sendError( ERR_DATA::ERR_PIN_TAKEN, String(pin) );
+			return 0;
+		}
+		if ( isValidPin(pin, OBJ_TYPE::TYPE_INPUT) )
+		{
+			int8_t unit = reservePCNTUnit();
+			if ( unit < 0 )
+			{
+				sendError(ERR_DATA::ERR_OUT_OF_RANGE, String(unit) );
+				return 0; //must be able to reserve a PCNT unit
+			}
+
+			shared_ptr<HSCounterOBJ> newObj(new HSCounterOBJ(id, static_cast<pcnt_unit_t>(unit), pin, ctrlPin, preset, accum, OBJ_TYPE::TYPE_COUNTER_HS, mode, filter, !b_checkOnly));
+			if ( !newObj->getHardwareReady() )
+			{
+				sendError(ERR_DATA::ERR_CREATION_FAILED, id );
+				return 0;
+			}
+
+			ladderObjects.emplace_back(newObj);
+			setClaimedPin(pin);
+			if ( ctrlPin != PCNT_PIN_NOT_USED )
+				setClaimedPin(ctrlPin);
+			#ifdef DEBUG
+			Serial.println(PSTR("NEW HIGH SPEED COUNTER"));
+			#endif
+			return newObj;
+		}
+	}
+	return 0;
+}
+
+shared_ptr<Ladder_OBJ_Logical> PLC_Main::createScheduleOBJ( const String &id, const vector<String> &args )
+{
+	uint8_t numArgs = args.size();
+	vector<Schedule_Window> windows;
+
+	if ( numArgs < 2 ) //must have at least one window
+	{
+		sendError(ERR_DATA::ERR_INSUFFICIENT_ARGS, id );
+		return 0;
+	}
+
+	for ( uint8_t x = 1; x < numArgs; x++ )
+	{
+		Schedule_Window window;
+		if ( !ScheduleOBJ::parseWindow(args[x], window) )
+		{
+			sendError(ERR_DATA::ERR_UNKNOWN_ARGS, args[0] + args[x]);
+			return 0;
+		}
+		windows.push_back(window);
+	}
+
+	shared_ptr<ScheduleOBJ> newObj(new ScheduleOBJ(id, Core.getSystemTimeObj().get(), windows));
+	ladderObjects.emplace_back(newObj);
+	#ifdef DEBUG
+	Serial.println(PSTR("NEW SCHEDULE"));
+	#endif
+	return newObj;
+}
+
+shared_ptr<Ladder_VAR> PLC_Main::findOrCreateFloatVAR( const String &id, const String &arg )
+{
+	if ( !strDataType(arg) ) //variable name or object bit
+	{
+		shared_ptr<Ladder_VAR> var = findLadderVarByID(arg);
+		if ( !var )
+			sendError(ERR_DATA::ERR_INVALID_OBJ, arg);
+
+		return var;
+	}
+
+	return make_shared<Ladder_VAR>( atof(arg.c_str()), id );
+}
+
+shared_ptr<Ladder_OBJ_Logical> PLC_Main::createPIDOBJ( const String &id, const vector<String> &args )
+{
+	uint8_t numArgs = args.size();
+	uint32_t period = PID_DEFAULT_PERIOD;
+	double outMin = PID_DEFAULT_MIN, outMax = PID_DEFAULT_MAX;
+
+	if ( numArgs < 4 ) //must have a PV, SP, and CV
+	{
+		sendError(ERR_DATA::ERR_INSUFFICIENT_ARGS, id );
+		return 0;
+	}
+	if ( numArgs > 10 )
+		sendError(ERR_DATA::ERR_UNKNOWN_ARGS, args[0] + args[10]);
+
+	if ( numArgs > 9 )
+		outMax = args[9].toDouble();
+	if ( numArgs > 8 )
+		outMin = args[8].toDouble();
+	if ( numArgs > 7 )
+		period = args[7].toInt();
+
+	if ( !period || outMin >= outMax )
+	{
+		sendError(ERR_DATA::ERR_OUT_OF_RANGE, id );
+		return 0;
+	}
+
+	shared_ptr<Ladder_VAR> pv = findOrCreateFloatVAR( bitTagPV, args[1] ),
+						   sp = findOrCreateFloatVAR( bitTagSP, args[2] ),
+						   cv = findOrCreateFloatVAR( bitTagCV, args[3] ),
+						   kp = findOrCreateFloatVAR( bitTagKP, numArgs > 4 ? args[4] : String("1") ),
+						   ki = findOrCreateFloatVAR( bitTagKI, numArgs > 5 ? args[5] : String("0") ),
+						   kd = findOrCreateFloatVAR( bitTagKD, numArgs > 6 ? args[6] : String("0") );
+
+	if ( !pv || !sp || !cv || !kp || !ki || !kd )
+		return 0;
+
+	shared_ptr<PIDOBJ> newObj(new PIDOBJ(id, &timerWheel, pv, sp, cv, kp, ki, kd, period, outMin, outMax));
+	ladderObjects.emplace_back(newObj);
+	#ifdef DEBUG
+	Serial.println(PSTR("NEW PID"));
+	#endif
+	return newObj;
+}
+
+shared_ptr<Ladder_OBJ_Logical> PLC_Main::createStackOBJ( const String &id, const vector<String> &args )
+{
+	uint8_t numArgs = args.size();
+	if ( numArgs < 3 ) //must have a source and a depth
+	{
+		sendError(ERR_DATA::ERR_INSUFFICIENT_ARGS, id );
+		return 0;
+	}
+	if ( numArgs > 4 )
+		sendError(ERR_DATA::ERR_UNKNOWN_ARGS, args[0] + args[4]);
+
+	shared_ptr<Ladder_VAR> source = findLadderVarByID(args[1]), dest = 0;
+	if ( !source || Ladder_Array::getStorageType(source->getType()) == OBJ_TYPE::TYPE_INVALID )
+	{
+		sendError(ERR_DATA::ERR_INVALID_OBJ, args[1]);
+		return 0;
+	}
+
+	int64_t depth = parseInt(args[2]);
+	if ( strDataType(args[2]) != 1 || depth < 1 || depth > ARRAY_MAX_LENGTH )
+	{
+		sendError(ERR_DATA::ERR_OUT_OF_RANGE, id + CHAR_SPACE + args[2] );
+		return 0;
+	}
+
+	if ( numArgs > 3 )
+	{
+		dest = findLadderVarByID(args[3]);
+		if ( !dest )
+		{
+			sendError(ERR_DATA::ERR_INVALID_OBJ, args[3]);
+			return 0;
+		}
+	}
+
+	shared_ptr<StackOBJ> newObj(new StackOBJ(id, source, depth, dest, args[0] == lifoTag ? OBJ_TYPE::TYPE_LIFO : OBJ_TYPE::TYPE_FIFO));
+	ladderObjects.emplace_back(newObj);
+	#ifdef DEBUG
+	Serial.println(PSTR("NEW STACK"));
+	#endif
+	return newObj;
+}
+
+shared_ptr<Ladder_OBJ_Logical> PLC_Main::createStackUnloadOBJ( const String &id, const vector<String> &args )
+{
+	if ( args.size() < 2 )
+	{
+		sendError(ERR_DATA::ERR_INSUFFICIENT_ARGS, id );
+		return 0;
+	}
+	if ( args.size() > 2 )
+		sendError(ERR_DATA::ERR_UNKNOWN_ARGS, args[0] + args[2]);
+
+	shared_ptr<Ladder_OBJ_Logical> stack = findLadderObjByID(args[1]);
+	if ( !stack || ( stack->getType() != OBJ_TYPE::TYPE_FIFO && stack->getType() != OBJ_TYPE::TYPE_LIFO ) )
+	{
+		sendError(ERR_DATA::ERR_INVALID_OBJ, args[1]);
+		return 0;
+	}
+
+	shared_ptr<StackUnloadOBJ> newObj(new StackUnloadOBJ(id, static_pointer_cast<StackOBJ>(stack)));
+	ladderObjects.emplace_back(newObj);
+	#ifdef DEBUG
+	Serial.println(PSTR("NEW STACK UNLOAD"));
+	#endif
+	return newObj;
+}
+
+shared_ptr<Ladder_OBJ_Logical> PLC_Main::createShiftRegisterOBJ( const String &id, const vector<String> &args )
+{
+	if ( args.size() < 3 ) //must have an input bit and a length
+	{
+		sendError(ERR_DATA::ERR_INSUFFICIENT_ARGS, id );
+		return 0;
+	}
+	if ( args.size() > 3 )
+		sendError(ERR_DATA::ERR_UNKNOWN_ARGS, args[0] + args[3]);
+
+	shared_ptr<Ladder_VAR> bit = 0;
+	if ( strDataType(args[1]) )
+		bit = createVariableInstance(bitTagVAL, args[1]);
+	else
+		bit = findLadderVarByID(args[1]);
+
+	if ( !bit )
+	{
+		sendError(ERR_DATA::ERR_INVALID_OBJ, args[1]);
+		return 0;
+	}
+
+	int64_t length = parseInt(args[2]);
+	if ( strDataType(args[2]) != 1 || length < 1 || length > SHIFT_MAX_LENGTH )
+	{
+		sendError(ERR_DATA::ERR_OUT_OF_RANGE, id + CHAR_SPACE + args[2] );
+		return 0;
+	}
+
+	shared_ptr<ShiftRegisterOBJ> newObj(new ShiftRegisterOBJ(id, bit, length, args[0] == shiftRightTag ? OBJ_TYPE::TYPE_SHIFT_RIGHT : OBJ_TYPE::TYPE_SHIFT_LEFT));
+	ladderObjects.emplace_back(newObj);
+	#ifdef DEBUG
+	Serial.println(PSTR("NEW SHIFT REGISTER"));
+	#endif
+	return newObj;
+}
+
+shared_ptr<Ladder_OBJ_Logical> PLC_Main::createSequencerOBJ( const String &id, const vector<String> &args )
+{
+	shared_ptr<Ladder_VAR> dest = 0;
+	uint16_t first = 1;
+	if ( args.size() > 1 && !strContains(args[1], CHAR_ACCESSOR_OPERATOR) ) //a lone name before the steps is the destination
+	{
+		dest = findLadderVarByID(args[1]);
+		if ( !dest )
+		{
+			sendError(ERR_DATA::ERR_INVALID_OBJ, args[1]);
+			return 0;
+		}
+		first = 2;
+	}
+
+	vector<String> stepArgs;
+	int16_t depth = 0; //parenthesis depth, function arguments in a condition were split apart with the object arguments
+	for ( uint16_t x = first; x < args.size(); x++ )
+	{
+		if ( depth > 0 )
+			stepArgs.back() += CHAR_COMMA + args[x];
+		else
+			stepArgs.push_back(args[x]);
+
+		for ( uint16_t y = 0; y < args[x].length(); y++ )
+		{
+			if ( args[x][y] == CHAR_P_START )
+				depth++;
+			else if ( args[x][y] == CHAR_P_END )
+				depth--;
+		}
+	}
+
+	if ( !stepArgs.size() )
+	{
+		sendError(ERR_DATA::ERR_INSUFFICIENT_ARGS, id );
+		return 0;
+	}
+	if ( stepArgs.size() > SEQ_MAX_STEPS )
+	{
+		sendError(ERR_DATA::ERR_OUT_OF_RANGE, id + CHAR_SPACE + String(stepArgs.size()) );
+		return 0;
+	}
+
+	vector<Sequencer_Step> steps(stepArgs.size());
+	for ( uint16_t x = 0; x < stepArgs.size(); x++ )
+	{
+		const String &str = stepArgs[x];
+		Sequencer_Step &step = steps[x];
+		step.i_time = 0;
+		step.b_active = false;
+		step.i_next = ( x + 1U < stepArgs.size() ) ? x + 1 : SEQ_DONE; //the last step completes the sequence by default
+
+		int timePos = str.indexOf(CHAR_ACCESSOR_OPERATOR), restPos = ( timePos < 0 ) ? -1 : str.indexOf(CHAR_ACCESSOR_OPERATOR, timePos + 1);
+		String mask = str.substring(0, timePos), time = ( restPos < 0 ) ? str.substring(timePos + 1) : str.substring(timePos + 1, restPos);
+		int64_t maskVal = parseInt(mask), timeVal = parseInt(time);
+		if ( timePos < 0 || strDataType(mask) != 1 || strDataType(time) != 1 || maskVal < 0 || maskVal > UINT32_MAX || timeVal < 0 || timeVal > UINT32_MAX )
+		{
+			sendError(ERR_DATA::ERR_UNKNOWN_ARGS, id + CHAR_SPACE + str );
+			return 0;
+		}
+		step.i_mask = maskVal;
+		step.i_preset = timeVal;
+
+		String condition;
+		if ( restPos >= 0 )
+		{
+			condition = str.substring(restPos + 1);
+			int condPos = condition.indexOf(CHAR_ACCESSOR_OPERATOR);
+			String next = ( condPos < 0 ) ? condition : condition.substring(0, condPos);
+			if ( strDataType(next) == 1 ) //a plain number is the next step, the rest is the condition
+			{
+				int64_t nextVal = parseInt(next);
+				if ( nextVal < 0 || static_cast<uint64_t>(nextVal) >= stepArgs.size() )
+				{
+					sendError(ERR_DATA::ERR_OUT_OF_RANGE, id + CHAR_SPACE + str );
+					return 0;
+				}
+				step.i_next = nextVal;
+				condition = ( condPos < 0 ) ? String() : condition.substring(condPos + 1);
+			}
+		}
+
+		if ( condition.length() )
+		{
+			step.condition = make_shared<ComputeBlockOBJ>(id + CHAR_VAR_OPERATOR + String(x));
+			if ( !step.condition->compile(condition, bind(&PLC_Main::findLadderVarByID, this, placeholders::_1)) )
+			{
+				sendError(ERR_DATA::ERR_INVALID_EXPRESSION, step.condition->getCompileError());
+				return 0;
+			}
+		}
+	}
+
+	shared_ptr<SequencerOBJ> newObj(new SequencerOBJ(id, &timerWheel, steps, dest));
+	ladderObjects.emplace_back(newObj);
+	#ifdef DEBUG
+	Serial.println(PSTR("NEW SEQUENCER"));
+	#endif
+	return newObj;
+}
+
+shared_ptr<Ladder_OBJ_Logical> PLC_Main::createLoggerOBJ( const String &id, const vector<String> &args )
+{
+	if ( args.size() < 3 ) //must have a period and at least one variable
+	{
+		sendError(ERR_DATA::ERR_INSUFFICIENT_ARGS, id );
+		return 0;
+	}
+	if ( id.length() > LOG_MAX_NAME ) //the ID is used for the log file names
+	{
+		sendError(ERR_DATA::ERR_NAME_TOO_LONG, id );
+		return 0;
+	}
+	if ( args.size() - 2 > LOG_MAX_VARS )
+	{
+		sendError(ERR_DATA::ERR_OUT_OF_RANGE, id + CHAR_SPACE + String(args.size() - 2) );
+		return 0;
+	}
+
+	int64_t period = parseInt(args[1]);
+	if ( strDataType(args[1]) != 1 || period < 0 || period > UINT32_MAX )
+	{
+		sendError(ERR_DATA::ERR_OUT_OF_RANGE, id + CHAR_SPACE + args[1] );
+		return 0;
+	}
+
+	vector<shared_ptr<Ladder_VAR>> vars;
+	vector<String> names;
+	for ( uint8_t x = 2; x < args.size(); x++ )
+	{
+		shared_ptr<Ladder_VAR> var = findLadderVarByID(args[x]);
+		if ( !var || !var->getValuePtr() ) //strings and arrays can't be logged
+		{
+			sendError(ERR_DATA::ERR_INVALID_OBJ, args[x]);
+			return 0;
+		}
+		vars.push_back(var);
+		names.push_back(args[x]);
+	}
+
+	shared_ptr<LoggerOBJ> newObj(new LoggerOBJ(id, &timerWheel, vars, names, period, OBJ_TYPE::TYPE_LOGGER, !b_checkOnly));
+	if ( !b_checkOnly && !newObj->hasWriter() ) //out of memory for the writer task, the samples would never reach the flash
+	{
+		sendError(ERR_DATA::ERR_CREATION_FAILED, id );
+		return 0;
+	}
+	ladderObjects.emplace_back(newObj);
+	#ifdef DEBUG
+	Serial.println(PSTR("NEW LOGGER"));
+	#endif
+	return newObj;
+}
+
 //TODO - Implement some way where a user can easily dictate which variable type to use for memory purposes, otherwise default to auto-detection (maybe always estimate high? 64-bit?).
 shared_ptr<Ladder_OBJ_Logical> PLC_Main::createVariableOBJ( const String &id, const vector<String> &args )
 {
 	shared_ptr<Ladder_VAR> newObj = 0;
 
+	if ( args.size() > 3 ) //a length was given, so this is an array
+		return createArrayOBJ(id, args);
+
 	//could use an else here for but it really doesn't matter
 	if ( args.size() > 1 )
 	{
@@ -580,6 +1584,55 @@ shared_ptr<Ladder_OBJ_Logical> PLC_Main::createVariableOBJ( const String &id, co
 	return newObj;
 }
 
+shared_ptr<Ladder_OBJ_Logical> PLC_Main::createArrayOBJ( const String &id, const vector<String> &args )
+{
+	if ( args.size() > 4 )
+		sendError(ERR_DATA::ERR_UNKNOWN_ARGS, args[0] + args[4]);
+
+	OBJ_TYPE elementType = OBJ_TYPE::TYPE_INVALID;
+	if ( args[2] == VAR_INT32 )
+		elementType = OBJ_TYPE::TYPE_VAR_INT;
+	else if ( args[2] == VAR_UINT32 )
+		elementType = OBJ_TYPE::TYPE_VAR_UINT;
+	else if ( args[2] == VAR_INT64 )
+		elementType = OBJ_TYPE::TYPE_VAR_LONG;
+	else if ( args[2] == VAR_UINT64 )
+		elementType = OBJ_TYPE::TYPE_VAR_ULONG;
+	else if ( args[2] == VAR_DOUBLE )
+		elementType = OBJ_TYPE::TYPE_VAR_FLOAT;
+	else if ( args[2] == VAR_BOOL || args[2] == VAR_BOOLEAN )
+		elementType = OBJ_TYPE::TYPE_VAR_BOOL;
+	else
+	{
+		sendError(ERR_DATA::ERR_INCORRECT_VAR_TYPE, args[2]);
+		return 0;
+	}
+
+	int64_t length = parseInt(args[3]);
+	if ( strDataType(args[3]) != 1 || length < 1 || length > ARRAY_MAX_LENGTH )
+	{
+		sendError(ERR_DATA::ERR_OUT_OF_RANGE, id + CHAR_SPACE + args[3] );
+		return 0;
+	}
+
+	shared_ptr<Ladder_Array> newObj(new Ladder_Array(id, elementType, length));
+
+	if ( args[1] == "TRUE" )
+		newObj->setAll(true);
+	else if ( elementType == OBJ_TYPE::TYPE_VAR_FLOAT )
+		newObj->setAll( atof(args[1].c_str()) );
+	else if ( elementType == OBJ_TYPE::TYPE_VAR_ULONG )
+		newObj->setAll( static_cast<uint64_t>(strtoull(args[1].c_str(), NULL, 10)) );
+	else if ( args[1] != "FALSE" ) //storage starts zeroed
+		newObj->setAll( static_cast<int64_t>(atoll(args[1].c_str())) );
+
+	ladderObjects.emplace_back(newObj);
+	#ifdef DEBUG
+	Serial.println( PSTR("New array has length: ") + String(newObj->getLength()) );
+	#endif
+	return newObj;
+}
+
 shared_ptr<Ladder_VAR> PLC_Main::createVariableInstance(const String &id, const String &arg)
 {
 	shared_ptr<Ladder_VAR> newVar = 0;
@@ -588,7 +1641,7 @@ shared_ptr<Ladder_VAR> PLC_Main::createVariableInstance(const String &id, const
 	if ( dataType == 2) //double type
 		newVar = make_shared<Ladder_VAR>( atof(arg.c_str()),id);
 	else if ( dataType == 1)//integer type
-		newVar = make_shared<Ladder_VAR>( atoll(arg.c_str()),id);
+		newVar = make_shared<Ladder_VAR>( static_cast<int64_t>(atoll(arg.c_str())),id);
 
 	return newVar;
 }
@@ -684,6 +1737,134 @@ shared_ptr<Ladder_OBJ_Logical> PLC_Main::createMathOBJ( const String &id, OBJ_TY
 	return newObj;
 }
 
+shared_ptr<Ladder_OBJ_Logical> PLC_Main::createComputeOBJ( const String &id, const vector<String> &args )
+{
+	if ( args.size() < 2 )
+	{
+		sendError(ERR_DATA::ERR_MATH_TOO_FEW_ARGS, id);
+		return 0;
+	}
+
+	shared_ptr<Ladder_VAR> dest = 0;
+	uint8_t exprStart = 1;
+	if ( args.size() > 2 && !strContains(args[1], vector<char>{CHAR_P_START, CHAR_P_END}) ) //a lone name before the expression is the destination
+	{
+		dest = findLadderVarByID(args[1]);
+		if ( !dest )
+		{
+			sendError(ERR_DATA::ERR_INVALID_OBJ, args[1]);
+			return 0;
+		}
+		exprStart = 2;
+	}
+
+	String expr = args[exprStart];
+	for ( uint8_t x = exprStart + 1; x < args.size(); x++ ) //function arguments were split apart with the object arguments
+		expr += CHAR_COMMA + args[x];
+
+	shared_ptr<ComputeBlockOBJ> newObj(new ComputeBlockOBJ(id, dest));
+	if ( !newObj->compile(expr, bind(&PLC_Main::findLadderVarByID, this, placeholders::_1)) )
+	{
+		sendError(ERR_DATA::ERR_INVALID_EXPRESSION, newObj->getCompileError());
+		return 0;
+	}
+
+	ladderObjects.emplace_back(newObj);
+	#ifdef DEBUG
+	Serial.println(PSTR("NEW CPT"));
+	#endif
+	return newObj;
+}
+
+shared_ptr<Ladder_OBJ_Logical> PLC_Main::createArrayMathOBJ( const String &id, OBJ_TYPE type, const vector<String> &args )
+{
+	uint8_t argSize = args.size(),
+			numRequired = ( type == OBJ_TYPE::TYPE_MATH_COP || type == OBJ_TYPE::TYPE_MATH_FILL || type == OBJ_TYPE::TYPE_MATH_FIND ) ? 3 : 2;
+
+	if ( argSize < numRequired )
+	{
+		sendError(ERR_DATA::ERR_MATH_TOO_FEW_ARGS, id);
+		return 0;
+	}
+
+	shared_ptr<Ladder_Array> source = 0, destination = 0;
+	shared_ptr<Ladder_VAR> value = 0, result = 0;
+	uint32_t srcStart = 0, destStart = 0;
+	String arrayArg = ( type == OBJ_TYPE::TYPE_MATH_FILL ) ? args[2] : args[1],
+		   otherArg = ( type == OBJ_TYPE::TYPE_MATH_FILL ) ? args[1] : args[2];
+
+	if ( type == OBJ_TYPE::TYPE_MATH_FILL )
+		destination = findLadderArrayByID(arrayArg, destStart);
+	else
+		source = findLadderArrayByID(arrayArg, srcStart);
+
+	if ( !source && !destination )
+	{
+		sendError(ERR_DATA::ERR_INVALID_OBJ, arrayArg);
+		return 0;
+	}
+
+	if ( type == OBJ_TYPE::TYPE_MATH_COP )
+	{
+		destination = findLadderArrayByID(otherArg, destStart);
+		if ( !destination )
+		{
+			sendError(ERR_DATA::ERR_INVALID_OBJ, otherArg);
+			return 0;
+		}
+	}
+	else if ( type == OBJ_TYPE::TYPE_MATH_FILL || type == OBJ_TYPE::TYPE_MATH_FIND )
+	{
+		if ( strDataType(otherArg) )
+			value = createVariableInstance(bitTagVAL, otherArg);
+		else
+			value = findLadderVarByID(otherArg);
+
+		if ( !value )
+		{
+			sendError(ERR_DATA::ERR_INVALID_OBJ, otherArg);
+			return 0;
+		}
+	}
+
+	//Range defaults to the rest of the array(s), from the start element(s)
+	uint32_t length = source ? source->getLength() - srcStart : destination->getLength() - destStart;
+	if ( source && destination )
+		length = min( length, destination->getLength() - destStart );
+
+	for ( uint8_t x = numRequired; x < argSize; x++ ) //optional DEST variable and/or LEN
+	{
+		if ( strDataType(args[x]) == 1 )
+		{
+			int64_t tempLen = parseInt(args[x]);
+			if ( tempLen < 1 || tempLen > length )
+			{
+				sendError(ERR_DATA::ERR_OUT_OF_RANGE, id + CHAR_SPACE + args[x] );
+				return 0;
+			}
+			length = tempLen;
+		}
+		else if ( !result && type != OBJ_TYPE::TYPE_MATH_COP && type != OBJ_TYPE::TYPE_MATH_FILL && !strDataType(args[x]) )
+		{
+			result = findLadderVarByID(args[x]);
+			if ( !result )
+			{
+				sendError(ERR_DATA::ERR_INVALID_OBJ, args[x]);
+				return 0;
+			}
+		}
+		else
+			sendError(ERR_DATA::ERR_UNKNOWN_ARGS, args[0] + args[x]);
+	}
+
+	shared_ptr<ArrayBlockOBJ> newObj(new ArrayBlockOBJ(id, type, source, srcStart, destination, destStart, length, value, result));
+	ladderObjects.emplace_back(newObj);
+	#ifdef DEBUG
+	Serial.println(PSTR("NEW ARRAY BLOCK"));
+	#endif
+	return newObj;
+}
+
 shared_ptr<Ladder_OBJ_Accessor> PLC_Main::createRemoteClient( const String &id, const vector<String> &args )
 {
 	//Args: IP, Port, Timeout Time
@@ -901,6 +2082,17 @@ void PLC_Main::sendError(ERR_DATA err, const String &info )
 			error = err_math_division_by_zero;
 		}
 		break;
+		case ERR_DATA::ERR_INVALID_EXPRESSION:
+		{
+			error = err_failed_creation + CHAR_SPACE + err_invalid_expression;
+		}
+		break;
+	}
+
+	if ( b_checkOnly ) //collect every error, the running program is never touched
+	{
+		addDiagnostic( info.length() ? error + CHAR_SPACE + "\"" + info + "\"" : error, info );
+		return;
 	}
 
 	if ( info.length() )
@@ -16,13 +16,49 @@
 #include "PLC_IO.h"
 #include "PLC_Rung.h"
 #include "PLC_Parser.h"
+#include "PLC_Analog.h"
+#include "PLC_Timer.h"
+#include "PLC_Retain.h"
+#include "PLC_Task.h"
+#include "PLC_Watchdog.h"
 #include <HardwareSerial.h>
 #include "../CORE/UICore.h"
+#include "../CORE/Trace.h"
+#include "../CORE/HeapStats.h"
+#include <SPIFFS.h>
+
+#define SCRIPT_CHUNK_SIZE 256 //bytes of a script file read at a time by the parser
+#define SCRIPT_CHECK_MAX_DIAGNOSTICS 32 //errors kept by a script check, later ones are only counted
+#define SCAN_COST_NODE_NS 400 //rough cost of one rung node (object reference) in the scan, used to estimate the scan time of a checked script
+#define SCAN_COST_OBJECT_NS 1500 //rough cost of one object update at the end of the scan
 
 using namespace std;
 
 extern UICore Core;
 
+class InputOBJ;
+class Ladder_Array;
+
+//An error found by a script check.
+struct Script_Diagnostic
+{
+	uint16_t i_line, //line of the script, starting at 1
+			 i_column; //column of the offending name or argument in the line, starting at 1. 0 if it isn't known.
+	String s_message;
+};
+
+//Resources that a checked script would use once applied.
+struct Script_Check_Report
+{
+	uint16_t i_numObjects, //logic objects and accessors
+			 i_numVars,
+			 i_numRungs,
+			 i_numNodes, //object references in all rungs
+			 i_numErrors; //including any beyond SCRIPT_CHECK_MAX_DIAGNOSTICS
+	uint32_t i_heapUsed, //bytes
+			 i_scanEstimate; //uS
+};
+
 /*Remote controlling of other "ESPLC" devices:
 MODE 1: - The secondary device acts purely as an IO expander, where the primary device initializes ladder objects on the secondary, and sends updates to it as necessary. 
 		The secondary device performs no logic processing.  
@@ -81,10 +117,19 @@ class PLC_Main
 	PLC_Main()
 	{
 		currentScript = make_shared<String>(); //initialize the smart pointer
+		b_checkOnly = false;
+		i_numErrors = 0;
+		i_parseLine = 0;
+		i_parseColumn = 0;
+		b_lastCarriage = false;
+		i_currentTask = 0;
 	}
 	~PLC_Main()
 	{
+		tasks.clear(); //stops any dual core workers before the rungs go away
 		ladderRungs.clear(); //empty our vectors -- should also delete the objects once they are no longer referenced (smart pointers)
+		inputObjects.clear();
+		analogSampler.reset();
 		ladderObjects.clear();
 		accessorObjects.clear();
 		ladderVars.clear();
@@ -95,6 +140,10 @@ class PLC_Main
 	void generatePWMMap();
 	//This is used to reserve an available PWM channel from the PWM map. A return value of -1 indicatces a failure
 	int8_t reservePWMChannel();
+	//Generates the map used for determining the available PCNT (pulse counter) units that can be used by a high speed counter.
+	void generatePCNTMap();
+	//This is used to reserve an available PCNT unit from the PCNT map. A return value of -1 indicatces a failure
+	int8_t reservePCNTUnit();
 
 	//Overloaded function that parses a logic script by string reference.
 	//Returns true on success.
@@ -104,25 +153,57 @@ class PLC_Main
 	bool parseScript(String *script){ return parseScript(script->c_str()); }
 	//This function parses an inputted logic script and breaks it into individual lines, which ultimately create the logic objects and rungs as appropriate.
 	bool parseScript(const char *);
+	//Parses a logic script straight from a file, SCRIPT_CHUNK_SIZE bytes at a time, so the size of the script isn't limited by the free heap.
+	bool parseScript(File &);
+	//Parses the script into a separate PLC_Main object in check only mode, and reports the resources it would use. Every error is collected (with its line and column)
+	//rather than stopping at the first one. No hardware is claimed, and the running program keeps running.
+	//Args: <Script file>, <Errors found>
+	static Script_Check_Report checkScript( File &, vector<Script_Diagnostic> & );
 	//Used to parse the appropriate logic tags from the logic script and return the associated byte.
 	uint8_t parseLogic( const String & );
 	//Used to send specific errors to both the web interface, as well as the serial.
 	void sendError(ERR_DATA, const String & = ""); 
 	//This function is responsible for destructing all rungs and objects before reconstructing the ladder logic program.
 	void resetAll(); 
-	//This function adds the inputted ladder rung into the ladder rung vector.
+	//This function adds the inputted ladder rung into the ladder rung vector, and to the task section being parsed.
 	bool addLadderRung(shared_ptr<Ladder_Rung>);
+	//Starts (or continues) a task section. Rungs that follow are added to the task. Script args: [0] = name, [1] = period (MS by default, or US), 0 for continuous
+	bool beginTask( const vector<String> & );
 	//Creates a new ladder object based in inputted TYPE argument (parsed from the logic script), once the arguments for each ne wobject have been parsed, the appropriate 
 	//object is created, paired with its name for later reference by the parser. 
 	shared_ptr<Ladder_OBJ> createNewLadderObject( const String &, const vector<String> &);
-	//Creates a new OUTPUT type object, based on the inputted arguments. Script args: [1] = output pin, [2] = NO/NC
+	//Adds the value of a newly created object to the retentive storage. Variables are kept as is, other objects keep their accumulator (ACC).
+	bool addRetentiveOBJ( const String &, shared_ptr<Ladder_OBJ> );
+	//Creates a new OUTPUT type object, based on the inputted arguments. Script args: [1] = output pin, [2] = type (digital/PWM), [3] = NO/NC
+	//PWM only: [4] = duty cycle, [5] = frequency, [6] = resolution (bits). [7] = safe state applied by the scan watchdog (OFF (default) or ON), EX: O1[OUTPUT,2,PWM,NO,512,5000,10,ON]
 	shared_ptr<Ladder_OBJ_Logical> createOutputOBJ( const String &, const vector<String> &);
-	//Creates an input object and associates it with a name. Script args: [1] = input pin, [2] = type (analog/digital), [3] = logic
+	//Creates an input object and associates it with a name. Script args: [1] = input pin, [2] = type (analog/digital/interrupt), [3] = logic
+	//Analog only: [4] = filter (AVG/MED/IIR), [5] = window size or IIR alpha, [6] = EU min, [7] = EU max, [8] = ON threshold (EU), [9] = OFF threshold (EU)
 	shared_ptr<Ladder_OBJ_Logical> createInputOBJ( const String &, const vector<String> &);
 	//Creates a counter object and associates it with a name. Script args: [1] = count value, [2] = accum, [3] = subtype(CTU/CTD)
 	shared_ptr<Ladder_OBJ_Logical> createCounterOBJ( const String &, const vector<String> &);
-	//Creates a new timer object and associates it with a name. Script args: [1] = delay(ms), [2]= accum default(ms), [3] = subtype(TON/TOF)
+	//Creates a new timer object and associates it with a name. Script args: [1] = delay, [2]= accum default, [3] = subtype(TON/TOF/RTO), [4] = time base(MS/US)
 	shared_ptr<Ladder_OBJ_Logical> createTimerOBJ( const String &, const vector<String> &);
+	//Creates a high speed (PCNT) counter object and associates it with a name. 
+	//Script args: [1] = input pin, [2] = preset, [3] = accum, [4] = subtype(CTU/CTD/QUAD), [5] = control pin (QUAD B channel), [6] = filter (APB cycles)
+	shared_ptr<Ladder_OBJ_Logical> createHSCounterOBJ( const String &, const vector<String> &);
+	//Creates a schedule object and associates it with a name. Script args: [1...n] = time windows ([DAYS-]HHMM-HHMM, EX: MTWRF-0600-1800)
+	shared_ptr<Ladder_OBJ_Logical> createScheduleOBJ( const String &, const vector<String> &);
+	//Creates a PID controller object and associates it with a name. Sources may be variables/object bits or constants.
+	//Script args: [1] = PV, [2] = SP, [3] = CV, [4] = KP, [5] = KI, [6] = KD, [7] = sample period (ms), [8] = CV min, [9] = CV max
+	shared_ptr<Ladder_OBJ_Logical> createPIDOBJ( const String &, const vector<String> &);
+	//Creates a FIFO/LIFO stack object and associates it with a name. Script args: [1] = source variable, [2] = depth, [3] = destination variable (optional)
+	shared_ptr<Ladder_OBJ_Logical> createStackOBJ( const String &, const vector<String> &);
+	//Creates an unload object for an existing FIFO/LIFO stack. Script args: [1] = stack name
+	shared_ptr<Ladder_OBJ_Logical> createStackUnloadOBJ( const String &, const vector<String> &);
+	//Creates a bit shift register object (BSL/BSR) and associates it with a name. Script args: [1] = bit to shift in (variable/object bit or 0/1), [2] = length
+	shared_ptr<Ladder_OBJ_Logical> createShiftRegisterOBJ( const String &, const vector<String> &);
+	//Creates a step sequencer object and associates it with a name. Script args: [1] = destination variable for the step mask (optional), [2..] = steps as MASK:TIME[:NEXT][:CONDITION]
+	shared_ptr<Ladder_OBJ_Logical> createSequencerOBJ( const String &, const vector<String> &);
+	//Creates a data logger object and associates it with a name. Script args: [1] = sample period (mS, 0 samples on the rising edge of the rung), [2..] = variables to sample
+	shared_ptr<Ladder_OBJ_Logical> createLoggerOBJ( const String &, const vector<String> &);
+	//Returns the variable referenced by the inputted argument, or creates a new floating point variable with the inputted ID if the argument is a constant.
+	shared_ptr<Ladder_VAR> findOrCreateFloatVAR( const String &, const String & );
 	//Creates a new basic math object, which is capable of performing a series of simple calculations based on inputted arguments.
 
 	//shared_ptr<Ladder_OBJ> createMathOBJ( const String &, const vector<String> &);
@@ -130,9 +211,16 @@ class PLC_Main
 	shared_ptr<Ladder_OBJ_Logical> createOneshotOBJ();
     //Creates a new basic math object, which is capable of performing a series of simple calculations based on inputted arguments.
 	shared_ptr<Ladder_OBJ_Logical> createMathOBJ( const String &, OBJ_TYPE, const vector<String> &);
+	//Creates a new compute block, which evaluates an expression that is compiled when the script is loaded. Script args: [1] = DEST (optional), [2] = expression
+	shared_ptr<Ladder_OBJ_Logical> createComputeOBJ( const String &, const vector<String> &);
+	//Creates a new bulk array operation block. Arrays may be given a start element (ARR.5). Trailing args are DEST (variable name) and/or LEN (integer), in either order.
+	//Script args: COP: [1] = source array, [2] = dest array | FILL: [1] = value, [2] = dest array | FIND: [1] = array, [2] = value | SUM/AVG/MIN/MAX: [1] = array
+	shared_ptr<Ladder_OBJ_Logical> createArrayMathOBJ( const String &, OBJ_TYPE, const vector<String> &);
 	//Creates a new variable type object which represents a stored value in memory, to be accessed by other objects such as counters or timers or comparison blocks, etc.
 	//Stored on the global list of initialized ladder objects for reference.
 	shared_ptr<Ladder_OBJ_Logical> createVariableOBJ( const String &, const vector<String> &);
+	//Creates a new array variable object. Called by createVariableOBJ when a length is given. Script args: [1] = initial value, [2] = type, [3] = length
+	shared_ptr<Ladder_OBJ_Logical> createArrayOBJ( const String &, const vector<String> &);
 	//Creates a ladder variable object for reference by a different part of the code based on the type of data stored in the argument string.
 	shared_ptr<Ladder_VAR> createVariableInstance( const String &, const String &);
 	//Creates a ladder object reference that represents the current state of an object that is initialized on another ESPLC device.
@@ -163,6 +251,8 @@ class PLC_Main
 	//Returns the created variable object that corresponds to it's unique ID
 	//Args: Ladder Var Vector, Unique ID
 	shared_ptr<Ladder_VAR> findLadderVarByID( const String & );
+	//Returns the created array object that corresponds to it's unique ID. An element may be given with the var operator (ARR.5), which is stored in the second argument.
+	shared_ptr<Ladder_Array> findLadderArrayByID( const String &, uint32_t & );
 
 	//This function scan for nodes on the given port
 	vector<IPAddress> scanForRemoteNodes( uint16_t, uint8_t, uint8_t, uint16_t );
@@ -176,6 +266,12 @@ class PLC_Main
 	vector<shared_ptr<Ladder_VAR>> &getLadderVars(){ return ladderVars; }
 	//Returns the locally stored pointer to the PLC web status server.
 	unique_ptr<PLC_Remote_Server> &getRemoteServer(){ return remoteServer; }
+	//Returns the retentive storage service, which keeps the values of objects declared with the RET flag.
+	PLC_Retain &getRetentiveStorage(){ return retentiveStorage; }
+	//Returns the tasks of the current program, highest priority first.
+	vector<shared_ptr<PLC_Task>> &getTasks(){ return tasks; }
+	//Returns the scan watchdog, which checks each scan against the time budget set in the device settings.
+	PLC_Scan_Watchdog &getScanWatchdog(){ return scanWatchdog; }
 	//Returns a reference to the local storage container for initialized Ladder_OBJ_Accessor objects.
 	vector<shared_ptr<Ladder_OBJ_Accessor>> &getAccessorObjects() { return accessorObjects; }
 	//Returns the number of accessors in the locally stored accessor container.
@@ -185,18 +281,54 @@ class PLC_Main
 	void processLogic(); 
 		
 	private:
+	//Clears the previous program and any errors, before a script is parsed.
+	void beginScript();
+	//Records an error found in check only mode. Args: <Message>, <Name or argument that caused it, used to find the column>
+	void addDiagnostic( const String &, const String & );
+	//Parses the given chars, passing each completed line to the parser. A line that isn't complete yet is kept in the String for the next call.
+	//Args: <Chars>, <Number of chars>, <Current line>
+	bool parseScriptChars(const char *, size_t, String &);
+	//Called once the whole script has been parsed, before the first scan.
+	void finishScript();
+	//Sorts the tasks by priority, and hands each object and input to the highest priority task that references it. Called by finishScript().
+	void buildTasks();
+	//Runs the given task: samples its inputs, processes its rungs and updates its objects. Returns the time taken (uS), including any tasks that preempted it.
+	//Args: <Task index>, <Current time (uS)>
+	int64_t runTask( uint8_t, int64_t );
+	//Runs any task with a higher priority than the given one that is due. Called between rungs. Returns the time taken (uS).
+	int64_t runPreemptingTasks( uint8_t );
+
 	vector<shared_ptr<Ladder_Rung>> ladderRungs; //Container for all ladder rungs present in the parsed ladder logic script.
 
 	vector<shared_ptr<Ladder_OBJ_Logical>> ladderObjects; //Container for all Ladder_OBJ_Logical objects present in the parsed ladder logic script. Used for easy status query.
+	vector<shared_ptr<InputOBJ>> inputObjects; //Physical inputs, sampled into the input process image at the start of each scan.
 	vector<shared_ptr<Ladder_OBJ_Accessor>> accessorObjects; //Container for all Ladder_OBJ_Accessor objects present in the larsed ladder logic script.
 	vector<shared_ptr<Ladder_VAR>> ladderVars; //Container for all ladder variables present in the parsed ladder logic script. Used for easy status query.
+	vector<shared_ptr<PLC_Task>> tasks; //Task sections of the script, highest priority first once the script is parsed.
+	vector<shared_ptr<Ladder_OBJ_Logical>> backgroundObjects; //Objects that no rung references, updated on every pass.
+	vector<shared_ptr<InputOBJ>> backgroundInputs; //Inputs that no rung references, sampled on every pass.
+	uint8_t i_currentTask; //task section being parsed
 	
 	shared_ptr<String> currentScript; //save the current script in RAM?.. Hmm..
 
 	unique_ptr<PLC_Remote_Server> remoteServer; //PLC_Remote_Server object
+	unique_ptr<PLC_Analog_Sampler> analogSampler; //Background sampling of analog inputs. Created when the first analog input is declared.
+	PLC_Timer_Wheel timerWheel; //Shared by all timer objects, advanced once at the start of each scan.
+	PLC_Retain retentiveStorage; //Saves the values of objects declared with the RET flag to flash.
+	PLC_Scan_Watchdog scanWatchdog; //Checks the time taken by each scan.
+
+	bool b_checkOnly; //objects are created without claiming hardware, and errors are collected rather than ending the parse
+	vector<Script_Diagnostic> diagnostics; //errors found in check only mode
+	uint16_t i_numErrors,
+			 i_parseLine, //line being parsed
+			 i_parseColumn; //column of the last char read from the script (check only mode)
+	bool b_lastCarriage; //the last char read was a carriage return, so a newline right after it ends the same line (the script arrives in chunks)
+	String s_checkLine; //line being parsed (check only mode), used to find the column of an error
+	vector<uint16_t> checkColumns; //column in the script of each char in s_checkLine, since spaces are dropped
 	
 	std::map<uint8_t, PIN_TYPE> pinMap; //This map stores information about which physical pins are available on the ESP32 that IO can use.
 	std::map<uint8_t, PWM_STATUS> pwmMap; //This map stores information about the available PWM channels that a newly declared output can use. 
+	std::map<uint8_t, PWM_STATUS> pcntMap; //This map stores information about the available PCNT units that a newly declared high speed counter can use.
 };
 
 //Generic functions here
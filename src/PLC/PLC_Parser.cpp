@@ -73,6 +73,10 @@ bool PLC_Parser::parseLine()
     //This parser code can be cleaned up, but we'll worry about getting it working first.
     vector<shared_ptr<Ladder_OBJ_Wrapper>> firstEQObjects; //container for all "global" assignment operations for the line being parsed.
     vector<String> firstOrObjects; //continer for all strings that are split at the OR operator (parallel operations)
+    const String &line = getParsedLineStr();
+    if ( line.startsWith(taskTag + CHAR_BRACKET_START) && line.endsWith(String(CHAR_BRACKET_END)) ) //task section header, not a rung
+        return pMain->beginTask( splitString( line.substring(taskTag.length() + 1, line.length() - 1), CHAR_COMMA ) );
+
     //Before handling each tier, break up any "global" object operations (per line). An example of this is the Objects being assigned (=) at the end of the line (not in parenthesis).
     vector<String> outer = splitString(getParsedLineStr(), CHAR_EQUALS, true, CHAR_P_START, CHAR_P_END); //Split on '=' char first
     for ( uint8_t x = 0; x < outer.size(); x++ )
@@ -136,7 +140,7 @@ bool PLC_Parser::parseLine()
     else if ( firstEQObjects.size() > 1 ) //no objects in the OR objects list.. means that all of the objects were stored into the EQobjects vector. Time for a bit of a hack... 
     {
         shared_ptr<Ladder_OBJ_Wrapper> firstObj = firstEQObjects.front();
-        getRung()->addInitialRungObject(firstObj);
+        addInitialRungObject(firstObj);
         for (uint8_t x = 1; x < firstEQObjects.size(); x++ )
             firstObj->addNextObject(firstEQObjects[x]);
     }
@@ -151,11 +155,11 @@ bool PLC_Parser::parseLine()
         }
     }
 
-    getRung()->addInitialRungObject(getFirstNestObjects()); //Find and add the appropriate objects to the initial objects list for the PLC scan.
+    addInitialRungObject(getFirstNestObjects()); //Find and add the appropriate objects to the initial objects list for the PLC scan.
 
 
     //Finally, add the rung to the list of rungs in PLC_Main for processing.
-	if ( PLCObj.addLadderRung(getRung()) )
+	if ( getRung()->compileRung(rungWrappers, firstRungWrappers) && pMain->addLadderRung(getRung()) )
 	{
 		#ifdef DEBUG
 		Serial.print(PSTR("Rung Created. Objects: "));
@@ -167,11 +171,48 @@ bool PLC_Parser::parseLine()
 	return true; //success
 }
 
+String PLC_Parser::maskArguments( const String &line )
+{
+    String output;
+    for ( uint16_t x = 0; x < line.length(); x++ )
+    {
+        output += line[x];
+        if ( line[x] != CHAR_BRACKET_START )
+            continue;
+
+        int end = line.indexOf(CHAR_BRACKET_END, x);
+        if ( end < 0 ) //unterminated, leave it for the object parser to complain about
+            continue;
+
+        String args = line.substring(x + 1, end);
+        if ( strContains(args, vector<char>{CHAR_EQUALS, CHAR_OR, CHAR_AND, CHAR_P_START, CHAR_P_END}) )
+        {
+            output += CHAR_ARG_MASK + String(maskedArgs.size());
+            maskedArgs.push_back(args);
+            x = end - 1; //the closing bracket is copied on the next pass
+        }
+    }
+
+    return output;
+}
+
+String PLC_Parser::unmaskArguments( const String &args )
+{
+    if ( args.length() && args[0] == CHAR_ARG_MASK )
+    {
+        uint16_t index = args.substring(1).toInt();
+        if ( index < maskedArgs.size() )
+            return maskedArgs[index];
+    }
+
+    return args;
+}
+
 bool PLC_Parser::buildObjectStr(const String &str)
 {
     if ( strBeginsWith( str, CHAR_BRACKET_START ) ) //jumping to special single-use objects such as ONS
     {
-        sParsedArgs = removeFromStr(str, { CHAR_BRACKET_START, CHAR_BRACKET_END });
+        sParsedArgs = unmaskArguments(removeFromStr(str, { CHAR_BRACKET_START, CHAR_BRACKET_END }));
         if ( !sParsedArgs.length() )
             return false;
     }
@@ -186,7 +227,7 @@ bool PLC_Parser::buildObjectStr(const String &str)
         } 
         if (definitions.size() > 1) //Have args and object name, with name (including bit/accessor operator) coming first
         {
-            sParsedArgs = definitions.back(); //Args are the second element. Save off here
+            sParsedArgs = unmaskArguments(definitions.back()); //Args are the second element. Save off here
         }
         if ( definitions.size() > 0 ) //have only the object name,accessor, etc.
         {
@@ -246,7 +287,7 @@ shared_ptr<Ladder_OBJ_Wrapper> PLC_Parser::getObjectVARWrapper(shared_ptr<Ladder
 {
     shared_ptr<Ladder_VAR> pVar = ptr->getObjectVAR(sParsedBit); //This will attempt to find the existing variable object (or sometimes create it, depending on the object type)
     if ( pVar ) //If successful (not null), make the wrapper and return it
-        return make_shared<Ladder_OBJ_Wrapper>( pVar, getRungNum(), getNotOP() );
+        return make_shared<Ladder_OBJ_Wrapper>( pVar, getNotOP() );
 
     return 0; //failed, return NULL
 }
@@ -262,10 +303,10 @@ shared_ptr<Ladder_OBJ_Wrapper> PLC_Parser::createNewWrapper( shared_ptr<Ladder_O
         }
         else
         {
-            newOBJWrapper = make_shared<Ladder_OBJ_Wrapper>( obj, getRungNum(), getNotOP() );
+            newOBJWrapper = make_shared<Ladder_OBJ_Wrapper>( obj, getNotOP() );
         }
 
-        if ( getRung()->addRungObject(newOBJWrapper) ) //Add to the new rung in order to perform updates on the object, post line scanning.
+        if ( addRungObject(newOBJWrapper) ) //Add to the new rung in order to perform updates on the object, post line scanning.
         {
             return newOBJWrapper; //return the new wrapper for later use.
         }
@@ -278,7 +319,7 @@ shared_ptr<Ladder_OBJ_Wrapper> PLC_Parser::handleObject()
     shared_ptr<Ladder_OBJ_Wrapper> obj = 0;
     if ( getParsedAccessorStr().length() ) //Do we have some accessor that we are referencing?
     {
-        shared_ptr<Ladder_OBJ_Accessor> accessor = PLCObj.findAccessorByID(getParsedAccessorStr()); 
+        shared_ptr<Ladder_OBJ_Accessor> accessor = pMain->findAccessorByID(getParsedAccessorStr()); 
         if ( !accessor ) //didn't find the accessor from the list. 
         {
             sendError(ERR_DATA::ERR_INVALID_ACCESSOR, getParsedAccessorStr());
@@ -294,11 +335,11 @@ shared_ptr<Ladder_OBJ_Wrapper> PLC_Parser::handleObject()
     }   
     else
     {
-        obj = createNewWrapper(PLCObj.findLadderObjByID(getParsedObjectStr()));
+        obj = createNewWrapper(pMain->findLadderObjByID(getParsedObjectStr()));
 
         if ( !obj ) //Invalid object? Probably because it doesn't exist
         {
-            shared_ptr<Ladder_OBJ> newObj = PLCObj.createNewLadderObject(getParsedObjectStr(), parseObjectArgs());
+            shared_ptr<Ladder_OBJ> newObj = pMain->createNewLadderObject(getParsedObjectStr(), parseObjectArgs());
             if ( newObj )  //so try to create it
             {
                 if(newObj->getType()==OBJ_TYPE::TYPE_ONS)
@@ -306,7 +347,7 @@ shared_ptr<Ladder_OBJ_Wrapper> PLC_Parser::handleObject()
                     obj = createNewWrapper(static_pointer_cast<Ladder_OBJ_Logical>(newObj));
                 }
                 else
-                    obj = createNewWrapper(PLCObj.findLadderObjByID(getParsedObjectStr())); //create a wrapper from the newly generated object
+                    obj = createNewWrapper(pMain->findLadderObjByID(getParsedObjectStr())); //create a wrapper from the newly generated object
             }
             else //guess not
             {
@@ -332,7 +373,7 @@ vector<String> PLC_Parser::parseObjectArgs()
 
 void PLC_Parser::sendError(ERR_DATA err, const String &str)
 { 
-    PLCObj.sendError(err,str);
+    pMain->sendError(err,str);
 }
 
 vector<shared_ptr<Ladder_OBJ_Wrapper>> PLC_Parser::getFirstNestObjects()
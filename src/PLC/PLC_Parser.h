@@ -6,6 +6,8 @@
 
 using namespace std;
 
+class PLC_Main;
+
 struct NestContainer
 {
 	NestContainer( uint8_t pTier, uint8_t orTier )
@@ -82,14 +84,16 @@ struct NestContainer
 struct PLC_Parser
 {
 public:
-	PLC_Parser( const String &parsed, uint16_t rung )
+	//Args: <Line>, <Rung number>, <PLC_Main object that the objects and rung are created in (the running program, or a script check)>
+	PLC_Parser( const String &parsed, uint16_t rung, PLC_Main *main )
 	{
 		/*create a new ladder rung when the helper is initialized. 
 		Presumably each helper represents a line being parsed, and each line represents a "rung" in the ladder logic.*/
 		pRung = make_shared<Ladder_Rung>(); 
 		bitNot = false; 
-		sParsedLine = parsed;
+		sParsedLine = maskArguments(parsed);
 		iRung = rung;
+		pMain = main;
 	}
 
 	//Forwards an error of a given type (with additional info message as second argument) to the client.
@@ -126,6 +130,16 @@ public:
 	vector<shared_ptr<Ladder_OBJ_Wrapper>> getFirstNestObjects();
 
 	bool buildObjectStr( const String & );
+	//Replaces object arguments that contain logic operators (EX: CPT expressions) with a placeholder, so the logic operators in the line can be split safely.
+	String maskArguments( const String & );
+	//Returns the original object arguments if the inputted arguments are a placeholder created by maskArguments().
+	String unmaskArguments( const String & );
+
+	//Stores a newly created wrapper for the rung being parsed. All wrappers are flattened into the rung once the line has been parsed.
+	bool addRungObject( shared_ptr<Ladder_OBJ_Wrapper> obj ){ if ( !obj ) return false; rungWrappers.emplace_back(obj); return true; }
+	//Stores the wrapper(s) that are referenced at the beginning of each logic scan for the rung being parsed.
+	bool addInitialRungObject( shared_ptr<Ladder_OBJ_Wrapper> obj ){ firstRungWrappers.emplace_back(obj); return true; }
+	bool addInitialRungObject( const vector<shared_ptr<Ladder_OBJ_Wrapper>> &vec ){ firstRungWrappers.insert(firstRungWrappers.end(), vec.begin(), vec.end()); return true; }
 
 	shared_ptr<Ladder_Rung> &getRung(){ return pRung; }
 	bool getNotOP(){ return bitNot; }
@@ -138,6 +152,7 @@ private:
 	uint16_t iLinePos; //position at which the line is currently being parsed (in the string character array)
 	uint16_t iLineLength; //total length of the parsed line (number of chars)
 	uint16_t iRung; 
+	PLC_Main *pMain;
 	String sParsedLine,
 		   sParsedArgs, //object arguments (if applicable)
 		   sParsedObj, //object name 
@@ -145,7 +160,9 @@ private:
 		   sParsedBit; //for bit operations on objects
 
 	shared_ptr<Ladder_Rung> pRung; //Rung object that is being created by the parser
+	vector<shared_ptr<Ladder_OBJ_Wrapper>> rungWrappers, firstRungWrappers; //Parse-time object graph for the rung, discarded once the rung is compiled.
 	vector<shared_ptr<NestContainer>> nestData;
+	vector<String> maskedArgs; //original arguments replaced by maskArguments()
 };
 
 //This object is responsible for breaking up an inputted line based on the different types of operators that we are using for the PLC. 
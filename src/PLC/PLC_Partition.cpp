@@ -0,0 +1,206 @@
+/*
+ * PLC_Partition.cpp
+ *
+ * Dual core rung processing, see PLC_Partition.h.
+ */
+
+#include "PLC_Partition.h"
+#include "../CORE/HeapStats.h"
+#include <algorithm>
+
+//Returns the group (root rung) that the given rung belongs to.
+static uint16_t findGroup( vector<uint16_t> &parent, uint16_t rung )
+{
+	while ( parent[rung] != rung )
+	{
+		parent[rung] = parent[parent[rung]]; //shorten the path for the next lookup
+		rung = parent[rung];
+	}
+	return rung;
+}
+
+PLC_Rung_Partition::PLC_Rung_Partition( const vector<shared_ptr<Ladder_Rung>> &rungs ) : ladderRungs(rungs)
+{
+	uint16_t numRungs = rungs.size();
+	i_numGroups = 0;
+	b_parallel = false;
+	workerNodes[0] = workerNodes[1] = 0;
+
+	//Gather the memory touched by each rung, then sort it so overlapping ranges sit next to each other.
+	vector<pair<Ladder_Dependency, uint16_t>> ranges;
+	vector<Ladder_Dependency> deps;
+	for ( uint16_t x = 0; x < numRungs; x++ )
+	{
+		const vector<shared_ptr<Ladder_OBJ_Logical>> &objects = rungs[x]->getRungObjects();
+		deps.clear();
+		for ( uint16_t y = 0; y < objects.size(); y++ )
+			objects[y]->getDependencies(deps);
+
+		for ( uint16_t y = 0; y < deps.size(); y++ )
+			ranges.push_back( make_pair(deps[y], x) );
+	}
+	sort( ranges.begin(), ranges.end(), []( const pair<Ladder_Dependency, uint16_t> &a, const pair<Ladder_Dependency, uint16_t> &b ){ return a.first.start < b.first.start; } );
+
+	//Rungs with overlapping ranges are joined into the same group.
+	vector<uint16_t> parent(numRungs);
+	for ( uint16_t x = 0; x < numRungs; x++ )
+		parent[x] = x;
+
+	const uint8_t *runEnd = 0;
+	uint16_t runRung = 0;
+	for ( uint32_t x = 0; x < ranges.size(); x++ )
+	{
+		if ( ranges[x].first.start < runEnd )
+		{
+			uint16_t a = findGroup(parent, runRung), b = findGroup(parent, ranges[x].second);
+			if ( a != b )
+				parent[max(a, b)] = min(a, b);
+			if ( ranges[x].first.end > runEnd )
+				runEnd = ranges[x].first.end;
+		}
+		else //no overlap with anything before it, start a new run
+		{
+			runEnd = ranges[x].first.end;
+			runRung = ranges[x].second;
+		}
+	}
+
+	//Total up each group, then hand out the largest groups first to whichever core has the least work so far.
+	vector<uint32_t> groupNodes(numRungs, 0);
+	vector<uint16_t> groups;
+	for ( uint16_t x = 0; x < numRungs; x++ )
+	{
+		uint16_t group = findGroup(parent, x);
+		if ( group == x )
+			groups.push_back(x);
+		groupNodes[group] += rungs[x]->getNumRungObjects();
+	}
+	i_numGroups = groups.size();
+	sort( groups.begin(), groups.end(), [&groupNodes]( uint16_t a, uint16_t b ){ return groupNodes[a] > groupNodes[b]; } );
+
+	vector<uint8_t> groupWorker(numRungs, 0);
+	for ( uint16_t x = 0; x < groups.size(); x++ )
+	{
+		uint8_t worker = ( workerNodes[1] < workerNodes[0] ) ? 1 : 0;
+		groupWorker[groups[x]] = worker;
+		workerNodes[worker] += groupNodes[groups[x]];
+	}
+
+	for ( uint16_t x = 0; x < numRungs; x++ ) //in program order, so rungs within a group keep their order
+		workerRungs[groupWorker[findGroup(parent, x)]].push_back(x);
+
+	i_workerAllocs = 0;
+	b_parallel = workerNodes[1] >= PARTITION_MIN_NODES;
+	if ( !b_parallel )
+		return;
+
+	b_running = true;
+	#ifdef ARDUINO_ARCH_ESP32
+	doneSignal = xSemaphoreCreateBinary();
+	taskHandle = 0;
+	xTaskCreatePinnedToCore(workerTask, "PLC_SCAN", PARTITION_WORKER_STACK, this, PARTITION_WORKER_PRIORITY, &taskHandle, PARTITION_WORKER_CORE);
+	#else
+	i_scansStarted = i_scansDone = 0;
+	worker = thread( &PLC_Rung_Partition::workerLoop, this );
+	#endif
+
+	#ifdef DEBUG
+	Serial.println(PSTR("Dual core scan: ") + String(i_numGroups) + PSTR(" groups, nodes per core: ") + String(workerNodes[0]) + PSTR("/") + String(workerNodes[1]));
+	#endif
+}
+
+PLC_Rung_Partition::~PLC_Rung_Partition()
+{
+	if ( !b_parallel )
+		return;
+
+	#ifdef ARDUINO_ARCH_ESP32
+	b_running = false;
+	if ( taskHandle )
+	{
+		xTaskNotifyGive(taskHandle);
+		xSemaphoreTake(doneSignal, portMAX_DELAY); //wait for the task to leave its loop
+	}
+	vSemaphoreDelete(doneSignal);
+	#else
+	{
+		lock_guard<mutex> lock(workerMutex);
+		b_running = false;
+	}
+	workerSignal.notify_all();
+	worker.join();
+	#endif
+}
+
+void PLC_Rung_Partition::processShare( uint8_t index )
+{
+	const vector<uint16_t> &share = workerRungs[index];
+	for ( uint16_t x = 0; x < share.size(); x++ )
+		ladderRungs[share[x]]->processRung(share[x]);
+}
+
+uint32_t PLC_Rung_Partition::processRungs()
+{
+	if ( !b_parallel )
+	{
+		processShare(0);
+		return 0;
+	}
+
+	#ifdef ARDUINO_ARCH_ESP32
+	xTaskNotifyGive(taskHandle);
+	processShare(0);
+	xSemaphoreTake(doneSignal, portMAX_DELAY); //barrier, nothing is updated until both shares are done
+	#else
+	{
+		lock_guard<mutex> lock(workerMutex);
+		i_scansStarted++;
+	}
+	workerSignal.notify_all();
+	processShare(0);
+
+	unique_lock<mutex> lock(workerMutex);
+	workerSignal.wait( lock, [this]{ return i_scansDone == i_scansStarted; } );
+	#endif
+	return i_workerAllocs;
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+void PLC_Rung_Partition::workerTask( void *arg )
+{
+	PLC_Rung_Partition *pPartition = static_cast<PLC_Rung_Partition *>(arg);
+	while ( true )
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		if ( !pPartition->b_running )
+			break;
+
+		uint32_t allocs = Heap_Monitor::getThreadAllocs();
+		pPartition->processShare(1);
+		pPartition->i_workerAllocs = Heap_Monitor::getThreadAllocs() - allocs;
+		xSemaphoreGive(pPartition->doneSignal);
+	}
+
+	xSemaphoreGive(pPartition->doneSignal);
+	vTaskDelete(0); //delete self
+}
+#else
+void PLC_Rung_Partition::workerLoop()
+{
+	unique_lock<mutex> lock(workerMutex);
+	while ( true )
+	{
+		workerSignal.wait( lock, [this]{ return !b_running || i_scansDone != i_scansStarted; } );
+		if ( !b_running )
+			break;
+
+		lock.unlock();
+		uint32_t allocs = Heap_Monitor::getThreadAllocs();
+		processShare(1);
+		i_workerAllocs = Heap_Monitor::getThreadAllocs() - allocs;
+		lock.lock();
+		i_scansDone++;
+		workerSignal.notify_all();
+	}
+}
+#endif
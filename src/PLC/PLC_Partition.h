@@ -0,0 +1,84 @@
+/*
+ * PLC_Partition.h
+ *
+ * Splits the rungs of a program into groups that share no objects or variables, and processes the groups on both cores within a scan.
+ * Rungs are grouped by the memory their objects read and write while the rung is processed (see Ladder_OBJ_Logical::getDependencies), so any two rungs
+ * that touch the same object, variable or array end up in the same group, and keep their program order. Groups never see each other's changes during
+ * the rung pass, so the result of a scan is the same as the serial scan. The objects are only updated (outputs written, timers scheduled) once both
+ * cores have finished their rungs.
+ * On the ESP32 the second share runs in a task on the protocol core (0). The native build (pio test -e native) uses a std::thread, and
+ * test/test_partition checks that its results are bit-identical to the serial scan and benchmarks both.
+ */
+
+#ifndef PLC_PARTITION_H_
+#define PLC_PARTITION_H_
+
+#include "PLC_IO.h"
+#include "PLC_Rung.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#else
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+#define PARTITION_NUM_WORKERS 2 //the scan core, and one worker
+#define PARTITION_WORKER_CORE 0 //the Arduino loop (and logic scan) runs on core 1
+#define PARTITION_WORKER_STACK 4096
+#define PARTITION_WORKER_PRIORITY 2 //above the logger and analog sampler tasks, which share the core
+#define PARTITION_MIN_NODES 64 //smaller programs aren't worth the hand off to the other core (nodes in the worker's share)
+
+class PLC_Rung_Partition
+{
+	public:
+	//Groups the given rungs and balances the groups across both cores. The worker is only started if isParallel() is true.
+	PLC_Rung_Partition( const vector<shared_ptr<Ladder_Rung>> & );
+	~PLC_Rung_Partition(); //stops the worker
+
+	//Returns true if the program split into enough independent work for the worker to be used.
+	bool isParallel(){ return b_parallel; }
+	//Returns the number of independent rung groups found.
+	uint16_t getNumGroups(){ return i_numGroups; }
+	//Returns the number of rung nodes processed by the given worker (0 is the scan core).
+	uint32_t getWorkerNodes( uint8_t worker ){ return workerNodes[worker]; }
+	//Returns the indices of the rungs processed by the given worker, in program order.
+	const vector<uint16_t> &getWorkerRungs( uint8_t worker ){ return workerRungs[worker]; }
+
+	//Processes every rung. The worker's share is handed off first, then the scan core processes its own share and waits for the worker to finish.
+	//Returns the number of heap allocations the worker made during its share, which the scan core's own count (Heap_Monitor::getThreadAllocs) can't see.
+	uint32_t processRungs();
+
+	private:
+	//Processes the rungs assigned to the given worker, in program order.
+	void processShare( uint8_t );
+	#ifdef ARDUINO_ARCH_ESP32
+	static void workerTask( void * );
+	#else
+	void workerLoop();
+	#endif
+
+	const vector<shared_ptr<Ladder_Rung>> &ladderRungs;
+	vector<uint16_t> workerRungs[PARTITION_NUM_WORKERS]; //rung indices, in program order
+	uint32_t workerNodes[PARTITION_NUM_WORKERS];
+	uint16_t i_numGroups;
+	uint32_t i_workerAllocs; //during the last share, written by the worker before it signals the scan core
+	bool b_parallel;
+
+	#ifdef ARDUINO_ARCH_ESP32
+	TaskHandle_t taskHandle;
+	SemaphoreHandle_t doneSignal; //given by the worker once its share is processed, and once more when it stops
+	volatile bool b_running;
+	#else
+	thread worker;
+	mutex workerMutex;
+	condition_variable workerSignal;
+	uint32_t i_scansStarted, i_scansDone;
+	bool b_running;
+	#endif
+};
+
+#endif /* PLC_PARTITION_H_ */
@@ -27,6 +27,7 @@ PLC_Remote_Server::~PLC_Remote_Server()
 
 void PLC_Remote_Server::processRequests()
 {
+    Heap_Scope heapScope(HEAP_TAG_REMOTE);
     WiFiClient client = localServer->available();
 
     if (client)
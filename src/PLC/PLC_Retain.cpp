@@ -0,0 +1,319 @@
+/*
+ * PLC_Retain.cpp
+ *
+ * Journal format: a 4 byte header (RETAIN_MAGIC), followed by fixed size records. A record holds the name hash, the variable type, the raw value and a check byte.
+ * Records are only ever appended, so the newest record for a name is the current value. A record that was cut short by a power loss fails its check and ends the read.
+ */
+
+#include "PLC_Main.h"
+#include "PLC_Retain.h"
+#include <string.h>
+#include <algorithm>
+
+//Check byte for a serialized record, covers the key, type and value.
+static uint8_t retainCheck( const uint8_t *record )
+{
+	uint8_t sum = 0;
+	for ( uint8_t x = 0; x < RETAIN_RECORD_SIZE - 1; x++ )
+		sum += record[x];
+	return ~sum;
+}
+
+template <typename T>
+static void setRawValue( Ladder_VAR &var, uint64_t raw )
+{
+	T value;
+	memcpy( &value, &raw, sizeof(T) );
+	var.setValue(value);
+}
+
+PLC_Retain::PLC_Retain()
+{
+	memset( &stats, 0, sizeof(stats) );
+	iInterval = static_cast<int64_t>(RETAIN_INTERVAL_DEFAULT) * 1000000;
+	iLastWrite = 0;
+	i_journalSize = 0;
+	taskHandle = 0;
+	b_pending.store(false);
+	b_snapshot = false;
+	b_failed.store(false);
+}
+
+uint8_t PLC_Retain::getValueSize( OBJ_TYPE type )
+{
+	switch( type )
+	{
+		case OBJ_TYPE::TYPE_VAR_BOOL:
+			return sizeof(bool);
+		case OBJ_TYPE::TYPE_VAR_USHORT:
+			return sizeof(uint16_t);
+		case OBJ_TYPE::TYPE_VAR_INT:
+			return sizeof(int_fast32_t);
+		case OBJ_TYPE::TYPE_VAR_UINT:
+			return sizeof(uint_fast32_t);
+		case OBJ_TYPE::TYPE_VAR_LONG:
+		case OBJ_TYPE::TYPE_VAR_ULONG:
+		case OBJ_TYPE::TYPE_VAR_FLOAT:
+			return sizeof(uint64_t);
+		default:
+			break;
+	}
+
+	return 0; //not a type that can be retained
+}
+
+uint32_t PLC_Retain::hashName( const String &name )
+{
+	uint32_t hash = 2166136261UL; //FNV-1a
+	for ( uint16_t x = 0; x < name.length(); x++ )
+	{
+		hash ^= static_cast<uint8_t>(name[x]);
+		hash *= 16777619UL;
+	}
+	return hash;
+}
+
+bool PLC_Retain::add( const String &name, shared_ptr<Ladder_VAR> var )
+{
+	uint8_t size = var ? getValueSize(var->getType()) : 0;
+	if ( !size || !var->getValuePtr() )
+		return false;
+
+	Retain_Entry entry;
+	entry.var = var;
+	entry.pValue = var->getValuePtr();
+	entry.i_key = hashName(name);
+	entry.i_size = size;
+	entry.i_saved = 0;
+	memcpy( &entry.i_saved, entry.pValue, size );
+	entries.push_back(entry);
+	return true;
+}
+
+void PLC_Retain::addRecord( uint16_t index, uint64_t raw )
+{
+	uint8_t record[RETAIN_RECORD_SIZE];
+	memcpy( record, &entries[index].i_key, sizeof(uint32_t) );
+	record[4] = static_cast<uint8_t>(entries[index].var->getType());
+	memcpy( record + 5, &raw, sizeof(uint64_t) );
+	record[RETAIN_RECORD_SIZE - 1] = retainCheck(record);
+	recordBuffer.insert( recordBuffer.end(), record, record + RETAIN_RECORD_SIZE );
+	recordEntries.push_back(index);
+}
+
+void PLC_Retain::addSnapshot()
+{
+	recordBuffer.clear();
+	recordEntries.clear();
+	for ( uint16_t x = 0; x < entries.size(); x++ )
+	{
+		uint64_t raw = 0;
+		memcpy( &raw, entries[x].pValue, entries[x].i_size );
+		addRecord(x, raw);
+	}
+}
+
+bool PLC_Retain::writeRecords( File &file, uint32_t &size )
+{
+	if ( file.write( recordBuffer.data(), recordBuffer.size() ) != recordBuffer.size() )
+		return false;
+
+	size += recordBuffer.size();
+	stats.i_bytesWritten += recordBuffer.size();
+	return true;
+}
+
+void PLC_Retain::restore()
+{
+	if ( !entries.size() )
+		return;
+
+	waitForWriter(); //a write for the previous script may still be running
+	recordBuffer.reserve( entries.size() * RETAIN_RECORD_SIZE );
+	recordEntries.reserve( entries.size() );
+	if ( !Core.isFSOpen() )
+		return;
+
+	if ( !taskHandle && xTaskCreatePinnedToCore(writerTask, "PLC_RETAIN", RETAIN_WRITER_STACK, this, 1, &taskHandle, RETAIN_WRITER_CORE) != pdPASS )
+	{
+		taskHandle = 0;
+		Core.sendMessage( PSTR("Failed to start the retentive writer task, values are written during the scan."), PRIORITY_HIGH );
+	}
+
+	File journal = SPIFFS.open( SPIFFS.exists(file_Retain) ? file_Retain : file_RetainTemp, FILE_READ ); //the snapshot is only left under its temporary name if a compaction was cut short
+	if ( journal )
+	{
+		uint32_t magic = 0;
+		vector<bool> restored(entries.size(), false);
+		if ( journal.read( reinterpret_cast<uint8_t *>(&magic), RETAIN_HEADER_SIZE ) == RETAIN_HEADER_SIZE && magic == RETAIN_MAGIC )
+		{
+			uint8_t record[RETAIN_RECORD_SIZE];
+			while ( journal.read( record, RETAIN_RECORD_SIZE ) == RETAIN_RECORD_SIZE && record[RETAIN_RECORD_SIZE - 1] == retainCheck(record) )
+			{
+				uint32_t key;
+				uint64_t raw;
+				memcpy( &key, record, sizeof(uint32_t) );
+				memcpy( &raw, record + 5, sizeof(uint64_t) );
+
+				for ( uint16_t x = 0; x < entries.size(); x++ )
+				{
+					Ladder_VAR &var = *entries[x].var;
+					if ( entries[x].i_key != key || static_cast<uint8_t>(var.getType()) != record[4] ) //a changed type in the script discards the old value
+						continue;
+
+					switch( var.getType() )
+					{
+						case OBJ_TYPE::TYPE_VAR_BOOL: setRawValue<bool>(var, raw); break;
+						case OBJ_TYPE::TYPE_VAR_USHORT: setRawValue<uint16_t>(var, raw); break;
+						case OBJ_TYPE::TYPE_VAR_INT: setRawValue<int_fast32_t>(var, raw); break;
+						case OBJ_TYPE::TYPE_VAR_UINT: setRawValue<uint_fast32_t>(var, raw); break;
+						case OBJ_TYPE::TYPE_VAR_LONG: setRawValue<int64_t>(var, raw); break;
+						case OBJ_TYPE::TYPE_VAR_ULONG: setRawValue<uint64_t>(var, raw); break;
+						case OBJ_TYPE::TYPE_VAR_FLOAT: setRawValue<double>(var, raw); break;
+						default: break;
+					}
+					restored[x] = true;
+				}
+			}
+		}
+		journal.close();
+		Core.sendMessage( PSTR("Retentive values restored: ") + String(count(restored.begin(), restored.end(), true)) + "/" + String(entries.size()) );
+	}
+
+	for ( uint16_t x = 0; x < entries.size(); x++ ) //the restored values are the new baseline
+	{
+		entries[x].i_saved = 0;
+		memcpy( &entries[x].i_saved, entries[x].pValue, entries[x].i_size );
+	}
+
+	addSnapshot(); //start from a clean snapshot, which also drops values of variables that are no longer in the script
+	b_snapshot = true;
+	b_pending.store(true, memory_order_release);
+	writeBatch(); //before the first scan, so there's no need to hand it off
+	if ( b_failed.exchange(false) )
+	{
+		Core.sendMessage( PSTR("Failed to write retentive values."), PRIORITY_HIGH );
+	}
+}
+
+bool PLC_Retain::compact()
+{
+	File snapshot = SPIFFS.open(file_RetainTemp, FILE_WRITE);
+	if ( !snapshot )
+		return false;
+
+	uint32_t magic = RETAIN_MAGIC, size = RETAIN_HEADER_SIZE;
+	bool success = snapshot.write( reinterpret_cast<const uint8_t *>(&magic), RETAIN_HEADER_SIZE ) == RETAIN_HEADER_SIZE && writeRecords(snapshot, size);
+	snapshot.close();
+	stats.i_bytesWritten += RETAIN_HEADER_SIZE;
+	stats.i_numCompactions++;
+
+	if ( !success ) //keep the old journal
+	{
+		SPIFFS.remove(file_RetainTemp);
+		return false;
+	}
+
+	SPIFFS.remove(file_Retain);
+	SPIFFS.rename(file_RetainTemp, file_Retain);
+	i_journalSize = size;
+	return true;
+}
+
+bool PLC_Retain::append()
+{
+	File journal = SPIFFS.open(file_Retain, FILE_APPEND);
+	bool success = journal && writeRecords(journal, i_journalSize);
+	journal.close();
+	if ( !success )
+		return false;
+
+	stats.i_numFlushes++;
+	stats.i_numRecords += recordEntries.size();
+	return true;
+}
+
+void PLC_Retain::writeBatch()
+{
+	if ( b_snapshot ? compact() : append() ) //only values that reached the flash count as saved, the others are picked up again by the next flush
+	{
+		for ( uint16_t x = 0; x < recordEntries.size(); x++ )
+			memcpy( &entries[recordEntries[x]].i_saved, &recordBuffer[x * RETAIN_RECORD_SIZE + 5], sizeof(uint64_t) );
+	}
+	else
+		b_failed.store(true);
+
+	b_pending.store(false, memory_order_release); //hands the buffer (and the saved values and stats written above) back to the scan
+}
+
+void PLC_Retain::writerTask( void *arg )
+{
+	PLC_Retain *pRetain = static_cast<PLC_Retain *>(arg);
+
+	while ( true ) //runs for as long as the device does, and is reused by every script
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		if ( pRetain->b_pending.load(memory_order_acquire) )
+			pRetain->writeBatch();
+	}
+}
+
+void PLC_Retain::waitForWriter()
+{
+	while ( b_pending.load(memory_order_acquire) )
+		vTaskDelay( pdMS_TO_TICKS(RETAIN_WRITER_WAIT) );
+}
+
+void PLC_Retain::flush()
+{
+	if ( b_pending.load(memory_order_acquire) ) //the writer task still has the buffer
+		return;
+
+	recordBuffer.clear();
+	recordEntries.clear();
+	for ( uint16_t x = 0; x < entries.size(); x++ )
+	{
+		uint64_t raw = 0;
+		memcpy( &raw, entries[x].pValue, entries[x].i_size );
+		if ( raw != entries[x].i_saved )
+			addRecord(x, raw);
+	}
+
+	if ( recordEntries.empty() || !Core.isFSOpen() )
+		return;
+
+	b_snapshot = i_journalSize + recordBuffer.size() > RETAIN_JOURNAL_MAX; //replace the journal rather than growing it
+	if ( b_snapshot )
+		addSnapshot();
+
+	b_pending.store(true, memory_order_release);
+	if ( taskHandle )
+		xTaskNotifyGive(taskHandle);
+	else
+		writeBatch();
+}
+
+void PLC_Retain::update( int64_t now )
+{
+	if ( b_failed.exchange(false) ) //set by the writer task, which can't send messages itself
+	{
+		Core.sendMessage( PSTR("Failed to write retentive values."), PRIORITY_HIGH );
+	}
+
+	if ( !entries.size() || now - iLastWrite < iInterval )
+		return;
+
+	iLastWrite = now;
+	flush();
+}
+
+void PLC_Retain::reset()
+{
+	waitForWriter();
+	flush(); //values changed since the last write would otherwise be lost
+	waitForWriter();
+	entries.clear();
+	recordBuffer.clear();
+	recordEntries.clear();
+	i_journalSize = 0;
+}
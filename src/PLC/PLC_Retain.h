@@ -0,0 +1,106 @@
+/*
+ * PLC_Retain.h
+ *
+ * Retentive storage for ladder variables. Objects that are declared with the RET flag have their value (or accumulator) saved to a journal file
+ * in the flash file system, and restored after the script is parsed so they survive a reboot.
+ * Changed values are only collected once per write interval and appended to the journal as small fixed size records in a single write.
+ * The journal is compacted into a fresh snapshot of the current values once it grows past RETAIN_JOURNAL_MAX. SPIFFS spreads the page writes across
+ * the whole partition, so no single flash sector takes every update. test/test_retain measures the bytes written for a typical program and estimates
+ * the flash life from them (decades at the default interval, months if every scan were written).
+ * The scan only serializes the changed values. The file system work is done by a low priority writer task, which owns the record buffer until the write
+ * has finished (see b_pending), and a value only counts as saved once its record has reached the flash. Changes made while a write is in progress go out with the next one.
+ */
+
+#ifndef PLC_RETAIN_H_
+#define PLC_RETAIN_H_
+
+#include "PLC_IO.h"
+#include "OBJECTS/obj_var.h"
+#include <SPIFFS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+
+#define RETAIN_INTERVAL_DEFAULT 10 //seconds between journal writes (default)
+#define RETAIN_JOURNAL_MAX 4096 //journal size (bytes) that triggers a compaction
+#define RETAIN_RECORD_SIZE 14 //key (4) + type (1) + value (8) + check (1)
+#define RETAIN_HEADER_SIZE 4
+#define RETAIN_MAGIC 0x31544552 //"RET1"
+#define RETAIN_WRITER_CORE 0 //the Arduino loop (and logic scan) runs on core 1
+#define RETAIN_WRITER_STACK 3072
+#define RETAIN_WRITER_WAIT 1 //time (mS) between checks while waiting for the writer task to finish
+
+//A variable that is kept across restarts.
+struct Retain_Entry
+{
+	shared_ptr<Ladder_VAR> var;
+	const void *pValue; //address of the stored value, compared against the last written copy
+	uint32_t i_key; //hash of the name, identifies the variable's records in the journal
+	uint64_t i_saved; //value last written to the journal (raw bytes), only updated once the write has succeeded
+	uint8_t i_size;
+};
+
+//Write statistics, for estimating flash wear.
+struct Retain_Stats
+{
+	uint32_t i_numFlushes, //journal appends
+			 i_numRecords, //records appended
+			 i_numCompactions;
+	uint64_t i_bytesWritten; //total bytes written to the file system (journal appends and snapshots)
+};
+
+class PLC_Retain
+{
+	public:
+	PLC_Retain();
+
+	//Adds a variable to the retentive list. Args: <Name (used as the journal key)>, <Variable>
+	bool add( const String &, shared_ptr<Ladder_VAR> );
+	//Loads the journal and applies the saved values to the registered variables. Called once the script has been parsed, before the first scan.
+	void restore();
+	//Hands any changed values to the writer task, if the write interval has passed. Called at the end of each scan. Arg: current time (uS)
+	void update( int64_t );
+	//Hands any changed values to the writer task immediately. Does nothing while the previous write is still in progress.
+	void flush();
+	//Saves any pending changes and waits for them to be written, then forgets all registered variables (before a new script is parsed).
+	void reset();
+	//Sets the minimum time between journal writes (seconds).
+	void setInterval( uint16_t seconds ){ iInterval = static_cast<int64_t>(seconds) * 1000000; }
+	uint16_t getNumEntries(){ return entries.size(); }
+	const Retain_Stats &getStats(){ return stats; }
+
+	private:
+	static void writerTask( void * );
+	//Writes the records in the buffer, then marks their values as saved. Called from the writer task, or from the scan thread if there is none.
+	void writeBatch();
+	//Waits until the writer task has finished with the record buffer.
+	void waitForWriter();
+	//Replaces the journal with a snapshot holding the records in the buffer.
+	bool compact();
+	//Appends the records in the buffer to the journal.
+	bool append();
+	//Serializes the given value of an entry into the record buffer. Args: <Entry index>, <Raw value>
+	void addRecord( uint16_t, uint64_t );
+	//Serializes the current value of every entry into the record buffer.
+	void addSnapshot();
+	//Writes the record buffer to the given file. Returns false on a failed write.
+	bool writeRecords( File &, uint32_t & );
+	static uint8_t getValueSize( OBJ_TYPE );
+	static uint32_t hashName( const String & );
+
+	vector<Retain_Entry> entries;
+	vector<uint8_t> recordBuffer; //reused for every write, sized for all entries when the journal is restored
+	vector<uint16_t> recordEntries; //entry index of each record in the buffer
+	Retain_Stats stats;
+	int64_t iInterval, //minimum time between journal writes (uS)
+			iLastWrite;
+	uint32_t i_journalSize;
+	TaskHandle_t taskHandle;
+	//Hands the record buffer (and the entries' saved values and the stats) between the cores. Set with release once the owner is done with them,
+	//and read with acquire before the other side touches them.
+	atomic<bool> b_pending; //the record buffer belongs to the writer task
+	bool b_snapshot; //the records in the buffer replace the journal, only changed while the scan owns the buffer
+	atomic<bool> b_failed; //the last write failed, reported from the scan thread
+};
+
+#endif /* PLC_RETAIN_H_ */
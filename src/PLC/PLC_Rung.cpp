@@ -10,55 +10,114 @@
 
 Ladder_Rung::~Ladder_Rung()
 {
+	rungNodes.clear(); //Clear the node tables.
+	rungEdges.clear();
 	rungObjects.clear(); //Clear the vector of objects.
-	firstRungObjects.clear();
 }
 
-bool Ladder_Rung::addRungObject( shared_ptr<Ladder_OBJ_Wrapper> obj )
+bool Ladder_Rung::compileRung( const vector<shared_ptr<Ladder_OBJ_Wrapper>> &wrappers, const vector<shared_ptr<Ladder_OBJ_Wrapper>> &firstWrappers )
 {
-	if ( !obj )
-		return false; //must be a valid object.
-	
-	 rungObjects.emplace_back(obj); 
-	 return true;
-}
-bool Ladder_Rung::addInitialRungObject( const vector<shared_ptr<Ladder_OBJ_Wrapper>> &vec )
-{
-	for ( uint8_t x = 0; x < vec.size(); x++ )
+	if ( !wrappers.size() || !firstWrappers.size() )
+		return false; //must have some objects to process
+
+	map<Ladder_OBJ_Wrapper *, uint16_t> nodeIndexes; //wrapper -> node index, only used while compiling
+	uint16_t numEdges = firstWrappers.size();
+	for ( uint16_t x = 0; x < wrappers.size(); x++ )
 	{
-		if ( !addInitialRungObject(vec[x]) )
-			return false;
+		nodeIndexes[wrappers[x].get()] = x;
+		numEdges += wrappers[x]->getNextObjects().size();
 	}
-	
-	return true; //default return path 
-}
-bool Ladder_Rung::addInitialRungObject( shared_ptr<Ladder_OBJ_Wrapper> obj )
-{
+
+	rungObjects.clear();
+	rungNodes.clear();
+	rungEdges.clear();
+	rungObjects.reserve(wrappers.size());
+	rungNodes.reserve(wrappers.size());
+	rungEdges.reserve(numEdges);
+
+	for ( uint16_t x = 0; x < firstWrappers.size(); x++ )
+	{
+		map<Ladder_OBJ_Wrapper *, uint16_t>::iterator it = nodeIndexes.find(firstWrappers[x].get());
+		if ( it == nodeIndexes.end() )
+			return false; //initial object that doesn't belong to this rung
+		
+		rungEdges.push_back(it->second);
+	}
+	i_numInitialNodes = firstWrappers.size();
+
+	for ( uint16_t x = 0; x < wrappers.size(); x++ )
+	{
+		const shared_ptr<Ladder_OBJ_Logical> &obj = wrappers[x]->getObject();
+		const vector<shared_ptr<Ladder_OBJ_Wrapper>> &nextObjects = wrappers[x]->getNextObjects();
+
+		if ( nextObjects.size() > UINT8_MAX )
+			return false; //too many branches from a single object
+
+		Ladder_Rung_Node node;
+		node.i_objIndex = rungObjects.size();
+		for ( uint16_t y = 0; y < rungObjects.size(); y++ ) //the same object may be referenced multiple times in a rung, only store it once.
+		{
+			if ( rungObjects[y] == obj )
+			{
+				node.i_objIndex = y;
+				break;
+			}
+		}
+		if ( node.i_objIndex == rungObjects.size() )
+			rungObjects.emplace_back(obj);
+
+		node.i_flags = wrappers[x]->getNot() ? NODE_FLAG_NOT : 0;
+		node.i_nextIndex = rungEdges.size();
+		node.i_numNext = nextObjects.size();
+
+		for ( uint8_t y = 0; y < nextObjects.size(); y++ )
+		{
+			map<Ladder_OBJ_Wrapper *, uint16_t>::iterator it = nodeIndexes.find(nextObjects[y].get());
+			if ( it == nodeIndexes.end() )
+				return false; //successor that doesn't belong to this rung
+
+			rungEdges.push_back(it->second);
+		}
+
+		rungNodes.push_back(node);
+	}
+
+	rungObjects.shrink_to_fit(); //duplicate references leave some slack behind
+
 	#ifdef DEBUG
-	Serial.println(PSTR("Adding Initial"));
+	Serial.println(PSTR("Rung compiled. Nodes: ") + String(rungNodes.size()) + PSTR(" Objects: ") + String(rungObjects.size()) + PSTR(" Edges: ") + String(rungEdges.size()));
 	#endif
 
-	firstRungObjects.emplace_back(obj);
 	return true;
 }
 
-shared_ptr<Ladder_OBJ_Wrapper> Ladder_Rung::getRungObjectByID(const String &id)
+shared_ptr<Ladder_OBJ_Logical> Ladder_Rung::getRungObjectByID(const String &id)
 {
-	for ( uint16_t x = 0; x < getNumRungObjects(); x++ )
+	for ( uint16_t x = 0; x < rungObjects.size(); x++ )
 	{
-		if ( rungObjects[x]->getObject()->getID() == id )
+		if ( rungObjects[x]->getID() == id )
 			return rungObjects[x];
 	}
 	
 	return 0; //Found nothing
 }
 
+void Ladder_Rung::processNode( uint16_t nodeIndex, bool state )
+{
+	const Ladder_Rung_Node &node = rungNodes[nodeIndex];
+	rungObjects[node.i_objIndex]->setLineState(state, node.i_flags & NODE_FLAG_NOT); //line state needs to be set per node, not per ladder object
+
+	uint16_t lastEdge = node.i_nextIndex + node.i_numNext;
+	for ( uint16_t x = node.i_nextIndex; x < lastEdge; x++ )
+		processNode(rungEdges[x], state);
+}
+
 void Ladder_Rung::processRung( uint16_t rungNum ) //Begins the process 
 {
 	//begin the update process 
 	//Line state is always true at the beginning of the rung. From this point, the objects should handle all logic operations on their own until all pathways are checked
-	for ( uint8_t x = 0; x < getNumInitialRungObjects(); x++ )
+	for ( uint16_t x = 0; x < i_numInitialNodes; x++ )
 	{
-		firstRungObjects[x]->setLineState(true);
+		processNode(rungEdges[x], true);
 	}
 }
@@ -21,33 +21,51 @@ Each rung has its own set of logic statements (set by the end-user) that ultimat
 
 extern UICore Core;
 
+//Flags that are stored per node in the compiled rung.
+enum RUNG_NODE_FLAGS : uint8_t
+{
+	NODE_FLAG_NOT = 0x01 //The object is being interpreted using NOT logic for this instance.
+};
+
+//Compact scan-time representation of a single Ladder_OBJ_Wrapper. Nodes reference the rung's object table and edge table by index rather than by pointer.
+struct Ladder_Rung_Node
+{
+	uint16_t i_objIndex; //Index of the ladder object in the rung's object table.
+	uint16_t i_nextIndex; //Index of the first successor in the rung's edge table.
+	uint8_t i_numNext; //Number of successors, stored contiguously in the edge table starting at i_nextIndex.
+	uint8_t i_flags; //RUNG_NODE_FLAGS
+};
+
 class Ladder_Rung
 {
 	public:	
-	Ladder_Rung(){ };
+	Ladder_Rung(){ i_numInitialNodes = 0; };
 	~Ladder_Rung();
-	//Adds a new ladder logic object to the rung, provided it passes the appropriate tests.
-	bool addRungObject( shared_ptr<Ladder_OBJ_Wrapper> ); 
-	//Returns the ladder object associated within this rung object, based on the object's index in the storage vector.
-	shared_ptr<Ladder_OBJ_Wrapper>getRungObjectByIndex(uint16_t x){ return rungObjects[x]; }
+	//Flattens the wrapper graph generated by the parser into the compact node/edge tables used during the scan. The wrappers are no longer needed afterwards.
+	//Args: All wrappers created for the rung, Wrappers that are referenced at the beginning of each scan.
+	bool compileRung( const vector<shared_ptr<Ladder_OBJ_Wrapper>> &, const vector<shared_ptr<Ladder_OBJ_Wrapper>> & );
+	//Returns the ladder object associated within this rung object, based on the node's index in the node table.
+	const shared_ptr<Ladder_OBJ_Logical> &getRungObjectByIndex(uint16_t x){ return rungObjects[rungNodes[x].i_objIndex]; }
 	//Returns the ladder object associated with this rung object, based on the object's unique ID number.
-	shared_ptr<Ladder_OBJ_Wrapper>getRungObjectByID(const String &);
-	//Returns the total number of objects stored in the rung object.
-	uint16_t getNumRungObjects(){ return rungObjects.size(); }
-	//Returns the number of rung objects stored in the container for ladder objects that are referenced at the beginning of each ladder logic scan.
-	uint8_t getNumInitialRungObjects() { return firstRungObjects.size(); }
-	//Adds an inputted object to the container for the ladder objects that are referenced at the beginning of each ladder logic scan.
-	bool addInitialRungObject( shared_ptr<Ladder_OBJ_Wrapper> );
-	bool addInitialRungObject( const vector<shared_ptr<Ladder_OBJ_Wrapper>> & );
-	//Returns a reference to the container for the rung object's ladder objects.
-	vector<shared_ptr<Ladder_OBJ_Wrapper>> &getRungObjects(){ return rungObjects; }
+	shared_ptr<Ladder_OBJ_Logical> getRungObjectByID(const String &);
+	//Returns the total number of nodes (object references) stored in the rung object.
+	uint16_t getNumRungObjects(){ return rungNodes.size(); }
+	//Returns the number of nodes that are referenced at the beginning of each ladder logic scan.
+	uint16_t getNumInitialRungObjects() { return i_numInitialNodes; }
+	//Returns a reference to the container for the rung's unique ladder objects.
+	const vector<shared_ptr<Ladder_OBJ_Logical>> &getRungObjects(){ return rungObjects; }
 	//Begins the process of setting the line state to HIGH for the appropriate ladder object from the initial objects container, and iteratively determining the state for each subsequently associated object and applying changes as needed.
 	void processRung( uint16_t );
 
 		
 	private:
-	vector<shared_ptr<Ladder_OBJ_Wrapper>> rungObjects; //Container used to store all of the pointers to objects associated with a given rung.
-	vector<shared_ptr<Ladder_OBJ_Wrapper>> firstRungObjects; //Container used to store the objects that are first checked in the rung when it comes time to scan.
+	//Applies the line state to the node's object, then forwards the resulting state to each successor.
+	void processNode( uint16_t, bool );
+
+	vector<shared_ptr<Ladder_OBJ_Logical>> rungObjects; //Unique objects referenced by this rung. Nodes refer to these by index.
+	vector<Ladder_Rung_Node> rungNodes; //One entry per object reference (wrapper) in the parsed rung.
+	vector<uint16_t> rungEdges; //Node indices. The first i_numInitialNodes entries are the initial nodes, followed by each node's successor range.
+	uint16_t i_numInitialNodes; //Number of nodes that are processed at the beginning of each scan.
 };
 
 
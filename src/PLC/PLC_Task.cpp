@@ -0,0 +1,43 @@
+/*
+ * PLC_Task.cpp
+ *
+ * Scan rate and timing statistics of a task, see PLC_Task.h.
+ */
+
+#include "PLC_Task.h"
+
+PLC_Task::PLC_Task( const String &name, uint32_t period )
+{
+	s_name = name;
+	i_period = period;
+	i_nextRun = 0; //due on the first pass
+	memset( &stats, 0, sizeof(stats) );
+}
+
+void PLC_Task::beginRun( int64_t now )
+{
+	if ( !i_period )
+		return;
+
+	if ( i_nextRun && now - i_nextRun > stats.i_maxLatency )
+		stats.i_maxLatency = now - i_nextRun;
+
+	if ( !i_nextRun ) //the first run starts the schedule
+		i_nextRun = now;
+
+	i_nextRun += i_period;
+	if ( i_nextRun <= now ) //fell behind, skip ahead rather than running several times back to back
+	{
+		stats.i_overruns++;
+		i_nextRun = now + i_period;
+	}
+}
+
+void PLC_Task::endRun( int64_t time )
+{
+	stats.i_runs++;
+	stats.i_lastTime = time;
+	stats.i_totalTime += time;
+	if ( time > stats.i_maxTime )
+		stats.i_maxTime = time;
+}
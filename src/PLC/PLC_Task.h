@@ -0,0 +1,85 @@
+/*
+ * PLC_Task.h
+ *
+ * A task is a section of the logic script whose rungs are scanned at their own rate. Sections are started in the script with TASK[<NAME>,<PERIOD>], where the
+ * period is given in MS (default) or US (EX: TASK[FAST,1MS], TASK[SLOW,100MS]). A period of 0 scans the section on every pass of the main loop.
+ * Rungs before the first TASK line belong to the continuous MAIN task, so scripts without tasks are scanned as before.
+ * Shorter periods have a higher priority. A task that becomes due while a lower priority task is being scanned runs between two rungs of the lower priority task,
+ * then the lower priority task picks up where it left off. Each object is updated (outputs written, timers scheduled) by the highest priority task that uses it.
+ * With the dual core scan enabled, only tasks that nothing can preempt (the highest priority task, or every task if none has a period) are split across both
+ * cores. A partitioned run can't stop between rungs, so tasks below a periodic task are always scanned rung by rung on a single core.
+ */
+
+#ifndef PLC_TASK_H_
+#define PLC_TASK_H_
+
+#include "PLC_IO.h"
+#include "PLC_Rung.h"
+#include "PLC_Partition.h"
+
+#define TASK_MAX_TASKS 8
+
+class InputOBJ;
+
+//Timing statistics for a task, in uS.
+struct Task_Stats
+{
+	uint32_t i_runs,
+			 i_overruns, //times the task started a whole period (or more) late, these runs are skipped rather than made up
+			 i_preemptions, //times a higher priority task ran in the middle of this task's rungs
+			 i_skips; //runs skipped by the scan watchdog
+	int64_t i_lastTime, //execution time of the last run, not counting the higher priority tasks that ran within it
+			i_maxTime,
+			i_totalTime,
+			i_maxLatency; //longest delay between the time the task was due and the time it started
+};
+
+class PLC_Task
+{
+	public:
+	//Args: <Name>, <Period (uS), 0 for continuous>
+	PLC_Task( const String &name, uint32_t period );
+
+	const String &getName(){ return s_name; }
+	uint32_t getPeriod(){ return i_period; }
+	const Task_Stats &getStats(){ return stats; }
+
+	//Returns true if the task should run at the given time. Continuous tasks are always due.
+	bool isDue( int64_t now ){ return !i_period || now >= i_nextRun; }
+	//Records the start of a run at the given time, and schedules the next one.
+	void beginRun( int64_t );
+	//Records the end of a run. Arg: <Execution time (uS), not counting any higher priority tasks that ran within it>
+	void endRun( int64_t );
+	void addPreemption(){ stats.i_preemptions++; }
+	//Schedules the next run without running the task (scan watchdog SKIP policy).
+	void skipRun( int64_t now ){ beginRun(now); stats.i_skips++; }
+
+	//Args: <Rung>, <Rung number in the whole script>
+	void addRung( shared_ptr<Ladder_Rung> rung, uint16_t number ){ taskRungs.push_back(rung); rungNumbers.push_back(number); }
+	void addObject( shared_ptr<Ladder_OBJ_Logical> obj ){ taskObjects.push_back(obj); }
+	void addInput( shared_ptr<InputOBJ> input ){ taskInputs.push_back(input); }
+	//Rungs of the task, in script order.
+	vector<shared_ptr<Ladder_Rung>> &getRungs(){ return taskRungs; }
+	//Returns the number in the whole script of the given rung of the task.
+	uint16_t getRungNumber( uint16_t rung ){ return rungNumbers[rung]; }
+	//Objects that are updated at the end of each run of the task.
+	vector<shared_ptr<Ladder_OBJ_Logical>> &getObjects(){ return taskObjects; }
+	//Physical inputs referenced by the task's rungs, sampled at the start of each run.
+	vector<shared_ptr<InputOBJ>> &getInputs(){ return taskInputs; }
+	//Returns the dual core partition of the task's rungs, or null if they are processed on a single core.
+	unique_ptr<PLC_Rung_Partition> &getPartition(){ return rungPartition; }
+
+	private:
+	String s_name;
+	uint32_t i_period;
+	int64_t i_nextRun;
+	Task_Stats stats;
+
+	vector<shared_ptr<Ladder_Rung>> taskRungs;
+	vector<uint16_t> rungNumbers;
+	vector<shared_ptr<Ladder_OBJ_Logical>> taskObjects;
+	vector<shared_ptr<InputOBJ>> taskInputs;
+	unique_ptr<PLC_Rung_Partition> rungPartition;
+};
+
+#endif /* PLC_TASK_H_ */
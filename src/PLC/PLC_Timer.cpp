@@ -0,0 +1,130 @@
+/*
+ * PLC_Timer.cpp
+ *
+ * Hierarchical timer wheel used by ladder timers.
+ */ 
+
+#include "PLC_Timer.h"
+#include <string.h>
+
+PLC_Timer_Wheel::PLC_Timer_Wheel()
+{
+	memset(slots, 0, sizeof(slots));
+	i_currentTick = 0;
+	i_now = 0;
+	i_numScheduled = 0;
+}
+
+void PLC_Timer_Wheel::insert( Timer_Wheel_Node *node )
+{
+	uint64_t expiry = node->i_expiryTick;
+	if ( expiry <= i_currentTick ) //already due, fire on the next tick
+		expiry = i_currentTick + 1;
+
+	uint64_t delta = expiry - i_currentTick;
+	uint8_t level = 0;
+	while ( level < TIMER_WHEEL_LEVELS - 1 && delta >= (1ULL << (TIMER_WHEEL_SLOT_BITS * (level + 1))) )
+		level++;
+
+	uint8_t shift = TIMER_WHEEL_SLOT_BITS * level;
+	if ( delta >= (1ULL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) ) //beyond the range of the wheel, park in the furthest slot and re-queue when it cascades
+		expiry = i_currentTick + (TIMER_WHEEL_SLOT_MASK << shift);
+
+	Timer_Wheel_Node **slot = &slots[level][(expiry >> shift) & TIMER_WHEEL_SLOT_MASK];
+	node->prev = 0;
+	node->next = *slot;
+	if ( *slot )
+		(*slot)->prev = node;
+	*slot = node;
+	node->pSlot = slot;
+}
+
+void PLC_Timer_Wheel::schedule( Timer_Wheel_Node *node, int64_t expiryTime )
+{
+	cancel(node);
+	//round up, so the node never fires before the requested time
+	node->i_expiryTick = (expiryTime + (1 << TIMER_WHEEL_TICK_SHIFT) - 1) >> TIMER_WHEEL_TICK_SHIFT;
+	if ( !i_numScheduled ) //the wheel doesn't turn while empty, so catch up first
+		i_currentTick = i_now >> TIMER_WHEEL_TICK_SHIFT;
+
+	insert(node);
+	i_numScheduled++;
+}
+
+void PLC_Timer_Wheel::cancel( Timer_Wheel_Node *node )
+{
+	if ( !node->pSlot )
+		return;
+
+	if ( node->prev )
+		node->prev->next = node->next;
+	else
+		*node->pSlot = node->next;
+
+	if ( node->next )
+		node->next->prev = node->prev;
+
+	node->prev = 0;
+	node->next = 0;
+	node->pSlot = 0;
+	i_numScheduled--;
+}
+
+void PLC_Timer_Wheel::cascade( uint8_t level, uint8_t index )
+{
+	Timer_Wheel_Node *node = slots[level][index];
+	slots[level][index] = 0;
+	while ( node )
+	{
+		Timer_Wheel_Node *next = node->next;
+		insert(node); //count is unchanged
+		node = next;
+	}
+}
+
+void PLC_Timer_Wheel::advance( int64_t now )
+{
+	i_now = now;
+	uint64_t nowTick = now >> TIMER_WHEEL_TICK_SHIFT;
+
+	while ( i_currentTick < nowTick )
+	{
+		if ( !i_numScheduled ) //nothing to do, jump straight to the current time
+		{
+			i_currentTick = nowTick;
+			break;
+		}
+
+		i_currentTick++;
+
+		//When a lower level wraps around, pull the next slot of the level above down into it.
+		for ( uint8_t level = 1; level < TIMER_WHEEL_LEVELS; level++ )
+		{
+			if ( (i_currentTick >> (TIMER_WHEEL_SLOT_BITS * (level - 1))) & TIMER_WHEEL_SLOT_MASK )
+				break;
+
+			cascade(level, (i_currentTick >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK);
+		}
+
+		Timer_Wheel_Node *node = slots[0][i_currentTick & TIMER_WHEEL_SLOT_MASK];
+		slots[0][i_currentTick & TIMER_WHEEL_SLOT_MASK] = 0;
+		while ( node )
+		{
+			Timer_Wheel_Node *next = node->next;
+			node->prev = 0;
+			node->next = 0;
+			node->pSlot = 0;
+			i_numScheduled--;
+
+			if ( node->i_expiryTick > i_currentTick ) //parked beyond the range of the wheel, not due yet
+			{
+				insert(node);
+				i_numScheduled++;
+			}
+			else if ( node->func )
+				node->func(node->funcArg);
+
+			node = next;
+		}
+	}
+}
@@ -0,0 +1,62 @@
+/*
+ * PLC_Timer.h
+ *
+ * Shared timer service for ladder timers. A hierarchical timer wheel (4 levels of 64 slots) is advanced once per scan using a single
+ * microsecond timestamp, so timers that are not due cost nothing during the scan and expiry is O(1) per timer.
+ */ 
+
+#ifndef PLC_TIMER_H_
+#define PLC_TIMER_H_
+
+#include <stdint.h>
+
+#define TIMER_WHEEL_TICK_SHIFT 8 //1 tick = 256uS
+#define TIMER_WHEEL_SLOT_BITS 6 
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS) //slots per level
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS 4 //range of 64^4 ticks (~71 minutes), longer timers are re-queued as the wheel turns
+
+typedef void (*Timer_Wheel_Callback)( void * );
+
+//Intrusive list node that is embedded in each object that uses the timer wheel. No allocations are made when scheduling or cancelling.
+struct Timer_Wheel_Node
+{
+	Timer_Wheel_Node( Timer_Wheel_Callback callback = 0, void *arg = 0 ){ prev = 0; next = 0; pSlot = 0; i_expiryTick = 0; func = callback; funcArg = arg; }
+
+	bool isScheduled(){ return pSlot != 0; }
+
+	Timer_Wheel_Node *prev, *next;
+	Timer_Wheel_Node **pSlot; //slot this node is currently linked into (null if not scheduled)
+	uint64_t i_expiryTick;
+	Timer_Wheel_Callback func; //called from advance() once the node expires
+	void *funcArg;
+};
+
+class PLC_Timer_Wheel
+{
+	public:
+	PLC_Timer_Wheel();
+
+	//Moves the wheel forward to the inputted time (uS), firing any expired nodes. Called once at the start of each scan.
+	void advance( int64_t );
+	//Schedules the node to expire at the inputted absolute time (uS). Reschedules the node if it is already scheduled.
+	void schedule( Timer_Wheel_Node *, int64_t );
+	//Removes the node from the wheel (if scheduled).
+	void cancel( Timer_Wheel_Node * );
+	//Returns the timestamp (uS) that was sampled at the start of the current scan.
+	int64_t getNow(){ return i_now; }
+	//Returns the number of nodes currently scheduled.
+	uint32_t getNumScheduled(){ return i_numScheduled; }
+
+	private:
+	void insert( Timer_Wheel_Node * );
+	//Re-inserts all nodes from the given slot into the lower levels.
+	void cascade( uint8_t, uint8_t );
+
+	Timer_Wheel_Node *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	uint64_t i_currentTick;
+	int64_t i_now;
+	uint32_t i_numScheduled;
+};
+
+#endif /* PLC_TIMER_H_ */
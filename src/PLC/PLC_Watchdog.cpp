@@ -0,0 +1,192 @@
+/*
+ * PLC_Watchdog.cpp
+ *
+ * Scan time budget and overrun policy, see PLC_Watchdog.h.
+ */
+
+#include "PLC_Watchdog.h"
+#include "OBJECTS/obj_output_basic.h"
+#include "../CORE/UICore.h"
+#include "../CORE/Trace.h"
+#include "../CORE/HeapStats.h"
+
+extern UICore Core;
+
+PLC_Scan_Watchdog::PLC_Scan_Watchdog()
+{
+	i_budget = 0;
+	i_limit = 1;
+	i_policy = WATCHDOG_POLICY_LOG;
+	b_holding = false;
+	reset();
+}
+
+void PLC_Scan_Watchdog::configure( uint32_t budget, uint8_t limit, uint8_t policy )
+{
+	i_budget = budget;
+	i_limit = limit ? limit : 1;
+	i_policy = ( policy <= WATCHDOG_POLICY_FAULT ) ? policy : WATCHDOG_POLICY_LOG;
+}
+
+void PLC_Scan_Watchdog::setProgram( uint16_t numRungs, uint8_t numTasks )
+{
+	rungTimes.assign(numRungs, 0);
+	taskTimes.assign(numTasks, 0);
+	//Sized up front, so an overrun is recorded without allocating.
+	lastOverrun.rungTimes.assign(numRungs, 0);
+	lastOverrun.taskTimes.assign(numTasks, 0);
+}
+
+void PLC_Scan_Watchdog::clear()
+{
+	if ( b_holding )
+	{
+		for ( uint16_t x = 0; x < outputs.size(); x++ )
+			outputs[x]->releaseSafeState();
+	}
+	b_holding = false;
+	b_faulted = false;
+	i_consecutive = 0;
+	i_skipTask = WATCHDOG_NO_TASK;
+}
+
+void PLC_Scan_Watchdog::reset()
+{
+	clear();
+	outputs.clear();
+	rungTimes.clear();
+	taskTimes.clear();
+	memset( phaseTimes, 0, sizeof(phaseTimes) );
+	lastOverrun.rungTimes.clear();
+	lastOverrun.taskTimes.clear();
+	lastOverrun.i_time = lastOverrun.i_scanTime = 0;
+	lastOverrun.i_epoch = 0;
+	memset( lastOverrun.phaseTimes, 0, sizeof(lastOverrun.phaseTimes) );
+	memset( &stats, 0, sizeof(stats) );
+	i_scanStart = 0;
+	i_scanAllocs = i_workerAllocs = 0;
+	memset( phaseAllocs, 0, sizeof(phaseAllocs) );
+}
+
+void PLC_Scan_Watchdog::beginScan( int64_t now )
+{
+	i_scanStart = now;
+	i_scanAllocs = Heap_Monitor::getThreadAllocs();
+	i_workerAllocs = 0;
+	memset( phaseAllocs, 0, sizeof(phaseAllocs) );
+	if ( !i_budget )
+		return;
+
+	//Only the rungs that run in this scan are timed, the rest must read 0.
+	if ( rungTimes.size() )
+		memset( &rungTimes[0], 0, rungTimes.size() * sizeof(uint32_t) );
+	if ( taskTimes.size() )
+		memset( &taskTimes[0], 0, taskTimes.size() * sizeof(int64_t) );
+	memset( phaseTimes, 0, sizeof(phaseTimes) );
+}
+
+bool PLC_Scan_Watchdog::endScan( int64_t now )
+{
+	int64_t scanTime = now - i_scanStart;
+	stats.i_scans++;
+	stats.i_lastScan = scanTime;
+	if ( scanTime > stats.i_maxScan )
+		stats.i_maxScan = scanTime;
+
+	uint32_t allocs = Heap_Monitor::getThreadAllocs() - i_scanAllocs + i_workerAllocs;
+	if ( allocs && stats.i_scans > WATCHDOG_WARMUP_SCANS )
+	{
+		stats.i_lastAllocs = allocs;
+		memcpy( stats.lastPhaseAllocs, phaseAllocs, sizeof(phaseAllocs) );
+		if ( !stats.i_allocScans++ ) //once per program, the message itself allocates
+			Core.sendMessage( PSTR("Scan ") + String(stats.i_scans) + PSTR(" allocated from the heap ") + String(allocs) + PSTR(" times, ") + describeAllocs(stats), PRIORITY_HIGH );
+	}
+
+	if ( !i_budget )
+		return false;
+
+	if ( scanTime <= i_budget )
+	{
+		i_consecutive = 0;
+		return false;
+	}
+
+	stats.i_overruns++;
+	EventTrace.recordAt( TRACE_OVERRUN, 0, scanTime, now );
+	lastOverrun.i_time = now;
+	lastOverrun.i_scanTime = scanTime;
+	lastOverrun.i_epoch = Core.getSystemTimeObj()->GetEpoch();
+	memcpy( lastOverrun.phaseTimes, phaseTimes, sizeof(phaseTimes) );
+	lastOverrun.rungTimes = rungTimes; //same size, no allocation
+	lastOverrun.taskTimes = taskTimes;
+
+	if ( ++i_consecutive >= i_limit )
+		trip();
+
+	return true;
+}
+
+String PLC_Scan_Watchdog::describeAllocs( const Watchdog_Stats &scanStats )
+{
+	uint32_t taskAllocs = scanStats.i_lastAllocs;
+	for ( uint8_t x = 0; x < WATCHDOG_NUM_PHASES; x++ )
+		taskAllocs -= scanStats.lastPhaseAllocs[x];
+
+	return PSTR("accessors/remote server/background/retentive/tasks: ") + String(scanStats.lastPhaseAllocs[WATCHDOG_PHASE_ACCESSORS]) + "/" + String(scanStats.lastPhaseAllocs[WATCHDOG_PHASE_REMOTE_SERVER])
+		+ "/" + String(scanStats.lastPhaseAllocs[WATCHDOG_PHASE_BACKGROUND]) + "/" + String(scanStats.lastPhaseAllocs[WATCHDOG_PHASE_RETAIN]) + "/" + String(taskAllocs);
+}
+
+void PLC_Scan_Watchdog::trip()
+{
+	i_consecutive = 0;
+	stats.i_trips++;
+
+	String message = PSTR("Scan overrun: ") + String(static_cast<int32_t>(lastOverrun.i_scanTime)) + PSTR("us, budget: ") + String(i_budget) + PSTR("us");
+	switch ( i_policy )
+	{
+		case WATCHDOG_POLICY_SKIP:
+		{
+			//Tasks are in priority order, so the last one that ran is the lowest priority (longest period, or continuous). The first task is never skipped.
+			for ( uint8_t x = taskTimes.size(); x-- > 1; )
+			{
+				if ( taskTimes[x] > 0 )
+				{
+					i_skipTask = x;
+					break;
+				}
+			}
+			if ( i_skipTask != WATCHDOG_NO_TASK )
+				message += PSTR(", skipping task ") + String(i_skipTask);
+		}
+		break;
+		case WATCHDOG_POLICY_SAFE:
+		{
+			if ( !b_holding )
+				message += PSTR(", outputs set to their safe state");
+			holdOutputs();
+		}
+		break;
+		case WATCHDOG_POLICY_FAULT:
+		{
+			if ( !b_faulted )
+				message += PSTR(", logic stopped");
+			holdOutputs();
+			b_faulted = true;
+		}
+		break;
+		default:
+			break;
+	}
+
+	Core.sendMessage( message, PRIORITY_HIGH );
+}
+
+void PLC_Scan_Watchdog::holdOutputs()
+{
+	if ( b_holding )
+		return;
+
+	for ( uint16_t x = 0; x < outputs.size(); x++ )
+		outputs[x]->holdSafeState();
+	b_holding = true;
+}
@@ -0,0 +1,141 @@
+/*
+ * PLC_Watchdog.h
+ *
+ * Measures each pass of the logic scan against a time budget. Scans that run over the budget are counted and timestamped, and the time spent in each rung,
+ * task and phase of the last one is kept, so a blocking remote request or a long math loop can be found after the fact.
+ * Once a configured number of scans in a row have run over, the overrun policy is applied:
+ * LOG - a message is sent, nothing else changes.
+ * SKIP - the next run of the lowest priority task that ran in the last scan is skipped. The highest priority task is never skipped.
+ * SAFE - outputs are driven to their configured safe state (de-energized unless the script sets it, see createOutputOBJ) and held there. The logic keeps running.
+ * FAULT - outputs are held as with SAFE, and the logic stops.
+ * SAFE and FAULT stay in effect until the watchdog is cleared (/w reset) or a new script is loaded.
+ * Rungs that are processed on both cores (see PLC_Partition.h) are only timed as part of their task.
+ * The watchdog also checks that the scan runs without heap allocations once the program has been loaded. Every scan after the first is compared against
+ * the allocation count of the scan core and the dual core worker (see HeapStats.h), and a message is sent the first time one allocates. The count is
+ * split by phase, so allocations made by the network phases (remote clients, remote server) can be told apart from those made by the logic.
+ */
+
+#ifndef PLC_WATCHDOG_H_
+#define PLC_WATCHDOG_H_
+
+#include "PLC_IO.h"
+
+#define WATCHDOG_NO_TASK 0xFF
+#define WATCHDOG_REPORT_RUNGS 10 //slowest rungs of the last overrun shown in the report
+#define WATCHDOG_WARMUP_SCANS 1 //scans after a program is loaded that may allocate (first use of containers, etc.)
+
+class OutputOBJ;
+
+enum WATCHDOG_POLICY : uint8_t
+{
+	WATCHDOG_POLICY_LOG,
+	WATCHDOG_POLICY_SKIP,
+	WATCHDOG_POLICY_SAFE,
+	WATCHDOG_POLICY_FAULT
+};
+
+//Parts of the scan outside of the tasks, timed separately.
+enum WATCHDOG_PHASE : uint8_t
+{
+	WATCHDOG_PHASE_ACCESSORS, //remote clients, which may block on the network
+	WATCHDOG_PHASE_REMOTE_SERVER,
+	WATCHDOG_PHASE_BACKGROUND, //objects that no rung references
+	WATCHDOG_PHASE_RETAIN, //writing changed retentive values to flash
+	WATCHDOG_NUM_PHASES
+};
+
+//Timing of a scan that ran over the budget, in uS.
+struct Watchdog_Overrun
+{
+	int64_t i_time, //uptime at the end of the scan
+			i_scanTime;
+	uint32_t i_epoch; //system time (UNIX seconds) at the end of the scan
+	int64_t phaseTimes[WATCHDOG_NUM_PHASES];
+	vector<int64_t> taskTimes; //by task index, not counting the tasks that preempted them
+	vector<uint32_t> rungTimes; //by rung number (script order), 0 for rungs that didn't run
+};
+
+struct Watchdog_Stats
+{
+	uint32_t i_scans,
+			 i_overruns,
+			 i_trips, //times the policy was applied
+			 i_allocScans, //scans after the warm up that allocated from the heap
+			 i_lastAllocs, //allocations made by the last of them
+			 lastPhaseAllocs[WATCHDOG_NUM_PHASES]; //the part of them made in each phase, the rest were made by the tasks
+	int64_t i_lastScan,
+			i_maxScan;
+};
+
+class PLC_Scan_Watchdog
+{
+	public:
+	PLC_Scan_Watchdog();
+
+	//Args: <Budget (uS), 0 disables the watchdog>, <Overruns in a row before the policy is applied>, <WATCHDOG_POLICY>
+	void configure( uint32_t, uint8_t, uint8_t );
+	//Sizes the timing tables for a newly loaded program. Args: <Number of rungs>, <Number of tasks>
+	void setProgram( uint16_t, uint8_t );
+	//Adds an output that is held at its configured safe state by the SAFE and FAULT policies.
+	void addOutput( shared_ptr<OutputOBJ> output ){ outputs.push_back(output); }
+	//Releases the outputs and clears a fault. The statistics and the last overrun are kept.
+	void clear();
+	//Forgets the program (before a new script is parsed).
+	void reset();
+
+	bool isEnabled(){ return i_budget; }
+	bool isFaulted(){ return b_faulted; }
+	bool isHolding(){ return b_holding; }
+	uint32_t getBudget(){ return i_budget; }
+	uint8_t getPolicy(){ return i_policy; }
+	const Watchdog_Stats &getStats(){ return stats; }
+	//Returns the timing of the last scan that ran over the budget. i_time is 0 if there hasn't been one.
+	const Watchdog_Overrun &getLastOverrun(){ return lastOverrun; }
+	//Returns the allocations of the last allocating scan split by phase, for the reports.
+	static String describeAllocs( const Watchdog_Stats & );
+
+	//Called at the start of each scan. Arg: current time (uS)
+	void beginScan( int64_t );
+	//Called at the end of each scan. Checks the scan against the budget and applies the policy. Returns true if the scan ran over.
+	bool endScan( int64_t );
+	//Returns true if the next run of the given task is skipped (SKIP policy).
+	bool isSkipped( uint8_t task ){ return task == i_skipTask; }
+	//Called once the run has been skipped.
+	void clearSkip(){ i_skipTask = WATCHDOG_NO_TASK; }
+
+	//Timing of the current scan, only recorded while the watchdog is enabled.
+	void setRungTime( uint16_t rung, uint32_t time ){ if ( rung < rungTimes.size() ) rungTimes[rung] = time; }
+	void addTaskTime( uint8_t task, int64_t time ){ if ( task < taskTimes.size() ) taskTimes[task] += time; }
+	void setPhaseTime( WATCHDOG_PHASE phase, int64_t time ){ phaseTimes[phase] = time; }
+	//Adds allocations made for the current scan by another thread (the dual core worker).
+	void addAllocs( uint32_t count ){ i_workerAllocs += count; }
+	//Attributes allocations made by the scan core during the current scan to a phase.
+	void addPhaseAllocs( WATCHDOG_PHASE phase, uint32_t count ){ phaseAllocs[phase] += count; }
+
+	private:
+	//Applies the policy once enough scans in a row have run over.
+	void trip();
+	void holdOutputs();
+
+	uint32_t i_budget;
+	uint8_t i_limit,
+			i_policy,
+			i_consecutive, //scans in a row over the budget
+			i_skipTask; //task whose next run is skipped
+	bool b_faulted,
+		 b_holding; //outputs held at their safe state
+	int64_t i_scanStart;
+	uint32_t i_scanAllocs, //allocation count of the scan core at the start of the scan
+			 i_workerAllocs;
+
+	vector<shared_ptr<OutputOBJ>> outputs;
+	vector<uint32_t> rungTimes; //current scan
+	vector<int64_t> taskTimes;
+	int64_t phaseTimes[WATCHDOG_NUM_PHASES];
+	uint32_t phaseAllocs[WATCHDOG_NUM_PHASES]; //current scan
+
+	Watchdog_Overrun lastOverrun;
+	Watchdog_Stats stats;
+};
+
+#endif /* PLC_WATCHDOG_H_ */
@@ -517,6 +517,9 @@ String getObjectType(OBJ_TYPE val)
 		case OBJ_TYPE::TYPE_CLOCK:
 			obj_type = "CLK";
 			break;
+		case OBJ_TYPE::TYPE_SCHEDULE:
+			obj_type = scheduleTag2;
+			break;
 		case OBJ_TYPE::TYPE_TIMER_ON:
 			obj_type = typeTagTON;
 			break;
@@ -524,7 +527,7 @@ String getObjectType(OBJ_TYPE val)
 			obj_type = typeTagTOF;
 			break;
 		case OBJ_TYPE::TYPE_TIMER_RET:
-			obj_type = "RETT";
+			obj_type = typeTagRTO;
 			break;
 		case OBJ_TYPE::TYPE_COUNTER_UP:
 			obj_type = typeTagCTU;
@@ -532,9 +535,36 @@ String getObjectType(OBJ_TYPE val)
 		case OBJ_TYPE::TYPE_COUNTER_DOWN:
 			obj_type = typeTagCTD;
 			break;
+		case OBJ_TYPE::TYPE_COUNTER_HS:
+			obj_type = hsCounterTag;
+			break;
 		case OBJ_TYPE::TYPE_ONS:
 			obj_type = "ONS";
 			break;
+		case OBJ_TYPE::TYPE_PID:
+			obj_type = pidTag;
+			break;
+		case OBJ_TYPE::TYPE_FIFO:
+			obj_type = fifoTag;
+			break;
+		case OBJ_TYPE::TYPE_LIFO:
+			obj_type = lifoTag;
+			break;
+		case OBJ_TYPE::TYPE_STACK_UNLOAD:
+			obj_type = unloadTag1;
+			break;
+		case OBJ_TYPE::TYPE_SHIFT_LEFT:
+			obj_type = shiftLeftTag;
+			break;
+		case OBJ_TYPE::TYPE_SHIFT_RIGHT:
+			obj_type = shiftRightTag;
+			break;
+		case OBJ_TYPE::TYPE_SEQUENCER:
+			obj_type = sequencerTag;
+			break;
+		case OBJ_TYPE::TYPE_LOGGER:
+			obj_type = loggerTag;
+			break;
 		case OBJ_TYPE::TYPE_MATH_EQ:
 			obj_type = typeTagMEQ;
 			break;
@@ -584,11 +614,35 @@ String getObjectType(OBJ_TYPE val)
 			obj_type = typeTagMDEC;
 			break;
 		case OBJ_TYPE::TYPE_MATH_CPT:
-			obj_type = "CPT";
+			obj_type = typeTagMCPT;
 			break;
 		case OBJ_TYPE::TYPE_MATH_MOV:
 			obj_type = typeTagMMOV;
 			break;
+		case OBJ_TYPE::TYPE_MATH_COP:
+			obj_type = typeTagMCOP;
+			break;
+		case OBJ_TYPE::TYPE_MATH_FILL:
+			obj_type = typeTagMFILL;
+			break;
+		case OBJ_TYPE::TYPE_MATH_FIND:
+			obj_type = typeTagMFIND;
+			break;
+		case OBJ_TYPE::TYPE_MATH_SUM:
+			obj_type = typeTagMSUM;
+			break;
+		case OBJ_TYPE::TYPE_MATH_AVG:
+			obj_type = typeTagMAVG;
+			break;
+		case OBJ_TYPE::TYPE_MATH_MIN:
+			obj_type = typeTagMMIN;
+			break;
+		case OBJ_TYPE::TYPE_MATH_MAX:
+			obj_type = typeTagMMAX;
+			break;
+		case OBJ_TYPE::TYPE_VAR_ARRAY:
+			obj_type = variableTag1 + PSTR("[]");
+			break;
 		case OBJ_TYPE::TYPE_VAR_BOOL:
 		case OBJ_TYPE::TYPE_VAR_STRING:
 		case OBJ_TYPE::TYPE_VAR_FLOAT:
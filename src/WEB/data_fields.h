@@ -163,10 +163,12 @@ class VAR_Datafield : public DataField
 	{ variablePtr.uiShortVar = var; iVarType = OBJ_TYPE::TYPE_VAR_USHORT; }
 	VAR_Datafield( float *var, uint8_t address, FIELD_TYPE type, const String &fieldLabel = "", const vector<String> &params = {}, uint8_t cols = MAX_DATA_LENGTH, uint8_t rows = 1, bool newLine = true, bool functional = false ) : DataField( address, type, fieldLabel, String(*var), params, cols, rows, newLine, functional )
 	{ variablePtr.fVar = var; iVarType = OBJ_TYPE::TYPE_VAR_FLOAT; }
+	#if UINT_FAST32_MAX != UINT64_MAX //on 64 bit hosts (native tests) the fast types are the 64 bit types, which have their own constructors
 	VAR_Datafield( int_fast32_t *var, uint8_t address, FIELD_TYPE type, const String &fieldLabel = "", const vector<String> &params = {}, uint8_t cols = MAX_DATA_LENGTH, uint8_t rows = 1, bool newLine = true, bool functional = false ) : DataField( address, type, fieldLabel, String(*var), params, cols, rows, newLine, functional )
 	{ variablePtr.iVar = var; iVarType = OBJ_TYPE::TYPE_VAR_INT; }
 	VAR_Datafield( uint_fast32_t *var, uint8_t address, FIELD_TYPE type, const String &fieldLabel = "", const vector<String> &params = {}, uint8_t cols = MAX_DATA_LENGTH, uint8_t rows = 1, bool newLine = true, bool functional = false ) : DataField( address, type, fieldLabel, String(*var), params, cols, rows, newLine, functional )
 	{ variablePtr.uiVar = var; iVarType = OBJ_TYPE::TYPE_VAR_UINT; }
+	#endif
 	VAR_Datafield( uint8_t *var, uint8_t address, FIELD_TYPE type, const String &fieldLabel = "", const vector<String> &params = {}, uint8_t cols = MAX_DATA_LENGTH, uint8_t rows = 1, bool newLine = true, bool functional = false ) : DataField( address, type, fieldLabel, String(*var), params, cols, rows, newLine, functional )
 	{ variablePtr.uByteVar = var; iVarType = OBJ_TYPE::TYPE_VAR_UBYTE; }
 	VAR_Datafield( uint64_t *var, uint8_t address, FIELD_TYPE type, const String &fieldLabel = "", const vector<String> &params = {}, uint8_t cols = MAX_DATA_LENGTH, uint8_t rows = 1, bool newLine = true, bool functional = false ) : DataField( address, type, fieldLabel, intToStr(*var), params, cols, rows, newLine, functional )
@@ -63,6 +63,10 @@ void UICore::createAdminFields() //Should never be called more than once
 	//Remote control settings for external ESPLC devices
 	remotePLCTable->AddElement( make_shared<Select_Datafield>( &i_plc_netmode, index++, PSTR("PLC Net Modes"), vector<String>{ PSTR("Disabled"), PSTR("IO Expander"), PSTR("Cluster") } ) );
 	remotePLCTable->AddElement( make_shared<VAR_Datafield>( &i_plc_broadcast_port, index++, FIELD_TYPE::NUMBER, PSTR("Update Broadcast Port (Local)"), vector<String>{}, 5 ) );
+	remotePLCTable->AddElement( make_shared<VAR_Datafield>( &b_plc_dual_core, index++, FIELD_TYPE::CHECKBOX, PSTR("Process Independent Rungs On Both Cores (Applied On Next Script Load)") ) );
+	remotePLCTable->AddElement( make_shared<VAR_Datafield>( &i_plc_scan_budget, index++, FIELD_TYPE::NUMBER, PSTR("Scan Time Budget (us, 0 Disables The Watchdog)"), vector<String>{}, 5 ) );
+	remotePLCTable->AddElement( make_shared<VAR_Datafield>( &i_plc_scan_overruns, index++, FIELD_TYPE::NUMBER, PSTR("Overruns In A Row Before Action"), vector<String>{}, 3 ) );
+	remotePLCTable->AddElement( make_shared<Select_Datafield>( &i_plc_scan_policy, index++, PSTR("Scan Overrun Action"), vector<String>{ PSTR("Log"), PSTR("Skip Slowest Task"), PSTR("Hold Outputs Safe"), PSTR("Fault (Stop Logic)") } ) );
 
 	//Time table stuff
 	timeTable->AddElement( make_shared<VAR_Datafield>( &b_enableNIST, index++, FIELD_TYPE::CHECKBOX, PSTR("Enable NIST Time Updating (Requires internet connection)") ) );
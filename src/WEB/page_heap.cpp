@@ -0,0 +1,33 @@
+/*
+ * page_heap.cpp
+ *
+ * The purpose of this file is to send the heap use of each subsystem, and the sampled history of the device totals, as CSV (see HeapStats.h).
+ */
+#include <CORE/UICore.h>
+#include <CORE/HeapStats.h>
+
+void UICore::handleHeapStats()
+{
+	if (!handleAuthorization()) //make sure to have the uder log in first.
+		return;
+
+	String csv = PSTR("subsystem,allocs,frees,bytes,current,peak\n");
+	#if HEAP_ACCOUNTING
+	for ( uint8_t x = 0; x < HEAP_NUM_TAGS; x++ )
+	{
+		const Heap_Tag_Stats &stats = Heap_Monitor::getTagStats(x);
+		csv += String(Heap_Monitor::getTagName(x)) + ',' + String(stats.i_allocs.load()) + ',' + String(stats.i_frees.load()) + ',' + String(stats.i_bytes.load()) + ','
+			   + String(stats.i_current.load()) + ',' + String(stats.i_peak.load()) + '\n';
+	}
+	#endif
+
+	csv += PSTR("\nuptime,free,largest,min_free\n");
+	for ( uint8_t x = 0; x <= heapMonitor.getNumSamples(); x++ ) //oldest first, then the totals now
+	{
+		Heap_Sample sample = ( x < heapMonitor.getNumSamples() ) ? heapMonitor.getSample(x) : Heap_Monitor::takeSample();
+		csv += String(sample.i_time) + ',' + String(sample.i_free) + ',' + String(sample.i_largest) + ',' + String(sample.i_minFree) + '\n';
+	}
+
+	getWebServer().sendHeader(http_header_connection, http_header_close);
+	getWebServer().send(200, transmission_CSV, csv );
+}
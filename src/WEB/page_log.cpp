@@ -0,0 +1,90 @@
+/*
+ * page_log.cpp
+ *
+ * The purpose of this file is to stream the samples saved by a data logger object to the user, either decoded into CSV or as the raw (compressed) blocks.
+ * The data is sent a few blocks at a time on each pass of the main loop, so the whole log never has to fit in memory, and the logger's writer task is only
+ * held off for one pass at a time.
+ */
+#include <CORE/UICore.h>
+
+#include <PLC/PLC_Main.h>
+#include <PLC/OBJECTS/obj_logger.h>
+
+extern PLC_Main PLCObj;
+
+#define LOG_DOWNLOAD_BLOCKS 4 //blocks read from the log files on each pass of the main loop
+
+//A log download in progress. The request handler only sends the headers, the blocks follow a few at a time on each pass of the main loop.
+struct Log_Download
+{
+	weak_ptr<LoggerOBJ> logger; //the download ends if a new script replaces the logger
+	WiFiClient client; //kept open after the request has been handled, the end of the log is marked by closing it
+	Log_Read_Cursor cursor;
+	bool b_csv;
+};
+
+void UICore::handleLogDownload()
+{
+	if (!handleAuthorization()) //make sure to have the uder log in first.
+		return;
+
+	if ( p_logDownload ) //each download holds a connection open, so only one at a time
+	{
+		getWebServer().sendHeader(http_header_connection, http_header_close);
+		getWebServer().send(503, transmission_HTML, PSTR("A log download is already in progress.") );
+		return;
+	}
+
+	String id = getWebServer().arg(PSTR("id"));
+	id.toUpperCase(); //object names are stored in upper case by the parser
+	shared_ptr<Ladder_OBJ_Logical> obj = PLCObj.findLadderObjByID(id);
+	if ( !obj || obj->getType() != OBJ_TYPE::TYPE_LOGGER )
+	{
+		getWebServer().sendHeader(http_header_connection, http_header_close);
+		getWebServer().send(404, transmission_HTML, PSTR("Logger not found: ") + id );
+		return;
+	}
+
+	shared_ptr<LoggerOBJ> logger = static_pointer_cast<LoggerOBJ>(obj);
+	shared_ptr<Log_Download> download = make_shared<Log_Download>();
+	download->logger = logger;
+	download->b_csv = getWebServer().arg(PSTR("fmt")) != PSTR("bin");
+	download->client = getWebServer().client();
+	logger->beginRead(download->cursor);
+
+	//The response is written to the client directly, as the web server ends its own responses once the handler returns. There is no length, the connection is closed at the end.
+	String headers = PSTR("HTTP/1.1 200 OK\r\nContent-Type: ") + ( download->b_csv ? transmission_CSV : transmission_Binary )
+					 + PSTR("\r\nContent-Disposition: attachment; filename=") + id + ( download->b_csv ? PSTR(".csv") : PSTR(".bin") )
+					 + PSTR("\r\nConnection: close\r\n\r\n");
+	if ( download->b_csv )
+		headers += logger->getCSVHeader();
+	download->client.print(headers);
+	p_logDownload = download;
+}
+
+void UICore::continueLogDownload()
+{
+	if ( !p_logDownload )
+		return;
+
+	Log_Download &download = *p_logDownload;
+	shared_ptr<LoggerOBJ> logger = download.logger.lock();
+	bool more = logger && download.client.connected() && logger->readBlocks( download.cursor, LOG_DOWNLOAD_BLOCKS, [&download]( const uint8_t *block, uint16_t length )
+	{
+		if ( !download.b_csv )
+		{
+			download.client.write( block, length );
+			return;
+		}
+
+		String lines;
+		if ( LoggerOBJ::decodeBlock(block, length, lines) )
+			download.client.print(lines);
+	});
+
+	if ( !more ) //done, the client went away, or the logger was deleted
+	{
+		download.client.stop();
+		p_logDownload.reset();
+	}
+}
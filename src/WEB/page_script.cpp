@@ -13,6 +13,7 @@
 #include <CORE/UICore.h>
 
 #include <PLC/PLC_Main.h>
+#include <CORE/SlotStorage.h>
 
 extern PLC_Main PLCObj;
 extern UICore Core;
@@ -59,6 +60,13 @@ void UICore::handleScript() //Generate the HTML for our main page.
 		HTML += p_UIDataTables[x]->GenerateTableHTML(); //Add each datafield to the HTML body
 		
 	HTML += html_form_End;
+
+	//Scripts too large for the editor are uploaded, and parsed straight from flash. A checked script is only applied once it is committed.
+	HTML += generateScriptUploadForm( scriptUploadDir, PSTR("Upload Script File"), PSTR("Upload and Apply"), UINT8_MAX - 4 );
+	HTML += generateScriptUploadForm( scriptCheckDir, PSTR("Check Script File"), PSTR("Check Only"), UINT8_MAX - 2 );
+	DataTable commitTable;
+	commitTable.AddElement( make_shared<Hyperlink_Datafield>( UINT8_MAX, PSTR("Commit Checked Script"), scriptCommitDir ) );
+	HTML += commitTable.GenerateTableHTML();
 	HTML += generateFooter(); //Add the footer stuff.
 	getWebServer().sendHeader(http_header_connection, http_header_close);
 	getWebServer().send(200, transmission_HTML, HTML ); //And we're off.
@@ -77,4 +85,150 @@ void UICore::applyLogic()
 		}
 	}
 	Core.b_SaveScript = false; //Just a one off.
-}
\ No newline at end of file
+}
+
+String UICore::generateScriptUploadForm( const String &dir, const String &title, const String &button, uint8_t index )
+{
+	DataTable uploadTable( title );
+	uploadTable.AddElement( make_shared<FILE_Datafield>( vector<String>{PSTR("txt")}, false, index, PSTR("Script File") ) );
+	uploadTable.AddElement( make_shared<DataField>( index + 1, FIELD_TYPE::SUBMIT, button ) );
+	return html_form_Begin + dir + PSTR("\" method=\"post\" enctype=\"multipart/form-data\">") + uploadTable.GenerateTableHTML() + html_form_End;
+}
+
+shared_ptr<SlotStorage> UICore::receiveScriptUpload()
+{
+	HTTPUpload *fileUpload = &getWebServer().upload();
+
+	if (fileUpload->status == UPLOAD_FILE_START)
+	{
+		sendMessage(PSTR("Script Upload: ") + fileUpload->filename, PRIORITY_HIGH );
+		p_checkedScript.reset(); //its slot is about to be written
+		p_scriptUpload = make_shared<SlotStorage>(file_Script);
+		if ( !b_FSOpen || !p_scriptUpload->begin() ) //written to the unused slot, the saved script stays current until the new one has parsed
+		{
+			p_scriptUpload.reset();
+			sendMessage(PSTR("Failed to save the uploaded script."), PRIORITY_HIGH);
+		}
+	}
+	else if (fileUpload->status == UPLOAD_FILE_WRITE)
+	{
+		if ( p_scriptUpload && !p_scriptUpload->write(fileUpload->buf, fileUpload->currentSize) ) //straight to flash, the script is never held in RAM
+		{
+			p_scriptUpload.reset();
+			sendMessage(PSTR("Failed to save the uploaded script."), PRIORITY_HIGH);
+		}
+	}
+	else if (fileUpload->status == UPLOAD_FILE_END)
+	{
+		shared_ptr<SlotStorage> upload = p_scriptUpload;
+		p_scriptUpload.reset();
+		if ( !upload )
+			return 0;
+
+		if ( fileUpload->totalSize && upload->end() )
+			return upload;
+
+		sendMessage(PSTR("Failed to save the uploaded script."), PRIORITY_HIGH);
+	}
+	else if (fileUpload->status == UPLOAD_FILE_ABORTED)
+	{
+		p_scriptUpload.reset(); //the partly written slot is never made current
+		sendMessage(PSTR("Script upload aborted."), PRIORITY_HIGH);
+	}
+
+	return 0;
+}
+
+bool UICore::applyUploadedScript( shared_ptr<SlotStorage> upload )
+{
+	File scriptFile;
+	if ( upload->openWritten(scriptFile) == SLOT_NONE )
+	{
+		sendMessage(PSTR("Failed to save the uploaded script."), PRIORITY_HIGH);
+		return false;
+	}
+
+	bool parsed = PLCObj.parseScript(scriptFile);
+	scriptFile.close();
+	if ( parsed )
+	{
+		if ( upload->commit() )
+			sendMessage(PSTR("PLC Script saved."));
+		else
+			sendMessage(PSTR("PLC Script loaded, but it couldn't be saved. The previous script will be loaded on the next boot."), PRIORITY_HIGH);
+		loadPLCScript(PLCObj.getScript()); //the editor shows the new script (if it fits)
+	}
+	else if ( openPLCScript(scriptFile) ) //the failed parse cleared the logic, go back to the saved script
+	{
+		PLCObj.parseScript(scriptFile);
+		scriptFile.close();
+	}
+
+	return parsed;
+}
+
+void UICore::applyScriptUpload()
+{
+	shared_ptr<SlotStorage> upload = Core.receiveScriptUpload();
+	if ( upload ) //the whole script has been saved
+		Core.applyUploadedScript(upload);
+}
+
+void UICore::applyScriptCheck()
+{
+	shared_ptr<SlotStorage> upload = Core.receiveScriptUpload();
+	if ( !upload )
+		return;
+
+	File scriptFile;
+	if ( upload->openWritten(scriptFile) == SLOT_NONE )
+	{
+		Core.sendMessage(PSTR("Failed to save the uploaded script."), PRIORITY_HIGH);
+		return;
+	}
+
+	vector<Script_Diagnostic> errors;
+	Script_Check_Report report = PLC_Main::checkScript(scriptFile, errors);
+	scriptFile.close();
+
+	for ( uint8_t x = 0; x < errors.size(); x++ )
+	{
+		String location = PSTR("Line ") + String(errors[x].i_line);
+		if ( errors[x].i_column )
+			location += PSTR(", column ") + String(errors[x].i_column);
+		Core.sendMessage(location + PSTR(": ") + errors[x].s_message, PRIORITY_HIGH);
+	}
+	if ( report.i_numErrors > errors.size() )
+		Core.sendMessage(String(report.i_numErrors - errors.size()) + PSTR(" more errors not shown."), PRIORITY_HIGH);
+
+	Core.sendMessage(PSTR("Script check: ") + String(report.i_numErrors) + PSTR(" errors, ") + String(report.i_numObjects) + PSTR(" objects, ") + String(report.i_numVars) + PSTR(" variables, ")
+					 + String(report.i_numRungs) + PSTR(" rungs, ~") + String(report.i_heapUsed) + PSTR(" bytes RAM, ~") + String(report.i_scanEstimate) + PSTR(" uS scan."), PRIORITY_HIGH);
+
+	if ( !report.i_numErrors ) //kept in the unused slot until it is committed
+	{
+		Core.p_checkedScript = upload;
+		Core.sendMessage(PSTR("Script check passed, commit it to apply."), PRIORITY_HIGH);
+	}
+}
+
+void UICore::handleScriptCommit()
+{
+	if (!handleAuthorization())
+		return;
+
+	shared_ptr<SlotStorage> checked = p_checkedScript;
+	p_checkedScript.reset();
+	if ( checked )
+		applyUploadedScript(checked);
+	else
+		sendMessage(PSTR("No checked script to commit."), PRIORITY_HIGH);
+
+	handleScriptUpload(); //back to the script page
+}
+
+void UICore::handleScriptUpload()
+{
+	getWebServer().sendHeader(PSTR("Location"), scriptDir); //back to the script page, where the upload's messages are shown
+	getWebServer().sendHeader(http_header_connection, http_header_close);
+	getWebServer().send(303);
+}
@@ -0,0 +1,24 @@
+/*
+ * page_trace.cpp
+ *
+ * The purpose of this file is to send the event trace ring to the user as a binary file, for decoding into a timeline on the host (see Trace.h).
+ */
+#include <CORE/UICore.h>
+#include <CORE/Trace.h>
+
+void UICore::handleTraceDownload()
+{
+	if (!handleAuthorization()) //make sure to have the uder log in first.
+		return;
+
+	getWebServer().sendHeader(http_header_connection, http_header_close);
+	getWebServer().sendHeader(PSTR("Content-Disposition"), PSTR("attachment; filename=trace.bin") );
+	getWebServer().setContentLength(CONTENT_LENGTH_UNKNOWN); //sent in chunks
+	getWebServer().send(200, transmission_Binary, String() );
+
+	EventTrace.dump( [this]( const uint8_t *data, uint16_t length )
+	{
+		getWebServer().sendContent( reinterpret_cast<const char *>(data), length );
+	});
+	getWebServer().sendContent(""); //end of the chunked response
+}
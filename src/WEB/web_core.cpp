@@ -5,8 +5,8 @@ Description: The purpose of web_core.cpp is to serve as a common container for a
  not directly related to individual page functionality. 
 */
 
-#include "../Core/UICore.h"
-#include "../Core/GlobalDefs.h"
+#include "../CORE/UICore.h"
+#include "../CORE/GlobalDefs.h"
 #include <Update.h>
 
 const String &HTML_HEADER_INITIAL PROGMEM = PSTR(
@@ -36,8 +36,14 @@ void UICore::setupServer()
 	getWebServer().on(scriptDir, std::bind(&UICore::handleScript, this) );
 	getWebServer().on(statusDir, std::bind(&UICore::handleStatus, this) );
 	getWebServer().on(alertsDir, std::bind(&UICore::handleAlerts, this) );
+	getWebServer().on(logDir, std::bind(&UICore::handleLogDownload, this) );
+	getWebServer().on(traceDir, std::bind(&UICore::handleTraceDownload, this) );
+	getWebServer().on(heapDir, std::bind(&UICore::handleHeapStats, this) );
     getWebServer().on(firmwareDir, HTTP_GET, std::bind(&UICore::handleUpdater, this) );
     getWebServer().on(firmwareDir, HTTP_POST, [](){}, applyRemoteFirmwareUpdate ); //continuously call the firmware update function on HTTP POST method
+	getWebServer().on(scriptUploadDir, HTTP_POST, std::bind(&UICore::handleScriptUpload, this), applyScriptUpload ); //called for each piece of the uploaded script
+	getWebServer().on(scriptCheckDir, HTTP_POST, std::bind(&UICore::handleScriptUpload, this), applyScriptCheck );
+	getWebServer().on(scriptCommitDir, std::bind(&UICore::handleScriptCommit, this) );
 	//
 };
 
@@ -0,0 +1,114 @@
+/*
+ * Arduino.h
+ *
+ * Host stand-in for the parts of the Arduino-ESP32 core used by the PLC runtime, for the native build (see platformio.ini).
+ * Pins keep the last value written to them, and inputs read what a test set with nativeSetPin(). The clock only moves when a test moves it
+ * (nativeAdvanceTime), plus a configurable step on each read so loops that wait on it still finish.
+ */
+
+#ifndef NATIVE_ARDUINO_H_
+#define NATIVE_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+#include <algorithm>
+#include <functional>
+#include "WString.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "esp32-hal-gpio.h"
+
+typedef uint8_t byte;
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define IRAM_ATTR
+#define CPU_CLK_FREQ 80000000
+#define NATIVE_NUM_PINS 40
+
+using std::min;
+using std::max;
+
+class Print
+{
+	public:
+	virtual ~Print() {}
+	virtual size_t write( uint8_t ){ return 1; }
+	virtual size_t write( const uint8_t *, size_t size ){ return size; }
+	size_t print( const String &s ){ return s.length(); }
+	size_t print( const char *s ){ return strlen(s); }
+	template <class T> size_t print( const T &value ){ return String(value).length(); }
+	template <class T> size_t print( const T &value, int base ){ return String(value, base).length(); }
+	size_t println(){ return 0; }
+	template <class T> size_t println( const T &value ){ return print(value); }
+	template <class T> size_t println( const T &value, int base ){ return print(value, base); }
+	size_t printf( const char *, ... ){ return 0; }
+};
+
+class Stream : public Print
+{
+	public:
+	virtual int available(){ return 0; }
+	virtual int read(){ return -1; }
+	virtual int peek(){ return -1; }
+	virtual void flush(){}
+	void setTimeout( unsigned long ){}
+	String readString();
+	String readStringUntil( char terminator );
+};
+
+class HardwareSerial : public Stream
+{
+	public:
+	void begin( unsigned long ){}
+};
+extern HardwareSerial Serial;
+
+class EspClass
+{
+	public:
+	void restart(){}
+	uint32_t getFreeHeap();
+	uint32_t getMaxAllocHeap();
+	uint32_t getMinFreeHeap();
+};
+extern EspClass ESP;
+
+class IPAddress
+{
+	public:
+	IPAddress(){ address = 0; }
+	IPAddress( uint8_t a, uint8_t b, uint8_t c, uint8_t d ){ address = a | (b << 8) | (c << 16) | (static_cast<uint32_t>(d) << 24); }
+	IPAddress( uint32_t addr ){ address = addr; }
+	operator uint32_t() const { return address; }
+	uint8_t operator[]( int index ) const { return ( address >> ( index * 8 ) ) & 0xFF; }
+	bool operator==( const IPAddress &rhs ) const { return address == rhs.address; }
+	bool fromString( const String &str );
+	String toString() const;
+
+	private:
+	uint32_t address;
+};
+
+unsigned long millis();
+unsigned long micros();
+void delay( uint32_t ms );
+void delayMicroseconds( uint32_t us );
+void yield();
+uint32_t esp_get_free_heap_size();
+uint32_t esp_get_minimum_free_heap_size();
+
+//Test controls.
+void nativeSetTime( int64_t us );
+void nativeAdvanceTime( int64_t us );
+//Time (uS) added on every read of the clock, 0 to only move it by hand.
+void nativeSetTimeStep( int64_t us );
+void nativeSetPin( uint8_t pin, int level );
+int nativeGetPin( uint8_t pin );
+
+#endif /* NATIVE_ARDUINO_H_ */
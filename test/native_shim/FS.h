@@ -0,0 +1 @@
+#include "SPIFFS.h"
@@ -0,0 +1,42 @@
+/*
+ * NativeBench.h
+ *
+ * Benchmark runner for the native tests. Times a function over a number of runs with the host clock (the emulated micros() only moves when a
+ * test moves it), and counts the allocations it makes on the calling thread through the heap accounting (see CORE/HeapStats.h). Each result
+ * is printed as "BENCH <name>: <ns>/run, <allocs>/run" so CI can keep the history, and returned so the test can assert on it.
+ */
+
+#ifndef NATIVE_BENCH_H_
+#define NATIVE_BENCH_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+#include "CORE/HeapStats.h"
+
+struct Bench_Result
+{
+	double d_nsPerRun;
+	double d_allocsPerRun;
+	uint32_t i_allocs; //total over all runs
+};
+
+template <class F> Bench_Result nativeBenchmark( const char *name, uint32_t runs, F fn )
+{
+	fn(); //warm up, so buffers that are only created once aren't counted
+
+	uint32_t allocsBefore = Heap_Monitor::getThreadAllocs();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for ( uint32_t x = 0; x < runs; x++ )
+		fn();
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	Bench_Result result;
+	result.i_allocs = Heap_Monitor::getThreadAllocs() - allocsBefore;
+	result.d_nsPerRun = std::chrono::duration<double, std::nano>( end - start ).count() / ( runs ? runs : 1 );
+	result.d_allocsPerRun = static_cast<double>(result.i_allocs) / ( runs ? runs : 1 );
+	printf( "BENCH %s: %.1f ns/run, %.3f allocs/run\n", name, result.d_nsPerRun, result.d_allocsPerRun );
+	return result;
+}
+
+#endif /* NATIVE_BENCH_H_ */
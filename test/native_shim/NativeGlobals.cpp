@@ -0,0 +1,43 @@
+/*
+ * NativeGlobals.cpp
+ *
+ * See NativeGlobals.h.
+ */
+
+#include "NativeGlobals.h"
+#include "CORE/UICore.h"
+#include "CORE/Trace.h"
+#include "PLC/PLC_Main.h"
+#include <SPIFFS.h>
+#include <stdio.h>
+
+//Defined before the globals, as they may send messages while they are destroyed.
+static uint32_t i_messageCount = 0;
+static String s_lastMessage;
+static bool b_echoMessages = false;
+
+Trace_Buffer EventTrace; //declared before the other objects, as they may record events
+PLC_Main PLCObj;
+UICore Core;
+
+uint32_t nativeMessageCount(){ return i_messageCount; }
+const String &nativeLastMessage(){ return s_lastMessage; }
+void nativeEchoMessages( bool echo ){ b_echoMessages = echo; }
+
+void UICore::sendMessage( const String &str, uint8_t )
+{
+	i_messageCount++;
+	s_lastMessage = str;
+	if ( b_echoMessages )
+		printf( "%s\n", str.c_str() );
+}
+
+//There is no web UI or WiFi to set up here, only the file system (the in-memory SPIFFS), so the retentive values can be written.
+void UICore::setup()
+{
+	b_FSOpen = SPIFFS.begin(true);
+}
+
+void UICore::closeConnection( bool )
+{
+}
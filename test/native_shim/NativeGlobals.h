@@ -0,0 +1,21 @@
+/*
+ * NativeGlobals.h
+ *
+ * The objects that OpenPLC.cpp creates on the device (EventTrace, PLCObj, Core), created the same way for the native build. Messages sent through
+ * Core.sendMessage() are kept instead of going to the serial port and the alert history, so a test can check them. Core.setup() only opens the
+ * file system, which is closed until a test calls it.
+ */
+
+#ifndef NATIVE_GLOBALS_H_
+#define NATIVE_GLOBALS_H_
+
+#include "WString.h"
+#include <stdint.h>
+
+//Number of messages sent since the test started.
+uint32_t nativeMessageCount();
+const String &nativeLastMessage();
+//Prints each message to stdout as it's sent.
+void nativeEchoMessages( bool echo );
+
+#endif /* NATIVE_GLOBALS_H_ */
@@ -0,0 +1,543 @@
+/*
+ * NativeShim.cpp
+ *
+ * Host implementations of the Arduino and ESP-IDF functions declared in this directory, for the native build.
+ */
+
+#include "Arduino.h"
+#include "WiFi.h"
+#include "WiFiUdp.h"
+#include "SPIFFS.h"
+#include "stdlib_noniso.h"
+#include "rom/crc.h"
+#include "lwip/dns.h"
+#include "driver/gpio.h"
+#include "driver/pcnt.h"
+#include "soc/pcnt_struct.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+SPIFFSFS SPIFFS;
+pcnt_dev_t PCNT;
+
+//Clock
+
+static std::atomic<int64_t> i_nativeTime( 0 );
+static std::atomic<int64_t> i_nativeTimeStep( 1 );
+
+void nativeSetTime( int64_t us ){ i_nativeTime = us; }
+void nativeAdvanceTime( int64_t us ){ i_nativeTime += us; }
+void nativeSetTimeStep( int64_t us ){ i_nativeTimeStep = us; }
+
+int64_t esp_timer_get_time()
+{
+	return i_nativeTime.fetch_add( i_nativeTimeStep ) + i_nativeTimeStep;
+}
+
+unsigned long millis(){ return esp_timer_get_time() / 1000; }
+unsigned long micros(){ return esp_timer_get_time(); }
+void delay( uint32_t ms ){ nativeAdvanceTime( ms * 1000LL ); }
+void delayMicroseconds( uint32_t us ){ nativeAdvanceTime(us); }
+void yield(){}
+
+//Pins
+
+static int nativePins[NATIVE_NUM_PINS];
+static gpio_isr_t nativePinHandlers[NATIVE_NUM_PINS];
+static void *nativePinArgs[NATIVE_NUM_PINS];
+static int16_t nativePulseCounts[PCNT_UNIT_MAX];
+
+void nativeSetPin( uint8_t pin, int level )
+{
+	if ( pin >= NATIVE_NUM_PINS )
+		return;
+	bool changed = nativePins[pin] != level;
+	nativePins[pin] = level;
+	if ( changed && nativePinHandlers[pin] )
+		nativePinHandlers[pin]( nativePinArgs[pin] );
+}
+
+int nativeGetPin( uint8_t pin ){ return pin < NATIVE_NUM_PINS ? nativePins[pin] : 0; }
+
+void pinMode( uint8_t, uint8_t ){}
+void digitalWrite( uint8_t pin, uint8_t val ){ if ( pin < NATIVE_NUM_PINS ) nativePins[pin] = val; }
+int digitalRead( uint8_t pin ){ return nativeGetPin(pin) ? HIGH : LOW; }
+uint16_t analogRead( uint8_t pin ){ return nativeGetPin(pin); }
+double ledcSetup( uint8_t, double freq, uint8_t ){ return freq; }
+void ledcWrite( uint8_t, uint32_t ){}
+void ledcAttachPin( uint8_t, uint8_t ){}
+void ledcDetachPin( uint8_t ){}
+
+esp_err_t gpio_config( const gpio_config_t * ){ return ESP_OK; }
+int gpio_get_level( gpio_num_t gpio_num ){ return digitalRead(gpio_num); }
+esp_err_t gpio_install_isr_service( int ){ return ESP_OK; }
+
+esp_err_t gpio_isr_handler_add( gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args )
+{
+	if ( gpio_num < 0 || gpio_num >= NATIVE_NUM_PINS )
+		return ESP_FAIL;
+	nativePinHandlers[gpio_num] = isr_handler;
+	nativePinArgs[gpio_num] = args;
+	return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove( gpio_num_t gpio_num )
+{
+	return gpio_isr_handler_add( gpio_num, 0, 0 );
+}
+
+void nativeSetPulseCount( pcnt_unit_t unit, int16_t count ){ if ( unit < PCNT_UNIT_MAX ) nativePulseCounts[unit] = count; }
+
+esp_err_t pcnt_unit_config( const pcnt_config_t * ){ return ESP_OK; }
+esp_err_t pcnt_get_counter_value( pcnt_unit_t unit, int16_t *count ){ *count = unit < PCNT_UNIT_MAX ? nativePulseCounts[unit] : 0; return ESP_OK; }
+esp_err_t pcnt_counter_pause( pcnt_unit_t ){ return ESP_OK; }
+esp_err_t pcnt_counter_resume( pcnt_unit_t ){ return ESP_OK; }
+esp_err_t pcnt_counter_clear( pcnt_unit_t unit ){ nativeSetPulseCount( unit, 0 ); return ESP_OK; }
+esp_err_t pcnt_set_filter_value( pcnt_unit_t, uint16_t ){ return ESP_OK; }
+esp_err_t pcnt_filter_enable( pcnt_unit_t ){ return ESP_OK; }
+esp_err_t pcnt_filter_disable( pcnt_unit_t ){ return ESP_OK; }
+esp_err_t pcnt_event_enable( pcnt_unit_t, pcnt_evt_type_t ){ return ESP_OK; }
+esp_err_t pcnt_event_disable( pcnt_unit_t, pcnt_evt_type_t ){ return ESP_OK; }
+esp_err_t pcnt_isr_service_install( int ){ return ESP_OK; }
+esp_err_t pcnt_isr_handler_add( pcnt_unit_t, void (*)( void * ), void * ){ return ESP_OK; }
+esp_err_t pcnt_isr_handler_remove( pcnt_unit_t ){ return ESP_OK; }
+
+//System
+
+uint32_t EspClass::getFreeHeap(){ return 1 << 20; }
+uint32_t EspClass::getMaxAllocHeap(){ return 1 << 19; }
+uint32_t EspClass::getMinFreeHeap(){ return 1 << 20; }
+uint32_t esp_get_free_heap_size(){ return ESP.getFreeHeap(); }
+uint32_t esp_get_minimum_free_heap_size(){ return ESP.getMinFreeHeap(); }
+
+char *dtostrf( double number, signed char width, unsigned char prec, char *s )
+{
+	sprintf( s, "%*.*f", width, prec, number );
+	return s;
+}
+
+uint32_t crc32_le( uint32_t crc, const uint8_t *buf, uint32_t len )
+{
+	crc = ~crc;
+	while ( len-- )
+	{
+		crc ^= *buf++;
+		for ( uint8_t bit = 0; bit < 8; bit++ )
+			crc = ( crc >> 1 ) ^ ( 0xEDB88320 & -( crc & 1 ) );
+	}
+	return ~crc;
+}
+
+bool IPAddress::fromString( const String &str )
+{
+	unsigned int a, b, c, d;
+	if ( sscanf( str.c_str(), "%u.%u.%u.%u", &a, &b, &c, &d ) != 4 || a > 255 || b > 255 || c > 255 || d > 255 )
+		return false;
+	*this = IPAddress( a, b, c, d );
+	return true;
+}
+
+String IPAddress::toString() const
+{
+	char buf[16];
+	snprintf( buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3] );
+	return String(buf);
+}
+
+//FreeRTOS
+
+struct Native_Task
+{
+	std::mutex mutex;
+	std::condition_variable signal;
+	uint32_t i_notifications;
+	BaseType_t i_core;
+};
+
+struct Native_Semaphore
+{
+	std::mutex mutex;
+	std::condition_variable signal;
+	uint32_t i_count;
+};
+
+static thread_local Native_Task *p_currentTask = 0;
+static std::recursive_mutex criticalMutex;
+static bool b_failTaskCreation = false;
+
+void nativeFailTaskCreation( bool fail ){ b_failTaskCreation = fail; }
+
+void portENTER_CRITICAL( portMUX_TYPE * ){ criticalMutex.lock(); }
+void portEXIT_CRITICAL( portMUX_TYPE * ){ criticalMutex.unlock(); }
+void portENTER_CRITICAL_ISR( portMUX_TYPE * ){ criticalMutex.lock(); }
+void portEXIT_CRITICAL_ISR( portMUX_TYPE * ){ criticalMutex.unlock(); }
+BaseType_t xPortGetCoreID(){ return p_currentTask ? p_currentTask->i_core : 1; }
+
+BaseType_t xTaskCreatePinnedToCore( TaskFunction_t pvTaskCode, const char *, uint32_t, void *pvParameters, UBaseType_t, TaskHandle_t *pvCreatedTask, BaseType_t xCoreID )
+{
+	if ( b_failTaskCreation )
+		return pdFAIL;
+
+	Native_Task *task = new Native_Task; //lives as long as the process, a task may still be notified after it has returned
+	task->i_notifications = 0;
+	task->i_core = xCoreID;
+	if ( pvCreatedTask )
+		*pvCreatedTask = task;
+	std::thread( [task, pvTaskCode, pvParameters]{ p_currentTask = task; pvTaskCode(pvParameters); } ).detach();
+	return pdPASS;
+}
+
+void vTaskDelete( TaskHandle_t xTaskToDelete )
+{
+	if ( !xTaskToDelete || xTaskToDelete == p_currentTask )
+	{
+		for (;;)
+			std::this_thread::sleep_for( std::chrono::hours(1) );
+	}
+}
+
+void vTaskDelay( TickType_t xTicksToDelay ){ std::this_thread::sleep_for( std::chrono::milliseconds(xTicksToDelay) ); }
+void vTaskDelayUntil( TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement ){ *pxPreviousWakeTime += xTimeIncrement; vTaskDelay(xTimeIncrement); }
+TickType_t xTaskGetTickCount(){ return millis(); }
+
+uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait )
+{
+	Native_Task *task = p_currentTask;
+	if ( !task )
+		return 0;
+
+	std::unique_lock<std::mutex> lock(task->mutex);
+	if ( xTicksToWait == portMAX_DELAY )
+		task->signal.wait( lock, [task]{ return task->i_notifications > 0; } );
+	else
+		task->signal.wait_for( lock, std::chrono::milliseconds(xTicksToWait), [task]{ return task->i_notifications > 0; } );
+
+	uint32_t count = task->i_notifications;
+	task->i_notifications = ( xClearCountOnExit || !count ) ? 0 : count - 1;
+	return count;
+}
+
+BaseType_t xTaskNotifyGive( TaskHandle_t xTaskToNotify )
+{
+	Native_Task *task = static_cast<Native_Task *>(xTaskToNotify);
+	if ( !task )
+		return pdFAIL;
+	{
+		std::lock_guard<std::mutex> lock(task->mutex);
+		task->i_notifications++;
+	}
+	task->signal.notify_one();
+	return pdPASS;
+}
+
+static SemaphoreHandle_t createSemaphore( uint32_t count )
+{
+	Native_Semaphore *semaphore = new Native_Semaphore;
+	semaphore->i_count = count;
+	return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(){ return createSemaphore(0); }
+SemaphoreHandle_t xSemaphoreCreateMutex(){ return createSemaphore(1); }
+
+BaseType_t xSemaphoreTake( SemaphoreHandle_t xSemaphore, TickType_t xBlockTime )
+{
+	Native_Semaphore *semaphore = static_cast<Native_Semaphore *>(xSemaphore);
+	std::unique_lock<std::mutex> lock(semaphore->mutex);
+	if ( xBlockTime == portMAX_DELAY )
+		semaphore->signal.wait( lock, [semaphore]{ return semaphore->i_count > 0; } );
+	else if ( !semaphore->signal.wait_for( lock, std::chrono::milliseconds(xBlockTime), [semaphore]{ return semaphore->i_count > 0; } ) )
+		return pdFALSE;
+
+	semaphore->i_count--;
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive( SemaphoreHandle_t xSemaphore )
+{
+	Native_Semaphore *semaphore = static_cast<Native_Semaphore *>(xSemaphore);
+	{
+		std::lock_guard<std::mutex> lock(semaphore->mutex);
+		if ( semaphore->i_count )
+			return pdFALSE;
+		semaphore->i_count = 1;
+	}
+	semaphore->signal.notify_one();
+	return pdTRUE;
+}
+
+void vSemaphoreDelete( SemaphoreHandle_t xSemaphore )
+{
+	delete static_cast<Native_Semaphore *>(xSemaphore);
+}
+
+//Network
+
+struct Native_Remote_Host
+{
+	uint16_t i_port;
+	Native_Host handler;
+};
+
+#define NATIVE_MAX_HOSTS 4
+
+static Native_Remote_Host nativeHosts[NATIVE_MAX_HOSTS];
+static String s_nativeRequest, s_nativeReply; //kept between connections
+static unsigned int i_nativeReplyPos = 0;
+static bool b_wifiConnected = false;
+
+void nativeSetWiFiConnected( bool connected ){ b_wifiConnected = connected; }
+bool WiFiClass::isConnected(){ return b_wifiConnected; }
+
+void nativeSetRemoteHost( uint16_t port, Native_Host host )
+{
+	for ( uint8_t x = 0; x < NATIVE_MAX_HOSTS; x++ )
+	{
+		if ( nativeHosts[x].i_port == port || ( host && !nativeHosts[x].handler ) )
+		{
+			nativeHosts[x].i_port = host ? port : 0;
+			nativeHosts[x].handler = host;
+			return;
+		}
+	}
+}
+
+static Native_Host findHost( uint16_t port )
+{
+	for ( uint8_t x = 0; x < NATIVE_MAX_HOSTS; x++ )
+	{
+		if ( nativeHosts[x].handler && nativeHosts[x].i_port == port )
+			return nativeHosts[x].handler;
+	}
+	return 0;
+}
+
+int WiFiClient::connect( IPAddress ip, uint16_t port )
+{
+	stop();
+	if ( !b_wifiConnected || !findHost(port) )
+		return 0;
+	b_connected = true;
+	i_port = port;
+	ip_remote = ip;
+	s_nativeRequest = "";
+	s_nativeReply = "";
+	i_nativeReplyPos = 0;
+	return 1;
+}
+
+void WiFiClient::stop()
+{
+	b_connected = false;
+}
+
+size_t WiFiClient::write( const uint8_t *buf, size_t size )
+{
+	if ( !b_connected )
+		return 0;
+	s_nativeRequest.concat( reinterpret_cast<const char *>(buf), size );
+	return size;
+}
+
+void WiFiClient::flush()
+{
+	Native_Host host = b_connected ? findHost(i_port) : 0;
+	if ( !host || !s_nativeRequest.length() )
+		return;
+	host( s_nativeRequest, s_nativeReply );
+	s_nativeRequest = "";
+	i_nativeReplyPos = 0;
+}
+
+int WiFiClient::available()
+{
+	return b_connected ? s_nativeReply.length() - i_nativeReplyPos : 0;
+}
+
+int WiFiClient::read()
+{
+	if ( !available() )
+		return -1;
+	return static_cast<uint8_t>( s_nativeReply[i_nativeReplyPos++] );
+}
+
+String Stream::readStringUntil( char terminator )
+{
+	String str;
+	int c;
+	while ( ( c = read() ) >= 0 && c != terminator )
+		str += static_cast<char>(c);
+	return str;
+}
+
+String Stream::readString()
+{
+	String str;
+	int c;
+	while ( ( c = read() ) >= 0 )
+		str += static_cast<char>(c);
+	return str;
+}
+
+err_t dns_gethostbyname( const char *, ip_addr_t *, dns_found_callback, void * ){ return ERR_ARG; }
+
+struct Native_UDP_Reply
+{
+	int64_t i_arrival;
+	std::vector<uint8_t> data;
+};
+
+static uint16_t i_nativeUDPPort = 0;
+static Native_UDP_Host nativeUDPHost = 0;
+static std::vector<Native_UDP_Reply> nativeUDPReplies; //in flight, in order of arrival
+
+void nativeSetUDPHost( uint16_t port, Native_UDP_Host host )
+{
+	i_nativeUDPPort = host ? port : 0;
+	nativeUDPHost = host;
+	nativeUDPReplies.clear();
+}
+
+int WiFiUDP::endPacket()
+{
+	Native_UDP_Reply reply;
+	reply.i_arrival = esp_timer_get_time();
+	if ( b_wifiConnected && nativeUDPHost && i_port == i_nativeUDPPort && nativeUDPHost( packet.data(), packet.size(), reply.data, reply.i_arrival ) )
+	{
+		std::vector<Native_UDP_Reply>::iterator it = nativeUDPReplies.begin();
+		while ( it != nativeUDPReplies.end() && it->i_arrival <= reply.i_arrival )
+			it++;
+		nativeUDPReplies.insert( it, reply );
+	}
+	packet.clear();
+	return 1;
+}
+
+int WiFiUDP::parsePacket()
+{
+	received.clear();
+	i_readPos = 0;
+	if ( !nativeUDPReplies.size() || nativeUDPReplies[0].i_arrival > esp_timer_get_time() )
+		return 0;
+
+	received.swap( nativeUDPReplies[0].data );
+	nativeUDPReplies.erase( nativeUDPReplies.begin() );
+	return received.size();
+}
+
+int WiFiUDP::read( uint8_t *buf, size_t size )
+{
+	size_t length = min( size, received.size() - i_readPos );
+	memcpy( buf, received.data() + i_readPos, length );
+	i_readPos += length;
+	return length;
+}
+
+int WiFiUDP::read()
+{
+	return available() ? received[i_readPos++] : -1;
+}
+
+//File system
+
+std::vector<uint8_t> &File::data() const
+{
+	return SPIFFS.files[s_name];
+}
+
+size_t File::write( const uint8_t *buf, size_t size )
+{
+	if ( !b_open || SPIFFS.b_failWrites )
+		return 0;
+	std::vector<uint8_t> &bytes = data();
+	if ( i_pos + size > bytes.size() )
+		bytes.resize( i_pos + size );
+	memcpy( bytes.data() + i_pos, buf, size );
+	i_pos += size;
+	SPIFFS.i_bytesWritten += size;
+	return size;
+}
+
+size_t File::read( uint8_t *buf, size_t size )
+{
+	if ( !b_open )
+		return 0;
+	std::vector<uint8_t> &bytes = data();
+	size_t count = i_pos >= bytes.size() ? 0 : std::min( size, bytes.size() - i_pos );
+	memcpy( buf, bytes.data() + i_pos, count );
+	i_pos += count;
+	return count;
+}
+
+int File::read()
+{
+	uint8_t c;
+	return read( &c, 1 ) == 1 ? c : -1;
+}
+
+int File::available()
+{
+	return b_open && i_pos < size() ? size() - i_pos : 0;
+}
+
+int File::peek()
+{
+	return available() ? data()[i_pos] : -1;
+}
+
+bool File::seek( uint32_t pos )
+{
+	if ( !b_open || pos > size() )
+		return false;
+	i_pos = pos;
+	return true;
+}
+
+size_t File::size() const
+{
+	return b_open ? data().size() : 0;
+}
+
+File SPIFFSFS::open( const String &path, const char *mode )
+{
+	File file;
+	file.s_name = path.c_str();
+	if ( mode[0] == 'r' )
+	{
+		if ( !exists(path) )
+			return file;
+	}
+	else if ( mode[0] == 'w' )
+		files[file.s_name].clear();
+	else
+		file.i_pos = files[file.s_name].size();
+
+	file.b_open = true;
+	return file;
+}
+
+bool SPIFFSFS::rename( const String &from, const String &to )
+{
+	if ( !exists(from) )
+		return false;
+	files[to.c_str()].swap( files[from.c_str()] );
+	files.erase( from.c_str() );
+	return true;
+}
+
+size_t SPIFFSFS::usedBytes()
+{
+	size_t used = 0;
+	for ( std::map<std::string, std::vector<uint8_t>>::iterator it = files.begin(); it != files.end(); ++it )
+		used += it->second.size();
+	return used;
+}
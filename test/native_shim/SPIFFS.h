@@ -0,0 +1,69 @@
+/*
+ * SPIFFS.h
+ *
+ * Host stand-in for the SPIFFS file system: the files are kept in memory for the life of the test. The bytes written are counted, and writes
+ * can be made to fail, so the tests can check how much the flash is worn and how failures are handled.
+ */
+
+#ifndef NATIVE_SPIFFS_H_
+#define NATIVE_SPIFFS_H_
+
+#include "Arduino.h"
+#include <map>
+#include <string>
+#include <vector>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+class File : public Stream
+{
+	public:
+	File(){ b_open = false; i_pos = 0; }
+
+	operator bool() const { return b_open; }
+	size_t write( uint8_t c ){ return write( &c, 1 ); }
+	size_t write( const uint8_t *buf, size_t size );
+	size_t read( uint8_t *buf, size_t size );
+	int read();
+	int available();
+	int peek();
+	bool seek( uint32_t pos );
+	size_t position() const { return i_pos; }
+	size_t size() const;
+	void close(){ b_open = false; }
+	const char *name() const { return s_name.c_str(); }
+
+	private:
+	friend class SPIFFSFS;
+	std::vector<uint8_t> &data() const;
+
+	std::string s_name;
+	size_t i_pos;
+	bool b_open;
+};
+
+class SPIFFSFS
+{
+	public:
+	SPIFFSFS(){ i_bytesWritten = 0; b_failWrites = false; }
+
+	bool begin( bool = false ){ return true; }
+	void end(){}
+	bool format(){ files.clear(); return true; }
+	//Modes: "r" and "r+" need an existing file, and start at its beginning. "w" empties the file. "a" writes at the end.
+	File open( const String &path, const char *mode = FILE_READ );
+	bool exists( const String &path ){ return files.count( path.c_str() ); }
+	bool remove( const String &path ){ return files.erase( path.c_str() ); }
+	bool rename( const String &from, const String &to );
+	size_t totalBytes(){ return 1 << 20; }
+	size_t usedBytes();
+
+	std::map<std::string, std::vector<uint8_t>> files;
+	uint64_t i_bytesWritten;
+	bool b_failWrites; //every write returns 0
+};
+extern SPIFFSFS SPIFFS;
+
+#endif /* NATIVE_SPIFFS_H_ */
@@ -0,0 +1,420 @@
+/*
+ * WString.cpp
+ *
+ * Host version of the Arduino String, see WString.h.
+ */
+
+#include "WString.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <ctype.h>
+
+static void formatUnsigned( char *buf, unsigned long long value, unsigned char base )
+{
+	char digits[66];
+	uint8_t count = 0;
+	if ( base < 2 )
+		base = 10;
+	do
+	{
+		uint8_t digit = value % base;
+		digits[count++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+		value /= base;
+	} while ( value );
+
+	while ( count )
+		*buf++ = digits[--count];
+	*buf = 0;
+}
+
+static void formatSigned( char *buf, long long value, unsigned char base )
+{
+	if ( value < 0 && base == 10 )
+	{
+		*buf++ = '-';
+		formatUnsigned( buf, -static_cast<unsigned long long>(value), base );
+	}
+	else
+		formatUnsigned( buf, static_cast<unsigned long long>(value), base );
+}
+
+static void formatFloat( char *buf, double value, unsigned char decimals )
+{
+	snprintf( buf, 33, "%.*f", decimals, value );
+}
+
+String::String( const char *cstr )
+{
+	init();
+	if ( cstr )
+		copy( cstr, strlen(cstr) );
+}
+
+String::String( const char *cstr, unsigned int length )
+{
+	init();
+	if ( cstr )
+		copy( cstr, length );
+}
+
+String::String( const String &value )
+{
+	init();
+	*this = value;
+}
+
+String::String( String &&rval )
+{
+	init();
+	move(rval);
+}
+
+String::String( char c )
+{
+	init();
+	char buf[2] = { c, 0 };
+	*this = buf;
+}
+
+String::String( unsigned char value, unsigned char base ){ init(); char buf[66]; formatUnsigned( buf, value, base ); *this = buf; }
+String::String( int value, unsigned char base ){ init(); char buf[66]; formatSigned( buf, value, base ); *this = buf; }
+String::String( unsigned int value, unsigned char base ){ init(); char buf[66]; formatUnsigned( buf, value, base ); *this = buf; }
+String::String( long value, unsigned char base ){ init(); char buf[66]; formatSigned( buf, value, base ); *this = buf; }
+String::String( unsigned long value, unsigned char base ){ init(); char buf[66]; formatUnsigned( buf, value, base ); *this = buf; }
+String::String( long long value, unsigned char base ){ init(); char buf[66]; formatSigned( buf, value, base ); *this = buf; }
+String::String( unsigned long long value, unsigned char base ){ init(); char buf[66]; formatUnsigned( buf, value, base ); *this = buf; }
+String::String( float value, unsigned char decimals ){ init(); char buf[33]; formatFloat( buf, value, decimals ); *this = buf; }
+String::String( double value, unsigned char decimals ){ init(); char buf[33]; formatFloat( buf, value, decimals ); *this = buf; }
+
+String::~String()
+{
+	free(buffer);
+}
+
+void String::invalidate()
+{
+	free(buffer);
+	init();
+}
+
+bool String::reserve( unsigned int size )
+{
+	if ( buffer && capacity >= size )
+		return true;
+	if ( changeBuffer(size) )
+	{
+		if ( !len )
+			buffer[0] = 0;
+		return true;
+	}
+	return false;
+}
+
+bool String::changeBuffer( unsigned int maxStrLen )
+{
+	char *newBuffer = static_cast<char *>( realloc( buffer, maxStrLen + 1 ) );
+	if ( !newBuffer )
+		return false;
+	buffer = newBuffer;
+	capacity = maxStrLen;
+	return true;
+}
+
+String &String::copy( const char *cstr, unsigned int length )
+{
+	if ( !reserve(length) )
+	{
+		invalidate();
+		return *this;
+	}
+	len = length;
+	memmove( buffer, cstr, length );
+	buffer[len] = 0;
+	return *this;
+}
+
+void String::move( String &rhs )
+{
+	if ( this == &rhs )
+		return;
+	free(buffer);
+	buffer = rhs.buffer;
+	capacity = rhs.capacity;
+	len = rhs.len;
+	rhs.init();
+}
+
+String &String::operator=( const String &rhs )
+{
+	if ( this == &rhs )
+		return *this;
+	if ( rhs.buffer )
+		copy( rhs.buffer, rhs.len );
+	else
+		invalidate();
+	return *this;
+}
+
+String &String::operator=( const char *cstr )
+{
+	if ( cstr )
+		copy( cstr, strlen(cstr) );
+	else
+		invalidate();
+	return *this;
+}
+
+String &String::operator=( String &&rval )
+{
+	move(rval);
+	return *this;
+}
+
+String &String::operator=( StringSumHelper &&rval )
+{
+	move(rval);
+	return *this;
+}
+
+bool String::concat( const char *cstr, unsigned int length )
+{
+	if ( !cstr )
+		return false;
+	if ( !length )
+		return true;
+	unsigned int newlen = len + length;
+	if ( cstr >= buffer && cstr < buffer + len ) //appending a part of itself, which moves with the buffer
+	{
+		unsigned int offset = cstr - buffer;
+		if ( !reserve(newlen) )
+			return false;
+		memmove( buffer + len, buffer + offset, length );
+	}
+	else
+	{
+		if ( !reserve(newlen) )
+			return false;
+		memcpy( buffer + len, cstr, length );
+	}
+	len = newlen;
+	buffer[len] = 0;
+	return true;
+}
+
+bool String::concat( const char *cstr ){ return cstr ? concat( cstr, strlen(cstr) ) : false; }
+bool String::concat( unsigned char num ){ char buf[66]; formatUnsigned( buf, num, 10 ); return concat(buf); }
+bool String::concat( int num ){ char buf[66]; formatSigned( buf, num, 10 ); return concat(buf); }
+bool String::concat( unsigned int num ){ char buf[66]; formatUnsigned( buf, num, 10 ); return concat(buf); }
+bool String::concat( long num ){ char buf[66]; formatSigned( buf, num, 10 ); return concat(buf); }
+bool String::concat( unsigned long num ){ char buf[66]; formatUnsigned( buf, num, 10 ); return concat(buf); }
+bool String::concat( long long num ){ char buf[66]; formatSigned( buf, num, 10 ); return concat(buf); }
+bool String::concat( unsigned long long num ){ char buf[66]; formatUnsigned( buf, num, 10 ); return concat(buf); }
+bool String::concat( float num ){ char buf[33]; formatFloat( buf, num, 2 ); return concat(buf); }
+bool String::concat( double num ){ char buf[33]; formatFloat( buf, num, 2 ); return concat(buf); }
+
+StringSumHelper &operator+( const StringSumHelper &lhs, const String &rhs ){ StringSumHelper &a = const_cast<StringSumHelper &>(lhs); a.concat(rhs); return a; }
+StringSumHelper &operator+( const StringSumHelper &lhs, const char *cstr ){ StringSumHelper &a = const_cast<StringSumHelper &>(lhs); a.concat(cstr); return a; }
+StringSumHelper &operator+( const StringSumHelper &lhs, char c ){ StringSumHelper &a = const_cast<StringSumHelper &>(lhs); a.concat(c); return a; }
+StringSumHelper &operator+( const StringSumHelper &lhs, unsigned char num ){ StringSumHelper &a = const_cast<StringSumHelper &>(lhs); a.concat(num); return a; }
+StringSumHelper &operator+( const StringSumHelper &lhs, int num ){ StringSumHelper &a = const_cast<StringSumHelper &>(lhs); a.concat(num); return a; }
+StringSumHelper &operator+( const StringSumHelper &lhs, unsigned int num ){ StringSumHelper &a = const_cast<StringSumHelper &>(lhs); a.concat(num); return a; }
+StringSumHelper &operator+( const StringSumHelper &lhs, long num ){ StringSumHelper &a = const_cast<StringSumHelper &>(lhs); a.concat(num); return a; }
+StringSumHelper &operator+( const StringSumHelper &lhs, unsigned long num ){ StringSumHelper &a = const_cast<StringSumHelper &>(lhs); a.concat(num); return a; }
+StringSumHelper &operator+( const StringSumHelper &lhs, long long num ){ StringSumHelper &a = const_cast<StringSumHelper &>(lhs); a.concat(num); return a; }
+StringSumHelper &operator+( const StringSumHelper &lhs, unsigned long long num ){ StringSumHelper &a = const_cast<StringSumHelper &>(lhs); a.concat(num); return a; }
+StringSumHelper &operator+( const StringSumHelper &lhs, float num ){ StringSumHelper &a = const_cast<StringSumHelper &>(lhs); a.concat(num); return a; }
+StringSumHelper &operator+( const StringSumHelper &lhs, double num ){ StringSumHelper &a = const_cast<StringSumHelper &>(lhs); a.concat(num); return a; }
+
+int String::compareTo( const String &s ) const
+{
+	return strcmp( c_str(), s.c_str() );
+}
+
+bool String::equalsIgnoreCase( const String &s ) const
+{
+	if ( len != s.len )
+		return false;
+	for ( unsigned int x = 0; x < len; x++ )
+	{
+		if ( tolower(buffer[x]) != tolower(s.buffer[x]) )
+			return false;
+	}
+	return true;
+}
+
+bool String::startsWith( const String &prefix, unsigned int offset ) const
+{
+	if ( offset > len || prefix.len > len - offset )
+		return false;
+	return !strncmp( c_str() + offset, prefix.c_str(), prefix.len );
+}
+
+bool String::endsWith( const String &suffix ) const
+{
+	if ( suffix.len > len )
+		return false;
+	return !strcmp( c_str() + len - suffix.len, suffix.c_str() );
+}
+
+char &String::operator[]( unsigned int index )
+{
+	static char dummy;
+	if ( index >= len )
+	{
+		dummy = 0;
+		return dummy;
+	}
+	return buffer[index];
+}
+
+void String::getBytes( unsigned char *buf, unsigned int bufsize, unsigned int index ) const
+{
+	if ( !bufsize || !buf )
+		return;
+	if ( index >= len )
+	{
+		buf[0] = 0;
+		return;
+	}
+	unsigned int n = bufsize - 1;
+	if ( n > len - index )
+		n = len - index;
+	memcpy( buf, buffer + index, n );
+	buf[n] = 0;
+}
+
+int String::indexOf( char ch, unsigned int fromIndex ) const
+{
+	if ( fromIndex >= len )
+		return -1;
+	const char *found = static_cast<const char *>( memchr( buffer + fromIndex, ch, len - fromIndex ) );
+	return found ? found - buffer : -1;
+}
+
+int String::indexOf( const String &str, unsigned int fromIndex ) const
+{
+	if ( fromIndex >= len )
+		return -1;
+	const char *found = strstr( buffer + fromIndex, str.c_str() );
+	return found ? found - buffer : -1;
+}
+
+int String::lastIndexOf( char ch ) const
+{
+	for ( int x = len - 1; x >= 0; x-- )
+	{
+		if ( buffer[x] == ch )
+			return x;
+	}
+	return -1;
+}
+
+int String::lastIndexOf( const String &str ) const
+{
+	if ( str.len > len )
+		return -1;
+	for ( int x = len - str.len; x >= 0; x-- )
+	{
+		if ( !strncmp( buffer + x, str.c_str(), str.len ) )
+			return x;
+	}
+	return -1;
+}
+
+String String::substring( unsigned int left, unsigned int right ) const
+{
+	if ( left > right )
+	{
+		unsigned int temp = right;
+		right = left;
+		left = temp;
+	}
+	String out;
+	if ( left >= len )
+		return out;
+	if ( right > len )
+		right = len;
+	out.copy( buffer + left, right - left );
+	return out;
+}
+
+void String::replace( char find, char replace )
+{
+	for ( unsigned int x = 0; x < len; x++ )
+	{
+		if ( buffer[x] == find )
+			buffer[x] = replace;
+	}
+}
+
+void String::replace( const String &find, const String &replace )
+{
+	if ( !len || !find.len )
+		return;
+	String out;
+	unsigned int x = 0;
+	while ( x < len )
+	{
+		if ( x + find.len <= len && !strncmp( buffer + x, find.c_str(), find.len ) )
+		{
+			out.concat(replace);
+			x += find.len;
+		}
+		else
+			out.concat( buffer[x++] );
+	}
+	*this = out;
+}
+
+void String::remove( unsigned int index, unsigned int count )
+{
+	if ( index >= len )
+		return;
+	if ( count > len - index )
+		count = len - index;
+	memmove( buffer + index, buffer + index + count, len - index - count );
+	len -= count;
+	buffer[len] = 0;
+}
+
+void String::toLowerCase()
+{
+	for ( unsigned int x = 0; x < len; x++ )
+		buffer[x] = tolower(buffer[x]);
+}
+
+void String::toUpperCase()
+{
+	for ( unsigned int x = 0; x < len; x++ )
+		buffer[x] = toupper(buffer[x]);
+}
+
+void String::trim()
+{
+	if ( !len )
+		return;
+	unsigned int begin = 0, end = len;
+	while ( begin < end && isspace(buffer[begin]) )
+		begin++;
+	while ( end > begin && isspace(buffer[end - 1]) )
+		end--;
+	len = end - begin;
+	if ( begin )
+		memmove( buffer, buffer + begin, len );
+	buffer[len] = 0;
+}
+
+long String::toInt() const
+{
+	return buffer ? atol(buffer) : 0;
+}
+
+float String::toFloat() const
+{
+	return buffer ? atof(buffer) : 0;
+}
+
+double String::toDouble() const
+{
+	return buffer ? atof(buffer) : 0;
+}
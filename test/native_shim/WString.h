@@ -0,0 +1,152 @@
+/*
+ * WString.h
+ *
+ * Host version of the Arduino String, for the native build. The buffer is managed with malloc/realloc/free the same way as on the ESP32
+ * (it only grows, assigning a shorter value keeps it), so the allocation counts seen by the tests match the device.
+ */
+
+#ifndef NATIVE_WSTRING_H_
+#define NATIVE_WSTRING_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class __FlashStringHelper;
+class StringSumHelper;
+
+class String
+{
+	public:
+	String( const char *cstr = "" );
+	String( const char *cstr, unsigned int length );
+	String( const String &str );
+	String( String &&str );
+	explicit String( char c );
+	explicit String( unsigned char value, unsigned char base = 10 );
+	explicit String( int value, unsigned char base = 10 );
+	explicit String( unsigned int value, unsigned char base = 10 );
+	explicit String( long value, unsigned char base = 10 );
+	explicit String( unsigned long value, unsigned char base = 10 );
+	explicit String( long long value, unsigned char base = 10 );
+	explicit String( unsigned long long value, unsigned char base = 10 );
+	explicit String( float value, unsigned char decimals = 2 );
+	explicit String( double value, unsigned char decimals = 2 );
+	~String();
+
+	//Grows the buffer to hold the given length, never shrinks it. Returns false if it couldn't be allocated.
+	bool reserve( unsigned int size );
+	unsigned int length() const { return len; }
+	const char *c_str() const { return buffer ? buffer : ""; }
+
+	String &operator=( const String &rhs );
+	String &operator=( const char *cstr );
+	String &operator=( String &&rhs );
+	String &operator=( StringSumHelper &&rhs );
+
+	bool concat( const String &str ){ return concat( str.c_str(), str.len ); }
+	bool concat( const char *cstr );
+	bool concat( const char *cstr, unsigned int length );
+	bool concat( char c ){ return concat( &c, 1 ); }
+	bool concat( unsigned char num );
+	bool concat( int num );
+	bool concat( unsigned int num );
+	bool concat( long num );
+	bool concat( unsigned long num );
+	bool concat( long long num );
+	bool concat( unsigned long long num );
+	bool concat( float num );
+	bool concat( double num );
+
+	template <class T> String &operator+=( const T &rhs ){ concat(rhs); return *this; }
+
+	friend StringSumHelper &operator+( const StringSumHelper &lhs, const String &rhs );
+	friend StringSumHelper &operator+( const StringSumHelper &lhs, const char *cstr );
+	friend StringSumHelper &operator+( const StringSumHelper &lhs, char c );
+	friend StringSumHelper &operator+( const StringSumHelper &lhs, unsigned char num );
+	friend StringSumHelper &operator+( const StringSumHelper &lhs, int num );
+	friend StringSumHelper &operator+( const StringSumHelper &lhs, unsigned int num );
+	friend StringSumHelper &operator+( const StringSumHelper &lhs, long num );
+	friend StringSumHelper &operator+( const StringSumHelper &lhs, unsigned long num );
+	friend StringSumHelper &operator+( const StringSumHelper &lhs, long long num );
+	friend StringSumHelper &operator+( const StringSumHelper &lhs, unsigned long long num );
+	friend StringSumHelper &operator+( const StringSumHelper &lhs, float num );
+	friend StringSumHelper &operator+( const StringSumHelper &lhs, double num );
+
+	typedef void (String::*StringIfHelperType)() const;
+	void StringIfHelper() const {}
+	operator StringIfHelperType() const { return buffer ? &String::StringIfHelper : 0; }
+
+	int compareTo( const String &s ) const;
+	bool equals( const String &s ) const { return len == s.len && compareTo(s) == 0; }
+	bool equals( const char *cstr ) const { return strcmp( c_str(), cstr ? cstr : "" ) == 0; }
+	bool operator==( const String &rhs ) const { return equals(rhs); }
+	bool operator==( const char *cstr ) const { return equals(cstr); }
+	bool operator!=( const String &rhs ) const { return !equals(rhs); }
+	bool operator!=( const char *cstr ) const { return !equals(cstr); }
+	bool operator<( const String &rhs ) const { return compareTo(rhs) < 0; }
+	bool operator>( const String &rhs ) const { return compareTo(rhs) > 0; }
+	bool equalsIgnoreCase( const String &s ) const;
+	bool startsWith( const String &prefix ) const { return startsWith( prefix, 0 ); }
+	bool startsWith( const String &prefix, unsigned int offset ) const;
+	bool endsWith( const String &suffix ) const;
+
+	char charAt( unsigned int index ) const { return index < len ? buffer[index] : 0; }
+	void setCharAt( unsigned int index, char c ){ if ( index < len ) buffer[index] = c; }
+	char operator[]( unsigned int index ) const { return charAt(index); }
+	char &operator[]( unsigned int index );
+	void getBytes( unsigned char *buf, unsigned int bufsize, unsigned int index = 0 ) const;
+	void toCharArray( char *buf, unsigned int bufsize, unsigned int index = 0 ) const { getBytes( reinterpret_cast<unsigned char *>(buf), bufsize, index ); }
+	const char *begin() const { return c_str(); }
+	const char *end() const { return c_str() + len; }
+
+	int indexOf( char ch, unsigned int fromIndex = 0 ) const;
+	int indexOf( const String &str, unsigned int fromIndex = 0 ) const;
+	int lastIndexOf( char ch ) const;
+	int lastIndexOf( const String &str ) const;
+	String substring( unsigned int beginIndex ) const { return substring( beginIndex, len ); }
+	String substring( unsigned int beginIndex, unsigned int endIndex ) const;
+
+	void replace( char find, char replace );
+	void replace( const String &find, const String &replace );
+	void remove( unsigned int index ){ remove( index, (unsigned int)-1 ); }
+	void remove( unsigned int index, unsigned int count );
+	void toLowerCase();
+	void toUpperCase();
+	void trim();
+	void clear(){ len = 0; if ( buffer ) buffer[0] = 0; }
+
+	long toInt() const;
+	float toFloat() const;
+	double toDouble() const;
+
+	protected:
+	void init(){ buffer = 0; capacity = 0; len = 0; }
+	void invalidate();
+	bool changeBuffer( unsigned int maxStrLen );
+	String &copy( const char *cstr, unsigned int length );
+	void move( String &rhs );
+
+	char *buffer;
+	unsigned int capacity, //characters that fit, not counting the terminator
+				 len;
+};
+
+class StringSumHelper : public String
+{
+	public:
+	StringSumHelper( const String &s ) : String(s) {}
+	StringSumHelper( const char *p ) : String(p) {}
+	StringSumHelper( char c ) : String(c) {}
+	StringSumHelper( unsigned char num ) : String(num) {}
+	StringSumHelper( int num ) : String(num) {}
+	StringSumHelper( unsigned int num ) : String(num) {}
+	StringSumHelper( long num ) : String(num) {}
+	StringSumHelper( unsigned long num ) : String(num) {}
+	StringSumHelper( long long num ) : String(num) {}
+	StringSumHelper( unsigned long long num ) : String(num) {}
+	StringSumHelper( float num ) : String(num) {}
+	StringSumHelper( double num ) : String(num) {}
+};
+
+#endif /* NATIVE_WSTRING_H_ */
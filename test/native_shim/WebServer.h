@@ -0,0 +1,10 @@
+#ifndef NATIVE_WEBSERVER_H_
+#define NATIVE_WEBSERVER_H_
+
+#include "WiFi.h"
+#include "SPIFFS.h"
+
+//Only declared, the web UI isn't part of the native build.
+class WebServer;
+
+#endif /* NATIVE_WEBSERVER_H_ */
@@ -0,0 +1,80 @@
+/*
+ * WiFi.h
+ *
+ * Host stand-in for the Arduino-ESP32 WiFi library. There is no network: a test registers a host with nativeSetRemoteHost(), and clients that
+ * connect to its port exchange requests with it in process. The request and reply buffers are kept between connections, so an exchange only
+ * allocates when a message is longer than any before it.
+ */
+
+#ifndef NATIVE_WIFI_H_
+#define NATIVE_WIFI_H_
+
+#include "Arduino.h"
+
+#define WL_IDLE_STATUS 0
+#define WL_CONNECTED 3
+#define WL_CONNECT_FAILED 4
+#define WL_CONNECTION_LOST 5
+#define WL_DISCONNECTED 6
+
+//Called with each request sent to the host once the client flushes it, fills in the reply.
+typedef void (*Native_Host)( const String &request, String &reply );
+
+class WiFiClient : public Stream
+{
+	public:
+	WiFiClient(){ b_connected = false; i_port = 0; }
+
+	int connect( IPAddress ip, uint16_t port );
+	int connect( IPAddress ip, uint16_t port, int32_t timeout ){ return connect(ip, port); }
+	uint8_t connected(){ return b_connected; }
+	void stop();
+	int setNoDelay( bool ){ return 0; }
+	IPAddress remoteIP() const { return ip_remote; }
+	operator bool(){ return b_connected; }
+
+	virtual size_t write( uint8_t c ){ return write( &c, 1 ); }
+	virtual size_t write( const uint8_t *buf, size_t size );
+	virtual int available();
+	virtual int read();
+	virtual void flush();
+	using Print::print;
+
+	private:
+	bool b_connected;
+	uint16_t i_port;
+	IPAddress ip_remote;
+};
+
+class WiFiServer
+{
+	public:
+	WiFiServer( uint16_t port = 80 ){ i_port = port; }
+	void begin( uint16_t = 0 ){}
+	void setNoDelay( bool ){}
+	//No client ever connects to a server in the native build.
+	WiFiClient available(){ return WiFiClient(); }
+	void stop(){}
+
+	private:
+	uint16_t i_port;
+};
+
+class WiFiClass
+{
+	public:
+	bool isConnected();
+	int status(){ return isConnected() ? WL_CONNECTED : WL_DISCONNECTED; }
+	int32_t RSSI( uint8_t = 0 ){ return -50; }
+	String SSID( uint8_t = 0 ){ return String(); }
+	int hostByName( const char *host, IPAddress &ip ){ return ip.fromString(host); } //numeric addresses only, there is no DNS
+	IPAddress localIP(){ return IPAddress( 127, 0, 0, 1 ); }
+};
+extern WiFiClass WiFi;
+
+//Test controls.
+void nativeSetWiFiConnected( bool connected );
+//Registers the host reached by connecting to the given port (on any address), 0 removes it.
+void nativeSetRemoteHost( uint16_t port, Native_Host host );
+
+#endif /* NATIVE_WIFI_H_ */
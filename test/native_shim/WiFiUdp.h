@@ -0,0 +1,43 @@
+#ifndef NATIVE_WIFIUDP_H_
+#define NATIVE_WIFIUDP_H_
+
+#include "WiFi.h"
+#include <vector>
+
+//Called with each packet sent to the host's port. Fills in the reply and the time (native clock, uS) it arrives back, or returns false to drop the packet.
+typedef bool (*Native_UDP_Host)( const uint8_t *packet, size_t length, std::vector<uint8_t> &reply, int64_t &arrival );
+
+//Packets sent to a port registered with nativeSetUDPHost() are handed to that host in process, and its replies are received in order of arrival once the
+//native clock reaches them. Packets sent to any other port are dropped.
+class WiFiUDP : public Stream
+{
+	public:
+	WiFiUDP(){ i_port = 0; i_readPos = 0; }
+
+	uint8_t begin( uint16_t ){ return 1; }
+	void stop(){}
+	int beginPacket( IPAddress, uint16_t port ){ i_port = port; packet.clear(); return 1; }
+	int beginPacket( const char *, uint16_t port ){ i_port = port; packet.clear(); return 1; }
+	int endPacket();
+	//Returns the size of the next reply that has arrived, 0 if there isn't one.
+	int parsePacket();
+	int read( uint8_t *buf, size_t size );
+	int read( char *buf, size_t size ){ return read( reinterpret_cast<uint8_t *>(buf), size ); }
+	virtual int read();
+	virtual int available(){ return received.size() - i_readPos; }
+	virtual size_t write( uint8_t c ){ return write( &c, 1 ); }
+	virtual size_t write( const uint8_t *buf, size_t size ){ packet.insert( packet.end(), buf, buf + size ); return size; }
+	IPAddress remoteIP(){ return IPAddress(); }
+	uint16_t remotePort(){ return i_port; }
+
+	private:
+	uint16_t i_port;
+	std::vector<uint8_t> packet, //being written
+						 received; //being read
+	size_t i_readPos;
+};
+
+//Registers the host reached by sending to the given port (on any address), 0 removes it. Replies still in flight are discarded.
+void nativeSetUDPHost( uint16_t port, Native_UDP_Host host );
+
+#endif /* NATIVE_WIFIUDP_H_ */
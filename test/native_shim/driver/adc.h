@@ -0,0 +1,6 @@
+#ifndef NATIVE_DRIVER_ADC_H_
+#define NATIVE_DRIVER_ADC_H_
+
+#include "gpio.h"
+
+#endif /* NATIVE_DRIVER_ADC_H_ */
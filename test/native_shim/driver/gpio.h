@@ -0,0 +1,29 @@
+#ifndef NATIVE_DRIVER_GPIO_H_
+#define NATIVE_DRIVER_GPIO_H_
+
+#include <stdint.h>
+#include "../esp_timer.h"
+
+typedef int gpio_num_t;
+typedef enum { GPIO_INTR_DISABLE, GPIO_INTR_POSEDGE, GPIO_INTR_NEGEDGE, GPIO_INTR_ANYEDGE } gpio_int_type_t;
+typedef enum { GPIO_MODE_DISABLE, GPIO_MODE_INPUT, GPIO_MODE_OUTPUT } gpio_mode_t;
+typedef enum { GPIO_PULLUP_DISABLE, GPIO_PULLUP_ENABLE } gpio_pullup_t;
+typedef enum { GPIO_PULLDOWN_DISABLE, GPIO_PULLDOWN_ENABLE } gpio_pulldown_t;
+typedef struct
+{
+	uint64_t pin_bit_mask;
+	gpio_mode_t mode;
+	gpio_pullup_t pull_up_en;
+	gpio_pulldown_t pull_down_en;
+	gpio_int_type_t intr_type;
+} gpio_config_t;
+typedef void (*gpio_isr_t)( void *arg );
+
+esp_err_t gpio_config( const gpio_config_t *config );
+int gpio_get_level( gpio_num_t gpio_num );
+esp_err_t gpio_install_isr_service( int intr_alloc_flags );
+//The handler is kept, and called by nativeSetPin() when the level of the pin changes.
+esp_err_t gpio_isr_handler_add( gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args );
+esp_err_t gpio_isr_handler_remove( gpio_num_t gpio_num );
+
+#endif /* NATIVE_DRIVER_GPIO_H_ */
@@ -0,0 +1,24 @@
+#ifndef NATIVE_ESP32_HAL_GPIO_H_
+#define NATIVE_ESP32_HAL_GPIO_H_
+
+#include <stdint.h>
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x02
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+
+void pinMode( uint8_t pin, uint8_t mode );
+void digitalWrite( uint8_t pin, uint8_t val );
+int digitalRead( uint8_t pin );
+uint16_t analogRead( uint8_t pin );
+double ledcSetup( uint8_t channel, double freq, uint8_t resolution_bits );
+void ledcWrite( uint8_t channel, uint32_t duty );
+void ledcAttachPin( uint8_t pin, uint8_t channel );
+void ledcDetachPin( uint8_t pin );
+
+#endif /* NATIVE_ESP32_HAL_GPIO_H_ */
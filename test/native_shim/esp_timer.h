@@ -0,0 +1,24 @@
+#ifndef NATIVE_ESP_TIMER_H_
+#define NATIVE_ESP_TIMER_H_
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+typedef void *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)( void *arg );
+typedef enum { ESP_TIMER_TASK } esp_timer_dispatch_t;
+typedef struct
+{
+	esp_timer_cb_t callback;
+	void *arg;
+	esp_timer_dispatch_t dispatch_method;
+	const char *name;
+} esp_timer_create_args_t;
+
+//Microseconds since the test started, see nativeSetTime() in Arduino.h.
+int64_t esp_timer_get_time();
+
+#endif /* NATIVE_ESP_TIMER_H_ */
@@ -0,0 +1,15 @@
+#ifndef NATIVE_ESP_WIFI_H_
+#define NATIVE_ESP_WIFI_H_
+
+#include "esp_timer.h"
+
+typedef enum { WIFI_IF_STA, WIFI_IF_AP } wifi_interface_t;
+typedef struct
+{
+	struct { uint8_t ssid[32]; uint8_t password[64]; } ap;
+	struct { uint8_t ssid[32]; uint8_t password[64]; } sta;
+} wifi_config_t;
+
+esp_err_t esp_wifi_get_config( wifi_interface_t interface, wifi_config_t *conf );
+
+#endif /* NATIVE_ESP_WIFI_H_ */
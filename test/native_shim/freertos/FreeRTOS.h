@@ -0,0 +1,40 @@
+/*
+ * FreeRTOS.h
+ *
+ * Host stand-in for the FreeRTOS API used by the PLC runtime. Tasks run as detached threads, notifications and semaphores block on
+ * condition variables, and critical sections are one recursive mutex shared by all of them (the way they exclude both cores on the ESP32).
+ */
+
+#ifndef NATIVE_FREERTOS_H_
+#define NATIVE_FREERTOS_H_
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFF
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) (ms)
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+typedef struct
+{
+	uint32_t owner;
+	uint32_t count;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0, 0 }
+
+void portENTER_CRITICAL( portMUX_TYPE *mux );
+void portEXIT_CRITICAL( portMUX_TYPE *mux );
+void portENTER_CRITICAL_ISR( portMUX_TYPE *mux );
+void portEXIT_CRITICAL_ISR( portMUX_TYPE *mux );
+//Returns the core a task was pinned to, and 1 (the core of the Arduino loop) for any other thread.
+BaseType_t xPortGetCoreID();
+
+#endif /* NATIVE_FREERTOS_H_ */
@@ -0,0 +1,14 @@
+#ifndef NATIVE_FREERTOS_SEMPHR_H_
+#define NATIVE_FREERTOS_SEMPHR_H_
+
+#include "FreeRTOS.h"
+
+typedef void *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake( SemaphoreHandle_t xSemaphore, TickType_t xBlockTime );
+BaseType_t xSemaphoreGive( SemaphoreHandle_t xSemaphore );
+void vSemaphoreDelete( SemaphoreHandle_t xSemaphore );
+
+#endif /* NATIVE_FREERTOS_SEMPHR_H_ */
@@ -0,0 +1,21 @@
+#ifndef NATIVE_FREERTOS_TASK_H_
+#define NATIVE_FREERTOS_TASK_H_
+
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)( void * );
+
+BaseType_t xTaskCreatePinnedToCore( TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth, void *pvParameters,
+									UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask, BaseType_t xCoreID );
+//Deleting another task isn't supported. A task that deletes itself blocks forever, as its thread can't be stopped from inside the call.
+void vTaskDelete( TaskHandle_t xTaskToDelete );
+void vTaskDelay( TickType_t xTicksToDelay );
+void vTaskDelayUntil( TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement );
+TickType_t xTaskGetTickCount();
+uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait );
+BaseType_t xTaskNotifyGive( TaskHandle_t xTaskToNotify );
+//Makes xTaskCreatePinnedToCore fail, to test the paths that handle it.
+void nativeFailTaskCreation( bool fail );
+
+#endif /* NATIVE_FREERTOS_TASK_H_ */
@@ -0,0 +1,19 @@
+#ifndef NATIVE_LWIP_DNS_H_
+#define NATIVE_LWIP_DNS_H_
+
+#include <stdint.h>
+
+typedef int8_t err_t;
+#define ERR_OK 0
+#define ERR_INPROGRESS -5
+#define ERR_ARG -16
+
+typedef struct { uint32_t addr; } ip4_addr_t;
+typedef struct ip_addr { union { ip4_addr_t ip4; } u_addr; uint8_t type; } ip_addr_t;
+#define ip_2_ip4(ipaddr) (&((ipaddr)->u_addr.ip4))
+
+typedef void (*dns_found_callback)( const char *name, const ip_addr_t *ipaddr, void *callback_arg );
+//There is no name service in the native build, every lookup fails with ERR_ARG.
+err_t dns_gethostbyname( const char *hostname, ip_addr_t *addr, dns_found_callback found, void *callback_arg );
+
+#endif /* NATIVE_LWIP_DNS_H_ */
@@ -0,0 +1,9 @@
+#ifndef NATIVE_ROM_CRC_H_
+#define NATIVE_ROM_CRC_H_
+
+#include <stdint.h>
+
+//Same result as the ESP32 ROM function (CRC-32, reflected, polynomial 0xEDB88320).
+uint32_t crc32_le( uint32_t crc, const uint8_t *buf, uint32_t len );
+
+#endif /* NATIVE_ROM_CRC_H_ */
@@ -0,0 +1,26 @@
+#ifndef NATIVE_SOC_PCNT_STRUCT_H_
+#define NATIVE_SOC_PCNT_STRUCT_H_
+
+#include <stdint.h>
+
+//Only the status bits read by the limit interrupt handler.
+typedef struct
+{
+	union
+	{
+		struct
+		{
+			uint32_t cnt_mode:2;
+			uint32_t thres1_lat:1;
+			uint32_t thres0_lat:1;
+			uint32_t l_lim_lat:1;
+			uint32_t h_lim_lat:1;
+			uint32_t zero_lat:1;
+			uint32_t reserved7:25;
+		};
+		uint32_t val;
+	} status_unit[8];
+} pcnt_dev_t;
+extern pcnt_dev_t PCNT;
+
+#endif /* NATIVE_SOC_PCNT_STRUCT_H_ */
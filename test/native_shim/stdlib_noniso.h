@@ -0,0 +1,6 @@
+#ifndef NATIVE_STDLIB_NONISO_H_
+#define NATIVE_STDLIB_NONISO_H_
+
+char *dtostrf( double number, signed char width, unsigned char prec, char *s );
+
+#endif /* NATIVE_STDLIB_NONISO_H_ */
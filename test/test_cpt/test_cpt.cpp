@@ -0,0 +1,266 @@
+/*
+ * test_cpt.cpp
+ *
+ * Checks the expression compiler of the CPT block (see PLC/OBJECTS/MATH/obj_math_cpt.h): precedence and associativity, integer mode, comparisons,
+ * the errors it reports and division by zero. Benchmarks a 10 term formula as one CPT block against the same formula split across chained math
+ * blocks, and checks that both give the same result without allocating.
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <string>
+#include "PLC/PLC_Main.h"
+#include "PLC/OBJECTS/MATH/obj_math_cpt.h"
+#include "NativeBench.h"
+
+#define FORMULA_COPIES 20 //per scan, so the formulas outweigh the rest of the scan
+#define BENCH_SCANS 20000
+
+//Declares the 10 inputs of copy x, and a rung that changes one of them on every scan.
+static void addInputs( std::string &script, int x )
+{
+	char line[128];
+	for ( int y = 0; y < 10; y++ )
+	{
+		snprintf( line, sizeof(line), "V%d_%d[VAR,%d.5]\n", x, y, x + y + 1 );
+		script += line;
+	}
+	snprintf( line, sizeof(line), "R%d[VAR,0.0]\nE = N%d[ADD,V%d_0,0.001,V%d_0]\n", x, x, x, x );
+	script += line;
+}
+
+//R = V0*V1 + V2*V3 - V4/V5 + V6*V7 - V8 + V9
+static String buildCPTScript()
+{
+	std::string script = "E[VAR,1]\n";
+	for ( int x = 0; x < FORMULA_COPIES; x++ )
+	{
+		addInputs(script, x);
+		char rung[256];
+		snprintf( rung, sizeof(rung), "E = C%d[CPT,R%d,V%d_0*V%d_1+V%d_2*V%d_3-V%d_4/V%d_5+V%d_6*V%d_7-V%d_8+V%d_9]\n", x, x, x, x, x, x, x, x, x, x, x, x );
+		script += rung;
+	}
+	return String( script.c_str() );
+}
+
+//The same formula, one operation per block, through temporaries.
+static String buildChainedScript()
+{
+	std::string script = "E[VAR,1]\n";
+	for ( int x = 0; x < FORMULA_COPIES; x++ )
+	{
+		addInputs(script, x);
+		char rung[1024];
+		snprintf( rung, sizeof(rung),
+			"T%d_1[VAR,0.0]\nT%d_2[VAR,0.0]\nT%d_3[VAR,0.0]\nT%d_4[VAR,0.0]\nT%d_5[VAR,0.0]\nT%d_6[VAR,0.0]\nT%d_7[VAR,0.0]\nT%d_8[VAR,0.0]\n"
+			"E = M%d_1[MUL,V%d_0,V%d_1,T%d_1]\nE = M%d_2[MUL,V%d_2,V%d_3,T%d_2]\nE = M%d_3[ADD,T%d_1,T%d_2,T%d_3]\n"
+			"E = M%d_4[DIV,V%d_4,V%d_5,T%d_4]\nE = M%d_5[SUB,T%d_3,T%d_4,T%d_5]\nE = M%d_6[MUL,V%d_6,V%d_7,T%d_6]\n"
+			"E = M%d_7[ADD,T%d_5,T%d_6,T%d_7]\nE = M%d_8[SUB,T%d_7,V%d_8,T%d_8]\nE = M%d_9[ADD,T%d_8,V%d_9,R%d]\n",
+			x, x, x, x, x, x, x, x,
+			x, x, x, x, x, x, x, x, x, x, x, x,
+			x, x, x, x, x, x, x, x, x, x, x, x,
+			x, x, x, x, x, x, x, x, x, x, x, x );
+		script += rung;
+	}
+	return String( script.c_str() );
+}
+
+//Variables the expressions under test can refer to.
+static int64_t A, B, L;
+static double F, dest;
+static bool X;
+
+static shared_ptr<Ladder_VAR> resolve( const String &name )
+{
+	if ( name == "A" ) return make_shared<Ladder_VAR>( &A, "A" );
+	if ( name == "B" ) return make_shared<Ladder_VAR>( &B, "B" );
+	if ( name == "L" ) return make_shared<Ladder_VAR>( &L, "L" );
+	if ( name == "F" ) return make_shared<Ladder_VAR>( &F, "F" );
+	if ( name == "X" ) return make_shared<Ladder_VAR>( &X, "X" );
+	return 0;
+}
+
+//Compiles the expression into a block that stores its result in dest.
+static shared_ptr<ComputeBlockOBJ> compileExpr( const char *expr )
+{
+	shared_ptr<ComputeBlockOBJ> block = make_shared<ComputeBlockOBJ>( "C", make_shared<Ladder_VAR>( &dest, "D" ) );
+	if ( !block->compile( expr, resolve ) )
+		TEST_FAIL_MESSAGE( ( String(expr) + ": " + block->getCompileError() ).c_str() );
+	return block;
+}
+
+static double computeExpr( const char *expr )
+{
+	dest = -12345;
+	compileExpr(expr)->compute();
+	return dest;
+}
+
+//Returns the compile error of an expression that must not compile.
+static String compileError( const char *expr )
+{
+	ComputeBlockOBJ block( "C", make_shared<Ladder_VAR>( &dest, "D" ) );
+	TEST_ASSERT_FALSE( block.compile( expr, resolve ) );
+	return block.getCompileError();
+}
+
+static void runScans( uint16_t scans )
+{
+	for ( uint16_t x = 0; x < scans; x++ )
+	{
+		nativeAdvanceTime(1000);
+		PLCObj.processLogic();
+	}
+}
+
+static double result( int copy )
+{
+	return PLCObj.findLadderVarByID( String("R") + copy )->getValue<double>();
+}
+
+void setUp()
+{
+	nativeSetTimeStep(0);
+	A = 7; B = 2; L = 0; F = 0.5; X = true;
+}
+
+void tearDown(){}
+
+void test_precedence()
+{
+	TEST_ASSERT_FLOAT_WITHIN( 0, 14, computeExpr("2+3*4") );
+	TEST_ASSERT_FLOAT_WITHIN( 0, 20, computeExpr("(2+3)*4") );
+	TEST_ASSERT_FLOAT_WITHIN( 0, 3, computeExpr("10-4-3") ); //left associative
+	TEST_ASSERT_FLOAT_WITHIN( 0, 8, computeExpr("64/4/2") );
+	TEST_ASSERT_FLOAT_WITHIN( 0, 18, computeExpr("2*3^2") );
+	TEST_ASSERT_FLOAT_WITHIN( 0, -4, computeExpr("-2^2") ); //the power binds tighter than the sign
+	TEST_ASSERT_FLOAT_WITHIN( 0, 0.25, computeExpr("2^-2") );
+	TEST_ASSERT_FLOAT_WITHIN( 0, 8, computeExpr("A+B*F+MAX(A,B)-A*B/2-0.0") ); //7 + 1 + 7 - 7 - 0
+	TEST_ASSERT_FLOAT_WITHIN( 1e-12, 3, computeExpr("SQRT(ABS(-A-B))") );
+}
+
+void test_power_is_right_associative()
+{
+	TEST_ASSERT_FLOAT_WITHIN( 0, 512, computeExpr("2^3^2") );
+	TEST_ASSERT_FLOAT_WITHIN( 0, 64, computeExpr("(2^3)^2") );
+	TEST_ASSERT_FLOAT_WITHIN( 0, 2, computeExpr("256^0.5^3") ); //256^(1/8)
+}
+
+void test_integer_mode()
+{
+	TEST_ASSERT_TRUE( compileExpr("A*3%4+ABS(B-A)+MIN(A,B)")->usesInteger() );
+	TEST_ASSERT_FALSE( compileExpr("A/B")->usesInteger() );
+	TEST_ASSERT_FALSE( compileExpr("A^B")->usesInteger() );
+	TEST_ASSERT_FALSE( compileExpr("A+F")->usesInteger() );
+	TEST_ASSERT_FALSE( compileExpr("A+1.0")->usesInteger() );
+	TEST_ASSERT_FALSE( compileExpr("SQRT(A)")->usesInteger() );
+
+	TEST_ASSERT_FLOAT_WITHIN( 0, 1, computeExpr("A*3%4") );
+	TEST_ASSERT_FLOAT_WITHIN( 0, 1, computeExpr("A%B") );
+	A = -7;
+	TEST_ASSERT_FLOAT_WITHIN( 0, -1, computeExpr("A%B") ); //truncated toward zero, as in C
+	TEST_ASSERT_FLOAT_WITHIN( 0, -3.5, computeExpr("A/B") ); //division is done in floating point
+	TEST_ASSERT_FLOAT_WITHIN( 0, 1.5, computeExpr("7.5%B") ); //fmod in floating point
+
+	int64_t result = 0; //64-bit values stay exact, where a double would round them
+	shared_ptr<ComputeBlockOBJ> block = make_shared<ComputeBlockOBJ>( "C", make_shared<Ladder_VAR>( &result, "R" ) );
+	TEST_ASSERT_TRUE( block->compile( "L+1", resolve ) );
+	L = ( 1LL << 53 ) + 1;
+	block->compute();
+	TEST_ASSERT_TRUE( result == ( 1LL << 53 ) + 2 );
+}
+
+void test_comparisons()
+{
+	const char *trueExprs[] = { "B<A", "A>B", "A<=7", "A>=7", "A=7", "A==7", "A!=B", "A<>B", "1+2<2+2", "X*(A>B)", "-A<B" };
+	const char *falseExprs[] = { "A<B", "B>A", "A<=6", "A>=8", "A=B", "A==B", "A!=7", "A<>7", "2+2<1+2", "X*(A<B)" };
+	for ( uint8_t x = 0; x < sizeof(trueExprs) / sizeof(char *); x++ )
+	{
+		TEST_ASSERT_FLOAT_WITHIN( 0, 1, computeExpr(trueExprs[x]) );
+		TEST_ASSERT_TRUE( compileExpr(trueExprs[x])->evaluate() );
+	}
+	for ( uint8_t x = 0; x < sizeof(falseExprs) / sizeof(char *); x++ )
+	{
+		TEST_ASSERT_FLOAT_WITHIN( 0, 0, computeExpr(falseExprs[x]) );
+		TEST_ASSERT_FALSE( compileExpr(falseExprs[x])->evaluate() );
+	}
+}
+
+void test_compile_errors()
+{
+	TEST_ASSERT_EQUAL_STRING( "Unknown function FOO at position 6", compileError("A+FOO(1)").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "Unknown variable Z at position 4", compileError("A*Z").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "Missing ) at position 5", compileError("(A+B").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "Too few arguments for MIN at position 6", compileError("MIN(A)").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "Unexpected end of expression at position 3", compileError("A+").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "Unexpected character ')' at position 2", compileError("A)").c_str() );
+}
+
+//Only the two char comparisons in the grammar are accepted, anything else is an error rather than a shorter operator.
+void test_unlisted_operators_are_rejected()
+{
+	TEST_ASSERT_EQUAL_STRING( "Unexpected character '>' at position 3", compileError("A>>B").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "Unexpected character '>' at position 3", compileError("A=>B").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "Unexpected character '<' at position 3", compileError("A<<B").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "Unexpected character '<' at position 3", compileError("A=<B").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "Unexpected character '!' at position 2", compileError("A!B").c_str() );
+}
+
+//Like a DIV block, a division by zero leaves DEST as it was.
+void test_division_by_zero_keeps_dest()
+{
+	const char *exprs[] = { "A/(B-2)", "F/0", "A%(B-B)", "7.5%0", "1+A/(B-B)*0" };
+	B = 2;
+	for ( uint8_t x = 0; x < sizeof(exprs) / sizeof(char *); x++ )
+	{
+		TEST_ASSERT_FLOAT_WITHIN( 0, -12345, computeExpr(exprs[x]) );
+		TEST_ASSERT_FALSE( compileExpr(exprs[x])->evaluate() );
+	}
+	TEST_ASSERT_FLOAT_WITHIN( 0, 3.5, computeExpr("A/B") ); //and works again once the divisor isn't zero
+}
+
+void test_cpt_matches_chained_blocks()
+{
+	TEST_ASSERT_TRUE( PLCObj.parseScript( buildCPTScript() ) );
+	runScans(100);
+	double cpt[FORMULA_COPIES];
+	for ( int x = 0; x < FORMULA_COPIES; x++ )
+		cpt[x] = result(x);
+
+	double v[10];
+	for ( int y = 0; y < 10; y++ )
+		v[y] = PLCObj.findLadderVarByID( String("V0_") + y )->getValue<double>();
+	TEST_ASSERT_TRUE( fabs( cpt[0] - ( v[0]*v[1] + v[2]*v[3] - v[4]/v[5] + v[6]*v[7] - v[8] + v[9] ) ) < 1e-9 );
+
+	TEST_ASSERT_TRUE( PLCObj.parseScript( buildChainedScript() ) );
+	runScans(100);
+	for ( int x = 0; x < FORMULA_COPIES; x++ )
+		TEST_ASSERT_TRUE( result(x) == cpt[x] ); //same operations in the same order, so the same bits
+}
+
+void test_benchmark_cpt_against_chained_blocks()
+{
+	TEST_ASSERT_TRUE( PLCObj.parseScript( buildCPTScript() ) );
+	Bench_Result cpt = nativeBenchmark( "cpt_10_terms", BENCH_SCANS, [](){ nativeAdvanceTime(1000); PLCObj.processLogic(); } );
+	TEST_ASSERT_TRUE( PLCObj.parseScript( buildChainedScript() ) );
+	Bench_Result chained = nativeBenchmark( "chained_math_10_terms", BENCH_SCANS, [](){ nativeAdvanceTime(1000); PLCObj.processLogic(); } );
+
+	printf( "BENCH cpt speedup over chained blocks: %.2fx\n", chained.d_nsPerRun / cpt.d_nsPerRun );
+	TEST_ASSERT_EQUAL_UINT32( 0, cpt.i_allocs );
+	TEST_ASSERT_EQUAL_UINT32( 0, chained.i_allocs );
+}
+
+int main( int, char ** )
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_precedence);
+	RUN_TEST(test_power_is_right_associative);
+	RUN_TEST(test_integer_mode);
+	RUN_TEST(test_comparisons);
+	RUN_TEST(test_compile_errors);
+	RUN_TEST(test_unlisted_operators_are_rejected);
+	RUN_TEST(test_division_by_zero_keeps_dest);
+	RUN_TEST(test_cpt_matches_chained_blocks);
+	RUN_TEST(test_benchmark_cpt_against_chained_blocks);
+	return UNITY_END();
+}
@@ -0,0 +1,179 @@
+/*
+ * test_heap.cpp
+ *
+ * Checks the heap accounting (see CORE/HeapStats.h): every way of allocating is counted, against the subsystem of the enclosing Heap_Scope,
+ * the bytes in use are taken off the subsystem that allocated them wherever they're freed, and the per thread count only sees the calling thread.
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "CORE/HeapStats.h"
+#include "NativeBench.h"
+
+static void *volatile sink; //keeps the compiler from removing an allocation that is freed right away
+
+struct Tag_Snapshot
+{
+	uint32_t i_allocs, i_frees, i_bytes;
+};
+
+static Tag_Snapshot snapshot( HEAP_TAG tag )
+{
+	const Heap_Tag_Stats &stats = Heap_Monitor::getTagStats(tag);
+	Tag_Snapshot snap = { stats.i_allocs.load(), stats.i_frees.load(), stats.i_bytes.load() };
+	return snap;
+}
+
+void setUp(){}
+void tearDown(){}
+
+void test_malloc_and_free_are_counted_by_scope()
+{
+	Tag_Snapshot before = snapshot(HEAP_TAG_WEB);
+	uint32_t threadBefore = Heap_Monitor::getThreadAllocs();
+	{
+		Heap_Scope scope(HEAP_TAG_WEB);
+		sink = malloc(100);
+		free(sink);
+	}
+	Tag_Snapshot after = snapshot(HEAP_TAG_WEB);
+	TEST_ASSERT_EQUAL_UINT32( before.i_allocs + 1, after.i_allocs );
+	TEST_ASSERT_EQUAL_UINT32( before.i_frees + 1, after.i_frees );
+	TEST_ASSERT_EQUAL_UINT32( before.i_bytes + 100, after.i_bytes );
+	TEST_ASSERT_EQUAL_UINT32( threadBefore + 1, Heap_Monitor::getThreadAllocs() );
+}
+
+void test_calloc_and_realloc_are_counted()
+{
+	Heap_Scope scope(HEAP_TAG_PARSER);
+	Tag_Snapshot before = snapshot(HEAP_TAG_PARSER);
+	void *ptr = calloc(4, 8);
+	ptr = realloc(ptr, 64); //a realloc frees the old block and allocates a new one, even when it grows in place
+	sink = ptr;
+	free(ptr);
+	Tag_Snapshot after = snapshot(HEAP_TAG_PARSER);
+	TEST_ASSERT_EQUAL_UINT32( before.i_allocs + 2, after.i_allocs );
+	TEST_ASSERT_EQUAL_UINT32( before.i_frees + 2, after.i_frees );
+	TEST_ASSERT_EQUAL_UINT32( before.i_bytes + 32 + 64, after.i_bytes );
+}
+
+void test_new_and_containers_are_counted()
+{
+	Heap_Scope scope(HEAP_TAG_PLC);
+	uint32_t before = Heap_Monitor::getThreadAllocs();
+	sink = new int(5);
+	delete static_cast<int *>(sink);
+	shared_ptr<int> shared = make_shared<int>(5);
+	vector<uint8_t> bytes;
+	bytes.push_back(1);
+	TEST_ASSERT_EQUAL_UINT32( before + 3, Heap_Monitor::getThreadAllocs() );
+}
+
+void test_strings_are_counted()
+{
+	Heap_Scope scope(HEAP_TAG_ALERTS);
+	uint32_t before = Heap_Monitor::getThreadAllocs();
+	String str = "Scan ";
+	str += String(12345);
+	TEST_ASSERT_GREATER_THAN_UINT32( before, Heap_Monitor::getThreadAllocs() );
+
+	str.reserve(64);
+	before = Heap_Monitor::getThreadAllocs();
+	str = "";
+	str += "fits in the reserved buffer";
+	TEST_ASSERT_EQUAL_UINT32( before, Heap_Monitor::getThreadAllocs() );
+}
+
+void test_thread_count_ignores_other_threads()
+{
+	uint32_t before = Heap_Monitor::getThreadAllocs();
+	uint32_t otherCount = 0;
+	std::thread other( [&otherCount]{ uint32_t start = Heap_Monitor::getThreadAllocs(); sink = malloc(10); free(sink); otherCount = Heap_Monitor::getThreadAllocs() - start; } );
+	other.join();
+	uint32_t allocs = Heap_Monitor::getThreadAllocs() - before; //std::thread allocates its state on this thread
+	TEST_ASSERT_EQUAL_UINT32( 1, otherCount );
+	TEST_ASSERT_LESS_OR_EQUAL_UINT32( 1, allocs );
+}
+
+void test_benchmark_counts_allocations_per_run()
+{
+	String reused;
+	reused.reserve(32);
+	Bench_Result reserved = nativeBenchmark( "string_reserved", 1000, [&reused](){ reused = ""; reused += "value: "; reused += 12345; } );
+	Bench_Result fresh = nativeBenchmark( "string_fresh", 1000, [](){ String value; value.reserve(32); sink = const_cast<char *>( value.c_str() ); } );
+	TEST_ASSERT_EQUAL_UINT32( 0, reserved.i_allocs );
+	TEST_ASSERT_EQUAL_UINT32( 2000, fresh.i_allocs ); //the empty buffer, then the reserve
+}
+
+static int32_t bytesInUse( HEAP_TAG tag )
+{
+	return Heap_Monitor::getTagStats(tag).i_current.load();
+}
+
+void test_bytes_in_use_follow_the_allocating_scope()
+{
+	int32_t before = bytesInUse(HEAP_TAG_REMOTE), webBefore = bytesInUse(HEAP_TAG_WEB);
+	{
+		Heap_Scope scope(HEAP_TAG_REMOTE);
+		sink = new int[16];
+	}
+	int32_t used = bytesInUse(HEAP_TAG_REMOTE) - before;
+	TEST_ASSERT_TRUE( used >= static_cast<int32_t>( 16 * sizeof(int) + HEAP_TAG_SIZE ) );
+	TEST_ASSERT_TRUE( used < static_cast<int32_t>( 16 * sizeof(int) + HEAP_TAG_SIZE + 32 ) ); //rounded up by the allocator
+	{
+		Heap_Scope scope(HEAP_TAG_WEB);
+		delete[] static_cast<int *>(sink); //freed elsewhere, still counted against the subsystem that allocated it
+	}
+	TEST_ASSERT_EQUAL_INT32( before, bytesInUse(HEAP_TAG_REMOTE) );
+	TEST_ASSERT_EQUAL_INT32( webBefore, bytesInUse(HEAP_TAG_WEB) );
+}
+
+void test_bytes_in_use_cover_malloc_realloc_and_strings()
+{
+	Heap_Scope scope(HEAP_TAG_ALERTS);
+	int32_t before = bytesInUse(HEAP_TAG_ALERTS);
+	void *ptr = malloc(40);
+	int32_t small = bytesInUse(HEAP_TAG_ALERTS) - before;
+	TEST_ASSERT_TRUE( small >= 40 + HEAP_TAG_SIZE );
+	ptr = realloc(ptr, 400);
+	TEST_ASSERT_TRUE( bytesInUse(HEAP_TAG_ALERTS) - before >= 400 + HEAP_TAG_SIZE );
+	sink = ptr;
+	free(ptr);
+	TEST_ASSERT_EQUAL_INT32( before, bytesInUse(HEAP_TAG_ALERTS) );
+
+	{
+		String message;
+		message.reserve(300);
+		TEST_ASSERT_TRUE( bytesInUse(HEAP_TAG_ALERTS) - before >= 300 );
+		TEST_ASSERT_TRUE( Heap_Monitor::getTagStats(HEAP_TAG_ALERTS).i_peak.load() >= bytesInUse(HEAP_TAG_ALERTS) );
+	}
+	TEST_ASSERT_EQUAL_INT32( before, bytesInUse(HEAP_TAG_ALERTS) );
+}
+
+void test_bytes_in_use_across_threads()
+{
+	int32_t before = bytesInUse(HEAP_TAG_PLC);
+	std::thread other( []{ Heap_Scope scope(HEAP_TAG_PLC); sink = malloc(64); } );
+	other.join();
+	TEST_ASSERT_TRUE( bytesInUse(HEAP_TAG_PLC) - before >= 64 );
+	free(sink); //on another thread, outside of any scope
+	TEST_ASSERT_EQUAL_INT32( before, bytesInUse(HEAP_TAG_PLC) );
+}
+
+int main( int, char ** )
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_malloc_and_free_are_counted_by_scope);
+	RUN_TEST(test_calloc_and_realloc_are_counted);
+	RUN_TEST(test_new_and_containers_are_counted);
+	RUN_TEST(test_strings_are_counted);
+	RUN_TEST(test_thread_count_ignores_other_threads);
+	RUN_TEST(test_benchmark_counts_allocations_per_run);
+	RUN_TEST(test_bytes_in_use_follow_the_allocating_scope);
+	RUN_TEST(test_bytes_in_use_cover_malloc_realloc_and_strings);
+	RUN_TEST(test_bytes_in_use_across_threads);
+	return UNITY_END();
+}
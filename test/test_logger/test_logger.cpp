@@ -0,0 +1,270 @@
+/*
+ * test_logger.cpp
+ *
+ * Checks the sample encoding of the logger (see PLC/OBJECTS/obj_logger.h): the varint, zig-zag and XOR codecs round trip every value bit for bit,
+ * including the extremes of each type, and a reader following the log with a cursor gets every saved block once, in order, across file rotations.
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <float.h>
+#include <limits.h>
+#include <string.h>
+#include <math.h>
+#include <thread>
+#include <chrono>
+#include "PLC/OBJECTS/obj_logger.h"
+#include "CORE/UICore.h"
+
+extern UICore Core;
+
+//The variables sampled by the logger under test, one of each type it can log.
+struct Test_Values
+{
+	int64_t i_long;
+	uint64_t i_ulong;
+	int_fast32_t i_int;
+	uint_fast32_t i_uint;
+	uint16_t i_ushort;
+	bool b_bool;
+	double d_float;
+};
+#define TEST_NUM_VARS 7
+
+struct Test_Sample
+{
+	int64_t i_time;
+	uint64_t values[TEST_NUM_VARS];
+};
+
+static Test_Values values;
+static PLC_Timer_Wheel wheel;
+
+static shared_ptr<LoggerOBJ> createLogger( bool attach )
+{
+	vector<shared_ptr<Ladder_VAR>> vars;
+	vars.push_back( make_shared<Ladder_VAR>( &values.i_long, "L" ) );
+	vars.push_back( make_shared<Ladder_VAR>( &values.i_ulong, "UL" ) );
+	vars.push_back( make_shared<Ladder_VAR>( &values.i_int, "I" ) );
+	vars.push_back( make_shared<Ladder_VAR>( &values.i_uint, "UI" ) );
+	vars.push_back( make_shared<Ladder_VAR>( &values.i_ushort, "US" ) );
+	vars.push_back( make_shared<Ladder_VAR>( &values.b_bool, "B" ) );
+	vars.push_back( make_shared<Ladder_VAR>( &values.d_float, "F" ) );
+	vector<String> names;
+	for ( uint8_t x = 0; x < vars.size(); x++ )
+		names.push_back( vars[x]->getID() );
+	return make_shared<LoggerOBJ>( "TL", &wheel, vars, names, 0, OBJ_TYPE::TYPE_LOGGER, attach );
+}
+
+//The raw bits the logger should record for the current values.
+static Test_Sample expected( int64_t time )
+{
+	Test_Sample sample;
+	sample.i_time = time;
+	sample.values[0] = static_cast<uint64_t>(values.i_long);
+	sample.values[1] = values.i_ulong;
+	sample.values[2] = static_cast<uint64_t>( static_cast<int64_t>(values.i_int) );
+	sample.values[3] = values.i_uint;
+	sample.values[4] = values.i_ushort;
+	sample.values[5] = values.b_bool;
+	memcpy( &sample.values[6], &values.d_float, sizeof(double) );
+	return sample;
+}
+
+//Takes one sample at the given time (a period of 0 samples on each rising edge of the rung).
+static void takeSample( LoggerOBJ &logger, int64_t time )
+{
+	bool state = true;
+	wheel.advance(time);
+	logger.setLineState(state, false);
+	logger.updateObject();
+	logger.updateObject(); //the rung goes false again
+}
+
+static void waitUntilSaved( LoggerOBJ &logger )
+{
+	while ( !logger.isSaved() )
+		std::this_thread::sleep_for( std::chrono::milliseconds(1) );
+}
+
+//Reads every block from the cursor on, and appends their samples and sequence numbers.
+static void readAll( LoggerOBJ &logger, Log_Read_Cursor &cursor, uint8_t maxBlocks, vector<Test_Sample> &samples, vector<uint32_t> &sequences, bool once = false )
+{
+	bool more = true;
+	while ( more )
+	{
+		more = logger.readBlocks( cursor, maxBlocks, [&samples, &sequences]( const uint8_t *block, uint16_t length )
+		{
+			Log_Block_Header header;
+			memcpy( &header, block, sizeof(header) );
+			sequences.push_back(header.i_sequence);
+			TEST_ASSERT_EQUAL_UINT8( TEST_NUM_VARS, header.i_numVars );
+			TEST_ASSERT_TRUE( LoggerOBJ::decodeSamples( block, length, [&samples]( int64_t time, const uint64_t *raw )
+			{
+				Test_Sample sample;
+				sample.i_time = time;
+				memcpy( sample.values, raw, sizeof(sample.values) );
+				samples.push_back(sample);
+			}));
+		});
+		if ( once )
+			break;
+	}
+}
+
+static void checkSamples( const vector<Test_Sample> &want, const vector<Test_Sample> &got )
+{
+	TEST_ASSERT_EQUAL_UINT32( want.size(), got.size() );
+	for ( uint32_t x = 0; x < want.size(); x++ )
+	{
+		TEST_ASSERT_TRUE( want[x].i_time == got[x].i_time );
+		TEST_ASSERT_EQUAL_MEMORY( want[x].values, got[x].values, sizeof(want[x].values) );
+	}
+}
+
+void setUp()
+{
+	SPIFFS.format();
+	memset( &values, 0, sizeof(values) );
+}
+
+void tearDown(){}
+
+void test_extreme_values_round_trip()
+{
+	shared_ptr<LoggerOBJ> logger = createLogger(false); //kept in RAM, and read from there
+	const int64_t longs[] = { 0, INT64_MAX, INT64_MIN, -1, 1, INT64_MIN, INT64_MAX, 0 };
+	const uint64_t ulongs[] = { 0, UINT64_MAX, 0, 1ULL << 63, UINT64_MAX - 1, 1, 0, UINT64_MAX };
+	const int32_t ints[] = { 0, INT32_MAX, INT32_MIN, -1, INT32_MAX, 0, INT32_MIN, 1 };
+	const uint32_t uints[] = { 0, UINT32_MAX, 0, UINT32_MAX, 1, UINT32_MAX - 1, 0, 7 };
+	const uint16_t ushorts[] = { 0, UINT16_MAX, 0, 1, UINT16_MAX, UINT16_MAX, 2, 0 };
+	const double floats[] = { 0.0, -0.0, INFINITY, -INFINITY, NAN, DBL_MAX, DBL_MIN / 4, -DBL_MIN };
+	const int64_t times[] = { 1000, 1001, 1001, 5000000000LL, 5000000001LL, 5000000100LL, 9000000000000LL, 9000000000007LL }; //deltas of 0 and huge jumps
+
+	vector<Test_Sample> want, got;
+	vector<uint32_t> sequences;
+	for ( uint8_t x = 0; x < 8; x++ )
+	{
+		values.i_long = longs[x];
+		values.i_ulong = ulongs[x];
+		values.i_int = ints[x];
+		values.i_uint = uints[x];
+		values.i_ushort = ushorts[x];
+		values.b_bool = x & 1;
+		values.d_float = floats[x];
+		takeSample( *logger, times[x] );
+		want.push_back( expected(times[x]) );
+	}
+	for ( uint8_t x = 0; x < 8; x++ ) //repeated values, the XOR of a float with itself is the one byte form
+	{
+		takeSample( *logger, times[7] + 1000 * ( x + 1 ) );
+		want.push_back( expected( times[7] + 1000 * ( x + 1 ) ) );
+	}
+
+	Log_Read_Cursor cursor;
+	logger->beginRead(cursor);
+	readAll( *logger, cursor, 4, got, sequences );
+	checkSamples( want, got );
+}
+
+void test_random_walk_round_trips_across_blocks()
+{
+	shared_ptr<LoggerOBJ> logger = createLogger(true);
+	TEST_ASSERT_TRUE( logger->hasWriter() );
+	vector<Test_Sample> want, got;
+	vector<uint32_t> sequences;
+	uint64_t seed = 12345;
+	int64_t time = 0;
+	for ( uint16_t x = 0; x < 3000; x++ )
+	{
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		values.i_long += static_cast<int64_t>( seed >> 40 ) - ( 1LL << 23 );
+		values.i_ulong ^= seed;
+		values.i_int = static_cast<int32_t>( seed >> 32 );
+		values.i_uint += seed >> 60;
+		values.i_ushort = seed >> 48;
+		values.b_bool = seed >> 63;
+		values.d_float += ( static_cast<double>( seed >> 11 ) / ( 1ULL << 53 ) - 0.5 ) * 0.01;
+		time += 1000 + ( seed >> 58 );
+		takeSample( *logger, time );
+		want.push_back( expected(time) );
+		if ( x % 20 == 0 )
+			waitUntilSaved(*logger); //so the ring never overflows
+	}
+	waitUntilSaved(*logger);
+
+	Log_Read_Cursor cursor;
+	logger->beginRead(cursor);
+	readAll( *logger, cursor, 3, got, sequences );
+	checkSamples( want, got );
+	TEST_ASSERT_EQUAL_UINT32( 0, logger->getObjectVAR(bitTagERR)->getValue<uint32_t>() );
+}
+
+//A reader part way through the current file follows it when it's renamed, and skips ahead when the blocks it was reading have been removed.
+void test_cursor_follows_rotations()
+{
+	shared_ptr<LoggerOBJ> logger = createLogger(true);
+	vector<Test_Sample> got;
+	vector<uint32_t> sequences;
+	uint64_t seed = 99;
+	int64_t time = 0;
+	//Values that change a lot make full blocks quickly. Samples are added until the log file has rotated the given number of times.
+	std::function<void(uint8_t)> fillUntilRotated = [&]( uint8_t rotations )
+	{
+		size_t lastSize = 0;
+		while ( rotations )
+		{
+			for ( uint8_t x = 0; x < 20; x++ )
+			{
+				seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+				values.i_long = seed;
+				values.i_ulong = seed * 3;
+				values.d_float = static_cast<double>(seed);
+				time += 1000;
+				takeSample( *logger, time );
+			}
+			waitUntilSaved(*logger); //the writer task is done with the files
+			size_t size = SPIFFS.exists( logger->getFileName() ) ? SPIFFS.files[ logger->getFileName().c_str() ].size() : 0;
+			if ( size < lastSize )
+				rotations--;
+			lastSize = size;
+		}
+	};
+
+	fillUntilRotated(1);
+	Log_Read_Cursor cursor;
+	logger->beginRead(cursor);
+	readAll( *logger, cursor, 8, got, sequences, true ); //a few blocks from the rotated file
+	while ( cursor.i_file == 0 )
+		readAll( *logger, cursor, 1, got, sequences, true ); //into the current file
+
+	fillUntilRotated(1); //the file being read is renamed, and the cursor follows it
+	readAll( *logger, cursor, 4, got, sequences, true );
+	for ( uint32_t x = 1; x < sequences.size(); x++ )
+		TEST_ASSERT_EQUAL_UINT32( sequences[x - 1] + 1, sequences[x] );
+
+	uint32_t last = sequences.back();
+	fillUntilRotated(3); //the blocks after the cursor are gone
+	readAll( *logger, cursor, 4, got, sequences );
+	for ( uint32_t x = 1; x < sequences.size(); x++ )
+		TEST_ASSERT_TRUE( sequences[x] > sequences[x - 1] ); //in order, never twice
+	TEST_ASSERT_TRUE( sequences.back() > last );
+	TEST_ASSERT_EQUAL_UINT32( 0, logger->getObjectVAR(bitTagERR)->getValue<uint32_t>() );
+
+	//The last block read is the newest one, and the blocks after the skip run to it without gaps.
+	uint32_t skipped = 0;
+	for ( uint32_t x = 1; x < sequences.size(); x++ )
+		skipped += sequences[x] != sequences[x - 1] + 1;
+	TEST_ASSERT_EQUAL_UINT32( 1, skipped );
+}
+
+int main( int, char ** )
+{
+	Core.setup();
+	UNITY_BEGIN();
+	RUN_TEST(test_extreme_values_round_trip);
+	RUN_TEST(test_random_walk_round_trips_across_blocks);
+	RUN_TEST(test_cursor_follows_rotations);
+	return UNITY_END();
+}
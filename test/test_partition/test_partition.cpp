@@ -0,0 +1,217 @@
+/*
+ * test_partition.cpp
+ *
+ * Runs the same program serially and with its independent rungs split across both cores (see PLC/PLC_Partition.h), and checks that every
+ * variable ends up bit-identical. Rungs that share a variable, a timer or an array must land on the same core, however far apart they are in the
+ * program. The native build runs the second share on a std::thread. Both modes are also benchmarked.
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "PLC/PLC_Main.h"
+#include "CORE/UICore.h"
+#include "NativeBench.h"
+
+#define TEST_RUNGS 150
+#define TEST_SCANS 500
+
+//Rungs that share state, with the rung index of each. Every group has a rung before, between and after the independent rungs.
+//SV is read and written by two rungs, the timer TS is run by one rung and its bits read by two others, and AR.0 and AR.3 are separate elements joined by a SUM over the whole array.
+static const char *sharedDecls = "SV[VAR,0]\nTN[VAR,0]\nTA[VAR,0]\nAR[VAR,0,INT32,4]\nAT[VAR,0]\n";
+static const char *sharedRungs[3][3] =
+{
+	{ "SVL1[LES,SV,1000000] = SV1[ADD,SV,3,SV]\n", "TSL[LES,TN,1000000] = TS[TIMER,5,0,TON]\n", "ARL1[LES,AR.0,1000000] = AR1[ADD,AR.0,1,AR.0]\n" },
+	{ "SVL2[GRE,SV,100] = SV2[SUB,SV,50,SV]\n", "TS.DN = TSI[INC,TN]\n", "ARL2[LES,AR.3,1000000] = AR2[ADD,AR.3,2,AR.3]\n" },
+	{ "SVL3[GRE,SV,10] = SV3[MUL,SV,1,SV]\n", "TSG[GRE,TS.ACC,2] = TSA[INC,TA]\n", "ARL3[GRE,AR.0,-1] = ARS[SUM,AR,AT]\n" }
+};
+#define SHARED_GROUPS 3 //variable, timer and array
+#define INDEPENDENT_RUNGS_PER_X 3
+static uint16_t sharedRungIndex[3][3]; //[group][rung]
+
+//Integer, float and compute rungs, plus counters and a one shot, with no rung depending on another so they can be split.
+static String buildScript()
+{
+	std::string script = sharedDecls;
+	uint16_t numRungs = 0;
+	for ( int x = 0; x <= TEST_RUNGS; x++ )
+	{
+		if ( x % ( TEST_RUNGS / 2 ) == 0 ) //at the start, the middle and the end
+		{
+			for ( uint8_t group = 0; group < SHARED_GROUPS; group++ )
+			{
+				script += sharedRungs[x / ( TEST_RUNGS / 2 )][group];
+				sharedRungIndex[group][x / ( TEST_RUNGS / 2 )] = numRungs++;
+			}
+		}
+		if ( x == TEST_RUNGS )
+			break;
+
+		char rung[512];
+		snprintf( rung, sizeof(rung),
+			"A%d[VAR,%d]\nF%d[VAR,%d.25]\nK%d[VAR,0]\n"
+			"Z%d[LES,A%d,1000000] = AA%d[ADD,A%d,%d,A%d] = AM%d[MUL,F%d,1.0001,F%d]\n"
+			"Y%d[GRE,F%d,0] = FC%d[CPT,F%d,F%d-SIN(F%d)*0.5+%d%%7]\n"
+			"W%d[EQ,A%d,A%d] = C%d[COUNTER,%d,0,CTU] = OS%d[ONS] = KI%d[INC,K%d]\n",
+			x, x, x, x, x,
+			x, x, x, x, x % 13 + 1, x, x, x, x,
+			x, x, x, x, x, x, x,
+			x, x, x, x, x % 17 + 2, x, x, x );
+		script += rung;
+		numRungs += INDEPENDENT_RUNGS_PER_X;
+	}
+	return String( script.c_str() );
+}
+
+static void loadScript( bool dualCore )
+{
+	Core.findSetting("plc_dual_core")->setSettingValue( dualCore ? "1" : "0" );
+	TEST_ASSERT_TRUE( PLCObj.parseScript( buildScript() ) );
+}
+
+static void runScans( uint16_t scans )
+{
+	for ( uint16_t x = 0; x < scans; x++ )
+	{
+		nativeAdvanceTime(1000);
+		PLCObj.processLogic();
+	}
+}
+
+//Raw bytes of every variable, in script order.
+static std::vector<uint64_t> snapshot()
+{
+	const char *prefixes[] = { "A", "F", "K" };
+	std::vector<uint64_t> values;
+	for ( int x = 0; x < TEST_RUNGS; x++ )
+	{
+		for ( uint8_t y = 0; y < 3; y++ )
+		{
+			shared_ptr<Ladder_VAR> var = PLCObj.findLadderVarByID( String(prefixes[y]) + x );
+			TEST_ASSERT_NOT_NULL( var.get() );
+			uint64_t bits = 0;
+			if ( var->getType() == OBJ_TYPE::TYPE_VAR_FLOAT )
+			{
+				double value = var->getValue<double>();
+				memcpy( &bits, &value, sizeof(bits) );
+			}
+			else
+				bits = var->getValue<int64_t>();
+			values.push_back(bits);
+		}
+	}
+	const char *shared[] = { "SV", "TN", "TA", "AT", "AR.0", "AR.3", "TS.ACC" };
+	for ( uint8_t x = 0; x < sizeof(shared) / sizeof(char *); x++ )
+	{
+		shared_ptr<Ladder_VAR> var = PLCObj.findLadderVarByID( shared[x] );
+		TEST_ASSERT_NOT_NULL( var.get() );
+		values.push_back( var->getValue<int64_t>() );
+	}
+	return values;
+}
+
+static PLC_Rung_Partition *findPartition()
+{
+	vector<shared_ptr<PLC_Task>> &tasks = PLCObj.getTasks();
+	for ( uint8_t x = 0; x < tasks.size(); x++ )
+	{
+		if ( tasks[x]->getPartition() )
+			return tasks[x]->getPartition().get();
+	}
+	return 0;
+}
+
+//Returns the worker that processes the given rung.
+static uint8_t findWorker( PLC_Rung_Partition *partition, uint16_t rung )
+{
+	for ( uint8_t worker = 0; worker < PARTITION_NUM_WORKERS; worker++ )
+	{
+		const vector<uint16_t> &rungs = partition->getWorkerRungs(worker);
+		if ( std::find( rungs.begin(), rungs.end(), rung ) != rungs.end() )
+			return worker;
+	}
+	TEST_FAIL_MESSAGE("rung not found in any share");
+	return 0;
+}
+
+static bool isParallel()
+{
+	vector<shared_ptr<PLC_Task>> &tasks = PLCObj.getTasks();
+	for ( uint8_t x = 0; x < tasks.size(); x++ )
+	{
+		if ( tasks[x]->getPartition() && tasks[x]->getPartition()->isParallel() )
+			return true;
+	}
+	return false;
+}
+
+void setUp()
+{
+	nativeSetTimeStep(0); //the clock only moves between scans, so both runs see the same times
+}
+
+void tearDown(){}
+
+void test_partitioned_scan_matches_serial_scan()
+{
+	loadScript(false);
+	TEST_ASSERT_FALSE( isParallel() );
+	runScans(TEST_SCANS);
+	std::vector<uint64_t> serial = snapshot();
+	TEST_ASSERT_EQUAL_UINT32( TEST_SCANS, static_cast<uint32_t>(serial[0]) ); //A0 counts up by one every scan
+
+	loadScript(true);
+	TEST_ASSERT_TRUE( isParallel() );
+	runScans(TEST_SCANS);
+	std::vector<uint64_t> partitioned = snapshot();
+
+	TEST_ASSERT_EQUAL_UINT32( serial.size(), partitioned.size() );
+	TEST_ASSERT_EQUAL_MEMORY( &serial[0], &partitioned[0], serial.size() * sizeof(uint64_t) );
+}
+
+void test_shared_rungs_stay_together()
+{
+	loadScript(true);
+	PLC_Rung_Partition *partition = findPartition();
+	TEST_ASSERT_NOT_NULL( partition );
+	TEST_ASSERT_TRUE( partition->isParallel() );
+	TEST_ASSERT_EQUAL_UINT16( TEST_RUNGS + SHARED_GROUPS, partition->getNumGroups() ); //one per independent set, and one per shared set
+	for ( uint8_t group = 0; group < SHARED_GROUPS; group++ )
+	{
+		uint8_t worker = findWorker( partition, sharedRungIndex[group][0] );
+		TEST_ASSERT_EQUAL_UINT8( worker, findWorker( partition, sharedRungIndex[group][1] ) );
+		TEST_ASSERT_EQUAL_UINT8( worker, findWorker( partition, sharedRungIndex[group][2] ) );
+
+		const vector<uint16_t> &rungs = partition->getWorkerRungs(worker); //and in program order
+		TEST_ASSERT_TRUE( std::find( rungs.begin(), rungs.end(), sharedRungIndex[group][0] ) < std::find( rungs.begin(), rungs.end(), sharedRungIndex[group][1] ) );
+		TEST_ASSERT_TRUE( std::find( rungs.begin(), rungs.end(), sharedRungIndex[group][1] ) < std::find( rungs.begin(), rungs.end(), sharedRungIndex[group][2] ) );
+	}
+
+	runScans(TEST_SCANS);
+	TEST_ASSERT_TRUE( PLCObj.findLadderVarByID("TN")->getValue<int64_t>() > 0 ); //the shared rungs did run
+	TEST_ASSERT_TRUE( PLCObj.findLadderVarByID("AT")->getValue<int64_t>() > 0 );
+}
+
+void test_benchmark_serial_and_partitioned_scans()
+{
+	loadScript(false);
+	Bench_Result serial = nativeBenchmark( "scan_serial", TEST_SCANS, [](){ nativeAdvanceTime(1000); PLCObj.processLogic(); } );
+	loadScript(true);
+	Bench_Result partitioned = nativeBenchmark( "scan_partitioned", TEST_SCANS, [](){ nativeAdvanceTime(1000); PLCObj.processLogic(); } );
+
+	printf( "BENCH scan_partitioned speedup: %.2fx\n", serial.d_nsPerRun / partitioned.d_nsPerRun );
+	TEST_ASSERT_EQUAL_UINT32( 0, serial.i_allocs );
+	TEST_ASSERT_EQUAL_UINT32( 0, partitioned.i_allocs );
+}
+
+int main( int, char ** )
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_partitioned_scan_matches_serial_scan);
+	RUN_TEST(test_shared_rungs_stay_together);
+	RUN_TEST(test_benchmark_serial_and_partitioned_scans);
+	return UNITY_END();
+}
@@ -0,0 +1,194 @@
+/*
+ * test_retain.cpp
+ *
+ * Checks that retentive values (see PLC/PLC_Retain.h) survive a restart and a torn journal record, that the writer task saves every value it is
+ * handed while the scan keeps changing them, and measures the write amplification of the
+ * journal for a typical program: counters and a retentive timer that change on every 100 mS scan, and setpoints changed once an hour. The bytes
+ * written over a simulated day give an estimate of how long the flash lasts at each write interval.
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <string>
+#include <chrono>
+#include "PLC/PLC_Main.h"
+#include "CORE/UICore.h"
+
+#define SCAN_TIME 100000 //uS
+#define NUM_COUNTERS 8
+#define NUM_SETPOINTS 8
+#define SETPOINT_PERIOD 3600 //seconds between setpoint changes
+#define SIM_SECONDS 86400
+
+#define FLASH_PARTITION 0x170000 //SPIFFS partition in default.csv
+#define FLASH_FREE 2 //part of the partition (1/n) assumed free for SPIFFS to spread the writes over
+#define FLASH_PAGE 256 //SPIFFS programs whole pages, and updates the file's index page on every write
+#define FLASH_CYCLES 100000 //erase cycles per sector, from the flash datasheet
+
+static String buildScript()
+{
+	std::string script = "E[VAR,1]\nT1[TIMER,1000000000,0,RTO,RET]\nE = T1\n";
+	char line[96];
+	for ( int x = 0; x < NUM_COUNTERS; x++ )
+	{
+		snprintf( line, sizeof(line), "N%d[VAR,0,INT32,RET]\nE = I%d[INC,N%d]\n", x, x, x );
+		script += line;
+	}
+	for ( int x = 0; x < NUM_SETPOINTS; x++ )
+	{
+		snprintf( line, sizeof(line), "S%d[VAR,%d.5,RET]\n", x, x );
+		script += line;
+	}
+	return String( script.c_str() );
+}
+
+static void loadScript( uint16_t interval )
+{
+	Core.findSetting("plc_retain_interval")->setSettingValue( String(interval) );
+	TEST_ASSERT_TRUE( PLCObj.parseScript( buildScript() ) );
+	TEST_ASSERT_EQUAL_UINT16( 1 + NUM_COUNTERS + NUM_SETPOINTS, PLCObj.getRetentiveStorage().getNumEntries() );
+}
+
+static void runScans( uint32_t scans )
+{
+	for ( uint32_t x = 0; x < scans; x++ )
+	{
+		nativeAdvanceTime(SCAN_TIME);
+		PLCObj.processLogic();
+	}
+}
+
+static double value( const String &id )
+{
+	return PLCObj.findLadderVarByID(id)->getValue<double>();
+}
+
+void setUp()
+{
+	nativeSetTimeStep(0);
+	SPIFFS.format();
+}
+
+void tearDown(){}
+
+void test_values_survive_restart()
+{
+	loadScript(1);
+	runScans(25);
+	PLCObj.findLadderVarByID("S3")->setValue( 42.25 );
+	runScans(10); //the next write is due
+	double counter = value("N0"), timer = value("T1.ACC");
+	TEST_ASSERT_EQUAL_INT32( 35, static_cast<int32_t>(counter) );
+	TEST_ASSERT_TRUE( timer > 0 );
+
+	TEST_ASSERT_TRUE( PLCObj.parseScript( buildScript() ) ); //same as a restart, the objects are created again from the script
+	TEST_ASSERT_FLOAT_WITHIN( 0, counter, value("N0") );
+	TEST_ASSERT_FLOAT_WITHIN( 0, counter, value("N7") );
+	TEST_ASSERT_FLOAT_WITHIN( 0, timer, value("T1.ACC") );
+	TEST_ASSERT_FLOAT_WITHIN( 0, 42.25, value("S3") );
+	TEST_ASSERT_FLOAT_WITHIN( 0, 2.5, value("S2") );
+}
+
+void test_torn_record_is_ignored()
+{
+	loadScript(1);
+	runScans(15);
+	double counter = value("N0");
+	TEST_ASSERT_TRUE( PLCObj.parseScript( buildScript() ) ); //saves the last values
+	std::vector<uint8_t> &journal = SPIFFS.files[ file_Retain.c_str() ];
+	uint8_t torn[] = { 1, 2, 3, 4, 5 }; //a record cut short by a power loss
+	journal.insert( journal.end(), torn, torn + sizeof(torn) );
+
+	TEST_ASSERT_TRUE( PLCObj.parseScript( buildScript() ) );
+	TEST_ASSERT_FLOAT_WITHIN( 0, counter, value("N0") );
+}
+
+//The scan thread keeps changing the values while the writer task has a write in flight. Whatever was handed over last must be what is restored.
+void test_writer_task_saves_values()
+{
+	static int64_t counter = 0; //the writer task keeps a pointer to the storage for the life of the process
+	static double setpoint = 0;
+	static PLC_Retain retain;
+	nativeFailTaskCreation(false);
+	TEST_ASSERT_TRUE( retain.add( "WC", make_shared<Ladder_VAR>(&counter, "WC") ) );
+	TEST_ASSERT_TRUE( retain.add( "WS", make_shared<Ladder_VAR>(&setpoint, "WS") ) );
+	retain.restore();
+	nativeFailTaskCreation(true);
+	retain.setInterval(0);
+	for ( int64_t x = 1; x <= 20000; x++ )
+	{
+		counter = x;
+		setpoint = x * 0.5;
+		retain.update(x);
+	}
+	retain.reset(); //waits for the writer task, then saves the rest
+	TEST_ASSERT_TRUE( retain.getStats().i_numFlushes > 1 );
+
+	int64_t restoredCounter = 0;
+	double restoredSetpoint = 0;
+	PLC_Retain restored;
+	restored.add( "WC", make_shared<Ladder_VAR>(&restoredCounter, "WC") );
+	restored.add( "WS", make_shared<Ladder_VAR>(&restoredSetpoint, "WS") );
+	restored.restore();
+	TEST_ASSERT_TRUE( restoredCounter == 20000 );
+	TEST_ASSERT_FLOAT_WITHIN( 0, 10000.0, restoredSetpoint );
+}
+
+//Bytes written to the file system over a simulated day, against the bytes of the values that changed, at several write intervals.
+void test_benchmark_write_amplification()
+{
+	const uint16_t intervals[] = { 0, 1, 10, 60 }; //0 writes on every scan, as there would be without batching
+	double years[4];
+	for ( uint8_t x = 0; x < 4; x++ )
+	{
+		SPIFFS.format();
+		loadScript( intervals[x] );
+		Retain_Stats start = PLCObj.getRetentiveStorage().getStats();
+		uint64_t changes = 0, flashBytes = 0, written = SPIFFS.i_bytesWritten, startWritten = written;
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		for ( uint32_t scan = 1; scan <= SIM_SECONDS * ( 1000000 / SCAN_TIME ); scan++ )
+		{
+			if ( scan % ( SETPOINT_PERIOD * ( 1000000 / SCAN_TIME ) ) == 0 )
+			{
+				for ( int y = 0; y < NUM_SETPOINTS; y++ )
+					PLCObj.findLadderVarByID( String("S") + y )->setValue( static_cast<double>(scan + y) );
+				changes += NUM_SETPOINTS;
+			}
+			runScans(1);
+			changes += NUM_COUNTERS + 1; //the counters and the timer accumulator
+
+			if ( SPIFFS.i_bytesWritten != written ) //pages touched by this write
+			{
+				flashBytes += ( ( SPIFFS.i_bytesWritten - written + FLASH_PAGE - 1 ) / FLASH_PAGE + 1 ) * FLASH_PAGE;
+				written = SPIFFS.i_bytesWritten;
+			}
+		}
+		double ns = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - begin ).count();
+
+		const Retain_Stats &stats = PLCObj.getRetentiveStorage().getStats();
+		uint64_t bytes = stats.i_bytesWritten - start.i_bytesWritten, payload = changes * sizeof(uint64_t); //values are stored as 8 bytes
+		years[x] = static_cast<double>(FLASH_PARTITION / FLASH_FREE) * FLASH_CYCLES / flashBytes / 365;
+		printf( "BENCH retain_interval_%us: %.1f ns/scan, %u writes/day, %u compactions/day, %llu bytes/day for %llu changed value bytes "
+				"(amplification %.3f), %llu flash bytes/day, estimated flash life %.1f years\n",
+				intervals[x], ns / ( SIM_SECONDS * ( 1000000 / SCAN_TIME ) ), stats.i_numFlushes - start.i_numFlushes,
+				stats.i_numCompactions - start.i_numCompactions, static_cast<unsigned long long>(bytes), static_cast<unsigned long long>(payload),
+				static_cast<double>(bytes) / payload, static_cast<unsigned long long>(flashBytes), years[x] );
+		TEST_ASSERT_TRUE( SPIFFS.i_bytesWritten - startWritten == bytes ); //the journal's own count matches the file system's
+	}
+
+	TEST_ASSERT_TRUE( years[2] > 10 ); //the default interval
+	TEST_ASSERT_TRUE( years[2] > years[1] && years[1] > years[0] );
+}
+
+int main( int, char ** )
+{
+	nativeFailTaskCreation(true); //writes are made on the scan thread (except in test_writer_task_saves_values), so the counts don't depend on how the writer task is scheduled
+	Core.setup();
+	UNITY_BEGIN();
+	RUN_TEST(test_values_survive_restart);
+	RUN_TEST(test_torn_record_is_ignored);
+	RUN_TEST(test_writer_task_saves_values);
+	RUN_TEST(test_benchmark_write_amplification);
+	return UNITY_END();
+}
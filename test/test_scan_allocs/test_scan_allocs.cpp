@@ -0,0 +1,208 @@
+/*
+ * test_scan_allocs.cpp
+ *
+ * Runs a script that uses every object type, including a remote client polling an in-process host and the remote server, and checks that
+ * the scan makes no heap allocations once it has warmed up. The scan thread's own count is checked (malloc, realloc and new are all wrapped,
+ * see CORE/HeapStats.h), along with the watchdog's per-phase attribution, which also covers the dual core worker.
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <WiFi.h>
+#include <string>
+#include "PLC/PLC_Main.h"
+#include "PLC/PLC_Watchdog.h"
+#include "CORE/UICore.h"
+#include "CORE/HeapStats.h"
+#include "NativeGlobals.h"
+
+#define REMOTE_PORT 5000
+#define SERVER_PORT 5001
+#define WARMUP_SCANS 20
+#define TEST_SCANS 3000
+
+static int32_t i_remoteValue = 0;
+static void *volatile sink; //keeps the compiler from removing an allocation that is freed right away
+static bool b_remoteLeak = false; //makes the host allocate, as a network library would
+static bool b_remoteFlood = false; //makes the host send replies longer than any valid one
+
+//Answers init requests for any ID (IDs starting with 'B' are booleans, the rest integers), and update requests with changing values.
+//The reply is built in the kept buffer, which is sized on the first request, so the host itself doesn't allocate in the scan.
+static void remoteHost( const String &request, String &reply )
+{
+	reply.reserve(2048);
+	reply = "";
+	int end = request.indexOf(CHAR_QUERY_END);
+	if ( end < 1 )
+		return;
+
+	if ( b_remoteLeak )
+	{
+		sink = malloc(16);
+		free(sink);
+	}
+
+	if ( request[0] == CMD_REQUEST_INIT )
+	{
+		reply += CMD_SEND_INIT;
+		reply.concat( request.c_str() + 1, end - 1 );
+		reply += CHAR_UPDATE_RECORD;
+		reply += static_cast<int>( request[1] == 'B' ? OBJ_TYPE::TYPE_VAR_BOOL : OBJ_TYPE::TYPE_VAR_INT );
+		reply += CHAR_UPDATE_RECORD;
+		reply += '0';
+	}
+	else if ( request[0] == CMD_REQUEST_UPDATE )
+	{
+		i_remoteValue++;
+		reply += CMD_SEND_UPDATE;
+		int start = 1;
+		while ( start < end )
+		{
+			int next = request.indexOf(CHAR_UPDATE_RECORD, start);
+			if ( next < 0 || next > end )
+				next = end;
+			if ( start > 1 )
+				reply += CHAR_UPDATE_GROUP;
+			reply.concat( request.c_str() + start, next - start );
+			reply += CHAR_UPDATE_RECORD;
+			if ( request[start] == 'B' )
+				reply += ( i_remoteValue & 1 ) ? '1' : '0';
+			else
+				reply += i_remoteValue;
+			start = next + 1;
+		}
+	}
+	while ( b_remoteFlood && reply.length() < 2000 )
+		reply += '0';
+	reply += CHAR_QUERY_END;
+	reply += CHAR_TRANSMIT_END;
+}
+
+static String buildScript()
+{
+	std::string script =
+		"E[VAR,1]\nM[VAR,0,INT32]\nF[VAR,0.5]\nAR[VAR,0,DOUBLE,16]\nIA[VAR,0,INT32,8]\nST[VAR,0,INT32]\nDS[VAR,0,INT32]\nRC[VAR,0,INT32]\n"
+		"PV[VAR,1.0]\nSP[VAR,5.0]\nCV[VAR,0.0]\nP1[PID,PV,SP,CV,1,0.1,0,10]\n"
+		"Q1[FIFO,M,4]\nQ2[LIFO,M,4]\nU1[UNLOAD,Q1]\nB1[BSL,E,8]\nB2[BSR,E,8]\n"
+		"SQ[SEQ,ST,1:10,2:20:M>5,4:0]\nLG[LOG,5,F,PV]\nSC[SCH,MTWRF-0800-1700]\n"
+		"R1[REMOTE,10.0.0.5,5000,100,10]\n"
+		"IN1[INPUT,4] = T1[TIMER,100,0,TON] = O1[OUTPUT,2]\nE = T2[TIMER,50,0,TOF]\nT1.DN = T3[TIMER,70,0,RTO]\nE = C1[COUNTER,10,0,CTU]\n"
+		"T1.DN = C2[COUNTER,5,0,CTD] = O2[OUTPUT,13]\nIN2[INPUT,5] = B2\nAI[INPUT,34,A,NO,AVG,4] = O3[OUTPUT,25,PWM,NO,50,1000,8]\n"
+		"H1[HSC,18,100,0,CTU] = O4[OUTPUT,26]\nSC = O5[OUTPUT,27]\nE = P1\nE = MI[INC,M]\nE = OS1[ONS] = MD[DEC,IA.2]\n"
+		"E = Q1\nE = U1\nE = Q2\nE = B1\nE = B2\nE = SQ\nX0[GRE,M,5] = O2\nE = X1[ADD,M,F,F]\nE = X2[MUL,F,2,CV]\nE = X3[CPT,PV,SIN(F)*2+M%7]\n"
+		"E = X4[FILL,M,AR]\nE = X5[SUM,AR,F]\nE = X6[MOV,M,IA.1]\nE = X7[COP,AR,AR,4]\nE = X8[AVG,AR,F]\nX9[LES,M,1000] = X10[EQ,M,M]\n"
+		"R1:BX = O6[OUTPUT,32]\nE = RM[MOV,R1:RV,RC]\n"
+		"RV[VAR,0,INT32,RET]\nE = RI[INC,RV]\nTASK[FAST,1MS]\nE = Y1[INC,DS]\n";
+	for ( int x = 0; x < 100; x++ ) //independent rungs, enough for the dual core partition (see PARTITION_MIN_NODES)
+	{
+		char rung[96];
+		snprintf( rung, sizeof(rung), "G%d[VAR,0]\nZ%d[LES,G%d,1000] = GA%d[ADD,G%d,1,G%d]\n", x, x, x, x, x, x );
+		script += rung;
+	}
+	return String( script.c_str() );
+}
+
+//Loads the script and runs it until everything that is created on first use exists.
+static void loadScript( bool dualCore )
+{
+	Core.findSetting("plc_dual_core")->setSettingValue( dualCore ? "1" : "0" );
+	TEST_ASSERT_TRUE( PLCObj.parseScript( buildScript() ) );
+	PLCObj.createRemoteServer(SERVER_PORT); //kept between scripts
+	TEST_ASSERT_NOT_NULL( PLCObj.getRemoteServer().get() );
+	for ( uint16_t x = 0; x < WARMUP_SCANS; x++ )
+	{
+		nativeAdvanceTime(5000);
+		PLCObj.processLogic();
+	}
+}
+
+static void checkScansDontAllocate()
+{
+	int32_t remoteBefore = i_remoteValue;
+	uint32_t before = Heap_Monitor::getThreadAllocs();
+	for ( uint16_t x = 0; x < TEST_SCANS; x++ )
+	{
+		nativeAdvanceTime(5000);
+		PLCObj.processLogic();
+	}
+	uint32_t allocs = Heap_Monitor::getThreadAllocs() - before;
+
+	const Watchdog_Stats &stats = PLCObj.getScanWatchdog().getStats();
+	TEST_ASSERT_EQUAL_UINT32( 0, allocs );
+	TEST_ASSERT_EQUAL_UINT32( 0, stats.i_allocScans );
+	TEST_ASSERT_TRUE( i_remoteValue - remoteBefore > TEST_SCANS / 4 ); //the remote client did poll the host
+	TEST_ASSERT_EQUAL_INT32( i_remoteValue, PLCObj.findLadderVarByID("RC")->getValue<int32_t>() );
+}
+
+void setUp()
+{
+	nativeSetWiFiConnected(true);
+	nativeSetRemoteHost( REMOTE_PORT, remoteHost );
+	b_remoteLeak = b_remoteFlood = false;
+}
+
+void tearDown()
+{
+	nativeSetRemoteHost( REMOTE_PORT, 0 );
+}
+
+void test_serial_scan_does_not_allocate()
+{
+	loadScript(false);
+	checkScansDontAllocate();
+}
+
+void test_dual_core_scan_does_not_allocate()
+{
+	loadScript(true);
+	bool parallel = false;
+	vector<shared_ptr<PLC_Task>> &tasks = PLCObj.getTasks();
+	for ( uint8_t x = 0; x < tasks.size(); x++ )
+		parallel |= tasks[x]->getPartition() && tasks[x]->getPartition()->isParallel();
+	TEST_ASSERT_TRUE(parallel);
+	checkScansDontAllocate();
+}
+
+void test_allocation_in_remote_phase_is_reported()
+{
+	loadScript(false);
+	b_remoteLeak = true;
+	for ( uint16_t x = 0; x < 10; x++ )
+	{
+		nativeAdvanceTime(5000);
+		PLCObj.processLogic();
+	}
+	b_remoteLeak = false;
+
+	const Watchdog_Stats &stats = PLCObj.getScanWatchdog().getStats();
+	TEST_ASSERT_TRUE( stats.i_allocScans > 0 );
+	TEST_ASSERT_EQUAL_UINT32( stats.i_lastAllocs, stats.lastPhaseAllocs[WATCHDOG_PHASE_ACCESSORS] );
+}
+
+void test_overlong_reply_is_dropped()
+{
+	loadScript(false);
+	int32_t copied = PLCObj.findLadderVarByID("RC")->getValue<int32_t>();
+	b_remoteFlood = true;
+	uint32_t messages = nativeMessageCount();
+	for ( uint16_t x = 0; x < 100; x++ )
+	{
+		nativeAdvanceTime(5000);
+		PLCObj.processLogic();
+	}
+	b_remoteFlood = false;
+
+	TEST_ASSERT_TRUE( nativeMessageCount() > messages );
+	TEST_ASSERT_TRUE( nativeLastMessage().indexOf("too long") > 0 );
+	TEST_ASSERT_EQUAL_INT32( copied, PLCObj.findLadderVarByID("RC")->getValue<int32_t>() ); //no update was applied
+}
+
+int main( int, char ** )
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_serial_scan_does_not_allocate);
+	RUN_TEST(test_dual_core_scan_does_not_allocate);
+	RUN_TEST(test_allocation_in_remote_phase_is_reported);
+	RUN_TEST(test_overlong_reply_is_dropped);
+	return UNITY_END();
+}
@@ -0,0 +1,93 @@
+/*
+ * test_script_check.cpp
+ *
+ * Checks the line numbers a script check (see PLC_Main::checkScript) reports its errors at: every line terminator counts, blank and one char
+ * lines included, and a CRLF is one line even when a chunk read from the file ends between the two chars.
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <string>
+#include "PLC/PLC_Main.h"
+#include "CORE/UICore.h"
+
+#define SCRIPT_FILE "/test_script.txt"
+
+//Saves the script, checks it, and returns the line of each error found.
+static vector<uint16_t> checkLines( const std::string &script )
+{
+	File file = SPIFFS.open( SCRIPT_FILE, FILE_WRITE );
+	file.write( reinterpret_cast<const uint8_t *>( script.c_str() ), script.length() );
+	file.close();
+
+	vector<Script_Diagnostic> errors;
+	file = SPIFFS.open( SCRIPT_FILE, FILE_READ );
+	PLC_Main::checkScript( file, errors );
+	file.close();
+
+	vector<uint16_t> lines;
+	for ( uint8_t x = 0; x < errors.size(); x++ )
+		lines.push_back( errors[x].i_line );
+	return lines;
+}
+
+//A script of the given lines, each ending with the given terminator. Lines named BAD refer to a variable that doesn't exist.
+static std::string buildScript( const vector<std::string> &lines, const std::string &terminator )
+{
+	std::string script;
+	for ( uint8_t x = 0; x < lines.size(); x++ )
+		script += ( lines[x] == "BAD" ? std::string("E = Q[INC,MISSING]") : lines[x] ) + terminator;
+	return script;
+}
+
+static const vector<std::string> scriptLines = { "E[VAR,1]", "", "A[VAR,0]", "X", "", "BAD", "E = I[INC,A]", "", "BAD" }; //errors on lines 6 and 9
+
+void setUp()
+{
+	SPIFFS.format();
+}
+
+void tearDown(){}
+
+void test_blank_and_short_lines_are_counted()
+{
+	vector<uint16_t> lines = checkLines( buildScript( scriptLines, "\n" ) );
+	TEST_ASSERT_EQUAL_UINT32( 2, lines.size() );
+	TEST_ASSERT_EQUAL_UINT16( 6, lines[0] );
+	TEST_ASSERT_EQUAL_UINT16( 9, lines[1] );
+}
+
+void test_crlf_is_one_line()
+{
+	const char *terminators[] = { "\r\n", "\r" };
+	for ( uint8_t x = 0; x < 2; x++ )
+	{
+		vector<uint16_t> lines = checkLines( buildScript( scriptLines, terminators[x] ) );
+		TEST_ASSERT_EQUAL_UINT32( 2, lines.size() );
+		TEST_ASSERT_EQUAL_UINT16( 6, lines[0] );
+		TEST_ASSERT_EQUAL_UINT16( 9, lines[1] );
+	}
+}
+
+void test_crlf_split_between_chunks()
+{
+	std::string script = "E[VAR,1]\r\n";
+	script += "A[VAR,0]" + std::string( SCRIPT_CHUNK_SIZE - script.length() - 9, ' ' ) + "\r\n"; //the CR is the last char of the first chunk
+	TEST_ASSERT_EQUAL_UINT8( '\r', script[SCRIPT_CHUNK_SIZE - 1] );
+	script += "\r\nE = Q[INC,MISSING]\r\n";
+
+	vector<uint16_t> lines = checkLines(script);
+	TEST_ASSERT_EQUAL_UINT32( 1, lines.size() );
+	TEST_ASSERT_EQUAL_UINT16( 4, lines[0] );
+}
+
+int main( int, char ** )
+{
+	Core.setup();
+	UNITY_BEGIN();
+	RUN_TEST(test_blank_and_short_lines_are_counted);
+	RUN_TEST(test_crlf_is_one_line);
+	RUN_TEST(test_crlf_split_between_chunks);
+	return UNITY_END();
+}
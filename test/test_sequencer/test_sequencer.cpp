@@ -0,0 +1,158 @@
+/*
+ * test_sequencer.cpp
+ *
+ * Checks the sequencer object (see PLC/OBJECTS/obj_sequencer.h): steps follow their time and condition transitions, the step and its time are
+ * held while the rung is false, writes to JMP and STEP enter a step, and Tn records the time of each step's last pass.
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include "PLC/PLC_Main.h"
+
+#define SCAN_TIME 10000 //uS
+
+//Step 0 waits for START, step 1 for 100 mS, step 2 for GO, and step 3 completes the sequence after 50 mS.
+static const char *script =
+	"RUN[VAR,TRUE]\nSTART[VAR,FALSE]\nGO[VAR,FALSE]\nOUT[VAR,0,UINT32]\n"
+	"RUN = SQ1[SEQ,OUT,1:0:START,2:100,4:0:GO,8:50]\n";
+
+static void runScans( uint16_t scans )
+{
+	for ( uint16_t x = 0; x < scans; x++ )
+	{
+		nativeAdvanceTime(SCAN_TIME);
+		PLCObj.processLogic();
+	}
+}
+
+static shared_ptr<Ladder_VAR> var( const char *id )
+{
+	shared_ptr<Ladder_VAR> found = PLCObj.findLadderVarByID(id);
+	TEST_ASSERT_NOT_NULL( found.get() );
+	return found;
+}
+
+static int64_t value( const char *id )
+{
+	return var(id)->getValue<int64_t>();
+}
+
+static void set( const char *id, int64_t value )
+{
+	var(id)->setValue(value);
+}
+
+//Only the given step has its step bit set.
+static void assertStep( int64_t step )
+{
+	TEST_ASSERT_EQUAL_INT32( step, value("SQ1.STEP") );
+	TEST_ASSERT_EQUAL_UINT32( 1UL << step, value("OUT") );
+	const char *bits[] = { "SQ1.0", "SQ1.1", "SQ1.2", "SQ1.3" };
+	for ( int64_t x = 0; x < 4; x++ )
+		TEST_ASSERT_EQUAL_INT32( x == step, value(bits[x]) );
+}
+
+void setUp()
+{
+	nativeSetTimeStep(0);
+	TEST_ASSERT_TRUE( PLCObj.parseScript(script) );
+	var("SQ1.ACC"); //ACC is only kept up to date once something refers to it
+}
+
+void tearDown(){}
+
+void test_steps_follow_transitions()
+{
+	runScans(5);
+	assertStep(0); //waiting for START
+	set("START", 1);
+	runScans(1);
+	assertStep(1);
+
+	runScans(9);
+	assertStep(1);
+	TEST_ASSERT_EQUAL_UINT32( 90, value("SQ1.ACC") );
+	TEST_ASSERT_EQUAL_UINT32( 100, value("SQ1.PRE") );
+	runScans(1);
+	assertStep(2); //100 mS in step 1
+	TEST_ASSERT_EQUAL_UINT32( 100, value("SQ1.T1") );
+	TEST_ASSERT_EQUAL_UINT32( 0, value("SQ1.PRE") );
+
+	set("GO", 1);
+	runScans(1);
+	assertStep(3);
+	TEST_ASSERT_EQUAL_UINT32( 10, value("SQ1.T2") );
+	runScans(4);
+	TEST_ASSERT_FALSE( value("SQ1.DN") );
+	runScans(1);
+	TEST_ASSERT_TRUE( value("SQ1.DN") ); //the last step completes the sequence, and stays the current step
+	runScans(10);
+	assertStep(3);
+	TEST_ASSERT_EQUAL_UINT32( 50, value("SQ1.T3") );
+	TEST_ASSERT_EQUAL_UINT32( 50, value("SQ1.ACC") ); //held once done
+}
+
+void test_hold_keeps_step_and_time()
+{
+	set("START", 1);
+	runScans(5); //entered step 1 on the first scan, 40 mS ago
+	TEST_ASSERT_TRUE( value("SQ1.EN") );
+	set("RUN", 0);
+	runScans(50);
+	assertStep(1);
+	TEST_ASSERT_FALSE( value("SQ1.EN") );
+	TEST_ASSERT_EQUAL_UINT32( 50, value("SQ1.ACC") ); //time stops at the scan that sees the rung false
+
+	set("RUN", 1);
+	runScans(5);
+	assertStep(1);
+	runScans(1);
+	assertStep(2);
+	TEST_ASSERT_EQUAL_UINT32( 100, value("SQ1.T1") ); //only the time the sequence was running
+}
+
+void test_jump_and_step_writes()
+{
+	set("START", 1);
+	runScans(2);
+	assertStep(1);
+	TEST_ASSERT_EQUAL_INT32( -1, value("SQ1.JMP") );
+
+	set("SQ1.JMP", 3);
+	runScans(6);
+	TEST_ASSERT_TRUE( value("SQ1.DN") );
+	assertStep(3);
+	TEST_ASSERT_EQUAL_INT32( -1, value("SQ1.JMP") ); //the request is consumed
+
+	set("SQ1.JMP", 3); //to the current step, restarts it and clears DN
+	runScans(1);
+	assertStep(3);
+	TEST_ASSERT_FALSE( value("SQ1.DN") );
+	TEST_ASSERT_EQUAL_UINT32( 0, value("SQ1.ACC") );
+
+	set("SQ1.STEP", 2);
+	runScans(1);
+	assertStep(2); //the step being left is no longer active
+	set("SQ1.STEP", 99); //not a step, ignored
+	runScans(1);
+	assertStep(2);
+	set("SQ1.JMP", 99);
+	runScans(1);
+	assertStep(2);
+	TEST_ASSERT_EQUAL_INT32( -1, value("SQ1.JMP") );
+
+	set("SQ1.STEP", 0); //JMP wins over STEP in the same scan
+	set("SQ1.JMP", 1);
+	set("START", 0);
+	runScans(1);
+	assertStep(1);
+}
+
+int main( int, char ** )
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_steps_follow_transitions);
+	RUN_TEST(test_hold_keeps_step_and_time);
+	RUN_TEST(test_jump_and_step_writes);
+	return UNITY_END();
+}
@@ -0,0 +1,193 @@
+/*
+ * test_settings.cpp
+ *
+ * Checks the binary settings record (see CORE/UICore.h): every setting survives a save and load, fields saved by newer firmware are skipped, and the
+ * text file saved by older firmware is migrated once. Also measures the boot time load and the cost of a save, against the text file the settings
+ * were kept in before: time and allocations per load, and allocations and bytes written per save.
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include "CORE/UICore.h"
+#include "CORE/SlotStorage.h"
+#include "NativeBench.h"
+
+extern UICore Core;
+
+#define BENCH_RUNS 2000
+
+static void set( const char *name, const char *value )
+{
+	Device_Setting *setting = Core.findSetting(name);
+	TEST_ASSERT_NOT_NULL(setting);
+	setting->setSettingValue(value);
+}
+
+static String get( const char *name )
+{
+	return Core.findSetting(name)->getSettingValue();
+}
+
+//Settings of every type, set to values other than the defaults.
+static void setTestValues()
+{
+	set( "dev_serial_v", "3" );
+	set( "bt_en", "1" );
+	set( "net_sta_ssid", "Plant floor network" );
+	set( "net_sta_pwd", "hunter2" );
+	set( "net_sta_retry_count", "7" );
+	set( "plc_broadcast_port", "5005" );
+	set( "time_upd_freq", "123456" );
+	set( "plc_scan_budget", "25000" );
+}
+
+static void checkTestValues()
+{
+	TEST_ASSERT_EQUAL_STRING( "3", get("dev_serial_v").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "1", get("bt_en").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "Plant floor network", get("net_sta_ssid").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "hunter2", get("net_sta_pwd").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "7", get("net_sta_retry_count").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "5005", get("plc_broadcast_port").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "123456", get("time_upd_freq").c_str() );
+	TEST_ASSERT_EQUAL_STRING( "25000", get("plc_scan_budget").c_str() );
+}
+
+static void clearTestValues()
+{
+	set( "dev_serial_v", "0" );
+	set( "bt_en", "0" );
+	set( "net_sta_ssid", "" );
+	set( "net_sta_pwd", "" );
+	set( "net_sta_retry_count", "0" );
+	set( "plc_broadcast_port", "0" );
+	set( "time_upd_freq", "0" );
+	set( "plc_scan_budget", "0" );
+}
+
+//Every setting, by the name it's saved under in the text format.
+static const char *const settingNames[] = { "dev_id", "dev_serial_v", "bt_en", "bt_pwd", "ui_uname", "ui_pwd", "net_ap_en", "net_sta_retry",
+	"net_sta_retry_count", "net_sta_retry_timeout", "net_ap_ssid", "net_sta_ssid", "net_ap_pwd", "net_sta_pwd", "net_hostname", "dns_en", "dns_hostname",
+	"plc_netmode", "plc_broadcast_port", "plc_retain_interval", "time_en", "time_server", "time_port", "time_upd_freq", "plc_dual_core",
+	"plc_scan_budget", "plc_scan_overruns", "plc_scan_policy" };
+
+//The settings as older firmware saved them, one name=value line each.
+static String textSettings()
+{
+	String text;
+	for ( uint8_t x = 0; x < sizeof(settingNames) / sizeof(settingNames[0]); x++ )
+		text += String(settingNames[x]) + String(CHAR_EQUALS) + get(settingNames[x]) + String(CHAR_NEWLINE);
+	return text;
+}
+
+static void writeTextSettings( const String &text )
+{
+	File file = SPIFFS.open( file_Configuration, FILE_WRITE );
+	file.write( reinterpret_cast<const uint8_t *>(text.c_str()), text.length() );
+	file.close();
+}
+
+//Reads the text file the way a boot did before the binary record: a String for each name and value, and a search of the table by name.
+static void loadTextSettings()
+{
+	File file = SPIFFS.open( file_Configuration, FILE_READ );
+	while ( file.position() != file.size() )
+	{
+		String settingID = file.readStringUntil(CHAR_EQUALS),
+			   settingValue = file.readStringUntil(CHAR_NEWLINE);
+		Device_Setting *setting = Core.findSetting(settingID);
+		if ( setting )
+			setting->setSettingValue(settingValue);
+	}
+	file.close();
+}
+
+void setUp()
+{
+	SPIFFS.format();
+	clearTestValues();
+}
+
+void tearDown(){}
+
+void test_settings_round_trip()
+{
+	setTestValues();
+	TEST_ASSERT_TRUE( Core.saveSettings() );
+	clearTestValues();
+	TEST_ASSERT_TRUE( Core.loadSettings() );
+	checkTestValues();
+}
+
+//A field with an ID this firmware doesn't have is skipped, and the fields after it are still read.
+void test_unknown_fields_are_skipped()
+{
+	setTestValues();
+	vector<uint8_t> record;
+	Core.encodeSettings(record);
+	const uint8_t unknown[] = { 250, 3, 1, 2, 3 };
+	record.insert( record.begin() + SETTINGS_HEADER_SIZE, unknown, unknown + sizeof(unknown) );
+	record[5]++;
+	clearTestValues();
+	TEST_ASSERT_TRUE( Core.decodeSettings( record.data(), record.size() ) );
+	checkTestValues();
+
+	record.resize( record.size() - 1 ); //the last field is cut short
+	TEST_ASSERT_FALSE( Core.decodeSettings( record.data(), record.size() ) );
+}
+
+void test_text_settings_are_migrated()
+{
+	setTestValues();
+	writeTextSettings( textSettings() );
+	clearTestValues();
+	TEST_ASSERT_TRUE( Core.loadSettings() );
+	checkTestValues();
+	TEST_ASSERT_FALSE( SPIFFS.exists(file_Configuration) );
+
+	clearTestValues();
+	TEST_ASSERT_TRUE( Core.loadSettings() ); //from the binary record this time
+	checkTestValues();
+}
+
+//Boot time load and the cost of a save, text file (before) against the binary record (after).
+void test_benchmark_load_and_save()
+{
+	setTestValues();
+	String text = textSettings();
+	writeTextSettings(text);
+	Bench_Result textLoad = nativeBenchmark( "settings_load_text", BENCH_RUNS, [](){ loadTextSettings(); } );
+	checkTestValues();
+
+	TEST_ASSERT_TRUE( Core.saveSettings() );
+	Bench_Result binaryLoad = nativeBenchmark( "settings_load_binary", BENCH_RUNS, [](){ Core.loadSettings(); } );
+	checkTestValues();
+
+	uint64_t written = SPIFFS.i_bytesWritten;
+	Bench_Result textSave = nativeBenchmark( "settings_save_text", BENCH_RUNS, [](){ writeTextSettings( textSettings() ); } );
+	uint64_t textBytes = ( SPIFFS.i_bytesWritten - written ) / ( BENCH_RUNS + 1 );
+	written = SPIFFS.i_bytesWritten;
+	Bench_Result binarySave = nativeBenchmark( "settings_save_binary", BENCH_RUNS, [](){ Core.saveSettings(); } );
+	uint64_t binaryBytes = ( SPIFFS.i_bytesWritten - written ) / ( BENCH_RUNS + 1 );
+
+	vector<uint8_t> record;
+	Core.encodeSettings(record);
+	printf( "BENCH settings_size: text %u bytes, binary record %u bytes, %llu bytes written per text save, %llu per binary save (slot, then pointer)\n",
+			text.length(), static_cast<unsigned>(record.size()), static_cast<unsigned long long>(textBytes), static_cast<unsigned long long>(binaryBytes) );
+
+	TEST_ASSERT_TRUE( binaryLoad.d_allocsPerRun < textLoad.d_allocsPerRun );
+	TEST_ASSERT_TRUE( record.size() < text.length() );
+	TEST_ASSERT_TRUE( binarySave.d_allocsPerRun < textSave.d_allocsPerRun );
+}
+
+int main( int, char ** )
+{
+	Core.setup();
+	UNITY_BEGIN();
+	RUN_TEST(test_settings_round_trip);
+	RUN_TEST(test_unknown_fields_are_skipped);
+	RUN_TEST(test_text_settings_are_migrated);
+	RUN_TEST(test_benchmark_load_and_save);
+	return UNITY_END();
+}
@@ -0,0 +1,98 @@
+/*
+ * test_slot_storage.cpp
+ *
+ * Checks the A/B slot storage (see CORE/SlotStorage.h): a damaged current copy falls back on the other slot, and the next save replaces the damaged
+ * slot rather than the only good copy. Also checks that the newest copy wins once the pointer record is lost.
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include "CORE/SlotStorage.h"
+
+#define SLOT_PATH "/test_slots"
+
+static SlotStorage storage( SLOT_PATH );
+
+static bool save( const char *data )
+{
+	return storage.save( data, strlen(data) );
+}
+
+//Returns the data of the copy open() loads, or "none".
+static String load()
+{
+	File file;
+	int32_t length = storage.open(file);
+	if ( length == SLOT_NONE )
+		return String("none");
+
+	String data;
+	for ( int32_t x = 0; x < length; x++ )
+		data += static_cast<char>( file.read() );
+	file.close();
+	return data;
+}
+
+//Flips a bit in the data of the given slot, as a worn flash page would.
+static void damage( const char *suffix )
+{
+	std::vector<uint8_t> &slot = SPIFFS.files[ String( String(SLOT_PATH) + suffix ).c_str() ];
+	TEST_ASSERT_TRUE( slot.size() > sizeof(Slot_Header) );
+	slot[sizeof(Slot_Header)] ^= 0x10;
+}
+
+void setUp()
+{
+	SPIFFS.format();
+}
+
+void tearDown(){}
+
+void test_damaged_copy_falls_back()
+{
+	TEST_ASSERT_TRUE( save("first") ); //slot a
+	TEST_ASSERT_TRUE( save("second") ); //slot b
+	TEST_ASSERT_EQUAL_STRING( "second", load().c_str() );
+	damage(".b");
+	TEST_ASSERT_EQUAL_STRING( "first", load().c_str() );
+}
+
+//The current slot (b) is damaged and open() loads a. The next save goes to b, and a is still there if that save turns out bad as well.
+void test_save_replaces_damaged_slot()
+{
+	TEST_ASSERT_TRUE( save("first") );
+	TEST_ASSERT_TRUE( save("second") );
+	damage(".b");
+
+	TEST_ASSERT_TRUE( save("third") );
+	TEST_ASSERT_EQUAL_STRING( "third", load().c_str() );
+	damage(".b");
+	TEST_ASSERT_EQUAL_STRING( "first", load().c_str() );
+
+	TEST_ASSERT_TRUE( save("fourth") ); //and again
+	TEST_ASSERT_EQUAL_STRING( "fourth", load().c_str() );
+	TEST_ASSERT_TRUE( save("fifth") ); //once b is good, saves alternate again
+	TEST_ASSERT_EQUAL_STRING( "fifth", load().c_str() );
+	damage(".a");
+	TEST_ASSERT_EQUAL_STRING( "fourth", load().c_str() );
+}
+
+void test_newest_copy_wins_without_pointer()
+{
+	TEST_ASSERT_TRUE( save("first") );
+	TEST_ASSERT_TRUE( save("second") );
+	damage(".b");
+	TEST_ASSERT_TRUE( save("third") ); //written to b, and must be newer than the damaged copy it replaced
+	SPIFFS.remove( SLOT_PATH ".ptr" );
+	TEST_ASSERT_EQUAL_STRING( "third", load().c_str() );
+}
+
+int main( int, char ** )
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_damaged_copy_falls_back);
+	RUN_TEST(test_save_replaces_damaged_slot);
+	RUN_TEST(test_newest_copy_wins_without_pointer);
+	return UNITY_END();
+}
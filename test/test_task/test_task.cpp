@@ -0,0 +1,132 @@
+/*
+ * test_task.cpp
+ *
+ * Checks the task scheduling of the scan (see PLC/PLC_Task.h): periodic tasks run once per period and skip the runs they fall behind on, tasks are
+ * ordered by priority whatever their order in the script, and a periodic task that becomes due runs between the rungs of the continuous task.
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <string>
+#include "PLC/PLC_Main.h"
+
+#define MAIN_RUNGS 1000
+
+//MAIN counts its passes in C, one increment per rung. FAST copies C into X, so X shows how far MAIN had got when FAST ran.
+static String buildScript( uint16_t mainRungs )
+{
+	std::string script = "E[VAR,1]\nA[VAR,0]\nB[VAR,0]\nC[VAR,0]\nX[VAR,0]\n";
+	for ( uint16_t x = 0; x < mainRungs; x++ )
+	{
+		char rung[32];
+		snprintf( rung, sizeof(rung), "E = M%u[INC,C]\n", x );
+		script += rung;
+	}
+	script += "TASK[SLOW,20MS]\nE = SI[INC,B]\n"; //declared before FAST, but runs after it
+	script += "TASK[FAST,5MS]\nE = FI[INC,A]\nE = FC[ADD,C,0,X]\n";
+	return String( script.c_str() );
+}
+
+static void runScans( uint16_t scans, int64_t gap )
+{
+	for ( uint16_t x = 0; x < scans; x++ )
+	{
+		nativeAdvanceTime(gap);
+		PLCObj.processLogic();
+	}
+}
+
+static PLC_Task &findTask( const String &name )
+{
+	vector<shared_ptr<PLC_Task>> &tasks = PLCObj.getTasks();
+	for ( uint8_t x = 0; x < tasks.size(); x++ )
+	{
+		if ( tasks[x]->getName() == name )
+			return *tasks[x];
+	}
+	TEST_FAIL_MESSAGE("task not found");
+	return *tasks[0];
+}
+
+static int64_t value( const char *id )
+{
+	return PLCObj.findLadderVarByID(id)->getValue<int64_t>();
+}
+
+void setUp()
+{
+	nativeSetTimeStep(0);
+}
+
+void tearDown()
+{
+	nativeSetTimeStep(0);
+}
+
+void test_tasks_are_ordered_by_priority()
+{
+	TEST_ASSERT_TRUE( PLCObj.parseScript( buildScript(1) ) );
+	vector<shared_ptr<PLC_Task>> &tasks = PLCObj.getTasks();
+	TEST_ASSERT_EQUAL_UINT8( 3, tasks.size() );
+	TEST_ASSERT_TRUE( tasks[0]->getName() == "FAST" );
+	TEST_ASSERT_EQUAL_UINT32( 5000, tasks[0]->getPeriod() );
+	TEST_ASSERT_TRUE( tasks[1]->getName() == "SLOW" );
+	TEST_ASSERT_EQUAL_UINT32( 20000, tasks[1]->getPeriod() );
+	TEST_ASSERT_TRUE( tasks[2]->getName() == "MAIN" );
+	TEST_ASSERT_EQUAL_UINT32( 0, tasks[2]->getPeriod() );
+
+	runScans(1, 1000); //all three are due on the first pass, and FAST runs before MAIN
+	TEST_ASSERT_EQUAL_INT32( 0, value("X") );
+	TEST_ASSERT_EQUAL_INT32( 1, value("C") );
+	runScans(5, 1000);
+	TEST_ASSERT_EQUAL_INT32( 5, value("X") );
+}
+
+void test_periodic_tasks_run_once_per_period()
+{
+	TEST_ASSERT_TRUE( PLCObj.parseScript( buildScript(1) ) );
+	runScans(100, 1000);
+	TEST_ASSERT_EQUAL_UINT32( 20, findTask("FAST").getStats().i_runs );
+	TEST_ASSERT_EQUAL_UINT32( 5, findTask("SLOW").getStats().i_runs );
+	TEST_ASSERT_EQUAL_UINT32( 100, findTask("MAIN").getStats().i_runs );
+	TEST_ASSERT_EQUAL_INT32( 20, value("A") );
+	TEST_ASSERT_EQUAL_INT32( 5, value("B") );
+	TEST_ASSERT_EQUAL_UINT32( 0, findTask("FAST").getStats().i_overruns );
+	TEST_ASSERT_TRUE( findTask("FAST").getStats().i_maxLatency < 1000 );
+
+	//Passes 12 mS apart: FAST is a whole period late every time, and runs once per pass rather than catching up.
+	runScans(10, 12000);
+	TEST_ASSERT_EQUAL_UINT32( 30, findTask("FAST").getStats().i_runs );
+	TEST_ASSERT_EQUAL_UINT32( 10, findTask("FAST").getStats().i_overruns );
+}
+
+void test_continuous_task_is_preempted()
+{
+	TEST_ASSERT_TRUE( PLCObj.parseScript( buildScript(MAIN_RUNGS) ) );
+	nativeSetTimeStep(10); //every clock read takes 10 uS, so a pass of MAIN takes several FAST periods
+	bool midRun = false;
+	for ( uint16_t x = 0; x < 20; x++ )
+	{
+		runScans(1, 0);
+		midRun |= value("X") % MAIN_RUNGS != 0; //FAST ran part way through MAIN's rungs
+	}
+	nativeSetTimeStep(0);
+
+	PLC_Task &fast = findTask("FAST"), &main = findTask("MAIN");
+	TEST_ASSERT_TRUE( midRun );
+	TEST_ASSERT_EQUAL_UINT32( 20, main.getStats().i_runs );
+	TEST_ASSERT_TRUE( main.getStats().i_preemptions > 20 );
+	TEST_ASSERT_TRUE( fast.getStats().i_runs > 20 * 3 ); //several times per pass of MAIN
+	TEST_ASSERT_TRUE( fast.getStats().i_maxLatency < main.getStats().i_maxTime / 10 ); //runs soon after it's due, not after MAIN finishes
+	TEST_ASSERT_TRUE( main.getStats().i_lastTime > 0 ); //the time spent in FAST isn't counted against MAIN
+	TEST_ASSERT_EQUAL_INT32( 20 * MAIN_RUNGS, value("C") );
+}
+
+int main( int, char ** )
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_tasks_are_ordered_by_priority);
+	RUN_TEST(test_periodic_tasks_run_once_per_period);
+	RUN_TEST(test_continuous_task_is_preempted);
+	return UNITY_END();
+}
@@ -0,0 +1,131 @@
+/*
+ * test_time.cpp
+ *
+ * Checks the calendar conversion of Time (see CORE/Time.h) across leap years and rollovers, against a day by day count built from
+ * DaysInMonth, and benchmarks the conversions.
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include "CORE/Time.h"
+#include "NativeBench.h"
+
+void setUp()
+{
+	nativeSetTimeStep(0);
+}
+
+void tearDown(){}
+
+void test_days_in_month_follows_leap_years()
+{
+	TEST_ASSERT_EQUAL_UINT8( 29, Time::DaysInMonth(2024, 2) );
+	TEST_ASSERT_EQUAL_UINT8( 28, Time::DaysInMonth(2023, 2) );
+	TEST_ASSERT_EQUAL_UINT8( 29, Time::DaysInMonth(2000, 2) ); //divisible by 400
+	TEST_ASSERT_EQUAL_UINT8( 28, Time::DaysInMonth(2100, 2) ); //divisible by 100
+	TEST_ASSERT_EQUAL_UINT8( 31, Time::DaysInMonth(2023, 12) );
+	TEST_ASSERT_EQUAL_UINT8( 30, Time::DaysInMonth(2023, 11) );
+}
+
+//Every day from 1970 through 2199, counted one at a time.
+void test_civil_conversion_matches_day_count()
+{
+	int32_t days = 0;
+	for ( int32_t year = 1970; year < 2200; year++ )
+	{
+		for ( uint8_t month = 1; month <= 12; month++ )
+		{
+			for ( uint8_t day = 1; day <= Time::DaysInMonth(year, month); day++, days++ )
+			{
+				TEST_ASSERT_EQUAL_INT32( days, Time::DaysFromCivil(year, month, day) );
+
+				int32_t outYear;
+				uint8_t outMonth, outDay;
+				Time::CivilFromDays( days, outYear, outMonth, outDay );
+				TEST_ASSERT_EQUAL_INT32( year, outYear );
+				TEST_ASSERT_EQUAL_UINT8( month, outMonth );
+				TEST_ASSERT_EQUAL_UINT8( day, outDay );
+			}
+		}
+	}
+}
+
+void test_seconds_roll_over_into_leap_day()
+{
+	Time time( 24, 2, 28, 23, 59, 59 );
+	TEST_ASSERT_TRUE( time.IncrementTime( 1, TIME_SECOND ) );
+	TEST_ASSERT_EQUAL_STRING( "24:02:29:00:00:00", time.GetTimeStr().c_str() );
+	TEST_ASSERT_EQUAL_UINT8( 4, time.getDayOfWeek() ); //Thursday
+
+	Time common( 23, 2, 28, 23, 59, 59 );
+	common.IncrementTime( 1, TIME_SECOND );
+	TEST_ASSERT_EQUAL_STRING( "23:03:01:00:00:00", common.GetTimeStr().c_str() );
+}
+
+void test_year_rolls_over()
+{
+	Time time( 23, 12, 31, 23, 59, 59 );
+	time.IncrementTime( 1, TIME_SECOND );
+	TEST_ASSERT_EQUAL_STRING( "24:01:01:00:00:00", time.GetTimeStr().c_str() );
+	TEST_ASSERT_EQUAL_STRING( "24:1:1:0:0:0", time.GetTimeStr(false).c_str() );
+}
+
+void test_months_clamp_to_the_end_of_the_month()
+{
+	Time time( 24, 1, 31, 12, 0, 0 );
+	time.IncrementTime( 1, TIME_MONTH );
+	TEST_ASSERT_EQUAL_STRING( "24:02:29:12:00:00", time.GetTimeStr().c_str() );
+
+	Time leap( 24, 2, 29, 12, 0, 0 );
+	leap.IncrementTime( 1, TIME_YEAR );
+	TEST_ASSERT_EQUAL_STRING( "25:02:28:12:00:00", leap.GetTimeStr().c_str() );
+}
+
+void test_clock_runs_across_midnight()
+{
+	nativeAdvanceTime( 3600000000LL ); //an hour after boot, which the clock doesn't gain on its first update
+	Time time( 24, 2, 29, 23, 59, 58 );
+	nativeAdvanceTime( 2500000 );
+	time.UpdateTime();
+	TEST_ASSERT_EQUAL_STRING( "24:03:01:00:00:00", time.GetTimeStr().c_str() );
+	TEST_ASSERT_EQUAL_UINT8( 5, time.getDayOfWeek() ); //Friday
+}
+
+void test_time_string_is_returned_by_value()
+{
+	Time time( 24, 6, 1, 8, 0, 0 );
+	String before = time.GetTimeStr();
+	time.IncrementTime( 1, TIME_HOUR );
+	String after = time.GetTimeStr();
+	TEST_ASSERT_EQUAL_STRING( "24:06:01:08:00:00", before.c_str() );
+	TEST_ASSERT_EQUAL_STRING( "24:06:01:09:00:00", after.c_str() );
+}
+
+void test_benchmark_conversions()
+{
+	int32_t year, days = 0;
+	uint8_t month, day;
+	volatile int32_t sum = 0;
+	nativeBenchmark( "time_civil_from_days", 1000000, [&](){ Time::CivilFromDays( days++ % 47482, year, month, day ); sum += day; } );
+	nativeBenchmark( "time_days_from_civil", 1000000, [&](){ days++; sum += Time::DaysFromCivil( 1970 + days % 130, days % 12 + 1, days % 28 + 1 ); } );
+
+	Time time( 24, 1, 1, 0, 0, 0 );
+	nativeBenchmark( "time_fields_new_second", 1000000, [&](){ time.IncrementTime( 1, TIME_SECOND ); sum += time.getDay(); } );
+	nativeBenchmark( "time_fields_same_second", 1000000, [&](){ sum += time.getDay(); } );
+	Bench_Result text = nativeBenchmark( "time_string", 100000, [&](){ time.IncrementTime( 1, TIME_SECOND ); sum += time.GetTimeStr().length(); } );
+	TEST_ASSERT_TRUE( text.d_allocsPerRun <= 1 ); //only the returned String
+}
+
+int main( int, char ** )
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_days_in_month_follows_leap_years);
+	RUN_TEST(test_civil_conversion_matches_day_count);
+	RUN_TEST(test_seconds_roll_over_into_leap_day);
+	RUN_TEST(test_year_rolls_over);
+	RUN_TEST(test_months_clamp_to_the_end_of_the_month);
+	RUN_TEST(test_clock_runs_across_midnight);
+	RUN_TEST(test_time_string_is_returned_by_value);
+	RUN_TEST(test_benchmark_conversions);
+	return UNITY_END();
+}
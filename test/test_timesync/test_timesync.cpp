@@ -0,0 +1,210 @@
+/*
+ * test_timesync.cpp
+ *
+ * Checks the SNTP client (see CORE/TimeSync.h) against an NTP server running in process behind the native WiFiUDP: the offset and round trip
+ * delay it measures, slewing small corrections and stepping large ones, and recovering from dropped, late and unanswered requests.
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include "CORE/TimeSync.h"
+
+#define SERVER_ADDRESS "192.168.1.10"
+#define CLOCK_BASE 1700000000000000LL //uS, the clock's time when the native clock reads 0
+#define POLL_TIME 1000 //uS between calls to process()
+
+//The server's clock runs i_serverOffset ahead of the client's. A request takes i_delayOut to reach it, i_processing to be answered, and the reply
+//i_delayBack to return (all uS). The first i_numDropped requests are never answered, and the reply to the first request is held back by i_firstExtra.
+static int64_t i_serverOffset, i_delayOut, i_delayBack, i_processing, i_firstExtra;
+static uint8_t i_numDropped, i_numRequests;
+
+static void writeNTPTimestamp( uint8_t *buffer, int64_t unixMicros )
+{
+	uint32_t seconds = unixMicros / USEC_PER_SEC + NTP_UNIX_OFFSET;
+	uint32_t fraction = ( ( static_cast<uint64_t>( unixMicros % USEC_PER_SEC ) << 32 ) + USEC_PER_SEC - 1 ) / USEC_PER_SEC; //rounded up, so it reads back as the same uS
+	for ( uint8_t x = 0; x < 4; x++ )
+	{
+		buffer[x] = seconds >> ( 24 - x * 8 );
+		buffer[4 + x] = fraction >> ( 24 - x * 8 );
+	}
+}
+
+static bool ntpServer( const uint8_t *packet, size_t length, std::vector<uint8_t> &reply, int64_t &arrival )
+{
+	if ( length != NTP_PACKET_SIZE || ( packet[0] & 0x07 ) != 3 || i_numRequests++ < i_numDropped )
+		return false;
+
+	int64_t received = arrival + i_delayOut; //the native clock, at the server
+	reply.assign( NTP_PACKET_SIZE, 0 );
+	reply[0] = 0x24; //LI 0, Version 4, Mode 4 (server)
+	reply[1] = 2; //stratum
+	memcpy( &reply[24], packet + 40, 8 ); //originate, the client's transmit timestamp
+	writeNTPTimestamp( &reply[32], CLOCK_BASE + i_serverOffset + received );
+	writeNTPTimestamp( &reply[40], CLOCK_BASE + i_serverOffset + received + i_processing );
+	arrival = received + i_processing + i_delayBack + ( i_numRequests == 1 ? i_firstExtra : 0 );
+	return true;
+}
+
+static Time_Sync sync;
+static WiFiUDP udp;
+static Time systemClock;
+
+//Calls process() every POLL_TIME until the sync finishes, returns the result.
+static uint8_t runSync( uint32_t maxPolls = 10000 )
+{
+	TEST_ASSERT_TRUE( sync.begin(SERVER_ADDRESS) );
+	for ( uint32_t x = 0; x < maxPolls; x++ )
+	{
+		uint8_t result = sync.process( udp, &systemClock );
+		if ( result != SYNC_RESULT_NONE )
+			return result;
+		nativeAdvanceTime(POLL_TIME);
+	}
+	return SYNC_RESULT_NONE;
+}
+
+//Server time less the client's clock (uS).
+static int64_t clockError()
+{
+	systemClock.UpdateTime();
+	return CLOCK_BASE + i_serverOffset + esp_timer_get_time() - systemClock.GetEpochMicros();
+}
+
+void setUp()
+{
+	nativeSetTimeStep(0);
+	nativeAdvanceTime(1000000); //the client takes a request time of 0 as no request sent
+	nativeSetWiFiConnected(true);
+	nativeSetUDPHost( NTP_PORT, ntpServer );
+	i_serverOffset = 0;
+	i_delayOut = i_delayBack = 20000;
+	i_processing = 3000;
+	i_firstExtra = 0;
+	i_numDropped = i_numRequests = 0;
+	systemClock.SetEpochMicros( CLOCK_BASE + esp_timer_get_time() );
+	sync = Time_Sync();
+}
+
+void tearDown()
+{
+	nativeSetUDPHost( NTP_PORT, 0 );
+}
+
+void test_offset_and_delay()
+{
+	i_serverOffset = 250000;
+	TEST_ASSERT_EQUAL_UINT8( SYNC_RESULT_SUCCESS, runSync() );
+	TEST_ASSERT_EQUAL_INT32( 250, sync.getStats().i_lastOffset );
+	TEST_ASSERT_EQUAL_UINT32( 40000, sync.getStats().i_lastRTT ); //the server's processing time isn't part of the delay
+
+	//Half the difference between the two directions shows up in the offset, as it can't be measured.
+	i_serverOffset = -120000;
+	i_delayOut = 50000;
+	i_delayBack = 10000;
+	systemClock.SetEpochMicros( CLOCK_BASE + esp_timer_get_time() );
+	TEST_ASSERT_EQUAL_UINT8( SYNC_RESULT_SUCCESS, runSync() );
+	TEST_ASSERT_EQUAL_INT32( -120 + 20, sync.getStats().i_lastOffset );
+	TEST_ASSERT_EQUAL_UINT32( 60000, sync.getStats().i_lastRTT );
+	TEST_ASSERT_EQUAL_UINT32( 40000, sync.getStats().i_minRTT );
+	TEST_ASSERT_EQUAL_UINT32( 60000, sync.getStats().i_maxRTT );
+	TEST_ASSERT_EQUAL_UINT32( 2, sync.getStats().i_numSyncs );
+}
+
+void test_small_offset_is_slewed()
+{
+	i_serverOffset = TIME_SLEW_LIMIT * 1000; //the largest correction that is slewed
+	TEST_ASSERT_EQUAL_UINT8( SYNC_RESULT_SUCCESS, runSync() );
+	TEST_ASSERT_EQUAL_INT32( TIME_SLEW_LIMIT, sync.getStats().i_lastOffset );
+	TEST_ASSERT_TRUE( clockError() > 490000 ); //no jump
+
+	for ( uint8_t x = 0; x < 10; x++ ) //10 S, a correction of 1% of the elapsed time
+	{
+		nativeAdvanceTime(1000000);
+		systemClock.UpdateTime();
+	}
+	TEST_ASSERT_TRUE( llabs( clockError() - 400000 ) < 1000 );
+	for ( uint8_t x = 0; x < 45; x++ )
+	{
+		nativeAdvanceTime(1000000);
+		systemClock.UpdateTime();
+	}
+	TEST_ASSERT_TRUE( llabs( clockError() ) < 1000 ); //fully corrected, and no further
+}
+
+void test_large_offset_is_stepped()
+{
+	const int64_t offsets[] = { ( TIME_SLEW_LIMIT + 1 ) * 1000, 3600000000LL, -5000000 };
+	for ( uint8_t x = 0; x < 3; x++ )
+	{
+		i_serverOffset = offsets[x];
+		systemClock.SetEpochMicros( CLOCK_BASE + esp_timer_get_time() );
+		TEST_ASSERT_EQUAL_UINT8( SYNC_RESULT_SUCCESS, runSync() );
+		TEST_ASSERT_TRUE( sync.getStats().i_lastOffset == offsets[x] / 1000 );
+		TEST_ASSERT_TRUE( llabs( clockError() ) < 1000 ); //corrected at once
+	}
+}
+
+void test_dropped_requests_are_retried()
+{
+	i_numDropped = NTP_MAX_RETRIES - 1;
+	i_serverOffset = 100000;
+	TEST_ASSERT_EQUAL_UINT8( SYNC_RESULT_SUCCESS, runSync() );
+	TEST_ASSERT_EQUAL_UINT8( NTP_MAX_RETRIES, i_numRequests );
+	TEST_ASSERT_EQUAL_INT32( 100, sync.getStats().i_lastOffset );
+	TEST_ASSERT_EQUAL_UINT32( 0, sync.getStats().i_numFailures );
+}
+
+//The reply to the first request arrives after the retry was sent, and before the retry's reply. It no longer matches a request, so it's ignored.
+void test_late_reply_is_ignored()
+{
+	i_firstExtra = NTP_TIMEOUT * 1000LL;
+	i_delayBack = 100000;
+	TEST_ASSERT_EQUAL_UINT8( SYNC_RESULT_SUCCESS, runSync() );
+	TEST_ASSERT_EQUAL_UINT8( 2, i_numRequests );
+	TEST_ASSERT_EQUAL_UINT32( 120000, sync.getStats().i_lastRTT ); //the retry's round trip
+}
+
+void test_unanswered_sync_fails_and_recovers()
+{
+	i_numDropped = 255;
+	int64_t start = esp_timer_get_time();
+	TEST_ASSERT_EQUAL_UINT8( SYNC_RESULT_FAILED, runSync() );
+	TEST_ASSERT_EQUAL_UINT8( NTP_MAX_RETRIES, i_numRequests );
+	TEST_ASSERT_TRUE( esp_timer_get_time() - start <= ( NTP_TIMEOUT + 2 ) * 1000LL * NTP_MAX_RETRIES );
+	TEST_ASSERT_FALSE( sync.isBusy() );
+	TEST_ASSERT_EQUAL_UINT32( 1, sync.getStats().i_numFailures );
+	TEST_ASSERT_EQUAL_UINT32( 0, sync.getStats().i_numSyncs );
+
+	i_numDropped = 0;
+	i_numRequests = 0;
+	i_serverOffset = 2000000;
+	TEST_ASSERT_EQUAL_UINT8( SYNC_RESULT_SUCCESS, runSync() );
+	TEST_ASSERT_EQUAL_INT32( 2000, sync.getStats().i_lastOffset );
+	TEST_ASSERT_EQUAL_UINT32( 1, sync.getStats().i_numSyncs );
+}
+
+void test_unsynchronized_server_is_ignored()
+{
+	nativeSetUDPHost( NTP_PORT, []( const uint8_t *packet, size_t length, std::vector<uint8_t> &reply, int64_t &arrival )
+	{
+		bool answered = ntpServer( packet, length, reply, arrival );
+		reply[1] = 0; //stratum 0, a kiss-of-death
+		return answered;
+	});
+	TEST_ASSERT_EQUAL_UINT8( SYNC_RESULT_FAILED, runSync() );
+	TEST_ASSERT_EQUAL_UINT8( NTP_MAX_RETRIES, i_numRequests );
+}
+
+int main( int, char ** )
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_offset_and_delay);
+	RUN_TEST(test_small_offset_is_slewed);
+	RUN_TEST(test_large_offset_is_stepped);
+	RUN_TEST(test_dropped_requests_are_retried);
+	RUN_TEST(test_late_reply_is_ignored);
+	RUN_TEST(test_unanswered_sync_fails_and_recovers);
+	RUN_TEST(test_unsynchronized_server_is_ignored);
+	return UNITY_END();
+}
@@ -0,0 +1,121 @@
+/*
+ * test_watchdog.cpp
+ *
+ * Checks which task the scan watchdog's SKIP policy (see PLC/PLC_Watchdog.h) picks on an overrun: the lowest priority task that ran, never the
+ * highest priority one, even when it is the slowest.
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <string>
+#include "PLC/PLC_Main.h"
+#include "PLC/PLC_Watchdog.h"
+#include "CORE/UICore.h"
+#include "NativeGlobals.h"
+
+#define CLOCK_STEP 10 //uS that pass on every read of the clock, so the rungs take time
+
+//The FAST task has the most rungs, so it takes the longest in every scan.
+static String buildScript( bool withMain, bool withSlow )
+{
+	std::string script = "E[VAR,1]\nA[VAR,0]\nB[VAR,0]\nC[VAR,0]\n";
+	if ( withMain )
+		script += "E = MI[INC,C]\n";
+	if ( withSlow )
+		script += "TASK[SLOW,20MS]\nE = SI[INC,B]\n";
+	script += "TASK[FAST,1MS]\n";
+	for ( int x = 0; x < 20; x++ )
+	{
+		char rung[48];
+		snprintf( rung, sizeof(rung), "E = FI%d[INC,A]\n", x );
+		script += rung;
+	}
+	return String( script.c_str() );
+}
+
+static void loadScript( bool withMain, bool withSlow )
+{
+	TEST_ASSERT_TRUE( PLCObj.parseScript( buildScript(withMain, withSlow) ) );
+	Core.findSetting("plc_scan_budget")->setSettingValue("50");
+	Core.findSetting("plc_scan_overruns")->setSettingValue("1");
+	Core.findSetting("plc_scan_policy")->setSettingValue( String(WATCHDOG_POLICY_SKIP) );
+}
+
+static void runScans( uint16_t scans )
+{
+	for ( uint16_t x = 0; x < scans; x++ )
+	{
+		nativeAdvanceTime(1000);
+		PLCObj.processLogic();
+	}
+}
+
+static PLC_Task &findTask( const String &name )
+{
+	vector<shared_ptr<PLC_Task>> &tasks = PLCObj.getTasks();
+	for ( uint8_t x = 0; x < tasks.size(); x++ )
+	{
+		if ( tasks[x]->getName() == name )
+			return *tasks[x];
+	}
+	TEST_FAIL_MESSAGE("task not found");
+	return *tasks[0];
+}
+
+void setUp()
+{
+	nativeSetTimeStep(CLOCK_STEP);
+}
+
+void tearDown()
+{
+	Core.findSetting("plc_scan_budget")->setSettingValue("0");
+	nativeSetTimeStep(0);
+}
+
+void test_continuous_task_is_skipped_first()
+{
+	loadScript(true, true);
+	vector<shared_ptr<PLC_Task>> &tasks = PLCObj.getTasks();
+	TEST_ASSERT_EQUAL_UINT8( 3, tasks.size() );
+	TEST_ASSERT_TRUE( tasks[0]->getName() == "FAST" );
+	TEST_ASSERT_EQUAL_UINT32( 0, tasks[2]->getPeriod() );
+
+	runScans(10);
+	TEST_ASSERT_TRUE( PLCObj.getScanWatchdog().getStats().i_trips > 0 );
+	TEST_ASSERT_EQUAL_UINT32( 0, findTask("FAST").getStats().i_skips );
+	TEST_ASSERT_TRUE( tasks[2]->getStats().i_skips > 0 );
+}
+
+void test_longest_period_is_skipped_without_continuous_task()
+{
+	loadScript(false, true);
+	bool reported = false; //the trip names the task it will skip, in the scans where SLOW ran
+	for ( uint16_t x = 0; x < 100; x++ )
+	{
+		runScans(1);
+		reported |= nativeLastMessage().indexOf("skipping task") > 0;
+	}
+	TEST_ASSERT_TRUE( PLCObj.getScanWatchdog().getStats().i_trips > 0 );
+	TEST_ASSERT_EQUAL_UINT32( 0, findTask("FAST").getStats().i_skips );
+	TEST_ASSERT_TRUE( findTask("SLOW").getStats().i_skips > 0 );
+	TEST_ASSERT_TRUE( reported );
+}
+
+void test_highest_priority_task_is_never_skipped()
+{
+	loadScript(false, false);
+	runScans(10);
+	TEST_ASSERT_TRUE( PLCObj.getScanWatchdog().getStats().i_trips > 0 );
+	TEST_ASSERT_EQUAL_UINT32( 0, findTask("FAST").getStats().i_skips );
+	TEST_ASSERT_TRUE( nativeLastMessage().indexOf("skipping") < 0 );
+}
+
+int main( int, char ** )
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_continuous_task_is_skipped_first);
+	RUN_TEST(test_longest_period_is_skipped_without_continuous_task);
+	RUN_TEST(test_highest_priority_task_is_never_skipped);
+	return UNITY_END();
+}
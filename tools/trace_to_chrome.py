@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""
+Converts an ESPLC event trace dump to the Chrome trace JSON format, for viewing in chrome://tracing or https://ui.perfetto.dev
+
+The input is either the binary file from the /trace route, or a serial log containing the output of the /r command (lines starting with "T:").
+The dump format is described in src/CORE/Trace.h.
+
+Usage: trace_to_chrome.py <dump> [output.json]
+"""
+
+import json
+import struct
+import sys
+
+TRACE_MAGIC = 0x31435254
+HEADER = struct.Struct("<IHHII")
+RECORD = struct.Struct("<IHBBII")
+
+(SCAN_BEGIN, SCAN_END, TASK_BEGIN, TASK_END, RUNG_BEGIN, RUNG_END, OUTPUT_CHANGE, REMOTE_REQUEST, REMOTE_RESPONSE,
+ WEB_REQUEST, PARSE_BEGIN, PARSE_END, OVERRUN) = range(1, 14)
+
+PARSE_PHASES = ["Parse script", "Build tasks", "Restore retentive values"]
+
+
+def read_dump(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if data[:4] != struct.pack("<I", TRACE_MAGIC):  # serial log, rebuild the binary dump from the hex lines
+        hex_lines = []
+        for line in data.decode("ascii", "replace").splitlines():
+            pos = line.find("T:")
+            if pos >= 0:
+                hex_lines.append(line[pos + 2:].strip())
+        data = bytes.fromhex("".join(hex_lines))
+
+    magic, size, _, recorded, first = HEADER.unpack_from(data, 0)
+    if magic != TRACE_MAGIC or size != RECORD.size:
+        sys.exit("Not an ESPLC trace dump")
+
+    records = [RECORD.unpack_from(data, pos) for pos in range(HEADER.size, len(data) - RECORD.size + 1, RECORD.size)]
+    return recorded, first, records
+
+
+def convert(records):
+    events = []
+    cores = set()
+    wrap = 0
+    last = None
+    for time, ident, kind, core, value, _ in records:
+        if last is not None and time + wrap < last - 0x80000000:  # the 32 bit uS timestamp wraps every ~71 minutes
+            wrap += 0x100000000
+        ts = time + wrap
+        last = ts
+        cores.add(core)
+        base = {"pid": 1, "tid": core, "ts": ts}
+
+        if kind in (SCAN_BEGIN, SCAN_END):
+            events.append(dict(base, name="Scan", ph="B" if kind == SCAN_BEGIN else "E"))
+        elif kind in (TASK_BEGIN, TASK_END):
+            events.append(dict(base, name="Task %d" % ident, ph="B" if kind == TASK_BEGIN else "E"))
+        elif kind in (RUNG_BEGIN, RUNG_END):
+            events.append(dict(base, name="Rung %d" % (ident + 1), ph="B" if kind == RUNG_BEGIN else "E"))
+        elif kind == OUTPUT_CHANGE:
+            events.append(dict(base, name="Output pin %d" % ident, ph="C", args={"value": value}))
+        elif kind == REMOTE_REQUEST:
+            events.append(dict(base, name="Remote request .%d" % ident, ph="i", s="t", args={"bytes": value}))
+        elif kind == REMOTE_RESPONSE:
+            if value:
+                events.append(dict(base, name="Remote reply .%d" % ident, ph="X", ts=ts - value, dur=value))
+            else:
+                events.append(dict(base, name="Remote no reply .%d" % ident, ph="i", s="t"))
+        elif kind == WEB_REQUEST:
+            events.append(dict(base, name="Web request", ph="X", dur=value))
+        elif kind in (PARSE_BEGIN, PARSE_END):
+            name = PARSE_PHASES[ident] if ident < len(PARSE_PHASES) else "Parse phase %d" % ident
+            event = dict(base, name=name, ph="B" if kind == PARSE_BEGIN else "E")
+            if kind == PARSE_END:
+                event["args"] = {"count": value}
+            events.append(event)
+        elif kind == OVERRUN:
+            events.append(dict(base, name="Scan overrun", ph="i", s="g", args={"scan_us": value}))
+
+    for core in sorted(cores):
+        events.append({"pid": 1, "tid": core, "ph": "M", "name": "thread_name", "args": {"name": "Core %d" % core}})
+    return events
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+
+    recorded, first, records = read_dump(sys.argv[1])
+    trace = {"traceEvents": convert(records), "otherData": {"recorded": recorded, "first": first, "dumped": len(records)}}
+
+    out = open(sys.argv[2], "w") if len(sys.argv) > 2 else sys.stdout
+    json.dump(trace, out)
+    if out is not sys.stdout:
+        out.close()
+        print("%d events (%d recorded since boot)" % (len(records), recorded))
+
+
+if __name__ == "__main__":
+    main()